@@ -2,13 +2,17 @@
 #include "esp_log.h"
 #include "lwip/sockets.h"
 #include <errno.h>
+#include <cstring>
 
 static const char *TAG = "EspSocketTransport";
 
 namespace tinymcp {
 
-EspSocketTransport::EspSocketTransport(int sock) : sock_(sock), read_buffer_("") {
-    ESP_LOGI(TAG, "EspSocketTransport created with socket %d", sock_);
+EspSocketTransport::EspSocketTransport(int sock, size_t bufferCapacity)
+    : sock_(sock), rx_buf_(new char[bufferCapacity]), rx_capacity_(bufferCapacity),
+      rx_head_(0), rx_tail_(0), rx_scan_(0) {
+    ESP_LOGI(TAG, "EspSocketTransport created with socket %d (%u byte buffer)",
+             sock_, (unsigned)rx_capacity_);
 }
 
 EspSocketTransport::~EspSocketTransport() {
@@ -20,41 +24,53 @@ EspSocketTransport::~EspSocketTransport() {
 }
 
 bool EspSocketTransport::read(std::string &buffer) {
+    std::string_view frame;
+    if (!readView(frame)) {
+        buffer.clear();
+        return false;
+    }
+
+    // Reuses the caller's capacity, so steady-state reads do not allocate
+    buffer.assign(frame.data(), frame.size());
+    return true;
+}
+
+bool EspSocketTransport::readView(std::string_view &frame) {
+    frame = std::string_view();
+
     if (sock_ < 0) {
         ESP_LOGE(TAG, "Socket is invalid");
         return false;
     }
 
-    // Buffer size limit to prevent DoS attacks (16KB should be enough for MCP messages)
-    const size_t MAX_BUFFER_SIZE = 16384;
-
     // First check if we have a complete message in our buffer
-    size_t newline_pos = read_buffer_.find('\n');
-    if (newline_pos != std::string::npos) {
-        // Extract complete message (excluding newline)
-        buffer = read_buffer_.substr(0, newline_pos);
-        // Remove message from buffer (including newline)
-        read_buffer_.erase(0, newline_pos + 1);
-        ESP_LOGD(TAG, "Returning buffered message: %s", buffer.c_str());
+    if (nextBufferedFrame(frame)) {
+        ESP_LOGD(TAG, "Returning buffered message (%u bytes)", (unsigned)frame.size());
         return true;
     }
 
-    // Check buffer size limit
-    if (read_buffer_.size() >= MAX_BUFFER_SIZE) {
-        ESP_LOGE(TAG, "Read buffer overflow, clearing buffer");
-        read_buffer_.clear();
-        buffer.clear();
-        return false;
+    // Out of room at the end: move the partial frame to the front. This is
+    // the only copy on the receive path and happens once per buffer wrap.
+    if (rx_tail_ == rx_capacity_) {
+        if (rx_head_ == 0) {
+            ESP_LOGE(TAG, "Read buffer overflow, clearing buffer");
+            rx_head_ = rx_tail_ = rx_scan_ = 0;
+            return false;
+        }
+
+        size_t pending = rx_tail_ - rx_head_;
+        memmove(rx_buf_.get(), rx_buf_.get() + rx_head_, pending);
+        rx_scan_ -= rx_head_;
+        rx_tail_ = pending;
+        rx_head_ = 0;
     }
 
-    // No complete message in buffer, try to read more data
-    char tmp[512];
-    int r = ::recv(sock_, tmp, sizeof(tmp) - 1, MSG_DONTWAIT);
+    // No complete message in buffer, read straight into the free tail space
+    int r = ::recv(sock_, rx_buf_.get() + rx_tail_, rx_capacity_ - rx_tail_, MSG_DONTWAIT);
 
     if (r < 0) {
         if (errno == EAGAIN || errno == EWOULDBLOCK) {
             // No data available right now, but socket is still connected
-            buffer.clear();
             return true;
         }
         ESP_LOGE(TAG, "Socket read failed: errno %d", errno);
@@ -64,31 +80,41 @@ bool EspSocketTransport::read(std::string &buffer) {
         return false;
     }
 
-    tmp[r] = '\0';  // Null terminate for safety
+    rx_tail_ += r;
 
-    // Check if adding this data would exceed buffer limit
-    if (read_buffer_.size() + r > MAX_BUFFER_SIZE) {
-        ESP_LOGE(TAG, "Adding data would exceed buffer limit, clearing buffer");
-        read_buffer_.clear();
-        buffer.clear();
+    ESP_LOGD(TAG, "Read %d bytes from socket, buffered: %u", r, (unsigned)(rx_tail_ - rx_head_));
+
+    // Check again for complete message after adding new data
+    if (nextBufferedFrame(frame)) {
+        ESP_LOGD(TAG, "Returning new message (%u bytes)", (unsigned)frame.size());
+    }
+
+    // Still no complete message
+    return true;
+}
+
+bool EspSocketTransport::nextBufferedFrame(std::string_view &frame) {
+    char* base = rx_buf_.get();
+    char* newline = static_cast<char*>(memchr(base + rx_scan_, '\n', rx_tail_ - rx_scan_));
+    if (!newline) {
+        rx_scan_ = rx_tail_;
         return false;
     }
 
-    read_buffer_.append(tmp, r);
+    // Terminate in place so the slice can go straight to cJSON_Parse
+    *newline = '\0';
+    size_t end = newline - base;
+    frame = std::string_view(base + rx_head_, end - rx_head_);
 
-    ESP_LOGD(TAG, "Read %d bytes from socket, buffer size: %d", r, read_buffer_.size());
+    rx_head_ = end + 1;
+    rx_scan_ = rx_head_;
 
-    // Check again for complete message after adding new data
-    newline_pos = read_buffer_.find('\n');
-    if (newline_pos != std::string::npos) {
-        buffer = read_buffer_.substr(0, newline_pos);
-        read_buffer_.erase(0, newline_pos + 1);
-        ESP_LOGD(TAG, "Returning new message: %s", buffer.c_str());
-        return true;
+    // Buffer drained: rewind for free instead of compacting later. The
+    // slice stays valid because recv only runs on the next read call.
+    if (rx_head_ == rx_tail_) {
+        rx_head_ = rx_tail_ = rx_scan_ = 0;
     }
 
-    // Still no complete message
-    buffer.clear();
     return true;
 }
 
@@ -150,7 +176,7 @@ void EspSocketTransport::close() {
         sock_ = -1;
         ESP_LOGI(TAG, "Socket closed manually");
     }
-    read_buffer_.clear();
+    rx_head_ = rx_tail_ = rx_scan_ = 0;
 }
 
 } // namespace tinymcp
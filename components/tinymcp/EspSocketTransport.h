@@ -1,6 +1,8 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <memory>
 
 namespace tinymcp {
 
@@ -8,6 +10,9 @@ class Transport {
 public:
     virtual ~Transport() = default;
     virtual bool read(std::string &buffer) = 0;
+    // Zero-copy read: frame points into the transport's buffer, is
+    // NUL-terminated in place and stays valid until the next read call
+    virtual bool readView(std::string_view &frame) = 0;
     virtual bool write(const std::string &buffer) = 0;
     virtual bool isConnected() const = 0;
     virtual void close() = 0;
@@ -15,7 +20,9 @@ public:
 
 class EspSocketTransport : public Transport {
 public:
-    explicit EspSocketTransport(int sock);
+    static const size_t DEFAULT_BUFFER_CAPACITY = 8192;
+
+    explicit EspSocketTransport(int sock, size_t bufferCapacity = DEFAULT_BUFFER_CAPACITY);
     ~EspSocketTransport() override;
 
     // Delete copy constructor and assignment operator
@@ -23,13 +30,25 @@ public:
     EspSocketTransport& operator=(const EspSocketTransport&) = delete;
 
     bool read(std::string &buffer) override;
+    bool readView(std::string_view &frame) override;
     bool write(const std::string &buffer) override;
     bool isConnected() const override;
     void close() override;
 
 private:
+    // Hand out the next complete frame already in the buffer, if any
+    bool nextBufferedFrame(std::string_view &frame);
+
     int sock_;
-    std::string read_buffer_;  // Buffer for incomplete messages
+
+    // Fixed receive buffer allocated once per connection. Bytes in
+    // [rx_head_, rx_tail_) are unconsumed; rx_scan_ marks how far we have
+    // already searched for '\n' so pipelined data is scanned only once.
+    std::unique_ptr<char[]> rx_buf_;
+    size_t rx_capacity_;
+    size_t rx_head_;
+    size_t rx_tail_;
+    size_t rx_scan_;
 };
 
 } // namespace tinymcp
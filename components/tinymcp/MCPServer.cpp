@@ -1,6 +1,11 @@
 #include "MCPServer.h"
 #include "esp_log.h"
 #include "lightweight_json.h"
+#include "tinymcp_arena.h"
+#include "tinymcp_envelope.h"
+#include "tinymcp_log.h"
+#include "tinymcp_method_table.h"
+#include "tinymcp_metrics.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include <sstream>
@@ -12,6 +17,7 @@ namespace tinymcp {
 MCPServer::MCPServer(Transport* transport)
     : transport_(transport), running_(false), initialized_(false),
       error_count_(0), last_error_time_(0) {
+    JsonArenaPool::getInstance().initialize();
     ESP_LOGI(TAG, "MCPServer created");
 }
 
@@ -27,15 +33,17 @@ void MCPServer::run() {
     }
 
     running_ = true;
+    DeferredLog::getInstance().start();
     ESP_LOGI(TAG, "MCP Server starting...");
 
-    std::string buffer;
+    std::string_view frame;
     while (running_ && transport_->isConnected()) {
-        if (transport_->read(buffer)) {
-            if (!buffer.empty()) {
-                ESP_LOGD(TAG, "Received message (%d bytes): %s", buffer.length(), buffer.c_str());
-                processMessage(buffer);
-                buffer.clear();
+        // The view points into the transport's receive buffer and stays
+        // valid until the next read, which is all processMessage needs
+        if (transport_->readView(frame)) {
+            if (!frame.empty()) {
+                TINYMCP_LOGD(TAG, "Received message (%d bytes): %s", (int)frame.size(), frame);
+                processMessage(frame);
             }
             // If buffer is empty, no complete message available yet
         } else {
@@ -63,79 +71,153 @@ bool MCPServer::isRunning() const {
     return running_;
 }
 
-void MCPServer::processMessage(const std::string& message) {
+void MCPServer::processMessage(std::string_view message) {
     // Fast-fail: Check for empty messages
-    if (message.empty() || message.find_first_not_of(" \t\r\n") == std::string::npos) {
-        ESP_LOGD(TAG, "Received empty message, ignoring");
+    if (message.empty() || message.find_first_not_of(" \t\r\n") == std::string_view::npos) {
+        TINYMCP_LOGD(TAG, "Received empty message, ignoring");
         return;
     }
 
-    // Fast-fail: Check if this looks like an HTTP request
-    if (message.find("GET ") == 0 || message.find("POST ") == 0 ||
-        message.find("PUT ") == 0 || message.find("DELETE ") == 0 ||
-        message.find("HEAD ") == 0 || message.find("OPTIONS ") == 0 ||
-        message.find("Host:") == 0 || message.find("Connection:") == 0 ||
-        message.find("User-Agent:") == 0 || message.find("Accept:") == 0 ||
-        message.find("Cache-Control:") == 0 || message.find("Upgrade-Insecure-Requests:") == 0 ||
-        message.find("Accept-Encoding:") == 0 || message.find("Accept-Language:") == 0) {
-        ESP_LOGW(TAG, "Received HTTP request, closing connection");
-        stop();  // Close the connection immediately
+    noteRequestReceived();
+
+    // Fast-fail: route on the envelope before anything is parsed
+    JsonRpcEnvelope envelope;
+    if (envelope.scan(message.data(), message.size()) != TINYMCP_SUCCESS) {
+        if (JsonRpcEnvelope::looksLikeHttp(message.data(), message.size())) {
+            ESP_LOGW(TAG, "Received HTTP request, closing connection");
+            stop();  // Close the connection immediately
+            return;
+        }
+        TINYMCP_LOGW(TAG, "Failed to parse request: %s", message);
+        sendResponse(createErrorResponse("", -32700, "Parse error"));
         return;
     }
 
-    std::string method, id, params;
+    // Requests with other ids take the regular path, whose handlers map
+    // them to ""
+    std::string_view methodName, requestId;
+    if (envelope.getCategory() == MessageCategory::REQUEST && envelope.isJsonRpc2() &&
+        envelope.getMethod(methodName) && envelope.getStringId(requestId)) {
+        std::string id(requestId);
+        const MethodEntry* entry = MethodTable::find(methodName);
+        if (!entry || entry->category != MessageCategory::REQUEST) {
+            sendResponse(createErrorResponse(id, -32601, "Method not found"));
+            return;
+        }
+        if (entry->type == MessageType::PING_REQUEST) {
+            sendResponse(handlePing(id));
+            return;
+        }
+    }
+
+    // Parsing, the handler and serialization all allocate from one arena
+    // that is reset when this message is done
+    ArenaLease arena;
+    ArenaScope arenaScope(arena.get());
+
+    // Parse once; the handlers all work on this tree. Transport frames are
+    // NUL-terminated in place, so the view goes straight to cJSON.
+    tinymcp::JsonValue root;
+    tinymcp::JsonReader reader;
+
+    std::string method, id;
 
-    if (!parseRequest(message, method, id, params)) {
-        ESP_LOGE(TAG, "Failed to parse request: %s", message.c_str());
+    if (reader.parse(message.data(), root) && root.isArray()) {
+        processBatch(root);
+        return;
+    }
+
+    if (!root.isValid() || !parseRequest(root, method, id)) {
+        TINYMCP_LOGW(TAG, "Failed to parse request: %s", message);
         std::string error = createErrorResponse("", -32700, "Parse error");
         sendResponse(error);
         return;
     }
 
-    ESP_LOGD(TAG, "Processing method: %s, id: %s", method.c_str(), id.c_str());
+    sendResponse(dispatchRequest(root, method, id));
+}
 
-    std::string response;
+void MCPServer::processBatch(const JsonValue& batch) {
+    int count = batch.size();
+    if (count == 0 || count > static_cast<int>(MAX_BATCH_SIZE)) {
+        TINYMCP_LOGW(TAG, "Rejecting batch of %d elements", count);
+        sendResponse(createErrorResponse("", -32600, count == 0 ? "Invalid Request" : "Batch too large"));
+        return;
+    }
 
-    if (method == "initialize") {
-        response = handleInitialize(message);
-    } else if (method == "tools/list") {
-        if (!initialized_) {
-            response = createErrorResponse(id, -32002, "Server not initialized");
+    // Every element is answered in one array; notifications get no entry
+    std::string responses = "[";
+    size_t responseCount = 0;
+    for (int i = 0; i < count; ++i) {
+        JsonValue element = batch[i];
+        std::string method, id;
+        std::string response;
+        if (!parseRequest(element, method, id)) {
+            response = createErrorResponse(id, -32600, "Invalid Request");
+        } else if (!element.isMember("id")) {
+            dispatchRequest(element, method, id);
+            continue;
         } else {
-            response = handleToolsList(message);
+            response = dispatchRequest(element, method, id);
         }
-    } else if (method == "tools/call") {
-        if (!initialized_) {
-            response = createErrorResponse(id, -32002, "Server not initialized");
-        } else {
-            response = handleToolsCall(message);
+
+        if (responses.size() + response.size() + 2 > MAX_MESSAGE_SIZE) {
+            response = createErrorResponse(id, -32012, "Batch response too large");
         }
-    } else if (method == "ping") {
-        response = handlePing(message);
-    } else {
-        response = createErrorResponse(id, -32601, "Method not found");
+        if (responseCount++ > 0) {
+            responses += ',';
+        }
+        responses += response;
+    }
+    responses += ']';
+
+    if (responseCount > 0) {
+        sendResponse(responses);
+    }
+}
+
+std::string MCPServer::dispatchRequest(const JsonValue& root, const std::string& method,
+                                       const std::string& id) {
+    TINYMCP_LOGD(TAG, "Processing method: %s, id: %s", method, id);
+
+    std::string response;
+
+    const MethodEntry* entry = MethodTable::find(std::string_view(method));
+    MessageType type = entry ? entry->type : MessageType::UNKNOWN;
+
+    switch (type) {
+        case MessageType::INITIALIZE_REQUEST:
+            response = handleInitialize(root);
+            break;
+        case MessageType::LIST_TOOLS_REQUEST:
+            response = initialized_ ? handleToolsList(root) :
+                createErrorResponse(id, -32002, "Server not initialized");
+            break;
+        case MessageType::CALL_TOOL_REQUEST:
+            response = initialized_ ? handleToolsCall(root) :
+                createErrorResponse(id, -32002, "Server not initialized");
+            break;
+        case MessageType::PING_REQUEST:
+            response = handlePing(id);
+            break;
+        default:
+            response = createErrorResponse(id, -32601, "Method not found");
+            break;
     }
 
-    sendResponse(response);
+    return response;
 }
 
 void MCPServer::sendResponse(const std::string& response) {
     if (transport_ && !response.empty()) {
-        ESP_LOGD(TAG, "Sending response: %s", response.c_str());
+        TINYMCP_LOGD(TAG, "Sending response: %s", response);
         if (!transport_->write(response + "\n")) {
             ESP_LOGE(TAG, "Failed to send response");
         }
     }
 }
 
-std::string MCPServer::handleInitialize(const std::string& request) {
-    tinymcp::JsonValue root;
-    tinymcp::JsonReader reader;
-
-    if (!reader.parse(request, root)) {
-        return createErrorResponse("", -32700, "Parse error");
-    }
-
+std::string MCPServer::handleInitialize(const JsonValue& root) {
     std::string id = root.get("id", tinymcp::JsonValue::createString("")).asString();
 
     // Create response with server capabilities
@@ -165,21 +247,26 @@ std::string MCPServer::handleInitialize(const std::string& request) {
     return response.toStringCompact();
 }
 
-std::string MCPServer::handleToolsList(const std::string& request) {
-    tinymcp::JsonValue root;
-    tinymcp::JsonReader reader;
+std::string MCPServer::handleToolsList(const JsonValue& root) {
+    std::string id = root.get("id", tinymcp::JsonValue::createString("")).asString();
 
-    if (!reader.parse(request, root)) {
-        return createErrorResponse("", -32700, "Parse error");
+    // The tool set is fixed, so serialize it once and only splice the id
+    if (tools_list_cache_.empty()) {
+        tools_list_cache_ = buildToolsList();
     }
 
-    std::string id = root.get("id", tinymcp::JsonValue::createString("")).asString();
-
-    tinymcp::JsonValue response = tinymcp::JsonValue::createObject();
-    response.set("jsonrpc", "2.0");
-    response.set("id", id);
+    std::string response;
+    response.reserve(tools_list_cache_.size() + id.size() + 48);
+    response += "{\"jsonrpc\":\"2.0\",\"id\":";
+    response += tinymcp::JsonValue::createString(id).toStringCompact();
+    response += ",\"result\":{\"tools\":";
+    response += tools_list_cache_;
+    response += "}}";
+
+    return response;
+}
 
-    tinymcp::JsonValue result = tinymcp::JsonValue::createObject();
+std::string MCPServer::buildToolsList() {
     tinymcp::JsonValue tools = tinymcp::JsonValue::createArray();
 
     // Add example tools
@@ -231,34 +318,22 @@ std::string MCPServer::handleToolsList(const std::string& request) {
     gpioTool.set("inputSchema", gpioSchema);
     tools.append(gpioTool);
 
-    result.set("tools", tools);
-    response.set("result", result);
-
-    return response.toStringCompact();
+    TINYMCP_LOGD(TAG, "Cached tools/list payload");
+    return tools.toStringCompact();
 }
 
-std::string MCPServer::handleToolsCall(const std::string& request) {
-    ESP_LOGI(TAG, "handleToolsCall: Starting to process tool call");
-    tinymcp::JsonValue root;
-    tinymcp::JsonReader reader;
-
-    if (!reader.parse(request, root)) {
-        ESP_LOGE(TAG, "handleToolsCall: JSON parse failed");
-        return createErrorResponse("", -32700, "Parse error");
-    }
-
+std::string MCPServer::handleToolsCall(const JsonValue& root) {
     std::string id = root.get("id", tinymcp::JsonValue::createString("")).asString();
-    ESP_LOGI(TAG, "handleToolsCall: Request ID: %s", id.c_str());
 
     tinymcp::JsonValue params = root.get("params", tinymcp::JsonValue());
 
     if (!params.isObject()) {
-        ESP_LOGE(TAG, "handleToolsCall: Invalid params - not an object");
+        TINYMCP_LOGW(TAG, "handleToolsCall: Invalid params - not an object");
         return createErrorResponse(id, -32602, "Invalid params");
     }
 
     std::string toolName = params.get("name", tinymcp::JsonValue::createString("")).asString();
-    ESP_LOGI(TAG, "handleToolsCall: Tool name: %s", toolName.c_str());
+    TINYMCP_LOGD(TAG, "handleToolsCall: %s (id %s)", toolName, id);
 
     tinymcp::JsonValue arguments = params.get("arguments", tinymcp::JsonValue());
 
@@ -270,16 +345,14 @@ std::string MCPServer::handleToolsCall(const std::string& request) {
     tinymcp::JsonValue content = tinymcp::JsonValue::createArray();
 
     if (toolName == "echo") {
-        ESP_LOGI(TAG, "handleToolsCall: Processing echo tool");
         if (arguments.isMember("text")) {
-            ESP_LOGI(TAG, "handleToolsCall: Echo has text parameter");
             tinymcp::JsonValue textContent = tinymcp::JsonValue::createObject();
             textContent.set("type", "text");
             textContent.set("text", "Echo: " + arguments.get("text").asString());
             content.append(textContent);
-            ESP_LOGI(TAG, "Echo tool called with: %s", arguments.get("text").asString().c_str());
+            TINYMCP_LOGV(TAG, "Echo tool called with: %s", arguments.get("text").asString());
         } else {
-            ESP_LOGI(TAG, "handleToolsCall: Echo missing text parameter, returning error");
+            TINYMCP_LOGD(TAG, "handleToolsCall: Echo missing text parameter, returning error");
             return createErrorResponse(id, -32602, "Missing required parameter: text");
         }
     } else if (toolName == "gpio_control") {
@@ -293,32 +366,22 @@ std::string MCPServer::handleToolsCall(const std::string& request) {
             textContent.set("text", "GPIO pin " + std::to_string(pin) + " set to " + state);
             content.append(textContent);
 
-            ESP_LOGI(TAG, "GPIO tool called: pin %d, state %s", pin, state.c_str());
+            TINYMCP_LOGD(TAG, "GPIO tool called: pin %d, state %s", pin, state);
         } else {
             return createErrorResponse(id, -32602, "Missing required parameters: pin, state");
         }
     } else {
-        ESP_LOGI(TAG, "handleToolsCall: Unknown tool '%s', returning error", toolName.c_str());
+        TINYMCP_LOGD(TAG, "handleToolsCall: Unknown tool '%s', returning error", toolName);
         return createErrorResponse(id, -32601, "Unknown tool: " + toolName);
     }
 
-    ESP_LOGI(TAG, "handleToolsCall: Setting result and returning success response");
     result.set("content", content);
     response.set("result", result);
 
     return response.toStringCompact();
 }
 
-std::string MCPServer::handlePing(const std::string& request) {
-    tinymcp::JsonValue root;
-    tinymcp::JsonReader reader;
-
-    if (!reader.parse(request, root)) {
-        return createErrorResponse("", -32700, "Parse error");
-    }
-
-    std::string id = root.get("id", tinymcp::JsonValue::createString("")).asString();
-
+std::string MCPServer::handlePing(const std::string& id) {
     tinymcp::JsonValue response = tinymcp::JsonValue::createObject();
     response.set("jsonrpc", "2.0");
     response.set("id", id);
@@ -328,37 +391,28 @@ std::string MCPServer::handlePing(const std::string& request) {
 }
 
 std::string MCPServer::createErrorResponse(const std::string& id, int code, const std::string& message) {
-    ESP_LOGI(TAG, "createErrorResponse: Creating error response - id: %s, code: %d, message: %s", id.c_str(), code, message.c_str());
+    TINYMCP_LOGD(TAG, "createErrorResponse: id: %s, code: %d, message: %s", id, code, message);
 
-    ESP_LOGI(TAG, "createErrorResponse: Creating root object");
     tinymcp::JsonValue response = tinymcp::JsonValue::createObject();
-    ESP_LOGI(TAG, "createErrorResponse: Setting jsonrpc field");
     response.set("jsonrpc", "2.0");
-    ESP_LOGI(TAG, "createErrorResponse: Setting id field");
     if (id.empty()) {
         response.set("id", tinymcp::JsonValue::createNull());
     } else {
         response.set("id", id);
     }
 
-    ESP_LOGI(TAG, "createErrorResponse: Creating error object");
     tinymcp::JsonValue error = tinymcp::JsonValue::createObject();
-    ESP_LOGI(TAG, "createErrorResponse: Setting error code: %d", code);
     error.set("code", code);
-    ESP_LOGI(TAG, "createErrorResponse: Setting error message: %s", message.c_str());
     error.set("message", message);
-    ESP_LOGI(TAG, "createErrorResponse: Setting error object on response");
     response.set("error", error);
 
-    ESP_LOGI(TAG, "createErrorResponse: About to serialize response");
     std::string result = response.toStringCompact();
-    ESP_LOGI(TAG, "createErrorResponse: Serialized response length: %d", result.length());
-    ESP_LOGI(TAG, "createErrorResponse: Serialized response: %s", result.c_str());
+    TINYMCP_LOGV(TAG, "createErrorResponse: Serialized response: %s", result);
 
     if (result.empty()) {
         ESP_LOGE(TAG, "createErrorResponse: JSON serialization failed! Returning manual JSON");
         std::string manual_json = "{\"jsonrpc\":\"2.0\",\"id\":\"" + id + "\",\"error\":{\"code\":" + std::to_string(code) + ",\"message\":\"" + message + "\"}}";
-        ESP_LOGI(TAG, "createErrorResponse: Manual JSON: %s", manual_json.c_str());
+        TINYMCP_LOGV(TAG, "createErrorResponse: Manual JSON: %s", manual_json);
         return manual_json;
     }
 
@@ -374,35 +428,26 @@ std::string MCPServer::createSuccessResponse(const std::string& id, const std::s
     return response.toStringCompact();
 }
 
-bool MCPServer::parseRequest(const std::string& message, std::string& method, std::string& id, std::string& params) {
-    tinymcp::JsonValue root;
-    tinymcp::JsonReader reader;
-
-    ESP_LOGD(TAG, "Parsing message: %s", message.c_str());
-
-    if (!reader.parse(message, root)) {
-        ESP_LOGE(TAG, "JSON parse error for message: %s", message.c_str());
+bool MCPServer::parseRequest(const JsonValue& root, std::string& method, std::string& id) {
+    if (!root.isObject()) {
+        ESP_LOGE(TAG, "Request is not a JSON object");
         return false;
     }
 
     if (!root.isMember("jsonrpc") || root.get("jsonrpc").asString() != "2.0") {
-        ESP_LOGE(TAG, "Invalid JSON-RPC version in message: %s", message.c_str());
+        ESP_LOGE(TAG, "Invalid JSON-RPC version");
         return false;
     }
 
     if (!root.isMember("method")) {
-        ESP_LOGE(TAG, "Missing method in request: %s", message.c_str());
+        ESP_LOGE(TAG, "Missing method in request");
         return false;
     }
 
     method = root.get("method").asString();
     id = root.get("id", tinymcp::JsonValue::createString("")).asString();
 
-    if (root.isMember("params")) {
-        params = root.get("params").toStringCompact();
-    }
-
-    ESP_LOGD(TAG, "Successfully parsed: method=%s, id=%s", method.c_str(), id.c_str());
+    TINYMCP_LOGV(TAG, "Successfully parsed: method=%s, id=%s", method, id);
     return true;
 }
 
@@ -2,7 +2,9 @@
 
 #include <string>
 #include <memory>
+#include <string_view>
 #include "EspSocketTransport.h"
+#include "lightweight_json.h"
 
 namespace tinymcp {
 
@@ -25,23 +27,33 @@ public:
     bool isRunning() const;
 
 private:
-    // Process incoming messages
-    void processMessage(const std::string& message);
+    // Process incoming messages; the view must be NUL-terminated
+    void processMessage(std::string_view message);
+    
+    // Answer a JSON-RPC batch with a single array frame
+    void processBatch(const JsonValue& batch);
+    
+    // Run one validated request and return its serialized response
+    std::string dispatchRequest(const JsonValue& root, const std::string& method,
+                                const std::string& id);
     
     // Send response back to client
     void sendResponse(const std::string& response);
     
     // Handle initialization request
-    std::string handleInitialize(const std::string& request);
+    std::string handleInitialize(const JsonValue& root);
     
     // Handle tools/list request
-    std::string handleToolsList(const std::string& request);
+    std::string handleToolsList(const JsonValue& root);
+    
+    // Serialize the tools array served by tools/list
+    std::string buildToolsList();
     
     // Handle tools/call request
-    std::string handleToolsCall(const std::string& request);
+    std::string handleToolsCall(const JsonValue& root);
     
     // Handle ping request
-    std::string handlePing(const std::string& request);
+    std::string handlePing(const std::string& id);
     
     // Create error response
     std::string createErrorResponse(const std::string& id, int code, const std::string& message);
@@ -49,12 +61,13 @@ private:
     // Create success response
     std::string createSuccessResponse(const std::string& id, const std::string& result);
     
-    // Parse JSON-RPC request
-    bool parseRequest(const std::string& message, std::string& method, std::string& id, std::string& params);
+    // Validate an already parsed JSON-RPC request
+    bool parseRequest(const JsonValue& root, std::string& method, std::string& id);
     
     Transport* transport_;
     bool running_;
     bool initialized_;
+    std::string tools_list_cache_;
     
     // Rate limiting and error tracking
     unsigned int error_count_;
@@ -0,0 +1,459 @@
+// Micro-benchmarks for the TinyMCP core on the host build
+// Parse, dispatch and serialize throughput with allocations per message and peak heap
+
+#include "tinymcp_constants.h"
+#include "tinymcp_message.h"
+#include "tinymcp_request.h"
+#include "tinymcp_response.h"
+#include "tinymcp_notification.h"
+#include "tinymcp_session.h"
+#include "tinymcp_tools.h"
+#include "tinymcp_json.h"
+#include "tinymcp_cbor.h"
+#include "tinymcp_envelope.h"
+#include "tinymcp_metrics.h"
+
+#include "host_heap.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include <cJSON.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace tinymcp;
+
+namespace {
+
+const size_t ECHO_PAYLOAD_BYTES = 1024;
+const int PROGRESS_BURST = 32;
+
+// Upper bound on waiting for one tool result before the run is declared hung
+const int64_t DISPATCH_TIMEOUT_US = 2000000;
+
+// In-memory transport: frames pushed by the benchmark are returned by
+// tryReceive(), everything the session sends is counted and kept
+class MemoryTransport : public SessionTransport {
+public:
+    int send(const std::string& data) override {
+        framesSent++;
+        bytesSent += data.size();
+        lastFrame = data;
+        return TINYMCP_SUCCESS;
+    }
+
+    int receive(std::string& data, uint32_t) override {
+        return tryReceive(data);
+    }
+
+    int tryReceive(std::string& data) override {
+        if (inbound.empty()) {
+            return TINYMCP_ERROR_TIMEOUT;
+        }
+        data.swap(inbound.front());
+        inbound.pop_front();
+        return TINYMCP_SUCCESS;
+    }
+
+    bool isConnected() const override { return true; }
+    void close() override {}
+    std::string getClientInfo() const override { return "memory"; }
+
+    std::deque<std::string> inbound;
+    uint64_t framesSent = 0;
+    uint64_t bytesSent = 0;
+    std::string lastFrame;
+};
+
+struct Result {
+    std::string name;
+    uint64_t iterations;
+    double nsPerOp;
+    double allocsPerOp;
+    double bytesPerOp;          // Output bytes per op where meaningful
+    size_t peakBytes;           // Heap high-water above the starting live size
+};
+
+struct Options {
+    bool quick = false;
+    bool json = false;
+    bool metrics = false;
+    uint64_t iterations = 0;    // 0 picks a per-benchmark default
+    const char* filter = nullptr;
+};
+
+Options g_options;
+std::vector<Result> g_results;
+bool g_failed = false;
+
+std::string makePayload(size_t length) {
+    std::string payload;
+    payload.reserve(length);
+    for (size_t i = 0; i < length; ++i) {
+        payload.push_back(static_cast<char>('a' + i % 26));
+    }
+    return payload;
+}
+
+const std::string& initializeFrame() {
+    static const std::string frame =
+        "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"initialize\",\"params\":{"
+        "\"protocolVersion\":\"2024-11-05\",\"capabilities\":{\"roots\":{\"listChanged\":true}},"
+        "\"clientInfo\":{\"name\":\"tinymcp_bench\",\"version\":\"1.0.0\"}}}";
+    return frame;
+}
+
+const std::string& initializedFrame() {
+    static const std::string frame = "{\"jsonrpc\":\"2.0\",\"method\":\"notifications/initialized\"}";
+    return frame;
+}
+
+const std::string& toolsListFrame() {
+    static const std::string frame = "{\"jsonrpc\":\"2.0\",\"id\":2,\"method\":\"tools/list\",\"params\":{}}";
+    return frame;
+}
+
+const std::string& pingFrame() {
+    static const std::string frame = "{\"jsonrpc\":\"2.0\",\"id\":3,\"method\":\"ping\"}";
+    return frame;
+}
+
+const std::string& unknownMethodFrame() {
+    static const std::string frame = "{\"jsonrpc\":\"2.0\",\"id\":5,\"method\":\"device/reboot\",\"params\":{}}";
+    return frame;
+}
+
+const std::string& echoFrame() {
+    static const std::string frame =
+        "{\"jsonrpc\":\"2.0\",\"id\":4,\"method\":\"tools/call\",\"params\":{"
+        "\"name\":\"echo\",\"arguments\":{\"message\":\"" + makePayload(ECHO_PAYLOAD_BYTES) + "\"}}}";
+    return frame;
+}
+
+bool selected(const char* name) {
+    return !g_options.filter || strstr(name, g_options.filter) != nullptr;
+}
+
+uint64_t iterationsFor(uint64_t full) {
+    if (g_options.iterations) {
+        return g_options.iterations;
+    }
+    return g_options.quick ? std::max<uint64_t>(full / 100, 10) : full;
+}
+
+// Runs `op` `iterations` times after a short warm-up and records timing and
+// heap counters. `op` returns the output bytes it produced, or -1 on failure.
+bool run(const char* name, uint64_t fullIterations, const std::function<long(void)>& op) {
+    if (!selected(name)) {
+        return true;
+    }
+
+    uint64_t iterations = iterationsFor(fullIterations);
+    for (uint64_t i = 0; i < std::min<uint64_t>(iterations / 10 + 1, 100); ++i) {
+        if (op() < 0) {
+            fprintf(stderr, "%s: warm-up failed\n", name);
+            g_failed = true;
+            return false;
+        }
+    }
+
+    host_heap_stats_t before;
+    host_heap_reset_peak();
+    host_heap_get_stats(&before);
+
+    uint64_t outputBytes = 0;
+    int64_t startUs = esp_timer_get_time();
+    for (uint64_t i = 0; i < iterations; ++i) {
+        long bytes = op();
+        if (bytes < 0) {
+            fprintf(stderr, "%s: iteration %llu failed\n", name, static_cast<unsigned long long>(i));
+            g_failed = true;
+            return false;
+        }
+        outputBytes += static_cast<uint64_t>(bytes);
+    }
+    int64_t elapsedUs = esp_timer_get_time() - startUs;
+
+    host_heap_stats_t after;
+    host_heap_get_stats(&after);
+
+    Result result;
+    result.name = name;
+    result.iterations = iterations;
+    result.nsPerOp = static_cast<double>(elapsedUs) * 1000.0 / iterations;
+    result.allocsPerOp = static_cast<double>(after.allocations - before.allocations) / iterations;
+    result.bytesPerOp = static_cast<double>(outputBytes) / iterations;
+    result.peakBytes = after.peakBytes > before.liveBytes ? after.peakBytes - before.liveBytes : 0;
+    g_results.push_back(result);
+    return true;
+}
+
+// Session in reactor mode over a MemoryTransport, driven synchronously
+class BenchSession {
+public:
+    BenchSession() {
+        auto transport = std::make_unique<MemoryTransport>();
+        transport_ = transport.get();
+
+        SessionConfig config;
+        config.reactorMode = true;
+        session_ = std::make_unique<Session>(std::move(transport), config);
+        session_->setServerInfo("TinyMCP Host Bench", "1.0.0");
+
+        auto& registry = ToolRegistry::getInstance();
+        for (const auto& toolName : registry.getToolNames()) {
+            const char* description = registry.getDescription(toolName);
+            if (description) {
+                session_->addTool(toolName, description);
+            }
+        }
+    }
+
+    int start(bool handshake) {
+        int result = session_->initialize();
+        if (result != TINYMCP_SUCCESS || !handshake) {
+            return result;
+        }
+        if (exchange(initializeFrame()) < 0) {
+            return TINYMCP_ERROR_INVALID_STATE;
+        }
+        transport_->inbound.push_back(initializedFrame());
+        return session_->onReadable();
+    }
+
+    // Feeds one frame and services the session until one reply has been
+    // sent; returns the reply size or -1
+    long exchange(const std::string& frame) {
+        uint64_t sentBefore = transport_->framesSent;
+        transport_->inbound.push_back(frame);
+        if (session_->onReadable() != TINYMCP_SUCCESS) {
+            return -1;
+        }
+
+        int64_t deadline = esp_timer_get_time() + DISPATCH_TIMEOUT_US;
+        while (transport_->framesSent == sentBefore) {
+            if (esp_timer_get_time() > deadline || session_->poll(nullptr) != TINYMCP_SUCCESS) {
+                return -1;
+            }
+            std::this_thread::yield();
+        }
+        return static_cast<long>(transport_->lastFrame.size());
+    }
+
+    Session& session() { return *session_; }
+    MemoryTransport& transport() { return *transport_; }
+
+private:
+    MemoryTransport* transport_;
+    std::unique_ptr<Session> session_;
+};
+
+// Parse: text -> cJSON tree -> typed message
+
+long parseFrame(const std::string& frame) {
+    cJSON* json = Cbor::isCborFrame(frame.data(), frame.size()) ?
+                  Cbor::decode(frame.data(), frame.size()) : cJSON_Parse(frame.c_str());
+    if (!json) {
+        return -1;
+    }
+    std::unique_ptr<Message> message = Message::createFromJson(json);
+    cJSON_Delete(json);
+    return message ? 0 : -1;
+}
+
+// Re-encodes a JSON frame the way a CBOR client would send it
+std::string toCbor(const std::string& frame) {
+    std::string out;
+    cJSON* json = cJSON_Parse(frame.c_str());
+    StringJsonSink sink(out);
+    JsonWriter writer(&sink, WireFormat::CBOR);
+    writer.value(json);
+    writer.finish();
+    cJSON_Delete(json);
+    return out;
+}
+
+void benchParse() {
+    run("parse/initialize", 200000, [] { return parseFrame(initializeFrame()); });
+    run("parse/tools_list", 200000, [] { return parseFrame(toolsListFrame()); });
+    run("parse/echo_1k", 100000, [] { return parseFrame(echoFrame()); });
+
+    const std::string echoCbor = toCbor(echoFrame());
+    run("parse/echo_1k_cbor", 100000, [&echoCbor] { return parseFrame(echoCbor); });
+
+    // What routing costs before a frame is parsed
+    run("parse/echo_1k_envelope", 200000, [] {
+        JsonRpcEnvelope envelope;
+        return envelope.scan(echoFrame().data(), echoFrame().size()) == TINYMCP_SUCCESS ? 0L : -1L;
+    });
+}
+
+// Dispatch: frame in -> reply frame out through a live session
+
+void benchDispatch() {
+    run("dispatch/initialize", 20000, [] {
+        BenchSession bench;
+        if (bench.start(false) != TINYMCP_SUCCESS) {
+            return -1L;
+        }
+        return bench.exchange(initializeFrame());
+    });
+
+    BenchSession bench;
+    if (bench.start(true) != TINYMCP_SUCCESS) {
+        fprintf(stderr, "dispatch: session setup failed\n");
+        g_failed = true;
+        return;
+    }
+
+    run("dispatch/ping", 100000, [&bench] { return bench.exchange(pingFrame()); });
+    run("dispatch/unknown_method", 100000, [&bench] { return bench.exchange(unknownMethodFrame()); });
+    run("dispatch/tools_list", 20000, [&bench] { return bench.exchange(toolsListFrame()); });
+    run("dispatch/echo_1k", 20000, [&bench] { return bench.exchange(echoFrame()); });
+
+    run("dispatch/progress_burst", 20000, [&bench] {
+        MemoryTransport& transport = bench.transport();
+        uint64_t bytesBefore = transport.bytesSent;
+        for (int i = 1; i <= PROGRESS_BURST; ++i) {
+            if (bench.session().sendProgress("bench", i, PROGRESS_BURST, "working") != TINYMCP_SUCCESS) {
+                return -1L;
+            }
+        }
+        return static_cast<long>(transport.bytesSent - bytesBefore);
+    });
+}
+
+// Serialize: typed message -> minified text
+
+long writeMessage(const Message& message, std::string& out, WireFormat format = WireFormat::JSON) {
+    out.clear();
+    StringJsonSink sink(out);
+    JsonWriter writer(&sink, format);
+    if (message.write(writer) != TINYMCP_SUCCESS || writer.finish() != TINYMCP_SUCCESS) {
+        return -1;
+    }
+    return static_cast<long>(out.size());
+}
+
+void benchSerialize() {
+    std::string out;
+    out.reserve(MAX_MESSAGE_SIZE);
+
+    CallToolResponse echo(MessageId(4));
+    echo.addTextContent(makePayload(ECHO_PAYLOAD_BYTES));
+    run("serialize/echo_1k", 200000, [&] { return writeMessage(echo, out); });
+    run("serialize/echo_1k_cbor", 200000, [&] { return writeMessage(echo, out, WireFormat::CBOR); });
+    run("serialize/echo_1k_legacy", 100000, [&] {
+        out.clear();
+        return echo.serialize(out) == TINYMCP_SUCCESS ? static_cast<long>(out.size()) : -1L;
+    });
+
+    ListToolsResponse tools(MessageId(2));
+    auto& registry = ToolRegistry::getInstance();
+    for (const auto& toolName : registry.getToolNames()) {
+        const char* description = registry.getDescription(toolName);
+        if (description) {
+            tools.addTool(Tool(toolName, description));
+        }
+    }
+    run("serialize/tools_list", 100000, [&] { return writeMessage(tools, out); });
+    run("serialize/tools_list_cbor", 100000, [&] { return writeMessage(tools, out, WireFormat::CBOR); });
+
+    ProgressNotification progress(ProgressToken(std::string("bench")), 50, 100);
+    run("serialize/progress", 500000, [&] { return writeMessage(progress, out); });
+
+    // Size guards walk the tree; the count must match the printed text exactly
+    cJSON* tree = cJSON_Parse(echoFrame().c_str());
+    if (!tree || JsonHelper::getSerializedSize(tree) != JsonHelper::toString(tree).size()) {
+        fprintf(stderr, "getSerializedSize disagrees with the printed length\n");
+        g_failed = true;
+    }
+    run("size/echo_1k_tree", 500000, [&] { return static_cast<long>(JsonHelper::getSerializedSize(tree)); });
+    run("size/echo_1k_exceeds", 500000, [&] { return JsonHelper::exceedsMaxSize(tree, 256) ? 1L : 0L; });
+    run("serialize/echo_1k_tree", 200000, [&] { return static_cast<long>(JsonHelper::toString(tree).size()); });
+    cJSON_Delete(tree);
+}
+
+void printResults() {
+    if (g_options.json) {
+        printf("[");
+        for (size_t i = 0; i < g_results.size(); ++i) {
+            const Result& r = g_results[i];
+            printf("%s\n{\"name\":\"%s\",\"iterations\":%llu,\"ns_per_op\":%.1f,\"ops_per_sec\":%.0f,"
+                   "\"allocs_per_op\":%.2f,\"bytes_per_op\":%.0f,\"peak_heap_bytes\":%zu}",
+                   i ? "," : "", r.name.c_str(), static_cast<unsigned long long>(r.iterations),
+                   r.nsPerOp, 1e9 / r.nsPerOp, r.allocsPerOp, r.bytesPerOp, r.peakBytes);
+        }
+        printf("\n]\n");
+        return;
+    }
+
+    printf("%-28s %10s %12s %12s %10s %10s %10s\n",
+           "benchmark", "iters", "ns/op", "ops/s", "allocs/op", "bytes/op", "peak KB");
+    for (const Result& r : g_results) {
+        printf("%-28s %10llu %12.0f %12.0f %10.2f %10.0f %10.1f\n",
+               r.name.c_str(), static_cast<unsigned long long>(r.iterations), r.nsPerOp,
+               1e9 / r.nsPerOp, r.allocsPerOp, r.bytesPerOp, r.peakBytes / 1024.0);
+    }
+
+    if (!host_heap_tracking_enabled()) {
+        printf("(heap tracking disabled: allocs/op and peak are not measured)\n");
+    }
+}
+
+void usage(const char* argv0) {
+    fprintf(stderr,
+            "usage: %s [--quick] [--json] [--metrics] [--iterations N] [--filter SUBSTRING]\n"
+            "  --quick       1/100 of the default iterations (smoke test)\n"
+            "  --json        machine-readable results\n"
+            "  --metrics     dump the server_stats latency table after the run\n",
+            argv0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--quick")) {
+            g_options.quick = true;
+        } else if (!strcmp(argv[i], "--json")) {
+            g_options.json = true;
+        } else if (!strcmp(argv[i], "--metrics")) {
+            g_options.metrics = true;
+        } else if (!strcmp(argv[i], "--iterations") && i + 1 < argc) {
+            g_options.iterations = strtoull(argv[++i], nullptr, 10);
+        } else if (!strcmp(argv[i], "--filter") && i + 1 < argc) {
+            g_options.filter = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    registerDefaultTools();
+
+    benchParse();
+    benchSerialize();
+    benchDispatch();
+
+    printResults();
+
+#if TINYMCP_METRICS
+    if (g_options.metrics) {
+        cJSON* stats = Metrics::getInstance().toJson();
+        char* text = cJSON_Print(stats);
+        printf("%s\n", text ? text : "{}");
+        cJSON_free(text);
+        cJSON_Delete(stats);
+    }
+#endif
+
+    return g_failed ? 1 : 0;
+}
@@ -0,0 +1,347 @@
+// ESP-IDF system services for the host build
+// Logging, timer, events, heap reporting, a directory-backed SPIFFS, a simulated
+// WiFi scan and an in-memory GPIO driver
+
+#include "esp_err.h"
+#include "esp_event.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "esp_spiffs.h"
+#include "esp_wifi.h"
+#include "driver/gpio.h"
+#include "host_heap.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+
+namespace {
+
+// Heap budget reported to the firmware code; TINYMCP_HOST_HEAP_BYTES overrides
+const size_t DEFAULT_HEAP_BYTES = 64 * 1024 * 1024;
+
+std::chrono::steady_clock::time_point startTime() {
+    static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    return start;
+}
+
+size_t heapBudget() {
+    static const size_t budget = [] {
+        const char* value = getenv("TINYMCP_HOST_HEAP_BYTES");
+        return value ? static_cast<size_t>(strtoull(value, nullptr, 10)) : DEFAULT_HEAP_BYTES;
+    }();
+    return budget;
+}
+
+std::atomic<uint32_t> g_minimumFreeHeap{UINT32_MAX};
+
+std::atomic<int> g_logLevel{-1};
+
+int logLevel() {
+    int level = g_logLevel.load();
+    if (level < 0) {
+        const char* value = getenv("TINYMCP_HOST_LOG_LEVEL");
+        level = value ? atoi(value) : ESP_LOG_WARN;
+        g_logLevel = level;
+    }
+    return level;
+}
+
+std::mutex& logMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+uint32_t g_gpioLevels = 0;
+
+struct EventHandler {
+    esp_event_base_t base;
+    int32_t id;
+    esp_event_handler_t handler;
+    void* arg;
+};
+
+std::mutex g_eventMutex;
+std::vector<EventHandler> g_eventHandlers;
+
+void postEvent(esp_event_base_t base, int32_t id, void* data) {
+    std::vector<EventHandler> handlers;
+    {
+        std::lock_guard<std::mutex> lock(g_eventMutex);
+        handlers = g_eventHandlers;
+    }
+    for (const auto& entry : handlers) {
+        if (entry.base == base && (entry.id == id || entry.id == ESP_EVENT_ANY_ID)) {
+            entry.handler(entry.arg, base, id, data);
+        }
+    }
+}
+
+// A scan takes TINYMCP_HOST_SCAN_MS per channel sweep (default 300) and finds
+// these networks; the last one is hidden
+const struct {
+    const char* ssid;
+    uint8_t channel;
+    int8_t rssi;
+    wifi_auth_mode_t authmode;
+} SAMPLE_NETWORKS[] = {
+    {"tinymcp-host-a", 1, -42, WIFI_AUTH_WPA2_PSK},
+    {"tinymcp-host-b", 6, -57, WIFI_AUTH_WPA_WPA2_PSK},
+    {"tinymcp-host-c", 11, -71, WIFI_AUTH_OPEN},
+    {"", 6, -80, WIFI_AUTH_WPA2_PSK},
+};
+
+std::mutex g_scanMutex;
+bool g_scanRunning = false;
+std::vector<wifi_ap_record_t> g_scanRecords;
+
+// lwIP reports a closed peer through errno; the host kernel would also raise SIGPIPE
+__attribute__((constructor)) void ignoreSigpipe() {
+    signal(SIGPIPE, SIG_IGN);
+}
+
+} // namespace
+
+const char* esp_err_to_name(esp_err_t code) {
+    switch (code) {
+        case ESP_OK: return "ESP_OK";
+        case ESP_FAIL: return "ESP_FAIL";
+        case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE: return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND: return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_NOT_SUPPORTED: return "ESP_ERR_NOT_SUPPORTED";
+        case ESP_ERR_TIMEOUT: return "ESP_ERR_TIMEOUT";
+        default: return "UNKNOWN ERROR";
+    }
+}
+
+// Logging
+
+void esp_log_level_set(const char* tag, esp_log_level_t level) {
+    // Per-tag levels are not needed on the host; every tag follows the last call
+    (void)tag;
+    g_logLevel = level;
+}
+
+int esp_log_enabled(esp_log_level_t level) {
+    return level != ESP_LOG_NONE && static_cast<int>(level) <= logLevel();
+}
+
+void esp_log_write(esp_log_level_t level, const char* tag, const char* format, ...) {
+    // Filtered here as well, like ESP-IDF, since deferred records bypass the macros
+    (void)tag;
+    if (!esp_log_enabled(level)) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> guard(logMutex());
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+}
+
+// Timer
+
+int64_t esp_timer_get_time(void) {
+    auto elapsed = std::chrono::steady_clock::now() - startTime();
+    return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+}
+
+// System
+
+uint32_t esp_get_free_heap_size(void) {
+    host_heap_stats_t stats;
+    host_heap_get_stats(&stats);
+
+    size_t budget = heapBudget();
+    uint32_t freeHeap = static_cast<uint32_t>(stats.liveBytes < budget ? budget - stats.liveBytes : 0);
+
+    uint32_t minimum = g_minimumFreeHeap.load();
+    while (freeHeap < minimum && !g_minimumFreeHeap.compare_exchange_weak(minimum, freeHeap)) {
+    }
+    return freeHeap;
+}
+
+uint32_t esp_get_minimum_free_heap_size(void) {
+    uint32_t current = esp_get_free_heap_size();
+    uint32_t minimum = g_minimumFreeHeap.load();
+    return minimum < current ? minimum : current;
+}
+
+void esp_chip_info(esp_chip_info_t* out_info) {
+    memset(out_info, 0, sizeof(*out_info));
+    out_info->model = CHIP_ESP8266;
+    out_info->cores = 1;
+}
+
+const char* esp_get_idf_version(void) {
+    return "host";
+}
+
+void esp_restart(void) {
+    exit(0);
+}
+
+// Drivers without hardware behind them
+
+static std::string g_spiffsBasePath;
+
+esp_err_t esp_vfs_spiffs_register(const esp_vfs_spiffs_conf_t* conf) {
+    if (!conf || !conf->base_path) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (mkdir(conf->base_path, 0755) != 0 && errno != EEXIST) {
+        return ESP_FAIL;
+    }
+    g_spiffsBasePath = conf->base_path;
+    return ESP_OK;
+}
+
+esp_err_t esp_spiffs_info(const char* partition_label, size_t* total_bytes, size_t* used_bytes) {
+    (void)partition_label;
+    struct statvfs fs;
+    if (g_spiffsBasePath.empty() || statvfs(g_spiffsBasePath.c_str(), &fs) != 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    *total_bytes = static_cast<size_t>(fs.f_blocks) * fs.f_frsize;
+    *used_bytes = static_cast<size_t>(fs.f_blocks - fs.f_bfree) * fs.f_frsize;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_get_mode(wifi_mode_t* mode) {
+    (void)mode;
+    return ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t esp_wifi_sta_get_ap_info(wifi_ap_record_t* ap_info) {
+    (void)ap_info;
+    return ESP_ERR_INVALID_STATE;
+}
+
+esp_event_base_t const WIFI_EVENT = "WIFI_EVENT";
+
+esp_err_t esp_event_handler_register(esp_event_base_t event_base, int32_t event_id,
+                                     esp_event_handler_t event_handler, void* event_handler_arg) {
+    if (!event_handler) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    std::lock_guard<std::mutex> lock(g_eventMutex);
+    g_eventHandlers.push_back({event_base, event_id, event_handler, event_handler_arg});
+    return ESP_OK;
+}
+
+esp_err_t esp_event_handler_unregister(esp_event_base_t event_base, int32_t event_id,
+                                       esp_event_handler_t event_handler) {
+    std::lock_guard<std::mutex> lock(g_eventMutex);
+    for (auto it = g_eventHandlers.begin(); it != g_eventHandlers.end(); ++it) {
+        if (it->base == event_base && it->id == event_id && it->handler == event_handler) {
+            g_eventHandlers.erase(it);
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t esp_wifi_scan_start(const wifi_scan_config_t* config, bool block) {
+    wifi_scan_config_t scan = config ? *config : wifi_scan_config_t();
+    {
+        std::lock_guard<std::mutex> lock(g_scanMutex);
+        if (g_scanRunning) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        g_scanRunning = true;
+    }
+
+    const char* value = getenv("TINYMCP_HOST_SCAN_MS");
+    int sweepMs = value ? atoi(value) : 300;
+    int durationMs = scan.channel ? std::max(sweepMs / 13, 1) : sweepMs;
+
+    auto run = [scan, durationMs]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(durationMs));
+        wifi_event_sta_scan_done_t event = {};
+        {
+            std::lock_guard<std::mutex> lock(g_scanMutex);
+            g_scanRecords.clear();
+            for (const auto& sample : SAMPLE_NETWORKS) {
+                if ((scan.channel && sample.channel != scan.channel) || (!sample.ssid[0] && !scan.show_hidden)) {
+                    continue;
+                }
+                wifi_ap_record_t record = {};
+                snprintf(reinterpret_cast<char*>(record.ssid), sizeof(record.ssid), "%s", sample.ssid);
+                for (size_t i = 0; i < sizeof(record.bssid); i++) {
+                    record.bssid[i] = static_cast<uint8_t>(0x02 + sample.channel * i);
+                }
+                record.primary = sample.channel;
+                record.rssi = sample.rssi;
+                record.authmode = sample.authmode;
+                g_scanRecords.push_back(record);
+            }
+            event.number = static_cast<uint8_t>(g_scanRecords.size());
+            g_scanRunning = false;
+        }
+        postEvent(WIFI_EVENT, WIFI_EVENT_SCAN_DONE, &event);
+    };
+
+    if (block) {
+        run();
+    } else {
+        std::thread(run).detach();
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_scan_stop(void) {
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_scan_get_ap_records(uint16_t* number, wifi_ap_record_t* ap_records) {
+    if (!number || !ap_records) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // Like the driver, hand the records over once and forget them
+    std::lock_guard<std::mutex> lock(g_scanMutex);
+    size_t count = std::min<size_t>(*number, g_scanRecords.size());
+    std::copy(g_scanRecords.begin(), g_scanRecords.begin() + count, ap_records);
+    *number = static_cast<uint16_t>(count);
+    g_scanRecords.clear();
+    return ESP_OK;
+}
+
+esp_err_t gpio_config(const gpio_config_t* gpio_cfg) {
+    return gpio_cfg ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level) {
+    if (gpio_num < 0 || gpio_num >= GPIO_NUM_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (level) {
+        g_gpioLevels |= 1u << gpio_num;
+    } else {
+        g_gpioLevels &= ~(1u << gpio_num);
+    }
+    return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio_num) {
+    if (gpio_num < 0 || gpio_num >= GPIO_NUM_MAX) {
+        return 0;
+    }
+    return (g_gpioLevels >> gpio_num) & 1;
+}
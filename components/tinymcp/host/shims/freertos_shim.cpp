@@ -0,0 +1,689 @@
+// FreeRTOS kernel API on top of pthreads for the host build
+// Tasks are detached threads; queues, semaphores, event groups and notifications use condition variables
+// Software timers are served by one daemon task
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+#include "freertos/timers.h"
+
+#include <pthread.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+// Blocking calls wake at least this often to notice vTaskDelete() from another task
+static const std::chrono::milliseconds DELETE_POLL_INTERVAL(10);
+
+// How long vTaskDelete() waits for another task to reach a blocking call and exit
+static const std::chrono::milliseconds DELETE_JOIN_TIMEOUT(1000);
+
+struct tskTaskControlBlock {
+    TaskFunction_t code = nullptr;
+    void* parameters = nullptr;
+    std::string name;
+    bool adopted = false;                   // Thread not created by xTaskCreate
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    uint32_t notifyValue = 0;
+    bool exited = false;
+
+    std::atomic<bool> deleted{false};
+    std::atomic<int> refs{2};               // Owning thread + handle
+};
+
+namespace {
+
+// Thrown through the task's stack when it has been deleted
+struct TaskDeleted {};
+
+std::atomic<UBaseType_t> g_taskCount{1};
+
+Clock::time_point startTime() {
+    static const Clock::time_point start = Clock::now();
+    return start;
+}
+
+std::recursive_mutex& schedulerLock() {
+    static std::recursive_mutex lock;
+    return lock;
+}
+
+void releaseTask(tskTaskControlBlock* task) {
+    if (task->refs.fetch_sub(1) == 1) {
+        delete task;
+    }
+}
+
+thread_local tskTaskControlBlock* t_current = nullptr;
+
+// Threads that call into the kernel without being created by it (main, test
+// threads) get a control block on first use; it is never freed so late
+// static destructors can still take mutexes
+tskTaskControlBlock* currentTask() {
+    if (!t_current) {
+        t_current = new tskTaskControlBlock();
+        t_current->name = "host";
+        t_current->adopted = true;
+    }
+    return t_current;
+}
+
+void checkDeleted(tskTaskControlBlock* self) {
+    if (self->deleted.load()) {
+        throw TaskDeleted();
+    }
+}
+
+// Waits on `cv` until `pred` holds or `ticks` elapse, in short slices so a
+// pending vTaskDelete() of the calling task is honoured
+template <typename Predicate>
+bool waitTicks(std::unique_lock<std::mutex>& lock, std::condition_variable& cv,
+               TickType_t ticks, Predicate pred) {
+    if (pred()) {
+        return true;
+    }
+    if (ticks == 0) {
+        return false;
+    }
+
+    tskTaskControlBlock* self = currentTask();
+    bool forever = ticks == portMAX_DELAY;
+    Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(ticks * portTICK_PERIOD_MS);
+
+    while (!pred()) {
+        checkDeleted(self);
+
+        Clock::time_point now = Clock::now();
+        if (!forever && now >= deadline) {
+            return false;
+        }
+
+        Clock::time_point wake = now + DELETE_POLL_INTERVAL;
+        if (!forever) {
+            wake = std::min(wake, deadline);
+        }
+        cv.wait_until(lock, wake);
+    }
+
+    return true;
+}
+
+void* taskEntry(void* arg) {
+    tskTaskControlBlock* task = static_cast<tskTaskControlBlock*>(arg);
+    t_current = task;
+
+    try {
+        task->code(task->parameters);
+    } catch (const TaskDeleted&) {
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(task->mutex);
+        task->exited = true;
+    }
+    task->cv.notify_all();
+
+    g_taskCount--;
+    releaseTask(task);
+    return nullptr;
+}
+
+} // namespace
+
+// Queues and semaphores share one object, as they do in the kernel
+struct QueueDefinition {
+    enum class Kind { QUEUE, MUTEX, RECURSIVE_MUTEX, SEMAPHORE };
+
+    Kind kind = Kind::QUEUE;
+    std::mutex mutex;
+    std::condition_variable cv;
+
+    // Queue storage (ring of fixed-size items)
+    std::vector<uint8_t> storage;
+    size_t itemSize = 0;
+    size_t length = 0;
+    size_t head = 0;
+    size_t count = 0;
+
+    // Mutex ownership
+    TaskHandle_t owner = nullptr;
+    uint32_t depth = 0;
+};
+
+struct EventGroupDef_t {
+    std::mutex mutex;
+    std::condition_variable cv;
+    EventBits_t bits = 0;
+};
+
+struct tmrTimerControl {
+    std::string name;
+    TickType_t period = 1;
+    bool autoReload = false;
+    void* id = nullptr;
+    TimerCallbackFunction_t callback = nullptr;
+
+    bool active = false;                    // Guarded by the timer service lock
+    Clock::time_point expiry;
+};
+
+// Tasks
+
+BaseType_t xTaskCreate(TaskFunction_t pxTaskCode, const char* pcName, uint32_t usStackDepth,
+                       void* pvParameters, UBaseType_t uxPriority, TaskHandle_t* pxCreatedTask) {
+    (void)usStackDepth;
+    (void)uxPriority;
+
+    tskTaskControlBlock* task = new tskTaskControlBlock();
+    task->code = pxTaskCode;
+    task->parameters = pvParameters;
+    task->name = pcName ? pcName : "";
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+    g_taskCount++;
+    pthread_t thread;
+    int rc = pthread_create(&thread, &attr, taskEntry, task);
+    pthread_attr_destroy(&attr);
+
+    if (rc != 0) {
+        g_taskCount--;
+        delete task;
+        return pdFAIL;
+    }
+
+    pthread_setname_np(thread, task->name.substr(0, 15).c_str());
+
+    if (pxCreatedTask) {
+        *pxCreatedTask = task;
+    } else {
+        releaseTask(task);
+    }
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t xTaskToDelete) {
+    tskTaskControlBlock* self = currentTask();
+
+    if (!xTaskToDelete || xTaskToDelete == self) {
+        if (self->adopted) {
+            return;
+        }
+        self->deleted = true;
+        throw TaskDeleted();
+    }
+
+    tskTaskControlBlock* task = xTaskToDelete;
+    task->deleted = true;
+
+    // The kernel frees a deleted task at once; give this one the chance to
+    // leave its blocking call before the caller tears down what it waits on
+    {
+        std::unique_lock<std::mutex> lock(task->mutex);
+        task->cv.wait_for(lock, DELETE_JOIN_TIMEOUT, [task] { return task->exited; });
+    }
+
+    releaseTask(task);
+}
+
+void vTaskDelay(TickType_t xTicksToDelay) {
+    tskTaskControlBlock* self = currentTask();
+    std::unique_lock<std::mutex> lock(self->mutex);
+    waitTicks(lock, self->cv, xTicksToDelay, [] { return false; });
+}
+
+TickType_t xTaskGetTickCount(void) {
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - startTime());
+    return static_cast<TickType_t>(elapsed.count() / portTICK_PERIOD_MS);
+}
+
+UBaseType_t uxTaskGetNumberOfTasks(void) {
+    return g_taskCount.load();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    return currentTask();
+}
+
+void vTaskSuspendAll(void) {
+    schedulerLock().lock();
+}
+
+BaseType_t xTaskResumeAll(void) {
+    schedulerLock().unlock();
+    return pdFALSE;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify) {
+    {
+        std::lock_guard<std::mutex> guard(xTaskToNotify->mutex);
+        xTaskToNotify->notifyValue++;
+    }
+    xTaskToNotify->cv.notify_all();
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait) {
+    tskTaskControlBlock* self = currentTask();
+    std::unique_lock<std::mutex> lock(self->mutex);
+
+    waitTicks(lock, self->cv, xTicksToWait, [self] { return self->notifyValue != 0; });
+
+    uint32_t value = self->notifyValue;
+    if (value != 0) {
+        self->notifyValue = xClearCountOnExit ? 0 : value - 1;
+    }
+    return value;
+}
+
+// Queues
+
+QueueHandle_t xQueueCreate(UBaseType_t uxQueueLength, UBaseType_t uxItemSize) {
+    if (uxQueueLength == 0) {
+        return nullptr;
+    }
+
+    QueueDefinition* queue = new QueueDefinition();
+    queue->length = uxQueueLength;
+    queue->itemSize = uxItemSize;
+    queue->storage.resize(uxQueueLength * uxItemSize);
+    return queue;
+}
+
+void vQueueDelete(QueueHandle_t xQueue) {
+    delete xQueue;
+}
+
+static BaseType_t queueSend(QueueHandle_t queue, const void* item, TickType_t ticks, bool front) {
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    if (!waitTicks(lock, queue->cv, ticks, [queue] { return queue->count < queue->length; })) {
+        return errQUEUE_FULL;
+    }
+
+    size_t slot;
+    if (front) {
+        queue->head = (queue->head + queue->length - 1) % queue->length;
+        slot = queue->head;
+    } else {
+        slot = (queue->head + queue->count) % queue->length;
+    }
+
+    // Semaphores and event-style queues pass no item
+    if (item && queue->itemSize > 0) {
+        memcpy(&queue->storage[slot * queue->itemSize], item, queue->itemSize);
+    }
+    queue->count++;
+
+    lock.unlock();
+    queue->cv.notify_all();
+    return pdPASS;
+}
+
+static BaseType_t queueReceive(QueueHandle_t queue, void* buffer, TickType_t ticks, bool remove) {
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    if (!waitTicks(lock, queue->cv, ticks, [queue] { return queue->count > 0; })) {
+        return errQUEUE_EMPTY;
+    }
+
+    if (buffer && queue->itemSize > 0) {
+        memcpy(buffer, &queue->storage[queue->head * queue->itemSize], queue->itemSize);
+    }
+
+    if (remove) {
+        queue->head = (queue->head + 1) % queue->length;
+        queue->count--;
+        lock.unlock();
+        queue->cv.notify_all();
+    }
+    return pdPASS;
+}
+
+BaseType_t xQueueSend(QueueHandle_t xQueue, const void* pvItemToQueue, TickType_t xTicksToWait) {
+    return queueSend(xQueue, pvItemToQueue, xTicksToWait, false);
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t xQueue, const void* pvItemToQueue, TickType_t xTicksToWait) {
+    return queueSend(xQueue, pvItemToQueue, xTicksToWait, false);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t xQueue, const void* pvItemToQueue, TickType_t xTicksToWait) {
+    return queueSend(xQueue, pvItemToQueue, xTicksToWait, true);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t xQueue, void* pvBuffer, TickType_t xTicksToWait) {
+    return queueReceive(xQueue, pvBuffer, xTicksToWait, true);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t xQueue, void* pvBuffer, TickType_t xTicksToWait) {
+    return queueReceive(xQueue, pvBuffer, xTicksToWait, false);
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t xQueue) {
+    std::lock_guard<std::mutex> guard(xQueue->mutex);
+    return xQueue->count;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t xQueue) {
+    std::lock_guard<std::mutex> guard(xQueue->mutex);
+    return xQueue->length - xQueue->count;
+}
+
+// Semaphores and mutexes
+
+static SemaphoreHandle_t createSemaphore(QueueDefinition::Kind kind, size_t maxCount, size_t initialCount) {
+    QueueDefinition* semaphore = new QueueDefinition();
+    semaphore->kind = kind;
+    semaphore->length = maxCount;
+    semaphore->count = initialCount;
+    return semaphore;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    return createSemaphore(QueueDefinition::Kind::MUTEX, 1, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void) {
+    return createSemaphore(QueueDefinition::Kind::RECURSIVE_MUTEX, 1, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+    return createSemaphore(QueueDefinition::Kind::SEMAPHORE, 1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount) {
+    return createSemaphore(QueueDefinition::Kind::SEMAPHORE, uxMaxCount, uxInitialCount);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xBlockTime) {
+    if (xSemaphore->kind == QueueDefinition::Kind::QUEUE) {
+        return xQueueReceive(xSemaphore, nullptr, xBlockTime);
+    }
+
+    std::unique_lock<std::mutex> lock(xSemaphore->mutex);
+    if (!waitTicks(lock, xSemaphore->cv, xBlockTime, [xSemaphore] { return xSemaphore->count > 0; })) {
+        return pdFALSE;
+    }
+
+    xSemaphore->count--;
+    xSemaphore->owner = currentTask();
+    xSemaphore->depth = 1;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore) {
+    if (xSemaphore->kind == QueueDefinition::Kind::QUEUE) {
+        return xQueueSend(xSemaphore, nullptr, 0);
+    }
+
+    std::unique_lock<std::mutex> lock(xSemaphore->mutex);
+    if (xSemaphore->count >= xSemaphore->length) {
+        return pdFALSE;
+    }
+    if (xSemaphore->kind != QueueDefinition::Kind::SEMAPHORE && xSemaphore->owner != currentTask()) {
+        return pdFALSE;
+    }
+
+    xSemaphore->count++;
+    xSemaphore->owner = nullptr;
+    xSemaphore->depth = 0;
+
+    lock.unlock();
+    xSemaphore->cv.notify_all();
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t xMutex, TickType_t xBlockTime) {
+    TaskHandle_t self = currentTask();
+    std::unique_lock<std::mutex> lock(xMutex->mutex);
+
+    if (xMutex->owner == self) {
+        xMutex->depth++;
+        return pdTRUE;
+    }
+
+    if (!waitTicks(lock, xMutex->cv, xBlockTime, [xMutex] { return xMutex->count > 0; })) {
+        return pdFALSE;
+    }
+
+    xMutex->count--;
+    xMutex->owner = self;
+    xMutex->depth = 1;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t xMutex) {
+    std::unique_lock<std::mutex> lock(xMutex->mutex);
+    if (xMutex->owner != currentTask()) {
+        return pdFALSE;
+    }
+
+    if (--xMutex->depth > 0) {
+        return pdTRUE;
+    }
+
+    xMutex->owner = nullptr;
+    xMutex->count++;
+
+    lock.unlock();
+    xMutex->cv.notify_all();
+    return pdTRUE;
+}
+
+// Event groups
+
+EventGroupHandle_t xEventGroupCreate(void) {
+    return new EventGroupDef_t();
+}
+
+void vEventGroupDelete(EventGroupHandle_t xEventGroup) {
+    delete xEventGroup;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t xEventGroup, EventBits_t uxBitsToWaitFor,
+                                BaseType_t xClearOnExit, BaseType_t xWaitForAllBits, TickType_t xTicksToWait) {
+    std::unique_lock<std::mutex> lock(xEventGroup->mutex);
+
+    auto satisfied = [=] {
+        EventBits_t set = xEventGroup->bits & uxBitsToWaitFor;
+        return xWaitForAllBits ? set == uxBitsToWaitFor : set != 0;
+    };
+
+    bool met = waitTicks(lock, xEventGroup->cv, xTicksToWait, satisfied);
+    EventBits_t bits = xEventGroup->bits;
+
+    if (met && xClearOnExit) {
+        xEventGroup->bits &= ~uxBitsToWaitFor;
+    }
+    return bits;
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t xEventGroup, EventBits_t uxBitsToSet) {
+    EventBits_t bits;
+    {
+        std::lock_guard<std::mutex> guard(xEventGroup->mutex);
+        xEventGroup->bits |= uxBitsToSet;
+        bits = xEventGroup->bits;
+    }
+    xEventGroup->cv.notify_all();
+    return bits;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t xEventGroup, EventBits_t uxBitsToClear) {
+    std::lock_guard<std::mutex> guard(xEventGroup->mutex);
+    EventBits_t bits = xEventGroup->bits;
+    xEventGroup->bits &= ~uxBitsToClear;
+    return bits;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t xEventGroup) {
+    std::lock_guard<std::mutex> guard(xEventGroup->mutex);
+    return xEventGroup->bits;
+}
+
+// Software timers
+
+namespace {
+
+struct TimerService {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<tmrTimerControl*> timers;
+    bool started = false;
+};
+
+// Never freed, like the adopted task blocks, so the daemon can outlive statics
+TimerService& timerService() {
+    static TimerService* service = new TimerService();
+    return *service;
+}
+
+void timerServiceTask(void* pvParameters) {
+    TimerService& service = *static_cast<TimerService*>(pvParameters);
+    std::unique_lock<std::mutex> lock(service.mutex);
+
+    for (;;) {
+        tmrTimerControl* next = nullptr;
+        for (tmrTimerControl* timer : service.timers) {
+            if (timer->active && (!next || timer->expiry < next->expiry)) {
+                next = timer;
+            }
+        }
+
+        if (!next) {
+            service.cv.wait(lock);
+            continue;
+        }
+        if (Clock::now() < next->expiry) {
+            service.cv.wait_until(lock, next->expiry);
+            continue;
+        }
+
+        if (next->autoReload) {
+            next->expiry += std::chrono::milliseconds(next->period * portTICK_PERIOD_MS);
+        } else {
+            next->active = false;
+        }
+
+        // Unlocked so the callback can issue timer commands
+        lock.unlock();
+        next->callback(next);
+        lock.lock();
+    }
+}
+
+// Starts the daemon on first use; called with the service lock held
+void startTimerService(TimerService& service) {
+    if (!service.started) {
+        service.started = xTaskCreate(timerServiceTask, "Tmr Svc", 2048, &service,
+                                      configMAX_PRIORITIES - 1, nullptr) == pdPASS;
+    }
+}
+
+void armTimer(tmrTimerControl* timer) {
+    timer->active = true;
+    timer->expiry = Clock::now() + std::chrono::milliseconds(timer->period * portTICK_PERIOD_MS);
+}
+
+} // namespace
+
+TimerHandle_t xTimerCreate(const char* pcTimerName, TickType_t xTimerPeriodInTicks, UBaseType_t uxAutoReload,
+                           void* pvTimerID, TimerCallbackFunction_t pxCallbackFunction) {
+    if (xTimerPeriodInTicks == 0 || !pxCallbackFunction) {
+        return nullptr;
+    }
+
+    tmrTimerControl* timer = new tmrTimerControl();
+    timer->name = pcTimerName ? pcTimerName : "";
+    timer->period = xTimerPeriodInTicks;
+    timer->autoReload = uxAutoReload != 0;
+    timer->id = pvTimerID;
+    timer->callback = pxCallbackFunction;
+
+    TimerService& service = timerService();
+    std::lock_guard<std::mutex> guard(service.mutex);
+    startTimerService(service);
+    service.timers.push_back(timer);
+    return timer;
+}
+
+BaseType_t xTimerStart(TimerHandle_t xTimer, TickType_t xTicksToWait) {
+    (void)xTicksToWait;
+
+    TimerService& service = timerService();
+    {
+        std::lock_guard<std::mutex> guard(service.mutex);
+        armTimer(xTimer);
+    }
+    service.cv.notify_all();
+    return pdPASS;
+}
+
+BaseType_t xTimerReset(TimerHandle_t xTimer, TickType_t xTicksToWait) {
+    return xTimerStart(xTimer, xTicksToWait);
+}
+
+BaseType_t xTimerStop(TimerHandle_t xTimer, TickType_t xTicksToWait) {
+    (void)xTicksToWait;
+
+    TimerService& service = timerService();
+    {
+        std::lock_guard<std::mutex> guard(service.mutex);
+        xTimer->active = false;
+    }
+    service.cv.notify_all();
+    return pdPASS;
+}
+
+BaseType_t xTimerChangePeriod(TimerHandle_t xTimer, TickType_t xNewPeriod, TickType_t xTicksToWait) {
+    (void)xTicksToWait;
+
+    if (xNewPeriod == 0) {
+        return pdFAIL;
+    }
+
+    // As in the kernel, a dormant timer is started by a period change
+    TimerService& service = timerService();
+    {
+        std::lock_guard<std::mutex> guard(service.mutex);
+        xTimer->period = xNewPeriod;
+        armTimer(xTimer);
+    }
+    service.cv.notify_all();
+    return pdPASS;
+}
+
+BaseType_t xTimerDelete(TimerHandle_t xTimer, TickType_t xTicksToWait) {
+    (void)xTicksToWait;
+
+    TimerService& service = timerService();
+    {
+        std::lock_guard<std::mutex> guard(service.mutex);
+        service.timers.erase(std::remove(service.timers.begin(), service.timers.end(), xTimer),
+                             service.timers.end());
+    }
+    delete xTimer;
+    return pdPASS;
+}
+
+BaseType_t xTimerIsTimerActive(TimerHandle_t xTimer) {
+    TimerService& service = timerService();
+    std::lock_guard<std::mutex> guard(service.mutex);
+    return xTimer->active ? pdTRUE : pdFALSE;
+}
+
+void* pvTimerGetTimerID(TimerHandle_t xTimer) {
+    return xTimer->id;
+}
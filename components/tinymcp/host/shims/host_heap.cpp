@@ -0,0 +1,131 @@
+// Process heap accounting for the host build
+// Wraps the glibc allocator entry points; esp_get_free_heap_size() reports against it
+
+#include "host_heap.h"
+
+#include <atomic>
+
+#ifndef TINYMCP_HOST_TRACK_HEAP
+#define TINYMCP_HOST_TRACK_HEAP 0
+#endif
+
+#if TINYMCP_HOST_TRACK_HEAP
+
+#include <malloc.h>
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* ptr);
+}
+
+#endif
+
+namespace {
+
+std::atomic<uint64_t> g_allocations{0};
+std::atomic<uint64_t> g_frees{0};
+std::atomic<size_t> g_liveBytes{0};
+std::atomic<size_t> g_peakBytes{0};
+
+#if TINYMCP_HOST_TRACK_HEAP
+
+void trackAlloc(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+
+    size_t live = g_liveBytes.fetch_add(malloc_usable_size(ptr), std::memory_order_relaxed) +
+                  malloc_usable_size(ptr);
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+
+    size_t peak = g_peakBytes.load(std::memory_order_relaxed);
+    while (live > peak && !g_peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+}
+
+void trackFree(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+
+    g_liveBytes.fetch_sub(malloc_usable_size(ptr), std::memory_order_relaxed);
+    g_frees.fetch_add(1, std::memory_order_relaxed);
+}
+
+#endif
+
+} // namespace
+
+#if TINYMCP_HOST_TRACK_HEAP
+
+extern "C" {
+
+void* malloc(size_t size) {
+    void* ptr = __libc_malloc(size);
+    trackAlloc(ptr);
+    return ptr;
+}
+
+void* calloc(size_t count, size_t size) {
+    void* ptr = __libc_calloc(count, size);
+    trackAlloc(ptr);
+    return ptr;
+}
+
+void* realloc(void* ptr, size_t size) {
+    trackFree(ptr);
+    void* moved = __libc_realloc(ptr, size);
+    if (moved) {
+        trackAlloc(moved);
+    } else if (ptr && size != 0) {
+        // Original block is still live
+        trackAlloc(ptr);
+    }
+    return moved;
+}
+
+void* memalign(size_t alignment, size_t size) {
+    void* ptr = __libc_memalign(alignment, size);
+    trackAlloc(ptr);
+    return ptr;
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    return memalign(alignment, size);
+}
+
+int posix_memalign(void** out, size_t alignment, size_t size) {
+    void* ptr = memalign(alignment, size);
+    if (!ptr) {
+        return 12; // ENOMEM
+    }
+    *out = ptr;
+    return 0;
+}
+
+void free(void* ptr) {
+    trackFree(ptr);
+    __libc_free(ptr);
+}
+
+} // extern "C"
+
+#endif
+
+int host_heap_tracking_enabled(void) {
+    return TINYMCP_HOST_TRACK_HEAP ? 1 : 0;
+}
+
+void host_heap_get_stats(host_heap_stats_t* stats) {
+    stats->allocations = g_allocations.load();
+    stats->frees = g_frees.load();
+    stats->liveBytes = g_liveBytes.load();
+    stats->peakBytes = g_peakBytes.load();
+}
+
+void host_heap_reset_peak(void) {
+    g_peakBytes.store(g_liveBytes.load());
+}
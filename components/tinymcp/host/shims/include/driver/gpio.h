@@ -0,0 +1,55 @@
+#pragma once
+
+// Host stand-in for driver/gpio.h
+// Pin levels are kept in memory so gpio_control round-trips
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+typedef enum {
+    GPIO_NUM_0 = 0,
+    GPIO_NUM_16 = 16,
+    GPIO_NUM_MAX = 17
+} gpio_num_t;
+
+typedef enum {
+    GPIO_MODE_DISABLE = 0,
+    GPIO_MODE_INPUT = 1,
+    GPIO_MODE_OUTPUT = 2,
+    GPIO_MODE_OUTPUT_OD = 6
+} gpio_mode_t;
+
+typedef enum {
+    GPIO_PULLUP_DISABLE = 0,
+    GPIO_PULLUP_ENABLE
+} gpio_pullup_t;
+
+typedef enum {
+    GPIO_PULLDOWN_DISABLE = 0,
+    GPIO_PULLDOWN_ENABLE
+} gpio_pulldown_t;
+
+typedef enum {
+    GPIO_INTR_DISABLE = 0
+} gpio_int_type_t;
+
+typedef struct {
+    uint32_t pin_bit_mask;
+    gpio_mode_t mode;
+    gpio_pullup_t pull_up_en;
+    gpio_pulldown_t pull_down_en;
+    gpio_int_type_t intr_type;
+} gpio_config_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+esp_err_t gpio_config(const gpio_config_t* gpio_cfg);
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level);
+int gpio_get_level(gpio_num_t gpio_num);
+
+#ifdef __cplusplus
+}
+#endif
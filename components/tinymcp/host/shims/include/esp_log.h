@@ -0,0 +1,41 @@
+#pragma once
+
+// Host stand-in for esp_log.h
+// Lines go to stderr; the level comes from esp_log_level_set() or TINYMCP_HOST_LOG_LEVEL
+
+#include <stdarg.h>
+#include <stdint.h>
+
+typedef enum {
+    ESP_LOG_NONE,
+    ESP_LOG_ERROR,
+    ESP_LOG_WARN,
+    ESP_LOG_INFO,
+    ESP_LOG_DEBUG,
+    ESP_LOG_VERBOSE
+} esp_log_level_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void esp_log_level_set(const char* tag, esp_log_level_t level);
+int esp_log_enabled(esp_log_level_t level);
+void esp_log_write(esp_log_level_t level, const char* tag, const char* format, ...)
+    __attribute__((format(printf, 3, 4)));
+
+#ifdef __cplusplus
+}
+#endif
+
+#define ESP_LOG_LEVEL_LOCAL(level, tag, letter, format, ...) do {               \
+        if (esp_log_enabled(level)) {                                           \
+            esp_log_write(level, tag, letter " %s: " format "\n", tag, ##__VA_ARGS__); \
+        }                                                                       \
+    } while (0)
+
+#define ESP_LOGE(tag, format, ...) ESP_LOG_LEVEL_LOCAL(ESP_LOG_ERROR, tag, "E", format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) ESP_LOG_LEVEL_LOCAL(ESP_LOG_WARN, tag, "W", format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) ESP_LOG_LEVEL_LOCAL(ESP_LOG_INFO, tag, "I", format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) ESP_LOG_LEVEL_LOCAL(ESP_LOG_DEBUG, tag, "D", format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...) ESP_LOG_LEVEL_LOCAL(ESP_LOG_VERBOSE, tag, "V", format, ##__VA_ARGS__)
@@ -0,0 +1,34 @@
+#pragma once
+
+// Host stand-in for esp_system.h
+// Free heap is a fixed budget minus the bytes currently allocated by the process
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+typedef enum {
+    CHIP_ESP8266 = 0
+} esp_chip_model_t;
+
+typedef struct {
+    esp_chip_model_t model;
+    uint32_t features;
+    uint8_t cores;
+    uint8_t revision;
+} esp_chip_info_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t esp_get_free_heap_size(void);
+uint32_t esp_get_minimum_free_heap_size(void);
+void esp_chip_info(esp_chip_info_t* out_info);
+const char* esp_get_idf_version(void);
+void esp_restart(void);
+
+#ifdef __cplusplus
+}
+#endif
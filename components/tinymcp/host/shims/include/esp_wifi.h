@@ -0,0 +1,85 @@
+#pragma once
+
+// Host stand-in for esp_wifi.h
+// The station never connects; scans report a few sample networks
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "esp_event.h"
+
+typedef enum {
+    WIFI_MODE_NULL = 0,
+    WIFI_MODE_STA,
+    WIFI_MODE_AP,
+    WIFI_MODE_APSTA,
+    WIFI_MODE_MAX
+} wifi_mode_t;
+
+typedef enum {
+    WIFI_AUTH_OPEN = 0,
+    WIFI_AUTH_WEP,
+    WIFI_AUTH_WPA_PSK,
+    WIFI_AUTH_WPA2_PSK,
+    WIFI_AUTH_WPA_WPA2_PSK,
+    WIFI_AUTH_MAX
+} wifi_auth_mode_t;
+
+typedef enum {
+    WIFI_SCAN_TYPE_ACTIVE = 0,
+    WIFI_SCAN_TYPE_PASSIVE
+} wifi_scan_type_t;
+
+typedef struct {
+    uint32_t min;
+    uint32_t max;
+} wifi_active_scan_time_t;
+
+typedef struct {
+    wifi_active_scan_time_t active;
+    uint32_t passive;
+} wifi_scan_time_t;
+
+typedef struct {
+    uint8_t* ssid;
+    uint8_t* bssid;
+    uint8_t channel;
+    bool show_hidden;
+    wifi_scan_type_t scan_type;
+    wifi_scan_time_t scan_time;
+} wifi_scan_config_t;
+
+typedef struct {
+    uint8_t bssid[6];
+    uint8_t ssid[33];
+    uint8_t primary;
+    int8_t rssi;
+    wifi_auth_mode_t authmode;
+} wifi_ap_record_t;
+
+typedef enum {
+    WIFI_EVENT_SCAN_DONE = 1
+} wifi_event_t;
+
+typedef struct {
+    uint32_t status;
+    uint8_t number;
+    uint8_t scan_id;
+} wifi_event_sta_scan_done_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern esp_event_base_t const WIFI_EVENT;
+
+esp_err_t esp_wifi_get_mode(wifi_mode_t* mode);
+esp_err_t esp_wifi_sta_get_ap_info(wifi_ap_record_t* ap_info);
+esp_err_t esp_wifi_scan_start(const wifi_scan_config_t* config, bool block);
+esp_err_t esp_wifi_scan_stop(void);
+esp_err_t esp_wifi_scan_get_ap_records(uint16_t* number, wifi_ap_record_t* ap_records);
+
+#ifdef __cplusplus
+}
+#endif
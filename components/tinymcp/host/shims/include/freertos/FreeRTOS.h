@@ -0,0 +1,44 @@
+#pragma once
+
+// Host (Linux) stand-in for the FreeRTOS kernel headers
+// Types and macros match the ESP8266 port; the kernel runs on pthreads
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t StackType_t;
+typedef uint32_t EventBits_t;
+
+typedef struct tskTaskControlBlock* TaskHandle_t;
+typedef struct QueueDefinition* QueueHandle_t;
+typedef QueueHandle_t SemaphoreHandle_t;
+typedef struct EventGroupDef_t* EventGroupHandle_t;
+
+#define configTICK_RATE_HZ      1000
+#define configMAX_PRIORITIES    15
+#define tskIDLE_PRIORITY        0
+
+#define portTICK_PERIOD_MS      ((TickType_t)1000 / configTICK_RATE_HZ)
+#define portMAX_DELAY           ((TickType_t)0xffffffffUL)
+#define pdMS_TO_TICKS(xTimeInMs) ((TickType_t)(((TickType_t)(xTimeInMs) * (TickType_t)configTICK_RATE_HZ) / (TickType_t)1000))
+
+#define pdFALSE                 ((BaseType_t)0)
+#define pdTRUE                  ((BaseType_t)1)
+#define pdFAIL                  (pdFALSE)
+#define pdPASS                  (pdTRUE)
+#define errQUEUE_FULL           ((BaseType_t)0)
+#define errQUEUE_EMPTY          ((BaseType_t)0)
+
+#ifndef BIT0
+#define BIT7                    0x00000080
+#define BIT6                    0x00000040
+#define BIT5                    0x00000020
+#define BIT4                    0x00000010
+#define BIT3                    0x00000008
+#define BIT2                    0x00000004
+#define BIT1                    0x00000002
+#define BIT0                    0x00000001
+#endif
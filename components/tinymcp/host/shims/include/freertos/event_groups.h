@@ -0,0 +1,22 @@
+#pragma once
+
+// Host stand-in for FreeRTOS event groups
+
+#include "FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+EventGroupHandle_t xEventGroupCreate(void);
+void vEventGroupDelete(EventGroupHandle_t xEventGroup);
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t xEventGroup, EventBits_t uxBitsToWaitFor,
+                                BaseType_t xClearOnExit, BaseType_t xWaitForAllBits, TickType_t xTicksToWait);
+EventBits_t xEventGroupSetBits(EventGroupHandle_t xEventGroup, EventBits_t uxBitsToSet);
+EventBits_t xEventGroupClearBits(EventGroupHandle_t xEventGroup, EventBits_t uxBitsToClear);
+EventBits_t xEventGroupGetBits(EventGroupHandle_t xEventGroup);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,31 @@
+#pragma once
+
+// Host stand-in for FreeRTOS tasks
+// Each task is a detached pthread; vTaskDelete() of another task takes effect at its next blocking call
+
+#include "FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (*TaskFunction_t)(void*);
+
+BaseType_t xTaskCreate(TaskFunction_t pxTaskCode, const char* pcName, uint32_t usStackDepth,
+                       void* pvParameters, UBaseType_t uxPriority, TaskHandle_t* pxCreatedTask);
+void vTaskDelete(TaskHandle_t xTaskToDelete);
+void vTaskDelay(TickType_t xTicksToDelay);
+
+TickType_t xTaskGetTickCount(void);
+UBaseType_t uxTaskGetNumberOfTasks(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+
+void vTaskSuspendAll(void);
+BaseType_t xTaskResumeAll(void);
+
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify);
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait);
+
+#ifdef __cplusplus
+}
+#endif
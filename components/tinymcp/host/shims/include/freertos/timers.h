@@ -0,0 +1,31 @@
+#pragma once
+
+// Host stand-in for FreeRTOS software timers
+// Callbacks run one at a time on a daemon task, like the timer service task
+
+#include "FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct tmrTimerControl* TimerHandle_t;
+typedef void (*TimerCallbackFunction_t)(TimerHandle_t xTimer);
+
+TimerHandle_t xTimerCreate(const char* pcTimerName, TickType_t xTimerPeriodInTicks, UBaseType_t uxAutoReload,
+                           void* pvTimerID, TimerCallbackFunction_t pxCallbackFunction);
+
+// Commands apply at once instead of going through the timer queue; a timer
+// must not be deleted while its callback runs
+BaseType_t xTimerStart(TimerHandle_t xTimer, TickType_t xTicksToWait);
+BaseType_t xTimerStop(TimerHandle_t xTimer, TickType_t xTicksToWait);
+BaseType_t xTimerChangePeriod(TimerHandle_t xTimer, TickType_t xNewPeriod, TickType_t xTicksToWait);
+BaseType_t xTimerReset(TimerHandle_t xTimer, TickType_t xTicksToWait);
+BaseType_t xTimerDelete(TimerHandle_t xTimer, TickType_t xTicksToWait);
+
+BaseType_t xTimerIsTimerActive(TimerHandle_t xTimer);
+void* pvTimerGetTimerID(TimerHandle_t xTimer);
+
+#ifdef __cplusplus
+}
+#endif
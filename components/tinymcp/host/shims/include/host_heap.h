@@ -0,0 +1,30 @@
+#pragma once
+
+// Process heap accounting for the host build
+// malloc/free are interposed so benchmarks can report allocations and peak bytes
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint64_t allocations;       // malloc/calloc/realloc/memalign calls that returned memory
+    uint64_t frees;
+    size_t liveBytes;           // Usable size of blocks not yet freed
+    size_t peakBytes;           // High-water mark of liveBytes since the last reset
+} host_heap_stats_t;
+
+// False when built without TINYMCP_HOST_TRACK_HEAP (e.g. under sanitizers)
+int host_heap_tracking_enabled(void);
+
+void host_heap_get_stats(host_heap_stats_t* stats);
+
+// Restart peak tracking from the current live size
+void host_heap_reset_peak(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,5 @@
+#pragma once
+
+// Host stand-in for lwip/netdb.h
+
+#include <netdb.h>
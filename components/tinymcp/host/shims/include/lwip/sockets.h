@@ -0,0 +1,14 @@
+#pragma once
+
+// Host stand-in for lwip/sockets.h
+// lwIP's BSD layer maps directly onto the POSIX socket headers
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
@@ -0,0 +1,33 @@
+#pragma once
+
+// Host build configuration
+// Mirrors the tinymcp Kconfig defaults; override with -D on the compiler command line
+
+#ifndef CONFIG_LOG_DEFAULT_LEVEL
+#define CONFIG_LOG_DEFAULT_LEVEL 2
+#endif
+
+#ifndef CONFIG_TINYMCP_ENABLE_METRICS
+#define CONFIG_TINYMCP_ENABLE_METRICS 1
+#endif
+
+#ifndef CONFIG_SPIFFS_OBJ_NAME_LEN
+#define CONFIG_SPIFFS_OBJ_NAME_LEN 32
+#endif
+
+#ifndef CONFIG_TINYMCP_SCAN_CACHE_TTL_MS
+#define CONFIG_TINYMCP_SCAN_CACHE_TTL_MS 10000
+#endif
+
+#ifndef CONFIG_TINYMCP_DEFERRED_LOG
+#define CONFIG_TINYMCP_DEFERRED_LOG 1
+#endif
+
+#ifndef CONFIG_TINYMCP_LOG_RING_RECORDS
+#define CONFIG_TINYMCP_LOG_RING_RECORDS 32
+#endif
+
+// Kept at info so TINYMCP_HOST_LOG_LEVEL can still raise the runtime level
+#ifndef CONFIG_TINYMCP_LOG_LEVEL
+#define CONFIG_TINYMCP_LOG_LEVEL 3
+#endif
@@ -0,0 +1,251 @@
+// Decoder tests for the TinyMCP host build
+// CBOR decoding and the JSON-RPC envelope scanner on well-formed, deep and malformed frames
+
+#include "tinymcp_cbor.h"
+#include "tinymcp_envelope.h"
+#include "tinymcp_message.h"
+
+#include <cJSON.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace tinymcp;
+
+namespace {
+
+int g_checks = 0;
+int g_failed = 0;
+
+#define CHECK(condition) do {                                                   \
+        g_checks++;                                                             \
+        if (!(condition)) {                                                     \
+            g_failed++;                                                         \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+        }                                                                       \
+    } while (0)
+
+cJSON* decodeBytes(const std::vector<uint8_t>& bytes) {
+    return Cbor::decode(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+}
+
+// True when the bytes are rejected; a tree that does decode is freed
+bool rejects(const std::vector<uint8_t>& bytes) {
+    cJSON* root = decodeBytes(bytes);
+    cJSON_Delete(root);
+    return root == nullptr;
+}
+
+// {"a": <value>} with `levels` nested one-element arrays around 1
+std::vector<uint8_t> nestedArrays(size_t levels) {
+    std::vector<uint8_t> bytes = {0xA1, 0x61, 'a'};
+    bytes.insert(bytes.end(), levels, 0x81);
+    bytes.push_back(0x01);
+    return bytes;
+}
+
+// {"a": <value>} with `tags` tag headers in front of 1
+std::vector<uint8_t> taggedValue(size_t tags) {
+    std::vector<uint8_t> bytes = {0xA1, 0x61, 'a'};
+    bytes.insert(bytes.end(), tags, 0xC0);
+    bytes.push_back(0x01);
+    return bytes;
+}
+
+void testCborWellFormed() {
+    // {"id": 7, "ok": true, "s": "hi", "n": -2, "f": 1.5, "z": null}
+    std::vector<uint8_t> bytes = {
+        0xA6,
+        0x62, 'i', 'd', 0x07,
+        0x62, 'o', 'k', 0xF5,
+        0x61, 's', 0x62, 'h', 'i',
+        0x61, 'n', 0x21,
+        0x61, 'f', 0xF9, 0x3E, 0x00,
+        0x61, 'z', 0xF6,
+    };
+    cJSON* root = decodeBytes(bytes);
+    CHECK(cJSON_IsObject(root));
+    CHECK(cJSON_GetNumberValue(cJSON_GetObjectItem(root, "id")) == 7);
+    CHECK(cJSON_IsTrue(cJSON_GetObjectItem(root, "ok")));
+    const char* text = cJSON_GetStringValue(cJSON_GetObjectItem(root, "s"));
+    CHECK(text && std::string(text) == "hi");
+    CHECK(cJSON_GetNumberValue(cJSON_GetObjectItem(root, "n")) == -2);
+    CHECK(cJSON_GetNumberValue(cJSON_GetObjectItem(root, "f")) == 1.5);
+    CHECK(cJSON_IsNull(cJSON_GetObjectItem(root, "z")));
+    cJSON_Delete(root);
+
+    // Indefinite array and text: [1, "ab"]
+    root = decodeBytes({0x9F, 0x01, 0x7F, 0x61, 'a', 0x61, 'b', 0xFF, 0xFF});
+    CHECK(cJSON_IsArray(root) && cJSON_GetArraySize(root) == 2);
+    text = cJSON_GetStringValue(cJSON_GetArrayItem(root, 1));
+    CHECK(text && std::string(text) == "ab");
+    cJSON_Delete(root);
+
+    // A tag keeps its content
+    root = decodeBytes(taggedValue(1));
+    CHECK(cJSON_GetNumberValue(cJSON_GetObjectItem(root, "a")) == 1);
+    cJSON_Delete(root);
+
+    CHECK(Cbor::isCborFrame("\xA1", 1));
+    CHECK(Cbor::isCborFrame("\x80", 1));
+    CHECK(!Cbor::isCborFrame("{}", 2));
+    CHECK(!Cbor::isCborFrame(" [", 2));
+    CHECK(!Cbor::isCborFrame("", 0));
+}
+
+void testCborDepth() {
+    // The root map is level 1
+    cJSON* root = decodeBytes(nestedArrays(Cbor::MAX_DEPTH - 2));
+    CHECK(root != nullptr);
+    cJSON_Delete(root);
+    CHECK(rejects(nestedArrays(Cbor::MAX_DEPTH)));
+    CHECK(rejects(nestedArrays(4096)));
+
+    // Tags count as levels, so a frame full of them cannot recurse deeply
+    root = decodeBytes(taggedValue(Cbor::MAX_DEPTH - 2));
+    CHECK(root != nullptr);
+    cJSON_Delete(root);
+    CHECK(rejects(taggedValue(Cbor::MAX_DEPTH)));
+    CHECK(rejects(taggedValue(4096)));
+    CHECK(rejects(std::vector<uint8_t>(4096, 0xC0)));
+
+    // Indefinite containers are bounded the same way
+    std::vector<uint8_t> bytes(4096, 0x9F);
+    CHECK(rejects(bytes));
+}
+
+void testCborMalformed() {
+    CHECK(Cbor::decode(nullptr, 0) == nullptr);
+    CHECK(rejects({0xA1, 0x61}));                       // Truncated key
+    CHECK(rejects({0xA1, 0x61, 'a'}));                  // Missing value
+    CHECK(rejects({0x82, 0x01}));                       // Short array
+    CHECK(rejects({0x01, 0x02}));                       // Trailing bytes
+    CHECK(rejects({0xA1, 0x01, 0x01}));                 // Integer key
+    CHECK(rejects({0xA1, 0x61, 'a', 0x41, 0x00}));      // Byte string
+    CHECK(rejects({0x78, 0xFF, 'a'}));                  // Text longer than the frame
+    CHECK(rejects({0x7B, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}));
+    CHECK(rejects({0x9B, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}));
+    CHECK(rejects({0x1C}));                             // Reserved additional info
+    CHECK(rejects({0x9F, 0x01}));                       // Indefinite array without BREAK
+    CHECK(rejects({0x7F, 0x61, 'a'}));                  // Indefinite text without BREAK
+    CHECK(rejects({0x7F, 0x01, 0xFF}));                 // Non-text chunk
+    CHECK(rejects({0xDF, 0x01}));                       // Indefinite tag
+    CHECK(rejects({0xFF}));                             // Stray BREAK
+    CHECK(rejects({0xF8, 0x20}));                       // Unassigned simple value
+}
+
+void testEnvelopeRequest() {
+    const std::string frame =
+        " {\"jsonrpc\":\"2.0\",\"id\":\"r1\",\"method\":\"tools/call\","
+        "\"params\":{\"name\":\"echo\",\"arguments\":{\"t\":\"}]\\\"\"}}}\n";
+    JsonRpcEnvelope envelope;
+    CHECK(envelope.scan(frame.data(), frame.size()) == TINYMCP_SUCCESS);
+    CHECK(envelope.getKind() == JsonRpcEnvelope::Kind::OBJECT);
+    CHECK(envelope.getCategory() == MessageCategory::REQUEST);
+    CHECK(envelope.isJsonRpc2());
+    CHECK(envelope.canBuildTree());
+
+    std::string_view method, id;
+    CHECK(envelope.getMethod(method) && method == "tools/call");
+    CHECK(envelope.getStringId(id) && id == "r1");
+    CHECK(envelope.getParams().front() == '{' && envelope.getParams().back() == '}');
+
+    const std::string numbered = "{\"jsonrpc\":\"2.0\",\"id\":42,\"method\":\"ping\"}";
+    MessageId messageId;
+    CHECK(envelope.scan(numbered.data(), numbered.size()) == TINYMCP_SUCCESS);
+    CHECK(envelope.getId(messageId) && messageId.isInteger() && messageId.asInteger() == 42);
+    CHECK(!envelope.getStringId(id));
+
+    const std::string notification = "{\"jsonrpc\":\"2.0\",\"method\":\"notifications/initialized\"}";
+    CHECK(envelope.scan(notification.data(), notification.size()) == TINYMCP_SUCCESS);
+    CHECK(envelope.getCategory() == MessageCategory::NOTIFICATION);
+
+    const std::string response = "{\"jsonrpc\":\"2.0\",\"id\":1,\"result\":{}}";
+    CHECK(envelope.scan(response.data(), response.size()) == TINYMCP_SUCCESS);
+    CHECK(envelope.getCategory() == MessageCategory::RESPONSE);
+    CHECK(!envelope.canBuildTree());
+
+    const std::string batch = "[{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"ping\"}]";
+    CHECK(envelope.scan(batch.data(), batch.size()) == TINYMCP_SUCCESS);
+    CHECK(envelope.getKind() == JsonRpcEnvelope::Kind::BATCH);
+}
+
+void testEnvelopeDepth() {
+    auto nested = [](size_t levels) {
+        std::string frame = "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"x\",\"params\":";
+        frame.append(levels, '[');
+        frame.append(levels, ']');
+        frame += "}";
+        return frame;
+    };
+
+    JsonRpcEnvelope envelope;
+    std::string frame = nested(JsonRpcEnvelope::MAX_DEPTH);
+    CHECK(envelope.scan(frame.data(), frame.size()) == TINYMCP_SUCCESS);
+    frame = nested(JsonRpcEnvelope::MAX_DEPTH + 1);
+    CHECK(envelope.scan(frame.data(), frame.size()) != TINYMCP_SUCCESS);
+    frame = nested(4096);
+    CHECK(envelope.scan(frame.data(), frame.size()) != TINYMCP_SUCCESS);
+    CHECK(envelope.getKind() == JsonRpcEnvelope::Kind::INVALID);
+}
+
+void testEnvelopeMalformed() {
+    const char* frames[] = {
+        "",
+        "   ",
+        "\"text\"",
+        "{",
+        "{\"id\":1",
+        "{\"id\":1,}",
+        "{\"id\" 1}",
+        "{\"id\":}",
+        "{\"method\":\"ping}",
+        "{\"params\":[1,2}",
+        "{\"params\":{\"a\":1]}",
+        "{\"id\":1}x",
+        "[1,2",
+        "{\"id\":1}{\"id\":2}",
+    };
+    JsonRpcEnvelope envelope;
+    for (const char* frame : frames) {
+        bool rejected = envelope.scan(frame, strlen(frame)) != TINYMCP_SUCCESS;
+        CHECK(rejected);
+        if (!rejected) {
+            fprintf(stderr, "  accepted: %s\n", frame);
+        }
+    }
+    CHECK(envelope.scan(nullptr, 0) != TINYMCP_SUCCESS);
+
+    // Escaped methods and ids are left to the full parser
+    const std::string escaped = "{\"jsonrpc\":\"2.0\",\"id\":\"a\\\"b\",\"method\":\"pi\\u006eg\"}";
+    std::string_view view;
+    MessageId id;
+    CHECK(envelope.scan(escaped.data(), escaped.size()) == TINYMCP_SUCCESS);
+    CHECK(!envelope.getMethod(view));
+    CHECK(!envelope.getStringId(view));
+    CHECK(envelope.getId(id) && id.asString() == "a\"b");
+
+    const std::string badId = "{\"jsonrpc\":\"2.0\",\"id\":0x10,\"method\":\"ping\"}";
+    CHECK(envelope.scan(badId.data(), badId.size()) == TINYMCP_SUCCESS);
+    CHECK(!envelope.getId(id));
+
+    CHECK(JsonRpcEnvelope::looksLikeHttp("GET / HTTP/1.1", 14));
+    CHECK(JsonRpcEnvelope::looksLikeHttp("Content-Length: 12", 18));
+    CHECK(!JsonRpcEnvelope::looksLikeHttp("{\"id\":1}", 8));
+}
+
+} // namespace
+
+int main() {
+    testCborWellFormed();
+    testCborDepth();
+    testCborMalformed();
+    testEnvelopeRequest();
+    testEnvelopeDepth();
+    testEnvelopeMalformed();
+
+    printf("%d checks, %d failed\n", g_checks, g_failed);
+    return g_failed ? 1 : 0;
+}
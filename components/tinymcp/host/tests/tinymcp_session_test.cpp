@@ -0,0 +1,261 @@
+// Session tests for the TinyMCP host build
+// Every request gets a reply: full pending-task tables, oversized batches and duplicate ids
+
+#include "tinymcp_constants.h"
+#include "tinymcp_session.h"
+#include "tinymcp_tools.h"
+
+#include "esp_timer.h"
+
+#include <cJSON.h>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace tinymcp;
+
+namespace {
+
+int g_checks = 0;
+int g_failed = 0;
+
+#define CHECK(condition) do {                                                   \
+        g_checks++;                                                             \
+        if (!(condition)) {                                                     \
+            g_failed++;                                                         \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+        }                                                                       \
+    } while (0)
+
+// Long enough for several simulated scans (TINYMCP_HOST_SCAN_MS each)
+const int64_t REPLY_TIMEOUT_US = 10000000;
+
+// Frames pushed by the test are returned by tryReceive(); every frame the
+// session sends is kept
+class MemoryTransport : public SessionTransport {
+public:
+    int send(const std::string& data) override {
+        sent.push_back(data);
+        return TINYMCP_SUCCESS;
+    }
+
+    int receive(std::string& data, uint32_t) override {
+        return tryReceive(data);
+    }
+
+    int tryReceive(std::string& data) override {
+        if (inbound.empty()) {
+            return TINYMCP_ERROR_TIMEOUT;
+        }
+        data.swap(inbound.front());
+        inbound.pop_front();
+        return TINYMCP_SUCCESS;
+    }
+
+    bool isConnected() const override { return true; }
+    void close() override {}
+    std::string getClientInfo() const override { return "memory"; }
+
+    std::deque<std::string> inbound;
+    std::vector<std::string> sent;
+};
+
+// Replies to requests, keyed by integer id; notifications are skipped
+struct Reply {
+    int count = 0;
+    int errors = 0;
+    int errorCode = 0;          // Of the last error reply
+};
+
+class TestSession {
+public:
+    TestSession() {
+        auto transport = std::make_unique<MemoryTransport>();
+        transport_ = transport.get();
+
+        SessionConfig config;
+        config.reactorMode = true;
+        session_ = std::make_unique<Session>(std::move(transport), config);
+
+        auto& registry = ToolRegistry::getInstance();
+        for (const auto& toolName : registry.getToolNames()) {
+            const char* description = registry.getDescription(toolName);
+            if (description) {
+                session_->addTool(toolName, description);
+            }
+        }
+    }
+
+    bool start() {
+        if (session_->initialize() != TINYMCP_SUCCESS) {
+            return false;
+        }
+        feed("{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"initialize\",\"params\":{"
+             "\"protocolVersion\":\"2024-11-05\",\"capabilities\":{},"
+             "\"clientInfo\":{\"name\":\"tinymcp_session_test\",\"version\":\"1.0.0\"}}}");
+        feed("{\"jsonrpc\":\"2.0\",\"method\":\"notifications/initialized\"}");
+        return session_->onReadable() == TINYMCP_SUCCESS && collect() && replies[1].count == 1;
+    }
+
+    void feed(const std::string& frame) { transport_->inbound.push_back(frame); }
+
+    // Reads everything fed so far, then services the session until `ids`
+    // have `expected` replies each (or the timeout passes)
+    bool run(const std::vector<int>& ids, int expected = 1) {
+        // onReadable() takes a bounded number of frames per wakeup
+        while (!transport_->inbound.empty()) {
+            if (session_->onReadable() != TINYMCP_SUCCESS) {
+                return false;
+            }
+        }
+        int64_t deadline = esp_timer_get_time() + REPLY_TIMEOUT_US;
+        for (;;) {
+            if (!collect()) {
+                return false;
+            }
+            bool answered = true;
+            for (int id : ids) {
+                answered = answered && replies[id].count >= expected;
+            }
+            if (answered) {
+                return true;
+            }
+            if (esp_timer_get_time() > deadline || session_->poll(nullptr) != TINYMCP_SUCCESS) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    std::map<int, Reply> replies;
+    int batchFrames = 0;
+    int lastBatchSize = 0;
+
+private:
+    void record(const cJSON* item) {
+        const cJSON* id = cJSON_GetObjectItem(item, "id");
+        if (!cJSON_IsNumber(id)) {
+            return;
+        }
+        Reply& reply = replies[static_cast<int>(cJSON_GetNumberValue(id))];
+        reply.count++;
+        const cJSON* error = cJSON_GetObjectItem(item, "error");
+        if (error) {
+            reply.errors++;
+            reply.errorCode = static_cast<int>(cJSON_GetNumberValue(cJSON_GetObjectItem(error, "code")));
+        }
+    }
+
+    bool collect() {
+        for (; consumed_ < transport_->sent.size(); ++consumed_) {
+            cJSON* frame = cJSON_Parse(transport_->sent[consumed_].c_str());
+            if (!frame) {
+                fprintf(stderr, "unparseable frame: %s\n", transport_->sent[consumed_].c_str());
+                return false;
+            }
+            if (cJSON_IsArray(frame)) {
+                batchFrames++;
+                lastBatchSize = cJSON_GetArraySize(frame);
+                const cJSON* item = nullptr;
+                cJSON_ArrayForEach(item, frame) {
+                    record(item);
+                }
+            } else {
+                record(frame);
+            }
+            cJSON_Delete(frame);
+        }
+        return true;
+    }
+
+    MemoryTransport* transport_;
+    std::unique_ptr<Session> session_;
+    size_t consumed_ = 0;
+};
+
+// A scan keeps its task pending until the simulated radio finishes
+std::string scanRequest(int id) {
+    return "{\"jsonrpc\":\"2.0\",\"id\":" + std::to_string(id) + ",\"method\":\"tools/call\","
+           "\"params\":{\"name\":\"network_scan\",\"arguments\":{\"max_age_ms\":0}}}";
+}
+
+void testPendingTableFull() {
+    TestSession test;
+    CHECK(test.start());
+
+    const uint32_t capacity = SessionConfig().maxPendingTasks;
+    std::vector<int> ids;
+    for (uint32_t i = 0; i < capacity + 4; ++i) {
+        ids.push_back(100 + static_cast<int>(i));
+        test.feed(scanRequest(ids.back()));
+    }
+    CHECK(test.run(ids));
+
+    uint32_t refused = 0;
+    for (int id : ids) {
+        CHECK(test.replies[id].count == 1);
+        refused += test.replies[id].errorCode == TINYMCP_ERROR_RESOURCE_LIMIT;
+    }
+    CHECK(refused == 4);
+    for (uint32_t i = 0; i < capacity; ++i) {
+        CHECK(test.replies[ids[i]].errors == 0);
+    }
+}
+
+// A batch bigger than the pending table: the overflow elements carry errors
+// in the same array as the scan results
+void testBatchOverPendingLimit() {
+    TestSession test;
+    CHECK(test.start());
+
+    const uint32_t capacity = SessionConfig().maxPendingTasks;
+    CHECK(capacity + 3 <= SessionConfig().maxBatchSize);
+    std::vector<int> ids;
+    std::string batch = "[";
+    for (uint32_t i = 0; i < capacity + 3; ++i) {
+        ids.push_back(200 + static_cast<int>(i));
+        batch += (i ? "," : "") + scanRequest(ids.back());
+    }
+    test.feed(batch + "]");
+    CHECK(test.run(ids));
+
+    CHECK(test.batchFrames == 1);
+    CHECK(test.lastBatchSize == static_cast<int>(ids.size()));
+    uint32_t refused = 0;
+    for (int id : ids) {
+        CHECK(test.replies[id].count == 1);
+        refused += test.replies[id].errorCode == TINYMCP_ERROR_RESOURCE_LIMIT;
+    }
+    CHECK(refused == 3);
+}
+
+// A second request reusing a pending id is refused; the first still completes
+void testDuplicateId() {
+    TestSession test;
+    CHECK(test.start());
+
+    test.feed(scanRequest(77));
+    test.feed(scanRequest(77));
+    CHECK(test.run({77}, 2));
+
+    CHECK(test.replies[77].count == 2);
+    CHECK(test.replies[77].errors == 1);
+    CHECK(test.replies[77].errorCode == TINYMCP_INVALID_REQUEST);
+}
+
+} // namespace
+
+int main() {
+    registerDefaultTools();
+
+    testPendingTableFull();
+    testBatchOverPendingLimit();
+    testDuplicateId();
+
+    printf("%d checks, %d failed\n", g_checks, g_failed);
+    return g_failed ? 1 : 0;
+}
@@ -0,0 +1,95 @@
+// TinyMCP reactor server for the host build
+// Same setup as the firmware's reactor mode, listening on a local TCP port
+
+#include "tinymcp_reactor.h"
+#include "tinymcp_socket_transport.h"
+#include "tinymcp_tools.h"
+
+#include "esp_log.h"
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+static const char* TAG = "tinymcp_host";
+
+namespace {
+
+const uint16_t DEFAULT_PORT = 8080;
+const size_t DEFAULT_MAX_SESSIONS = 8;
+
+volatile sig_atomic_t g_stop = 0;
+
+void onSignal(int) {
+    g_stop = 1;
+}
+
+void configureSession(tinymcp::Session& session) {
+    session.setServerInfo("TinyMCP Host Server", "1.0.0");
+
+    tinymcp::ServerCapabilities capabilities;
+    capabilities.setProgressNotifications(true);
+    capabilities.setToolsListChanged(true);
+    session.setServerCapabilities(capabilities);
+
+    auto& registry = tinymcp::ToolRegistry::getInstance();
+    for (const auto& toolName : registry.getToolNames()) {
+        const char* description = registry.getDescription(toolName);
+        if (description) {
+            session.addTool(toolName, description);
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint16_t port = DEFAULT_PORT;
+    size_t maxSessions = DEFAULT_MAX_SESSIONS;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--port") && i + 1 < argc) {
+            port = static_cast<uint16_t>(atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--max-sessions") && i + 1 < argc) {
+            maxSessions = static_cast<size_t>(atoi(argv[++i]));
+        } else {
+            fprintf(stderr, "usage: %s [--port N] [--max-sessions N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    tinymcp::registerDefaultTools();
+
+    tinymcp::SocketTransportConfig transportConfig;
+    transportConfig.maxMessageSize = 4096;
+    transportConfig.enableKeepAlive = true;
+
+    tinymcp::EspSocketServer server(port, transportConfig);
+    server.setMaxConnections(maxSessions);
+
+    tinymcp::ReactorConfig reactorConfig;
+    reactorConfig.maxSessions = maxSessions;
+    reactorConfig.sessionConfig.enableToolsPagination = true;
+
+    tinymcp::SessionReactor reactor(server, reactorConfig);
+    reactor.setSessionSetup(configureSession);
+
+    int result = reactor.start();
+    if (result != tinymcp::TINYMCP_SUCCESS) {
+        ESP_LOGE(TAG, "Failed to start reactor on port %u: %d", port, result);
+        return 1;
+    }
+
+    ESP_LOGW(TAG, "TinyMCP host server listening on port %u", port);
+    while (!g_stop && reactor.isRunning()) {
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+
+    reactor.stop();
+    return 0;
+}
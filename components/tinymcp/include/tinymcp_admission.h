@@ -0,0 +1,56 @@
+#pragma once
+
+// Heap-based admission control for sessions and the socket server
+// Compares free heap and the largest free block against configured watermarks
+
+#include <cstdint>
+
+namespace tinymcp {
+
+// Heap watermarks in bytes, from the first to the last line of defence;
+// a watermark of 0 disables that check
+struct AdmissionConfig {
+    uint32_t minFreeHeapForAccept;      // Refuse new connections below this
+    uint32_t minFreeHeapForRequests;    // Reject new requests with TINYMCP_ERROR_RESOURCE_LIMIT below this
+    uint32_t minLargestBlockForRequests; // Same, when no block of this size can be allocated
+    uint32_t minFreeHeapForReads;       // Stop reading sockets below this so TCP flow control pushes back
+    uint32_t pauseRetryMs;              // Heap re-check interval while reads are paused
+    uint32_t queueFullTimeoutMs;        // How long a full message queue blocks the reader before rejecting
+
+    AdmissionConfig() :
+        minFreeHeapForAccept(16384),
+        minFreeHeapForRequests(10240),
+        minLargestBlockForRequests(4096),
+        minFreeHeapForReads(6144),
+        pauseRetryMs(50),
+        queueFullTimeoutMs(2000) {}
+};
+
+// Ordered from least to most restrictive
+enum class AdmissionLevel : uint8_t {
+    NORMAL,
+    REFUSE_CONNECTIONS,
+    REJECT_REQUESTS,
+    PAUSE_READS
+};
+
+class AdmissionControl {
+public:
+    static uint32_t getFreeHeap();
+    static uint32_t getLargestFreeBlock();
+
+    // Most restrictive level the current heap state calls for
+    static AdmissionLevel evaluate(const AdmissionConfig& config);
+
+    static bool canAcceptConnection(const AdmissionConfig& config) {
+        return evaluate(config) == AdmissionLevel::NORMAL;
+    }
+    static bool canAdmitRequest(const AdmissionConfig& config) {
+        return evaluate(config) < AdmissionLevel::REJECT_REQUESTS;
+    }
+    static bool canRead(const AdmissionConfig& config) {
+        return evaluate(config) < AdmissionLevel::PAUSE_READS;
+    }
+};
+
+} // namespace tinymcp
@@ -0,0 +1,127 @@
+#pragma once
+
+// Per-request bump arena for cJSON allocations
+// Parse, dispatch and response building share one block that is reset at once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+namespace tinymcp {
+
+// Fixed block handed out by bump allocation; frees are no-ops until reset()
+class JsonArena {
+public:
+    JsonArena() : block_(nullptr), capacity_(0), offset_(0) {}
+
+    void attach(uint8_t* block, size_t capacity);
+    void* allocate(size_t size);
+    void reset() { offset_ = 0; }
+
+    bool owns(const void* ptr) const {
+        const uint8_t* p = static_cast<const uint8_t*>(ptr);
+        return block_ && p >= block_ && p < block_ + capacity_;
+    }
+
+    size_t used() const { return offset_; }
+    size_t capacity() const { return capacity_; }
+
+private:
+    uint8_t* block_;
+    size_t capacity_;
+    size_t offset_;
+};
+
+// Boot-time pool of arenas plus the cJSON hooks that route allocations to
+// the arena bound to the calling task, falling back to the system heap
+class JsonArenaPool {
+public:
+    static const size_t DEFAULT_ARENA_COUNT = 2;
+    static const size_t DEFAULT_ARENA_SIZE = 4096;
+    static const size_t MAX_ARENAS = 4;
+    static const size_t MAX_BINDINGS = 4;
+
+    static JsonArenaPool& getInstance();
+
+    // Allocates the arena blocks and installs the cJSON hooks (once)
+    int initialize(size_t arenaCount = DEFAULT_ARENA_COUNT, size_t arenaSize = DEFAULT_ARENA_SIZE);
+    bool isInitialized() const { return initialized_; }
+
+    // Arena ownership; acquire() returns nullptr when all arenas are busy
+    JsonArena* acquire();
+    void release(JsonArena* arena);
+
+    // Per-task binding used by the cJSON hooks
+    JsonArena* getCurrent() const;
+    void setCurrent(JsonArena* arena);
+
+    // Statistics
+    struct Stats {
+        uint32_t arenaAllocations;   // cJSON mallocs served without touching the heap
+        uint32_t heapFallbacks;      // Arena bound but full, served by the heap
+        uint32_t arenaBytes;         // Total bytes bump-allocated
+        uint32_t resets;             // Arenas released back to the pool
+        uint32_t exhausted;          // acquire() calls with no free arena
+        uint32_t peakUsage;          // Largest single-request footprint
+
+        Stats() : arenaAllocations(0), heapFallbacks(0), arenaBytes(0),
+                 resets(0), exhausted(0), peakUsage(0) {}
+    };
+
+    const Stats& getStats() const { return stats_; }
+
+private:
+    JsonArenaPool();
+
+    static void* hookMalloc(size_t size);
+    static void hookFree(void* ptr);
+
+    struct Binding {
+        TaskHandle_t task;
+        JsonArena* arena;
+    };
+
+    static JsonArenaPool instance_;
+
+    JsonArena arenas_[MAX_ARENAS];
+    bool inUse_[MAX_ARENAS];
+    size_t arenaCount_;
+    Binding bindings_[MAX_BINDINGS];
+    bool initialized_;
+
+    Stats stats_;
+};
+
+// Holds a pooled arena for the lifetime of the scope
+class ArenaLease {
+public:
+    ArenaLease() : arena_(JsonArenaPool::getInstance().acquire()) {}
+    ~ArenaLease() { JsonArenaPool::getInstance().release(arena_); }
+
+    ArenaLease(const ArenaLease&) = delete;
+    ArenaLease& operator=(const ArenaLease&) = delete;
+
+    JsonArena* get() const { return arena_; }
+
+private:
+    JsonArena* arena_;
+};
+
+// Binds an arena to the current task for the lifetime of the scope. A null
+// arena suspends arena allocation, which is required for anything that
+// outlives the request (for example arguments copied into an AsyncTask).
+class ArenaScope {
+public:
+    explicit ArenaScope(JsonArena* arena);
+    ~ArenaScope();
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+private:
+    JsonArena* previous_;
+};
+
+} // namespace tinymcp
@@ -0,0 +1,63 @@
+#pragma once
+
+// CBOR (RFC 8949) codec for the JSON-RPC data model
+// Decodes frames into cJSON trees; JsonWriter encodes with the helpers below
+
+#include <cstddef>
+#include <cstdint>
+#include <cJSON.h>
+
+#include "tinymcp_constants.h"
+
+namespace tinymcp {
+
+const char* wireFormatToString(WireFormat format);
+bool wireFormatFromString(const char* name, WireFormat& format);
+
+namespace Cbor {
+    // Major types, pre-shifted into the initial byte
+    static constexpr uint8_t MAJOR_UNSIGNED = 0x00;
+    static constexpr uint8_t MAJOR_NEGATIVE = 0x20;
+    static constexpr uint8_t MAJOR_BYTES = 0x40;
+    static constexpr uint8_t MAJOR_TEXT = 0x60;
+    static constexpr uint8_t MAJOR_ARRAY = 0x80;
+    static constexpr uint8_t MAJOR_MAP = 0xA0;
+    static constexpr uint8_t MAJOR_TAG = 0xC0;
+    static constexpr uint8_t MAJOR_SIMPLE = 0xE0;
+
+    static constexpr uint8_t FALSE_VALUE = 0xF4;
+    static constexpr uint8_t TRUE_VALUE = 0xF5;
+    static constexpr uint8_t NULL_VALUE = 0xF6;
+    static constexpr uint8_t FLOAT32 = 0xFA;
+    static constexpr uint8_t FLOAT64 = 0xFB;
+    static constexpr uint8_t INDEFINITE = 0x1F;
+    static constexpr uint8_t BREAK = 0xFF;
+
+    static constexpr size_t MAX_HEADER_SIZE = 9;
+    static constexpr uint32_t MAX_DEPTH = 32;
+
+    // Initial byte plus the shortest big-endian argument; returns its size
+    size_t encodeHeader(uint8_t major, uint64_t argument, uint8_t* out);
+
+    // Integral values as integers, the rest as float32 when that is exact,
+    // otherwise float64; NaN and infinities become null like in JSON text
+    size_t encodeNumber(double number, uint8_t* out);
+
+    // JSON text starts with '{', '[' or whitespace, never with the initial
+    // byte of a CBOR array or map, so frames can be told apart by one byte
+    inline bool isCborFrame(const char* data, size_t length) {
+        if (length == 0) {
+            return false;
+        }
+        uint8_t initial = static_cast<uint8_t>(data[0]);
+        return initial >= MAJOR_ARRAY && initial < MAJOR_TAG;
+    }
+
+    // Decodes exactly one data item into a tree allocated through the cJSON
+    // hooks, so an active ArenaScope applies. Returns null on malformed or
+    // truncated input, trailing bytes, byte strings, non-text map keys or
+    // nesting deeper than MAX_DEPTH.
+    cJSON* decode(const char* data, size_t length);
+}
+
+} // namespace tinymcp
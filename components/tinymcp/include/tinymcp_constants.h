@@ -45,6 +45,10 @@ static constexpr const char* MSG_KEY_NEXT_CURSOR = "nextCursor";
 static constexpr const char* MSG_KEY_LISTCHANGED = "listChanged";
 static constexpr const char* MSG_KEY_MIMETYPE = "mimeType";
 static constexpr const char* MSG_KEY_META = "_meta";
+static constexpr const char* MSG_KEY_EXPERIMENTAL = "experimental";
+static constexpr const char* MSG_KEY_ENCODING = "encoding";
+static constexpr const char* MSG_KEY_FORMATS = "formats";
+static constexpr const char* MSG_KEY_FORMAT = "format";
 
 // MCP Methods
 static constexpr const char* METHOD_INITIALIZE = "initialize";
@@ -145,7 +149,11 @@ enum class MessageType {
     // Notification types
     INITIALIZED_NOTIFICATION,
     PROGRESS_NOTIFICATION,
-    CANCELLED_NOTIFICATION
+    CANCELLED_NOTIFICATION,
+    
+    // Application methods registered with MethodTable
+    CUSTOM_REQUEST,
+    CUSTOM_NOTIFICATION
 };
 
 // Content Types
@@ -161,6 +169,13 @@ enum class ToolResultType {
     ERROR
 };
 
+// Payload encoding of a session's frames; JSON unless CBOR was negotiated
+// through the experimental "encoding" capability during initialize
+enum class WireFormat {
+    JSON,
+    CBOR
+};
+
 // Maximum limits for ESP32/ESP8266
 static constexpr size_t MAX_MESSAGE_SIZE = 8192;
 static constexpr size_t MAX_METHOD_NAME_LENGTH = 64;
@@ -168,10 +183,21 @@ static constexpr size_t MAX_TOOL_NAME_LENGTH = 64;
 static constexpr size_t MAX_ERROR_MESSAGE_LENGTH = 256;
 static constexpr size_t MAX_TOOLS_COUNT = 16;
 static constexpr size_t MAX_CONTENT_LENGTH = 4096;
+static constexpr size_t MAX_PROGRESS_MESSAGE_LENGTH = 64;
+static constexpr size_t MAX_BATCH_SIZE = 16;        // Elements per JSON-RPC batch
+static constexpr size_t FILE_READ_MAX_LENGTH = 2048;    // Bytes per file_system read; escaping can double it
+static constexpr size_t FILE_CHUNK_SIZE = 512;          // Bytes per file_stream notification
+static constexpr size_t GPIO_BATCH_MAX_ACTIONS = 17;     // One per ESP8266 pin
+static constexpr size_t GPIO_BATCH_MAX_STEPS = 64;
+static constexpr uint32_t GPIO_BATCH_MAX_DURATION_US = 1000000;  // Whole gpio_batch sequence
 
 // Default timeouts (milliseconds)
 static constexpr uint32_t DEFAULT_REQUEST_TIMEOUT_MS = 30000;
 static constexpr uint32_t DEFAULT_TOOL_TIMEOUT_MS = 60000;
 static constexpr uint32_t DEFAULT_PROGRESS_INTERVAL_MS = 1000;
 
+// Progress jumps of at least this many percent are sent without waiting
+// for the interval
+static constexpr int PROGRESS_MIN_STEP_PERCENT = 10;
+
 } // namespace tinymcp
\ No newline at end of file
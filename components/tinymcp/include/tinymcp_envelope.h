@@ -0,0 +1,84 @@
+#pragma once
+
+// JSON-RPC envelope scanner for TinyMCP
+// Reads jsonrpc, id, method and the params span of a text frame without building a tree
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <cJSON.h>
+
+#include "tinymcp_constants.h"
+
+namespace tinymcp {
+
+class MessageId;
+
+// One pass over the top-level object of a frame. Member values are kept as
+// spans into the frame, which must outlive the envelope; nested values are
+// only checked for balanced brackets and terminated strings, so a frame
+// that scans can still fail to parse later.
+class JsonRpcEnvelope {
+public:
+    enum class Kind : uint8_t {
+        INVALID,
+        OBJECT,
+        BATCH       // Array frame; elements are not scanned
+    };
+
+    // Nesting accepted inside member values
+    static constexpr uint32_t MAX_DEPTH = 64;
+
+    JsonRpcEnvelope() { reset(); }
+
+    // TINYMCP_ERROR_INVALID_MESSAGE unless the frame is one JSON object or
+    // array, optionally surrounded by whitespace
+    int scan(const char* data, size_t length);
+
+    Kind getKind() const { return kind_; }
+
+    // Same rules as Message::detectMessageCategory()
+    MessageCategory getCategory() const;
+
+    bool isJsonRpc2() const { return jsonrpc_ == "\"2.0\""; }
+    bool hasId() const { return !id_.empty(); }
+
+    // False unless the method is a string without escapes
+    bool getMethod(std::string_view& method) const;
+
+    // False for ids that are not a string or a number
+    bool getId(MessageId& id) const;
+
+    // String id without escapes, as a view into the frame
+    bool getStringId(std::string_view& id) const;
+
+    // Raw text of the params value, empty without one
+    std::string_view getParams() const { return params_; }
+
+    // Only jsonrpc, id, method and params, each at most once, so buildTree()
+    // yields the same tree as parsing the whole frame
+    bool canBuildTree() const { return plain_ && kind_ == Kind::OBJECT; }
+
+    // Tree of the request or notification with params parsed from its span
+    // alone; nullptr if a member fails to parse. Allocates through the cJSON
+    // hooks, so an active ArenaScope applies.
+    cJSON* buildTree() const;
+
+    // Request line or header of an HTTP client that connected to the
+    // JSON-RPC port: a token of letters and dashes ended by a space or colon
+    static bool looksLikeHttp(const char* data, size_t length);
+
+private:
+    void reset();
+
+    Kind kind_;
+    bool plain_;
+    std::string_view jsonrpc_;
+    std::string_view id_;
+    std::string_view method_;
+    std::string_view params_;
+    std::string_view result_;
+    std::string_view error_;
+};
+
+} // namespace tinymcp
@@ -0,0 +1,143 @@
+#pragma once
+
+// Shared worker pool for TinyMCP async tool tasks
+// Runs AsyncTask::execute() off the session tasks, with a fast lane for short tools
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+
+namespace tinymcp {
+
+class AsyncTask;
+
+// Scheduling class of a task; higher runs first within the general queue
+enum class TaskPriority : uint8_t {
+    LOW = 0,        // Long scans and simulations
+    NORMAL = 1,
+    HIGH = 2
+};
+
+// Where a finished job or awaited event is reported: `bits` on `events`,
+// then `wake(wakeArg)` for a waiter that cannot block on the event group,
+// such as a reactor sitting in select()
+struct TaskNotify {
+    EventGroupHandle_t events;
+    EventBits_t bits;
+    void (*wake)(void* arg);
+    void* wakeArg;
+
+    TaskNotify(EventGroupHandle_t events = nullptr, EventBits_t bits = 0) :
+        events(events), bits(bits), wake(nullptr), wakeArg(nullptr) {}
+
+    bool isSet() const { return events || wake; }
+
+    void signal() const {
+        if (events) {
+            xEventGroupSetBits(events, bits);
+        }
+        if (wake) {
+            wake(wakeArg);
+        }
+    }
+};
+
+// Fixed pool of executor tasks shared by every session. Jobs wait in a
+// bounded priority queue (FIFO within a priority); fast-lane jobs go to a
+// separate FIFO that every worker drains first and worker 0 serves
+// exclusively, so a short synchronous tool never waits behind a WiFi scan
+// occupying the other workers.
+class TaskExecutor {
+public:
+    static const size_t DEFAULT_WORKER_COUNT = 2;
+    static const size_t MAX_WORKERS = 4;
+    static const size_t MAX_QUEUED_JOBS = 16;
+    static const uint32_t FAST_LANE_MAX_DURATION_MS = 1000;
+
+    static TaskExecutor& getInstance();
+
+    // Creates the workers (once); later calls are no-ops
+    int initialize(size_t workerCount = DEFAULT_WORKER_COUNT,
+                   uint32_t stackSize = 3072, UBaseType_t priority = 3);
+    bool isInitialized() const { return initialized_; }
+
+    // Queue one run of task->execute(). When it returns, `notify` is
+    // signalled (if still attached). `owner` identifies the submitter for
+    // detach(). Fails with TINYMCP_ERROR_RESOURCE_LIMIT when the lane is full.
+    int submit(const std::shared_ptr<AsyncTask>& task, const void* owner, const TaskNotify& notify);
+
+    // Drop queued jobs of `owner` and stop notifying it for running ones;
+    // must be called before the owner's event group is deleted
+    void detach(const void* owner);
+
+    // Statistics
+    struct Stats {
+        uint32_t jobsExecuted;
+        uint32_t fastLaneJobs;
+        uint32_t rejected;          // Queue full at submit()
+        uint32_t peakQueued;
+
+        Stats() : jobsExecuted(0), fastLaneJobs(0), rejected(0), peakQueued(0) {}
+    };
+
+    const Stats& getStats() const { return stats_; }
+    size_t getWorkerCount() const { return workerCount_; }
+
+private:
+    TaskExecutor();
+
+    struct Job {
+        std::shared_ptr<AsyncTask> task;
+        const void* owner;
+        TaskNotify notify;
+        uint8_t priority;
+        uint32_t sequence;
+
+        Job() : owner(nullptr), priority(0), sequence(0) {}
+    };
+
+    // Bounded FIFO (fast lane) and binary heap (general) over fixed arrays
+    struct JobQueue {
+        Job jobs[MAX_QUEUED_JOBS];
+        size_t count;
+
+        JobQueue() : count(0) {}
+    };
+
+    struct Worker {
+        TaskHandle_t handle;
+        Job current;
+        bool fastLaneOnly;
+    };
+
+    static void workerTask(void* pvParameters);
+    bool takeJob(Worker& worker);
+    void finishJob(Worker& worker);
+    void wakeWorkers();
+
+    static bool runsBefore(const Job& a, const Job& b);
+    static void pushFast(JobQueue& queue, Job&& job);
+    static void pushHeap(JobQueue& queue, Job&& job);
+    static void popFast(JobQueue& queue, Job& job);
+    static void popHeap(JobQueue& queue, Job& job);
+    static void dropOwner(JobQueue& queue, const void* owner, bool heap);
+
+    static TaskExecutor instance_;
+
+    JobQueue fastLane_;
+    JobQueue general_;
+    Worker workers_[MAX_WORKERS];
+    size_t workerCount_;
+    uint32_t nextSequence_;
+    SemaphoreHandle_t mutex_;
+    bool initialized_;
+
+    Stats stats_;
+};
+
+} // namespace tinymcp
@@ -114,8 +114,13 @@ public:
     static bool setId(cJSON* json, int id);
     
     // Serialization
+    // cJSON_PrintPreallocated() may need this much room beyond the text
+    static constexpr size_t PRINT_SLACK = 5;
+    
     static std::string toString(const cJSON* json, bool formatted = false);
+    // Exact length of the minified text, counted without printing or allocating
     static size_t getSerializedSize(const cJSON* json);
+    static void appendEscapedString(std::string& out, const char* value, size_t length);
     
     // Error response creation
     static JsonValue createErrorResponse(const std::string& id, int code, const std::string& message, const std::string& data = "");
@@ -180,6 +185,100 @@ private:
     static size_t calculateStringSize(const cJSON* json);
 };
 
+// Destination for JsonWriter output chunks
+class JsonSink {
+public:
+    virtual ~JsonSink() = default;
+    virtual int write(const char* data, size_t length) = 0;
+};
+
+// Appends every chunk to a string
+class StringJsonSink : public JsonSink {
+public:
+    explicit StringJsonSink(std::string& out) : out_(out) {}
+    int write(const char* data, size_t length) override {
+        out_.append(data, length);
+        return TINYMCP_SUCCESS;
+    }
+
+private:
+    std::string& out_;
+};
+
+// Streaming, minified JSON writer. Output is staged in one fixed chunk that
+// is handed to the sink whenever it fills, so the payload never exists in
+// memory as a whole. Without a sink it only counts bytes, which gives the
+// exact frame length for a second, streaming pass. With WireFormat::CBOR the
+// same calls emit CBOR, with indefinite-length objects and arrays.
+class JsonWriter {
+public:
+    static const size_t CHUNK_SIZE = 256;
+    static const size_t MAX_DEPTH = 32;
+    
+    explicit JsonWriter(JsonSink* sink = nullptr, WireFormat format = WireFormat::JSON);
+    
+    JsonWriter(const JsonWriter&) = delete;
+    JsonWriter& operator=(const JsonWriter&) = delete;
+    
+    // Structure
+    JsonWriter& beginObject();
+    JsonWriter& endObject();
+    JsonWriter& beginArray();
+    JsonWriter& endArray();
+    JsonWriter& key(const char* name);
+    
+    // Values
+    JsonWriter& value(const char* str);
+    JsonWriter& value(const std::string& str);
+    JsonWriter& value(const char* str, size_t length);
+    JsonWriter& value(int number);
+    JsonWriter& value(double number);
+    JsonWriter& value(bool flag);
+    JsonWriter& nullValue();
+    
+    // Streams an existing cJSON tree without printing it first
+    JsonWriter& value(const cJSON* json);
+    
+    // Writes a tree as a JSON string value (MCP "text" content holding JSON)
+    JsonWriter& jsonText(const cJSON* json);
+    
+    // Splices an already serialized JSON value (transcoded in CBOR mode)
+    JsonWriter& raw(const char* json, size_t length);
+    
+    // Flushes the staged chunk; returns the first error seen, if any
+    int finish();
+    
+    size_t size() const { return written_; }
+    WireFormat getFormat() const { return format_; }
+    int getStatus() const { return status_; }
+
+private:
+    void separator();
+    void put(char c);
+    void put(const char* data, size_t length);
+    void putString(const char* str, size_t length);
+    void putNumber(double number);
+    void putTree(const cJSON* json);
+    void putHeader(uint8_t major, uint64_t argument);
+    void putNull();
+    void putBool(bool flag);
+    void putTranscoded(const char* json, size_t length);
+    void flushChunk();
+    void push(char open);
+    void pop(char close);
+    
+    JsonSink* sink_;
+    char chunk_[CHUNK_SIZE];
+    size_t used_;
+    size_t written_;
+    int status_;
+    uint32_t depth_;
+    uint32_t hasItems_;     // Bit per nesting level: a comma is due before the next item
+    bool afterKey_;
+    bool embedded_;         // Inside jsonText(): escape everything written
+    WireFormat format_;
+};
+
 // Convenience macros for common JSON operations
 #define JSON_GET_STRING(json, key, defaultVal) \
     JsonHelper::getString(json, key, defaultVal)
@@ -0,0 +1,192 @@
+#pragma once
+
+// Deferred binary logging for TinyMCP
+// Hot-path log calls store compact records in a ring; a low-priority task
+// formats them and does the slow UART write
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+
+// Follows CONFIG_TINYMCP_DEFERRED_LOG (a disabled Kconfig bool is left undefined);
+// without it every record is formatted and written by the caller
+#ifndef TINYMCP_DEFERRED_LOG
+#if defined(CONFIG_TINYMCP_DEFERRED_LOG)
+#define TINYMCP_DEFERRED_LOG 1
+#else
+#define TINYMCP_DEFERRED_LOG 0
+#endif
+#endif
+
+// Most verbose esp_log_level_t compiled in. A module can define
+// TINYMCP_LOG_LOCAL_LEVEL before including this header to keep more or
+// less of its own logging; calls above the level generate no code.
+#ifndef TINYMCP_LOG_LEVEL
+#if defined(CONFIG_TINYMCP_LOG_LEVEL)
+#define TINYMCP_LOG_LEVEL CONFIG_TINYMCP_LOG_LEVEL
+#else
+#define TINYMCP_LOG_LEVEL 3     // ESP_LOG_INFO
+#endif
+#endif
+
+#ifndef TINYMCP_LOG_LOCAL_LEVEL
+#define TINYMCP_LOG_LOCAL_LEVEL TINYMCP_LOG_LEVEL
+#endif
+
+#ifndef CONFIG_TINYMCP_LOG_RING_RECORDS
+#define CONFIG_TINYMCP_LOG_RING_RECORDS 32
+#endif
+
+namespace tinymcp {
+
+// One log call, captured without formatting. Tag and format must be string
+// literals since they are read at drain time; integer arguments are kept as
+// 32-bit words and string arguments are copied (and truncated) into `text`.
+struct LogRecord {
+    static const size_t MAX_ARGS = 4;
+    static const size_t TEXT_BYTES = 40;
+
+    uint32_t timestampMs;
+    const char* tag;
+    const char* format;
+    uint8_t level;
+    uint8_t argCount;
+    uint8_t stringArgs;         // Bit i: args[i] is an offset into text
+    uint8_t textLength;
+    uint32_t args[MAX_ARGS];
+    char text[TEXT_BYTES];
+
+    void begin(esp_log_level_t recordLevel, const char* recordTag, const char* recordFormat);
+    void addWord(uint32_t value);
+    void addString(const char* str, size_t length);
+
+    // printf-style rendering of format with the captured arguments. Supports
+    // d/i/u/x/X/o/c/s with flags, width and precision (including '*');
+    // length modifiers are ignored. Returns the rendered length.
+    size_t render(char* out, size_t size) const;
+};
+
+namespace logdetail {
+
+inline void capture(LogRecord& record, const char* value) {
+    record.addString(value, value ? strlen(value) : 0);
+}
+
+inline void capture(LogRecord& record, const std::string& value) {
+    record.addString(value.data(), value.size());
+}
+
+inline void capture(LogRecord& record, std::string_view value) {
+    record.addString(value.data(), value.size());
+}
+
+// Floating point and non-string pointers are rejected at compile time
+template <typename T>
+inline typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type
+capture(LogRecord& record, T value) {
+    record.addWord(static_cast<uint32_t>(value));
+}
+
+} // namespace logdetail
+
+// Process-wide multi-producer ring of log records, drained by one task.
+// Producers never block: when the ring is full the record is dropped and
+// counted. Until start() succeeds (or with TINYMCP_DEFERRED_LOG off)
+// records are rendered and written by the caller.
+class DeferredLog {
+public:
+    static const size_t CAPACITY = CONFIG_TINYMCP_LOG_RING_RECORDS;
+    static const size_t MAX_LINE_LENGTH = 160;
+    static const uint32_t DRAIN_INTERVAL_MS = 50;  // Re-drain delay while records are pending
+
+    static DeferredLog& getInstance();
+
+    // Creates the drain task (once); later calls are no-ops
+    int start(uint32_t stackSize = 2048, UBaseType_t priority = tskIDLE_PRIORITY + 1);
+    bool isRunning() const { return running_.load(std::memory_order_acquire); }
+
+    template <typename... Args>
+    void write(esp_log_level_t level, const char* tag, const char* format, const Args&... args) {
+        static_assert(sizeof...(Args) <= LogRecord::MAX_ARGS, "Too many log arguments");
+
+        uint32_t position;
+        LogRecord* record = claim(position);
+        if (!record) {
+            if (!isRunning()) {
+                writeNow(level, tag, format, args...);
+            }
+            return;
+        }
+
+        record->begin(level, tag, format);
+        (logdetail::capture(*record, args), ...);
+        publish(position, level);
+    }
+
+    // Statistics
+    struct Stats {
+        uint32_t written;           // Records queued
+        uint32_t dropped;           // Ring full at write()
+        uint32_t peakQueued;
+    };
+
+    Stats getStats() const;
+
+private:
+    DeferredLog();
+
+    struct Slot {
+        std::atomic<uint32_t> sequence;
+        LogRecord record;
+    };
+
+    template <typename... Args>
+    void writeNow(esp_log_level_t level, const char* tag, const char* format, const Args&... args) {
+        LogRecord record;
+        record.begin(level, tag, format);
+        (logdetail::capture(record, args), ...);
+        print(record);
+    }
+
+    // Reserves the next slot, nullptr when stopped or full
+    LogRecord* claim(uint32_t& position);
+    void publish(uint32_t position, esp_log_level_t level);
+    size_t drain();
+    static void print(const LogRecord& record);
+    static void drainTask(void* pvParameters);
+
+    static DeferredLog instance_;
+
+    Slot slots_[TINYMCP_DEFERRED_LOG ? CAPACITY : 1];
+    std::atomic<uint32_t> enqueuePos_;
+    std::atomic<uint32_t> dequeuePos_;  // Advanced by the drain task only
+    std::atomic<bool> running_;
+    TaskHandle_t task_;
+    std::atomic<uint32_t> written_;
+    std::atomic<uint32_t> dropped_;
+    uint32_t reportedDrops_;
+    uint32_t peakQueued_;
+};
+
+} // namespace tinymcp
+
+#define TINYMCP_LOG_AT(level, tag, format, ...) do {                                    \
+        if (TINYMCP_LOG_LOCAL_LEVEL >= (level)) {                                       \
+            ::tinymcp::DeferredLog::getInstance().write(level, tag, format, ##__VA_ARGS__); \
+        }                                                                               \
+    } while (0)
+
+#define TINYMCP_LOGE(tag, format, ...) TINYMCP_LOG_AT(ESP_LOG_ERROR, tag, format, ##__VA_ARGS__)
+#define TINYMCP_LOGW(tag, format, ...) TINYMCP_LOG_AT(ESP_LOG_WARN, tag, format, ##__VA_ARGS__)
+#define TINYMCP_LOGI(tag, format, ...) TINYMCP_LOG_AT(ESP_LOG_INFO, tag, format, ##__VA_ARGS__)
+#define TINYMCP_LOGD(tag, format, ...) TINYMCP_LOG_AT(ESP_LOG_DEBUG, tag, format, ##__VA_ARGS__)
+#define TINYMCP_LOGV(tag, format, ...) TINYMCP_LOG_AT(ESP_LOG_VERBOSE, tag, format, ##__VA_ARGS__)
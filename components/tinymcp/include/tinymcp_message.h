@@ -53,6 +53,9 @@ public:
     
     bool setFromJson(const cJSON* json);
     bool addToJson(cJSON* json) const;
+    void appendJson(std::string& out) const;   // JSON literal, for splicing cached payloads
+    void writeJson(JsonWriter& writer) const;
+    uint32_t hash() const;                      // Allocation-free, for fixed-slot tables
     
     // Comparison operators
     bool operator==(const MessageId& other) const;
@@ -93,11 +96,19 @@ public:
     virtual int serialize(std::string& jsonOut) const = 0;
     virtual int deserialize(const std::string& jsonIn) = 0;
     
+    // Deserialize from an already parsed tree (no re-parse, no copy)
+    int deserializeFrom(const cJSON* json) { return json ? doDeserialize(json) : TINYMCP_PARSE_ERROR; }
+    
+    // Stream the minified message into a writer. The default builds the
+    // doSerialize() tree and walks it; hot messages write their fields directly.
+    virtual int write(JsonWriter& writer) const;
+    
     // JSON-RPC validation
     virtual bool validateJsonRpc(const cJSON* json) const;
     
     // Factory method for creating messages from JSON
     static std::unique_ptr<Message> createFromJson(const std::string& jsonStr);
+    static std::unique_ptr<Message> createFromJson(const cJSON* json);
     static MessageType detectMessageType(const cJSON* json);
     static MessageCategory detectMessageCategory(const cJSON* json);
     
@@ -113,6 +124,7 @@ protected:
     // Common validation helpers
     bool validateCommonFields(const cJSON* json) const;
     bool addCommonFields(cJSON* json) const;
+    void writeCommonFields(JsonWriter& writer) const;
     
     MessageType messageType_;
     MessageCategory messageCategory_;
@@ -252,19 +264,22 @@ public:
         : toolsListChanged_(false)
         , toolsPagination_(false)
         , progressNotifications_(false)
-        , resourceSubscription_(false) {}
+        , resourceSubscription_(false)
+        , wireFormat_(WireFormat::JSON) {}
     
     // Getters
     bool hasToolsListChanged() const { return toolsListChanged_; }
     bool hasToolsPagination() const { return toolsPagination_; }
     bool hasProgressNotifications() const { return progressNotifications_; }
     bool hasResourceSubscription() const { return resourceSubscription_; }
+    WireFormat getWireFormat() const { return wireFormat_; }
     
     // Setters
     void setToolsListChanged(bool enabled) { toolsListChanged_ = enabled; }
     void setToolsPagination(bool enabled) { toolsPagination_ = enabled; }
     void setProgressNotifications(bool enabled) { progressNotifications_ = enabled; }
     void setResourceSubscription(bool enabled) { resourceSubscription_ = enabled; }
+    void setWireFormat(WireFormat format) { wireFormat_ = format; }
     
     cJSON* toJson() const;
     bool fromJson(const cJSON* json);
@@ -274,6 +289,7 @@ private:
     bool toolsPagination_;
     bool progressNotifications_;
     bool resourceSubscription_;
+    WireFormat wireFormat_;     // Negotiated encoding for frames after initialize
 };
 
 // Message validation result
@@ -0,0 +1,52 @@
+#pragma once
+
+// JSON-RPC method dispatch table for TinyMCP Protocol
+// Maps method names to message types and constructors without temporary strings
+
+#include <memory>
+#include <string_view>
+#include <cJSON.h>
+#include "tinymcp_constants.h"
+
+namespace tinymcp {
+
+class Message;
+
+// Builds a typed message from a parsed JSON-RPC object, nullptr on failure
+using MessageCreator = std::unique_ptr<Message> (*)(const cJSON* json);
+
+// One method known to the factory
+struct MethodEntry {
+    std::string_view name;
+    MessageCategory category;
+    MessageType type;
+    MessageCreator create;
+};
+
+// Built-in methods live in a sorted constexpr table searched by binary
+// search; user methods are appended to a small fixed registry at startup.
+// Requests and notifications share one namespace, as in JSON-RPC.
+class MethodTable {
+public:
+    static constexpr size_t MAX_USER_METHODS = 8;
+
+    // Lookup by method name; returns nullptr for unknown methods
+    static const MethodEntry* find(std::string_view method);
+
+    // Lookup by the "method" member of a parsed message
+    static const MethodEntry* find(const cJSON* json);
+
+    // Register an application method. The name must outlive the table
+    // (a string literal), the creator must return a Request subclass for
+    // REQUEST and a Notification subclass for NOTIFICATION. Built-in
+    // methods cannot be overridden.
+    static int registerMethod(const char* name, MessageCategory category, MessageCreator create);
+
+    static size_t getUserMethodCount() { return userCount_; }
+
+private:
+    static MethodEntry userMethods_[MAX_USER_METHODS];
+    static size_t userCount_;
+};
+
+} // namespace tinymcp
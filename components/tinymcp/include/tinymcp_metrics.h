@@ -0,0 +1,167 @@
+#pragma once
+
+// Request latency instrumentation for TinyMCP
+// Fixed-bucket histograms per method/tool and stage, scraped via server_stats
+
+#include <cstddef>
+#include <cstdint>
+#include <cJSON.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "sdkconfig.h"
+
+// Follows CONFIG_TINYMCP_ENABLE_METRICS (a disabled Kconfig bool is left undefined)
+#ifndef TINYMCP_METRICS
+#if defined(CONFIG_TINYMCP_ENABLE_METRICS)
+#define TINYMCP_METRICS 1
+#else
+#define TINYMCP_METRICS 0
+#endif
+#endif
+
+namespace tinymcp {
+
+// Where a request spends its time
+enum class MetricStage : uint8_t {
+    PARSE = 0,      // Frame received -> typed message
+    QUEUE_WAIT,     // Queued -> picked up (message queue, executor queue)
+    EXECUTE,        // Method handler or tool logic
+    SEND,           // Serialize -> handed to the transport
+    COUNT
+};
+
+const char* metricStageToString(MetricStage stage);
+
+// Called for every request received; the first one since boot is logged
+// with its time from power-on. Kept with metrics compiled out, so startup
+// regressions always show in the boot log.
+void noteRequestReceived();
+
+// Milliseconds from boot to the first request, 0 until one arrives
+uint32_t getFirstRequestMs();
+
+// Process-wide latency table. Samples are keyed by method or tool name in
+// a small fixed table (the first slot collects everything that does not
+// fit) and land in log-spaced microsecond buckets. Each task can carry a
+// current key so that sends deep inside a handler are attributed to the
+// request being served.
+class Metrics {
+public:
+    static const size_t BUCKET_COUNT = 10;          // Last bucket is open-ended
+    static const size_t MAX_KEYS = 12;
+    static const size_t MAX_KEY_LENGTH = 23;
+    static const size_t MAX_TASK_KEYS = 8;
+    static const uint8_t OTHER_KEY = 0;
+    static const uint32_t BUCKET_BOUNDS_US[BUCKET_COUNT - 1];
+
+    struct Histogram {
+        uint16_t buckets[BUCKET_COUNT];             // Saturating
+        uint32_t count;
+        uint32_t maxUs;
+        uint64_t totalUs;
+        uint32_t heapLowWater;                      // Lowest free heap seen at stage end
+    };
+
+    static Metrics& getInstance();
+    static uint32_t nowUs();
+
+    // Slot for `name`, allocated on first use; OTHER_KEY once the table is full
+    uint8_t keyFor(const char* name);
+
+    // Record one sample for a stage that started at `startUs`
+    void record(uint8_t key, MetricStage stage, uint32_t startUs);
+    void record(const char* name, MetricStage stage, uint32_t startUs) {
+        record(keyFor(name), stage, startUs);
+    }
+
+    // Current key of the calling task, OTHER_KEY if none is set
+    uint8_t getTaskKey();
+    void setTaskKey(uint8_t key);
+    void clearTaskKey();
+
+    // {"bucket_bounds_us":[...],"methods":{name:{stage:{...}}}}
+    cJSON* toJson();
+    void reset();
+
+private:
+    Metrics();
+
+    struct Entry {
+        char name[MAX_KEY_LENGTH + 1];
+        Histogram stages[static_cast<size_t>(MetricStage::COUNT)];
+    };
+
+    struct TaskKey {
+        TaskHandle_t task;
+        uint8_t key;
+    };
+
+    bool lock();
+    void unlock() { xSemaphoreGive(mutex_); }
+
+    static Metrics instance_;
+
+    Entry entries_[MAX_KEYS];
+    size_t keyCount_;
+    TaskKey taskKeys_[MAX_TASK_KEYS];
+    SemaphoreHandle_t mutex_;
+};
+
+// Records `stage` from construction to destruction, keyed by name or by
+// the calling task's current key; free when compiled out
+class MetricSpan {
+public:
+#if TINYMCP_METRICS
+    MetricSpan(MetricStage stage, const char* name) :
+        stage_(stage), key_(Metrics::getInstance().keyFor(name)), startUs_(Metrics::nowUs()) {}
+    explicit MetricSpan(MetricStage stage) :
+        stage_(stage), key_(Metrics::getInstance().getTaskKey()), startUs_(Metrics::nowUs()) {}
+    ~MetricSpan() { Metrics::getInstance().record(key_, stage_, startUs_); }
+    uint8_t getKey() const { return key_; }
+#else
+    MetricSpan(MetricStage, const char*) {}
+    explicit MetricSpan(MetricStage) {}
+    uint8_t getKey() const { return 0; }
+#endif
+
+    MetricSpan(const MetricSpan&) = delete;
+    MetricSpan& operator=(const MetricSpan&) = delete;
+
+private:
+#if TINYMCP_METRICS
+    MetricStage stage_;
+    uint8_t key_;
+    uint32_t startUs_;
+#endif
+};
+
+// Makes `key` the calling task's current key for the enclosing scope
+class MetricTaskScope {
+public:
+#if TINYMCP_METRICS
+    explicit MetricTaskScope(uint8_t key) : previous_(Metrics::getInstance().getTaskKey()) {
+        Metrics::getInstance().setTaskKey(key);
+    }
+    ~MetricTaskScope() {
+        if (previous_ == Metrics::OTHER_KEY) {
+            Metrics::getInstance().clearTaskKey();
+        } else {
+            Metrics::getInstance().setTaskKey(previous_);
+        }
+    }
+#else
+    explicit MetricTaskScope(uint8_t) {}
+#endif
+
+    MetricTaskScope(const MetricTaskScope&) = delete;
+    MetricTaskScope& operator=(const MetricTaskScope&) = delete;
+
+#if TINYMCP_METRICS
+private:
+    uint8_t previous_;
+#endif
+};
+
+} // namespace tinymcp
@@ -0,0 +1,149 @@
+#pragma once
+
+// Shared WiFi scan cache for the network_scan tool
+// Scans start without blocking, finish on WIFI_EVENT_SCAN_DONE and serve every session
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/semphr.h"
+#include "sdkconfig.h"
+#include "tinymcp_executor.h"
+#include "tinymcp_timer.h"
+
+// Default age up to which a cached scan answers network_scan (menuconfig → TinyMCP)
+#ifndef CONFIG_TINYMCP_SCAN_CACHE_TTL_MS
+#define CONFIG_TINYMCP_SCAN_CACHE_TTL_MS 10000
+#endif
+
+namespace tinymcp {
+
+// One radio scan at a time. A caller whose options the scan in flight covers
+// joins it instead of starting its own; others wait for the radio. The last
+// MAX_CACHED_SCANS results are kept per options, and an all-channel scan also
+// answers single-channel requests with otherwise equal options.
+class NetworkScanner {
+public:
+    static constexpr size_t MAX_RECORDS = 50;
+    static constexpr size_t MAX_CACHED_SCANS = 3;
+    static constexpr uint32_t SCAN_DONE_TIMEOUT_MS = 15000;   // Gives up on a lost event
+
+    struct Options {
+        uint8_t channel;        // 0 scans every channel
+        bool passive;           // Listen for beacons instead of sending probe requests
+        bool showHidden;
+        uint16_t dwellMs;       // Time per channel, 0 for the driver defaults
+
+        Options() : channel(0), passive(false), showHidden(false), dwellMs(0) {}
+
+        bool operator==(const Options& other) const {
+            return channel == other.channel && passive == other.passive &&
+                   showHidden == other.showHidden && dwellMs == other.dwellMs;
+        }
+        bool operator!=(const Options& other) const { return !(*this == other); }
+
+        // Results of a scan with these options contain those of `other`
+        bool covers(const Options& other) const {
+            return (channel == 0 || channel == other.channel) && passive == other.passive &&
+                   showHidden == other.showHidden && dwellMs == other.dwellMs;
+        }
+    };
+
+    // Compact copy of wifi_ap_record_t, ordered by signal strength
+    struct Network {
+        char ssid[33];
+        uint8_t bssid[6];
+        uint8_t channel;
+        int8_t rssi;
+        uint8_t authmode;
+    };
+
+    struct Result {
+        int status;
+        std::vector<Network> networks;
+        uint32_t ageMs;         // Time since the scan finished
+        bool cached;            // Served by an earlier scan without waiting
+
+        Result() : status(0), ageMs(0), cached(false) {}
+    };
+
+    struct Stats {
+        uint32_t scansStarted;
+        uint32_t scansJoined;
+        uint32_t cacheHits;
+        uint32_t scansFailed;
+
+        Stats() : scansStarted(0), scansJoined(0), cacheHits(0), scansFailed(0) {}
+    };
+
+    static NetworkScanner& getInstance();
+
+    // Never blocks. `ticket` starts at 0 and is kept by the caller between
+    // polls. Returns true when `result` is filled in: the cached networks for
+    // `options` if no older than maxAgeMs or freshly scanned, or the error of
+    // the scan. Returns false while a scan is still running; `notify` is
+    // then signalled once that scan completes or times out, so the caller
+    // can sleep until its next poll. `owner` identifies the waiter for
+    // removeWaiter().
+    bool poll(const Options& options, uint32_t maxAgeMs, uint32_t& ticket, Result& result,
+              const void* owner = nullptr, const TaskNotify& notify = TaskNotify());
+
+    // True from a poll() that registered `owner` until it is signalled
+    bool isWaiting(const void* owner);
+
+    // Stop notifying `owner`; must be called before its event group is deleted
+    void removeWaiter(const void* owner);
+
+    Stats getStats();
+
+private:
+    NetworkScanner();
+
+    struct Waiter {
+        const void* owner;
+        TaskNotify notify;
+    };
+
+    struct CacheEntry {
+        Options options;
+        std::vector<Network> networks;
+        uint32_t generation;
+        TickType_t time;
+    };
+
+    // Callers hold mutex_
+    int startScan(const Options& options);
+    const CacheEntry* findCache(const Options& options, uint32_t minGeneration, TickType_t maxAge,
+                                TickType_t now) const;
+    void copyCache(const CacheEntry& entry, const Options& options, Result& result, TickType_t now) const;
+    void addWaiter(const void* owner, const TaskNotify& notify);
+    void wakeWaiters();
+
+    void onScanDone(uint32_t status);
+    static void onScanTimeout(void* arg);
+
+    static void eventHandler(void* arg, const char* base, int32_t id, void* data);
+
+    SemaphoreHandle_t mutex_;
+    bool handlerRegistered_;
+
+    // Scan in flight
+    bool scanning_;
+    Options scanOptions_;
+    TickType_t scanStartTime_;
+
+    // Scans are numbered as they complete; a ticket names the one to wait for
+    uint32_t completed_;
+    int lastStatus_;
+
+    std::vector<CacheEntry> cache_;
+    std::vector<Waiter> waiters_;           // Signalled when the scan in flight ends
+    TimerWheel::Timer scanTimer_;           // Gives up on a lost WIFI_EVENT_SCAN_DONE
+
+    Stats stats_;
+};
+
+} // namespace tinymcp
@@ -76,7 +76,7 @@ protected:
 private:
     std::string clientVersion_;
     std::string sessionId_;
-    cJSON* clientCapabilities_;
+    cJSON* clientCapabilities_ = nullptr;
 
 public:
     ~InitializedNotification() {
@@ -271,7 +271,7 @@ private:
     LogLevel level_;
     std::string message_;
     std::string context_;
-    cJSON* data_;
+    cJSON* data_ = nullptr;
 
 public:
     ~LogNotification() {
@@ -308,9 +308,6 @@ public:
         LogNotification::LogLevel level,
         const std::string& message,
         const std::string& context = "");
-
-private:
-    static MessageType getNotificationType(const std::string& method);
 };
 
 // Notification validation utilities
@@ -0,0 +1,102 @@
+#pragma once
+
+// Single-task select() reactor for TinyMCP sessions
+// Serves many clients from one FreeRTOS task instead of four tasks per session
+
+#include "tinymcp_session.h"
+#include "tinymcp_socket_transport.h"
+#include <functional>
+#include <memory>
+#include <vector>
+#include <atomic>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+namespace tinymcp {
+
+// Reactor configuration
+struct ReactorConfig {
+    size_t maxSessions;             // Concurrent sessions served by the reactor
+    uint32_t taskStackSize;         // Stack size for the reactor task
+    uint8_t taskPriority;           // Priority for the reactor task
+    SessionConfig sessionConfig;    // Applied to every accepted session
+    bool poolSessions;              // Preallocate maxSessions sessions at start() and reuse them
+
+    ReactorConfig() :
+        maxSessions(8),
+        taskStackSize(4096),
+        taskPriority(4),
+        poolSessions(true) {
+        sessionConfig.reactorMode = true;
+    }
+};
+
+// Callback used to configure each accepted session before it is initialized
+using SessionSetupCallback = std::function<void(Session&)>;
+
+// Drives the listen socket and every session socket from one select() loop.
+// Sessions run in SessionConfig::reactorMode; tool tasks run on the shared
+// TaskExecutor and the reactor only does their bookkeeping. A loopback UDP
+// socket in the select set lets a finished task wake the loop at once.
+class SessionReactor {
+public:
+    explicit SessionReactor(EspSocketServer& server, const ReactorConfig& config = ReactorConfig());
+    ~SessionReactor();
+
+    // Delete copy constructor and assignment
+    SessionReactor(const SessionReactor&) = delete;
+    SessionReactor& operator=(const SessionReactor&) = delete;
+
+    // Reactor lifecycle
+    int start();
+    int stop();
+    bool isRunning() const { return running_; }
+
+    // One select() iteration; usable without start() from an existing task
+    int runOnce(uint32_t maxWaitMs = UINT32_MAX);
+
+    // Configuration
+    void setSessionSetup(SessionSetupCallback callback) { sessionSetup_ = std::move(callback); }
+
+    // Statistics
+    struct ReactorStats {
+        uint32_t connectionsAccepted;
+        uint32_t connectionsRejected;
+        uint32_t sessionsClosed;
+        uint32_t wakeups;
+        uint32_t taskWakeups;           // Wakeups sent by finished tasks
+        uint32_t readPauses;            // Iterations that left session sockets unread for low heap
+
+        ReactorStats() : connectionsAccepted(0), connectionsRejected(0),
+                        sessionsClosed(0), wakeups(0), taskWakeups(0), readPauses(0) {}
+    };
+
+    const ReactorStats& getStats() const { return stats_; }
+    size_t getSessionCount() const { return sessions_.size(); }
+
+private:
+    static void reactorTask(void* pvParameters);
+
+    int acceptPending();
+    void closeSession(size_t index);
+
+    int openWakeSocket();
+    void closeWakeSocket();
+    void drainWakeSocket();
+    static void wake(void* arg);       // Session::setWakeup callback, any task
+
+    EspSocketServer& server_;
+    ReactorConfig config_;
+    SessionSetupCallback sessionSetup_;
+
+    std::vector<std::shared_ptr<Session>> sessions_;
+    std::atomic<bool> running_;
+    TaskHandle_t reactorHandle_;
+    int wakeSocket_;
+    std::atomic<bool> wakePending_;     // A byte is in flight; later wake() calls skip the send
+
+    ReactorStats stats_;
+};
+
+} // namespace tinymcp
@@ -70,6 +70,9 @@ public:
     const cJSON* getClientCapabilities() const { return clientCapabilities_; }
     void setClientCapabilities(cJSON* capabilities);
     
+    // First supported entry of capabilities.experimental.encoding.formats
+    WireFormat getPreferredWireFormat() const;
+    
     bool validateParams(const cJSON* params) const override;
     
 protected:
@@ -79,7 +82,7 @@ protected:
 private:
     std::string protocolVersion_;
     ClientInfo clientInfo_{"", ""};
-    cJSON* clientCapabilities_;
+    cJSON* clientCapabilities_ = nullptr;
     
 public:
     ~InitializeRequest() {
@@ -172,7 +175,7 @@ protected:
 private:
     std::string toolName_;
     std::vector<ToolArgument> arguments_;
-    cJSON* rawArguments_;
+    cJSON* rawArguments_ = nullptr;
     
 public:
     ~CallToolRequest() {
@@ -220,9 +223,6 @@ public:
         const std::vector<ToolArgument>& arguments = {});
     
     static std::unique_ptr<PingRequest> createPingRequest(const MessageId& id);
-    
-private:
-    static MessageType getRequestType(const std::string& method);
 };
 
 // Request validation utilities
@@ -34,6 +34,7 @@ public:
     bool isValid() const override;
     int serialize(std::string& jsonOut) const override;
     int deserialize(const std::string& jsonIn) override;
+    int write(JsonWriter& writer) const override;
     
 protected:
     int doSerialize(cJSON* json) const override;
@@ -43,6 +44,9 @@ protected:
     virtual int serializeResult(cJSON* json) const { return 0; }
     virtual int deserializeResult(const cJSON* json) { return 0; }
     
+    // Streams the result/error members; the default walks serializeResult()
+    virtual int writeResult(JsonWriter& writer) const;
+    
     MessageId id_;
     bool isError_;
 };
@@ -207,6 +211,11 @@ public:
     ToolContent(ContentType type, const std::string& text, const std::string& mimeType)
         : type_(type), text_(text), mimeType_(mimeType) {}
     
+    // JSON payload kept as a tree and written as escaped text on demand,
+    // so a tool result is never printed into an intermediate string
+    ToolContent(ContentType type, std::shared_ptr<cJSON> json)
+        : type_(type), mimeType_("application/json"), json_(std::move(json)) {}
+    
     ContentType getType() const { return type_; }
     const std::string& getText() const { return text_; }
     const std::string& getMimeType() const { return mimeType_; }
@@ -215,20 +224,24 @@ public:
     void setText(const std::string& text) { text_ = text; }
     void setMimeType(const std::string& mimeType) { mimeType_ = mimeType; }
     
-    bool isValid() const { return !text_.empty(); }
+    bool isValid() const { return !text_.empty() || json_; }
+    const cJSON* getJson() const { return json_.get(); }
     
     cJSON* toJson() const;
     bool fromJson(const cJSON* json);
+    void write(JsonWriter& writer) const;
     
     // Factory methods
     static ToolContent createText(const std::string& text);
     static ToolContent createError(const std::string& error);
     static ToolContent createJson(const std::string& json);
+    static ToolContent createJson(cJSON* json);     // Takes ownership
 
 private:
     ContentType type_;
     std::string text_;
     std::string mimeType_;
+    std::shared_ptr<cJSON> json_;
 };
 
 // Call Tool Response
@@ -259,10 +272,12 @@ public:
     void addTextContent(const std::string& text);
     void addErrorContent(const std::string& error);
     void addJsonContent(const std::string& json);
+    void addJsonContent(cJSON* json);               // Takes ownership
     
 protected:
     int serializeResult(cJSON* json) const override;
     int deserializeResult(const cJSON* json) override;
+    int writeResult(JsonWriter& writer) const override;
 
 private:
     std::vector<ToolContent> content_;
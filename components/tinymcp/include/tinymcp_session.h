@@ -3,12 +3,12 @@
 // FreeRTOS Session Management for TinyMCP Protocol
 // ESP8266/ESP32 optimized session handling with async task support
 
+#include <cstdint>
 #include <string>
 #include <memory>
-#include <unordered_map>
-#include <deque>
 #include <vector>
 #include <atomic>
+#include <functional>
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -21,6 +21,22 @@
 #include "tinymcp_request.h"
 #include "tinymcp_response.h"
 #include "tinymcp_notification.h"
+#include "tinymcp_admission.h"
+#include "tinymcp_arena.h"
+#include "tinymcp_envelope.h"
+#include "tinymcp_executor.h"
+#include "tinymcp_metrics.h"
+#include "tinymcp_timer.h"
+#include "sdkconfig.h"
+
+// Keep a copy of each raw message only when debug logging can print it
+#ifndef TINYMCP_KEEP_RAW_JSON
+#if defined(CONFIG_LOG_DEFAULT_LEVEL) && CONFIG_LOG_DEFAULT_LEVEL >= 4 // ESP_LOG_DEBUG
+#define TINYMCP_KEEP_RAW_JSON 1
+#else
+#define TINYMCP_KEEP_RAW_JSON 0
+#endif
+#endif
 
 namespace tinymcp {
 
@@ -29,6 +45,10 @@ class SessionTransport;
 class AsyncTask;
 class SessionManager;
 
+// Delivers one progress notification for a task's token
+using ProgressSender = std::function<int(const std::string& token, int progress, int total,
+                                         const char* message, const char* data, size_t dataLength)>;
+
 // Session state enumeration
 enum class SessionState : uint8_t {
     UNINITIALIZED = 0,
@@ -42,14 +62,25 @@ enum class SessionState : uint8_t {
 
 // Session configuration
 struct SessionConfig {
-    uint32_t maxPendingTasks;       // Maximum pending async tasks
-    uint32_t taskStackSize;         // Stack size for async tasks
+    uint32_t maxPendingTasks;       // Maximum pending async tasks (up to PendingTaskTable::MAX_SLOTS)
+    uint32_t taskStackSize;         // Stack size for session and executor tasks
     uint32_t messageQueueSize;      // Message queue depth
     uint32_t taskTimeoutMs;         // Task timeout in milliseconds
     uint32_t sessionTimeoutMs;      // Session timeout in milliseconds
-    uint8_t taskPriority;           // Priority for async tasks
+    uint8_t taskPriority;           // Priority for session and executor tasks
     bool enableProgressReporting;   // Enable progress notifications
     bool enableToolsPagination;     // Enable tools pagination
+    bool enableEventDrivenLoop;     // Block on events instead of polling
+    uint32_t taskPollIntervalMs;    // Re-run interval for unfinished async tasks
+    bool reactorMode;               // Driven by SessionReactor, no per-session tasks
+    bool enableJsonArena;           // Serve per-message cJSON allocations from JsonArenaPool
+    uint8_t executorWorkers;        // Shared TaskExecutor pool size, fixed by the first session
+    uint32_t progressIntervalMs;    // Minimum spacing of progress notifications per task
+    uint32_t maxBatchSize;          // Maximum elements in one JSON-RPC batch
+    uint32_t outboundQueueSize;     // Small frames queued for the writer, 0 sends inline
+    AdmissionConfig admission;      // Heap watermarks for backpressure and request rejection
+    bool enableCborEncoding;        // Offer CBOR to clients that ask for it during initialize
+    bool enableLazyParsing;         // Route text frames on a scanned envelope before parsing them
     
     SessionConfig() :
         maxPendingTasks(8),
@@ -59,7 +90,17 @@ struct SessionConfig {
         sessionTimeoutMs(300000),
         taskPriority(3),
         enableProgressReporting(true),
-        enableToolsPagination(false) {}
+        enableToolsPagination(false),
+        enableEventDrivenLoop(true),
+        taskPollIntervalMs(50),
+        reactorMode(false),
+        enableJsonArena(true),
+        executorWorkers(TaskExecutor::DEFAULT_WORKER_COUNT),
+        progressIntervalMs(DEFAULT_PROGRESS_INTERVAL_MS),
+        maxBatchSize(MAX_BATCH_SIZE),
+        outboundQueueSize(8),
+        enableCborEncoding(true),
+        enableLazyParsing(true) {}
 };
 
 // Transport interface for session communication
@@ -73,16 +114,63 @@ public:
     virtual bool isConnected() const = 0;
     virtual void close() = 0;
     
+    // Non-blocking receive for reactor mode: returns TINYMCP_ERROR_TIMEOUT
+    // while a frame is still incomplete, keeping partial data buffered
+    virtual int tryReceive(std::string& data) { return TINYMCP_ERROR_NOT_IMPLEMENTED; }
+    virtual int getSocket() const { return -1; }
+    
+    // Send from a caller-owned buffer (e.g. cJSON_PrintPreallocated output);
+    // transports that can gather-send override this to avoid the copy
+    virtual int sendBuffer(const char* data, size_t length) { return send(std::string(data, length)); }
+    
+    // Streamed send of one message whose exact length is known up front;
+    // chunks arrive in order between beginStream() and endStream(). The
+    // default gathers them and calls send(), framing transports override
+    // this to write the header first and each chunk straight to the wire.
+    virtual int beginStream(size_t length) {
+        streamBuffer_.clear();
+        streamBuffer_.reserve(length);
+        return TINYMCP_SUCCESS;
+    }
+    virtual int streamChunk(const char* data, size_t length) {
+        streamBuffer_.append(data, length);
+        return TINYMCP_SUCCESS;
+    }
+    virtual int endStream() {
+        int result = send(streamBuffer_);
+        std::string().swap(streamBuffer_);
+        return result;
+    }
+    
+    // Outbound coalescing: the session queues messages of up to
+    // getCoalesceLimit() bytes and hands them over together through
+    // sendFrames(). A limit of 0 keeps every send inline.
+    static const size_t MAX_COALESCED_FRAMES = 8;
+    virtual size_t getCoalesceLimit() const { return 0; }
+    virtual uint32_t getCoalesceWindowMs() const { return 0; }
+    virtual int sendFrames(const std::string* const* frames, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            int result = send(*frames[i]);
+            if (result != TINYMCP_SUCCESS) {
+                return result;
+            }
+        }
+        return TINYMCP_SUCCESS;
+    }
+    
     // Transport info
     virtual std::string getClientInfo() const = 0;
     virtual size_t getMaxMessageSize() const { return 4096; }
+
+protected:
+    std::string streamBuffer_;
 };
 
 // Async task base class
 class AsyncTask {
 public:
     AsyncTask(const MessageId& requestId, const std::string& method);
-    virtual ~AsyncTask() = default;
+    virtual ~AsyncTask();
     
     // Task lifecycle
     virtual int execute() = 0;
@@ -91,8 +179,25 @@ public:
     virtual bool isCancelled() const { return cancelled_; }
     virtual bool isValid() const = 0;
     
-    // Progress reporting
+    // Parked on an outside event that signals the task's timeout notify
+    // when it fires; until then the session leaves the task alone instead of
+    // re-running it every poll interval
+    virtual bool isWaiting() const { return false; }
+    
+    // Progress reporting. Updates are coalesced per task: only the latest
+    // value is kept and it is sent at most once per interval, on a jump of
+    // PROGRESS_MIN_STEP_PERCENT, or when it reaches total. Coalesced calls
+    // do not allocate.
     virtual int reportProgress(int current, int total, const std::string& message = "");
+    int reportProgress(int current, int total, const char* message);
+    void flushProgress();
+    
+    // Sends one piece of a streamed result right away, bypassing the
+    // coalescing above; current/total still describe overall progress
+    int reportPartialResult(int current, int total, const char* data, size_t length);
+    
+    // Set by the session on submit and cleared before the task is dropped
+    void setProgressSender(ProgressSender sender, uint32_t intervalMs);
     
     // Getters
     const MessageId& getRequestId() const { return requestId_; }
@@ -100,10 +205,27 @@ public:
     TickType_t getStartTime() const { return startTime_; }
     TickType_t getTimeout() const { return timeoutTicks_; }
     
-    // Setters
+    // Setters; a new timeout also moves an armed deadline
     void setTimeout(uint32_t timeoutMs);
     void setProgressToken(const std::string& token) { progressToken_ = token; }
     
+    // Response produced by execute(), handed to the session once finished
+    std::unique_ptr<Response> takeResponse() { return std::move(response_); }
+    
+    // Scheduling on the shared TaskExecutor
+    TaskPriority getPriority() const { return priority_; }
+    bool isFastLane() const { return fastLane_; }
+    void setScheduling(TaskPriority priority, bool fastLane) { priority_ = priority; fastLane_ = fastLane; }
+    bool isScheduled() const { return scheduled_; }
+    TickType_t getLastRunTime() const { return lastRunTime_; }
+    
+    // Timeout deadline on the shared TimerWheel, counted from the start
+    // time. On expiry isTimedOut() turns true and `notify` is signalled;
+    // disarm before its event group is deleted.
+    void armTimeout(const TaskNotify& notify);
+    void disarmTimeout();
+    bool isTimedOut() const { return timedOut_; }
+    
 protected:
     MessageId requestId_;
     std::string method_;
@@ -113,23 +235,87 @@ protected:
     TickType_t startTime_;
     TickType_t timeoutTicks_;
     SemaphoreHandle_t taskMutex_;
+    std::unique_ptr<Response> response_;
+    
+    // Coalesced progress, guarded by progressMutex_
+    struct ProgressState {
+        int current;
+        int total;
+        int lastSentPercent;
+        TickType_t lastSentTime;
+        bool pending;
+        bool sentAny;
+        char message[MAX_PROGRESS_MESSAGE_LENGTH];
+    };
     
-    // Helper for creating responses
-    std::unique_ptr<Response> createResponse(const cJSON* result = nullptr);
+    ProgressState progress_;
+    ProgressSender progressSender_;
+    TickType_t progressIntervalTicks_;
+    SemaphoreHandle_t progressMutex_;
+    
+    int sendPendingProgress();  // Caller holds progressMutex_
+    
+    // Owned by TaskExecutor while queued or running
+    TaskPriority priority_;
+    bool fastLane_;
+    std::atomic<bool> scheduled_;
+    TickType_t lastRunTime_;
+    friend class TaskExecutor;
+    
+    // Declared last so the destructor disarms it before anything it touches goes
+    static void onTimeout(void* arg);
+    std::atomic<bool> timedOut_;
+    TaskNotify timeoutNotify_;
+    TimerWheel::Timer timeoutTimer_;
+    
+    // Helper for creating responses; takes ownership of the result tree
+    std::unique_ptr<Response> createResponse(cJSON* result = nullptr);
     std::unique_ptr<Response> createErrorResponse(int errorCode, const std::string& message);
 };
 
 // Message context for processing
 struct MessageContext {
-    std::unique_ptr<Message> message;
-    std::string rawJson;
+    std::unique_ptr<Message> message;   // Null for a JSON-RPC batch
+    cJSON* root;                    // The single parse of this message, owned
+#if TINYMCP_KEEP_RAW_JSON
+    std::string rawJson;            // Debug builds only
+#endif
+#if TINYMCP_METRICS
+    uint32_t queuedUs = 0;          // Start of the queue-wait stage
+#endif
     TickType_t receivedTime;
     bool requiresResponse;
     MessageId requestId;
-    
-    MessageContext(std::unique_ptr<Message> msg, const std::string& json) :
-        message(std::move(msg)), rawJson(json), receivedTime(xTaskGetTickCount()),
-        requiresResponse(false) {}
+    JsonArena* arena;               // Backs every cJSON node of this message, may be null
+    
+    MessageContext(std::unique_ptr<Message> msg, cJSON* json, JsonArena* jsonArena = nullptr) :
+        message(std::move(msg)), root(json), receivedTime(xTaskGetTickCount()),
+        requiresResponse(false), arena(jsonArena) {}
+    
+    // Destroy the message and tree before their arena is reset and handed out again
+    ~MessageContext() {
+        message.reset();
+        if (root) {
+            cJSON_Delete(root);
+        }
+        JsonArenaPool::getInstance().release(arena);
+    }
+    
+    MessageContext(const MessageContext&) = delete;
+    MessageContext& operator=(const MessageContext&) = delete;
+};
+
+// Response array of one JSON-RPC batch. Synchronous replies are appended
+// while the batch is dispatched; async tool results are appended as their
+// tasks finish, and the array goes out as one frame once none is awaited.
+struct ResponseBatch {
+    std::string body;               // "[" plus the elements so far
+    std::vector<MessageId> awaiting;    // Async requests still running
+    size_t responseCount;
+    bool dispatching;               // Elements are still being processed
+    MessageId currentId;            // Element being dispatched
+    
+    ResponseBatch() : body("["), responseCount(0), dispatching(true) {}
 };
 
 // Session statistics
@@ -140,14 +326,61 @@ struct SessionStats {
     uint32_t tasksCompleted;
     uint32_t tasksCancelled;
     uint32_t errors;
+    uint32_t requestsRejected;      // Answered with TINYMCP_ERROR_RESOURCE_LIMIT
+    uint32_t readPauses;            // Receive loop iterations skipped for low heap
     TickType_t sessionStartTime;
     TickType_t lastActivityTime;
     
     SessionStats() : messagesReceived(0), messagesSent(0), tasksCreated(0),
                     tasksCompleted(0), tasksCancelled(0), errors(0),
+                    requestsRejected(0), readPauses(0),
                     sessionStartTime(0), lastActivityTime(0) {}
 };
 
+// Fixed-capacity table of a session's in-flight tasks. Slots live inside
+// the table and free ones form an intrusive list; lookups compare the id
+// hash before the id itself, so insert, find and remove never allocate.
+class PendingTaskTable {
+public:
+    static const size_t MAX_SLOTS = 16;
+    static const size_t NO_SLOT = SIZE_MAX;
+    
+    explicit PendingTaskTable(size_t capacity);
+    
+    // TINYMCP_ERROR_RESOURCE_LIMIT when full, TINYMCP_ERROR_INVALID_STATE
+    // when a task with the same request id is already pending
+    int insert(std::shared_ptr<AsyncTask> task);
+    size_t find(const MessageId& requestId) const;
+    void remove(size_t slot);
+    void clear();
+    
+    // Slot access for iteration over 0..capacity(); empty slots return null
+    const std::shared_ptr<AsyncTask>& at(size_t slot) const { return slots_[slot].task; }
+    
+    size_t size() const { return count_; }
+    size_t capacity() const { return capacity_; }
+    bool isFull() const { return count_ >= capacity_; }
+
+private:
+    struct Slot {
+        std::shared_ptr<AsyncTask> task;
+        uint32_t hash;
+        uint8_t nextFree;
+    };
+    
+    static const uint8_t END_OF_LIST = 0xFF;
+    
+    Slot slots_[MAX_SLOTS];
+    size_t capacity_;
+    size_t count_;
+    uint8_t freeHead_;
+};
+
+class Session;
+
+// Handles requests and notifications registered through MethodTable
+using CustomMessageHandler = std::function<int(Session&, const Message&)>;
+
 // Main session class
 class Session {
 public:
@@ -163,6 +396,15 @@ public:
     int run();
     int shutdown();
     
+    // Reactor mode: driven from a shared select() loop instead of run()
+    int onReadable();
+    int poll(TickType_t* nextWakeup);
+    int getSocket() const { return transport_ ? transport_->getSocket() : -1; }
+    
+    // Called when a tool task finishes on the executor or an awaited event
+    // fires; the reactor blocks in select(), not on the session's event group
+    void setWakeup(void (*wake)(void* arg), void* arg) { wake_ = wake; wakeArg_ = arg; }
+    
     // State management
     SessionState getState() const { return state_; }
     bool isActive() const { return state_ == SessionState::ACTIVE; }
@@ -173,9 +415,11 @@ public:
     void setServerCapabilities(const ServerCapabilities& capabilities);
     void addTool(const std::string& name, const std::string& description, 
                  const cJSON* schema = nullptr);
+    void setCustomMessageHandler(CustomMessageHandler handler) { customHandler_ = std::move(handler); }
     
     // Statistics
     const SessionStats& getStats() const { return stats_; }
+    WireFormat getWireFormat() const { return wireFormat_; }
     
     // Async task management
     int submitTask(std::unique_ptr<AsyncTask> task);
@@ -184,19 +428,55 @@ public:
     
     // Message handling
     int sendMessage(const Message& message);
+    int sendSerialized(const std::string& json);
+    int sendStreamed(const std::function<int(JsonWriter&)>& write);
     int sendNotification(const std::string& method, const cJSON* params = nullptr);
+    int sendProgress(const std::string& token, int progress, int total, const char* message,
+                     const char* data = nullptr, size_t dataLength = 0);
     
 private:
+    // Reuse by SessionManager's pool: a fresh or shut-down session whose
+    // queues fit `config` takes a new connection, keeping its FreeRTOS
+    // resources and buffers
+    friend class SessionManager;
+    bool isReusableFor(const SessionConfig& config) const;
+    void attach(std::unique_ptr<SessionTransport> transport, const SessionConfig& config);
+    
     // Core session tasks
     static void messageProcessorTask(void* pvParameters);
     static void asyncTaskManager(void* pvParameters);
-    static void keepAliveTask(void* pvParameters);
+    static void outboundWriterTask(void* pvParameters);
+    
+    // Shared by threaded and reactor modes
+    int handleIncomingMessage(const std::string& json);
+    bool serviceTasks();
+    bool serviceTimers();
+    TickType_t serviceKeepAlive();
+    void checkToolsListChanged();
+    static void onActivityTimer(void* arg);
     
     // Message processing
     int processMessage(std::unique_ptr<MessageContext> context);
     int processRequest(const Request& request);
     int processResponse(const Response& response);
     int processNotification(const Notification& notification);
+    int processBatch(const cJSON* batch);
+    int rejectMessage(const MessageContext& context, const char* reason);
+    bool routeEnvelope(const JsonRpcEnvelope& envelope, int& result);
+    
+    // Batch response assembly, all under sessionMutex_
+    bool isCollectingBatch() const;
+    void appendToBatch(ResponseBatch& batch, const std::string& element, const MessageId& id);
+    bool routeToBatch(const MessageId& id, const Message* response, std::vector<std::string>& frames);
+    void closeBatchIfDone(size_t index, std::vector<std::string>& frames);
+    
+    // Outbound queue; drainOutbound() requires sendMutex_
+    int enqueueFrame(std::unique_ptr<std::string> frame);
+    int drainOutbound();
+    int flushOutbound();
+    
+    // Re-encodes pre-serialized JSON for a CBOR session
+    int sendTranscoded(const std::string& json);
     
     // Protocol handlers
     int handleInitializeRequest(const InitializeRequest& request);
@@ -214,6 +494,11 @@ private:
     int sendErrorResponse(const MessageId& requestId, int errorCode, const std::string& message);
     void updateActivity();
     void cleanup();
+    bool tasksRunning() const;
+    
+    // Event-driven wait helpers
+    TickType_t getIdleTimeoutRemaining() const;
+    void wakeTaskManager(EventBits_t reason);
     
     // Configuration and state
     SessionConfig config_;
@@ -224,32 +509,67 @@ private:
     std::string serverName_;
     std::string serverVersion_;
     ServerCapabilities capabilities_;
+    std::atomic<WireFormat> wireFormat_;    // Outbound encoding, switched after initialize
     std::vector<std::string> supportedTools_;
+    CustomMessageHandler customHandler_;
     
     // FreeRTOS resources
     TaskHandle_t messageProcessorHandle_;
     TaskHandle_t asyncManagerHandle_;
-    TaskHandle_t keepAliveHandle_;
+    TaskHandle_t writerHandle_;
     QueueHandle_t messageQueue_;
+    QueueHandle_t outboundQueue_;           // std::string* frames, null when disabled
     QueueHandle_t taskQueue_;
     SemaphoreHandle_t sessionMutex_;
+    SemaphoreHandle_t sendMutex_;           // Keeps streamed frames from interleaving
     EventGroupHandle_t sessionEvents_;
+    void (*wake_)(void* arg);
+    void* wakeArg_;
+    
+    // EVENT_TASK_COMPLETED plus the reactor's wakeup, if set
+    TaskNotify taskNotify() const;
     
     // Event bits
     static const EventBits_t EVENT_SHUTDOWN_REQUEST = BIT0;
     static const EventBits_t EVENT_MESSAGE_RECEIVED = BIT1;
     static const EventBits_t EVENT_TASK_COMPLETED = BIT2;
+    static const EventBits_t EVENT_TASK_SUBMITTED = BIT3;
+    static const EventBits_t EVENT_TIMER_DUE = BIT4;
+    // Set by each session task as it returns; shutdown() waits on them
+    static const EventBits_t EVENT_PROCESSOR_EXITED = BIT5;
+    static const EventBits_t EVENT_MANAGER_EXITED = BIT6;
+    static const EventBits_t EVENT_WRITER_EXITED = BIT7;
+    static const EventBits_t EVENT_TASKS_EXITED =
+        EVENT_PROCESSOR_EXITED | EVENT_MANAGER_EXITED | EVENT_WRITER_EXITED;
+    
+    // Idle timeout and keep-alive deadline; set to whichever is nearer
+    TimerWheel::Timer activityTimer_;
+    std::atomic<bool> idleExpired_;
+    
+    // Timing constants
+    static const uint32_t KEEPALIVE_IDLE_MS = 60000;
+    static const uint32_t REACTOR_MAX_FRAMES_PER_WAKEUP = 4;
+    static const uint32_t WRITER_STACK_SIZE = 1536;
     
     // Task management
-    std::unordered_map<std::string, std::shared_ptr<AsyncTask>> pendingTasks_;
-    std::deque<std::shared_ptr<AsyncTask>> completedTasks_;
+    PendingTaskTable pendingTasks_;
+    
+    // JSON-RPC batches awaiting async results; collecting_ is the batch
+    // being dispatched on collectingTask_, whose replies it captures
+    std::vector<std::unique_ptr<ResponseBatch>> openBatches_;
+    ResponseBatch* collecting_;
+    TaskHandle_t collectingTask_;
     
     // Statistics
     SessionStats stats_;
     
+    // Receive buffer of run(), kept with its capacity across connections
+    std::string receiveBuffer_;
+    
     // Internal state
     bool initialized_;
     bool protocolInitialized_;
+    uint32_t listedToolsGeneration_;    // Registry generation last sent in tools/list
     TickType_t lastHeartbeat_;
 };
 
@@ -264,6 +584,15 @@ public:
     void removeSession(const std::shared_ptr<Session>& session);
     size_t getSessionCount() const;
     
+    // Boot-time pool of `count` sessions built for `config`. Their queues,
+    // locks, event groups and buffers are allocated once and reused by
+    // createSession() for configs with the same queue sizes, once nothing
+    // but the pool holds them. Call before the first createSession();
+    // sessions beyond the pool are allocated per connection as before.
+    // Like the rest of the manager, use it from one task.
+    int initializePool(size_t count, const SessionConfig& config);
+    size_t getPoolSize() const { return pool_.size(); }
+    
     // Global operations
     void shutdownAll();
     void cleanupInactiveSessions();
@@ -274,9 +603,12 @@ public:
         uint32_t activeSessions;
         uint32_t totalMessages;
         uint32_t totalTasks;
+        uint32_t pooledSessionsReused;
+        uint32_t poolMisses;            // Sessions allocated because no slot fit
         
         GlobalStats() : totalSessionsCreated(0), activeSessions(0),
-                       totalMessages(0), totalTasks(0) {}
+                       totalMessages(0), totalTasks(0),
+                       pooledSessionsReused(0), poolMisses(0) {}
     };
     
     const GlobalStats& getGlobalStats() const { return globalStats_; }
@@ -290,6 +622,7 @@ private:
     
     // Session storage
     std::vector<std::shared_ptr<Session>> sessions_;
+    std::vector<std::shared_ptr<Session>> pool_;
     mutable SemaphoreHandle_t managerMutex_;
     
     // Statistics
@@ -308,7 +641,7 @@ bool isValidSessionTransition(SessionState from, SessionState to);
 class CallToolTask : public AsyncTask {
 public:
     CallToolTask(const MessageId& requestId, const std::string& toolName, const cJSON* args);
-    virtual ~CallToolTask() = default;
+    virtual ~CallToolTask();
     
     bool isValid() const override;
     int execute() override;
@@ -316,6 +649,9 @@ public:
 protected:
     std::string toolName_;
     cJSON* arguments_;
+#if TINYMCP_METRICS
+    uint32_t queuedUs_;             // Creation time, for the executor queue wait
+#endif
     
     // Override this method to implement actual tool logic
     virtual int executeToolLogic(const cJSON* args, cJSON** result) = 0;
@@ -9,6 +9,7 @@
 #include <atomic>
 
 #include "lwip/sockets.h"
+#include <sys/uio.h>
 #include "lwip/netdb.h"
 #include "esp_log.h"
 
@@ -24,6 +25,9 @@ struct SocketTransportConfig {
     uint32_t keepAliveIdleSeconds;  // Keep-alive idle time
     uint32_t keepAliveIntervalSeconds; // Keep-alive interval
     uint32_t keepAliveCount;        // Keep-alive probe count
+    bool enableNoDelay;             // TCP_NODELAY; small frames are coalesced by the session instead
+    uint32_t coalesceWindowMs;      // Writer delay to gather more frames, 0 sends what is queued
+    size_t coalesceLimit;           // Largest coalesced frame and write, 0 disables the outbound queue
     
     SocketTransportConfig() :
         receiveTimeoutMs(5000),
@@ -33,7 +37,10 @@ struct SocketTransportConfig {
         enableKeepAlive(true),
         keepAliveIdleSeconds(60),
         keepAliveIntervalSeconds(10),
-        keepAliveCount(3) {}
+        keepAliveCount(3),
+        enableNoDelay(true),
+        coalesceWindowMs(0),
+        coalesceLimit(1024) {}
 };
 
 // ESP Socket Transport implementation
@@ -56,6 +63,19 @@ public:
     int receive(std::string& data, uint32_t timeoutMs = 1000) override;
     bool isConnected() const override;
     void close() override;
+    int tryReceive(std::string& data) override;
+    int sendBuffer(const char* data, size_t length) override;
+    int beginStream(size_t length) override;
+    int streamChunk(const char* data, size_t length) override;
+    int endStream() override;
+    int sendFrames(const std::string* const* frames, size_t count) override;
+    size_t getCoalesceLimit() const override { return config_.coalesceLimit; }
+    uint32_t getCoalesceWindowMs() const override { return config_.coalesceWindowMs; }
+    
+    // Serialize into a caller-provided buffer and send it without an
+    // intermediate std::string; fails if the JSON does not fit
+    int sendJson(cJSON* json, char* buffer, size_t bufferSize);
+    int getSocket() const override { return socket_; }
     
     std::string getClientInfo() const override;
     size_t getMaxMessageSize() const override { return config_.maxMessageSize; }
@@ -88,7 +108,8 @@ private:
     int configureSocket();
     
     // Message framing helpers
-    int sendFrame(const std::string& data);
+    int sendFrame(const char* data, size_t length);
+    int sendVectored(struct iovec* iov, int iovCount);
     int receiveFrame(std::string& data, uint32_t timeoutMs);
     int receiveExact(void* buffer, size_t size, uint32_t timeoutMs);
     
@@ -112,6 +133,13 @@ private:
     
     // Buffers
     std::unique_ptr<char[]> receiveBuffer_;
+    std::string partialFrame_;      // Header + body bytes of an incomplete frame (tryReceive)
+    
+    // Streamed send state; the header goes out with the first chunk
+    size_t streamLength_;
+    size_t streamRemaining_;        // Body bytes still owed to the current frame
+    bool streamHeaderSent_;
+    int streamStatus_;
     
     // Statistics
     mutable TransportStats stats_;
@@ -142,11 +170,16 @@ public:
     // Server information
     uint16_t getPort() const { return port_; }
     size_t getActiveConnections() const { return activeConnections_; }
+    int getListenSocket() const { return listenSocket_; }
     
     // Configuration
     void setMaxConnections(size_t maxConnections) { maxConnections_ = maxConnections; }
     void setReuseAddress(bool reuse) { reuseAddress_ = reuse; }
     
+    // Connections arriving below admission.minFreeHeapForAccept are closed
+    // right after accept() so clients fail fast instead of stalling
+    void setAdmissionConfig(const AdmissionConfig& admission) { admission_ = admission; }
+    
 private:
     // Socket setup
     int createListenSocket();
@@ -158,6 +191,7 @@ private:
     uint16_t port_;
     size_t maxConnections_;
     bool reuseAddress_;
+    AdmissionConfig admission_;
     
     // Server state
     int listenSocket_;
@@ -169,8 +203,10 @@ private:
         uint32_t connectionsAccepted;
         uint32_t connectionsClosed;
         uint32_t acceptErrors;
+        uint32_t connectionsRefused;
         
-        ServerStats() : connectionsAccepted(0), connectionsClosed(0), acceptErrors(0) {}
+        ServerStats() : connectionsAccepted(0), connectionsClosed(0), acceptErrors(0),
+                       connectionsRefused(0) {}
     };
     
     mutable ServerStats stats_;
@@ -187,6 +223,10 @@ namespace SocketUtils {
     int setSocketNonBlocking(int socket, bool nonBlocking = true);
     int setSocketReuseAddress(int socket, bool reuse = true);
     
+    // Gather-send every iovec, advancing through partial writes;
+    // returns 0 or -1 with errno set
+    int sendAllVectored(int socket, struct iovec* iov, int iovCount);
+    
     // Address helpers
     std::string formatAddress(const struct sockaddr_in& addr);
     int resolveHostname(const std::string& hostname, struct sockaddr_in& addr);
@@ -201,10 +241,12 @@ class MessageFraming {
 public:
     // Frame format: [4-byte length][message data]
     static int encodeMessage(const std::string& message, std::string& frame);
+    static void encodeHeader(size_t length, uint8_t header[4]);
     static int decodeMessage(const std::string& frame, std::string& message);
     
     // Streaming helpers
     static int sendFramedMessage(int socket, const std::string& message, uint32_t timeoutMs);
+    static int sendFramedMessage(int socket, const char* data, size_t length, uint32_t timeoutMs);
     static int receiveFramedMessage(int socket, std::string& message, uint32_t timeoutMs);
     
 private:
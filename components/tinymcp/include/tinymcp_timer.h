@@ -0,0 +1,112 @@
+#pragma once
+
+// Shared timer wheel for TinyMCP deadlines
+// Session idle timeouts, keep-alives and task timeouts run off one FreeRTOS software timer
+
+#include <cstddef>
+#include <cstdint>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/timers.h"
+
+namespace tinymcp {
+
+// Hashed timing wheel: SLOT_COUNT buckets of RESOLUTION_MS, deadlines
+// further out wait extra rounds. Arming and disarming are O(1) and
+// allocation-free since the caller owns the Timer; one one-shot software
+// timer is pointed at the next occupied slot, so an idle wheel costs no
+// wakeups at all.
+class TimerWheel {
+public:
+    static const size_t SLOT_COUNT = 64;
+    static const uint32_t RESOLUTION_MS = 100;
+
+    using Callback = void (*)(void* arg);
+
+    // One deadline, usually a member of the object it belongs to.
+    // Destroying an armed timer disarms it.
+    class Timer {
+    public:
+        Timer(Callback callback, void* arg);
+        ~Timer();
+
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+
+        bool isArmed() const { return armed_; }
+
+    private:
+        friend class TimerWheel;
+
+        Callback callback_;
+        void* arg_;
+        Timer* prev_;
+        Timer* next_;
+        uint32_t rounds_;           // Passes over the slot left before firing
+        uint8_t slot_;
+        bool armed_;
+    };
+
+    static TimerWheel& getInstance();
+
+    // Creates the lock and the software timer (once); later calls are no-ops
+    int initialize();
+    bool isInitialized() const { return timer_ != nullptr; }
+
+    // Fires `timer` once, at least `delayMs` from now (rounded up to the
+    // resolution); re-arming an armed timer moves it. Callbacks run on the
+    // timer service task with the wheel locked: they may arm or disarm
+    // timers and set flags or event bits, but must not block.
+    void arm(Timer& timer, uint32_t delayMs);
+
+    // On return the callback is neither pending nor running
+    void disarm(Timer& timer);
+
+    // Ticks until the wheel next fires, portMAX_DELAY when nothing is armed
+    TickType_t getNextExpiry();
+
+    // Statistics
+    struct Stats {
+        uint32_t armed;             // arm() calls
+        uint32_t fired;             // Callbacks run
+        uint32_t wakeups;           // Software timer expiries
+        uint32_t pending;           // Timers armed right now
+
+        Stats() : armed(0), fired(0), wakeups(0), pending(0) {}
+    };
+
+    Stats getStats();
+
+private:
+    TimerWheel();
+
+    static const uint8_t EXPIRED_SLOT = 0xff;
+
+    static void serviceCallback(TimerHandle_t handle);
+
+    uint32_t currentUnit() const;
+    uint32_t nextOccupiedDistance() const;
+    void link(Timer& timer, uint32_t unit);
+    void unlink(Timer& timer);
+    void advance();
+    void reschedule(TickType_t blockTicks);
+
+    static TimerWheel instance_;
+
+    Timer* slots_[SLOT_COUNT];
+    Timer* expired_;                // Due in the slot being run
+    uint64_t occupied_;             // Bit i: slots_[i] is non-empty
+    uint32_t position_;             // Last unit whose slot has run
+    uint32_t wakeUnit_;             // Unit the software timer is set for
+    bool scheduled_;
+    bool servicing_;
+    TickType_t origin_;
+    TickType_t resolutionTicks_;
+    SemaphoreHandle_t mutex_;
+    TimerHandle_t timer_;
+
+    Stats stats_;
+};
+
+} // namespace tinymcp
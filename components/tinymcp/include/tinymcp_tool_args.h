@@ -0,0 +1,211 @@
+#pragma once
+
+// Tool argument validation compiled from a tool's inputSchema
+// One pass over the arguments object checks them and fills typed, index-addressed slots
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "cJSON.h"
+
+namespace tinymcp {
+
+class ArgValidator;
+
+// Arguments of one tools/call after validation. Slot i holds the property at
+// position i of the schema's "properties"; name slots with
+// SchemaText::propertyIndex. Values point into the validated cJSON tree.
+class ToolArgs {
+public:
+    static constexpr size_t MAX_FIELDS = 16;
+
+    ToolArgs() : validator_(nullptr), slots_() {}
+
+    bool has(int index) const { return slots_[index].item != nullptr; }
+
+    int32_t getInt(int index, int32_t defaultValue) const {
+        return has(index) ? slots_[index].value : defaultValue;
+    }
+    double getNumber(int index, double defaultValue) const {
+        return has(index) ? slots_[index].item->valuedouble : defaultValue;
+    }
+    bool getBool(int index, bool defaultValue) const {
+        return has(index) ? slots_[index].value != 0 : defaultValue;
+    }
+    const char* getString(int index, const char* defaultValue = nullptr) const {
+        return has(index) ? slots_[index].item->valuestring : defaultValue;
+    }
+    // Position of the value in the property's enum list
+    int getEnum(int index, int defaultValue) const {
+        return has(index) ? static_cast<int>(slots_[index].value) : defaultValue;
+    }
+    // Arrays and objects; for an array, getInt() is its size
+    const cJSON* getItem(int index) const { return slots_[index].item; }
+
+    // Fills `out` from an element of the array argument at `index`. Elements
+    // were checked along with the arguments, so this cannot fail for them.
+    int getElement(int index, const cJSON* element, ToolArgs& out) const;
+
+private:
+    friend class ArgValidator;
+
+    struct Slot {
+        const cJSON* item;
+        int32_t value;          // Integer, boolean, enum position or array size
+    };
+
+    const ArgValidator* validator_;
+    Slot slots_[MAX_FIELDS];
+};
+
+// Object schema reduced to what validation needs: per property a type,
+// integer or item count range, enum set, required flag and, for arrays of
+// objects, a nested validator. Understands the output of the ToolHelpers
+// schema builders ("required" on the property or as a list of names).
+class ArgValidator {
+public:
+    enum class Type : uint8_t {
+        ANY,
+        STRING,
+        INTEGER,
+        NUMBER,
+        BOOLEAN,
+        ARRAY,
+        OBJECT
+    };
+
+    ArgValidator() {}
+
+    // TINYMCP_ERROR_INVALID_PARAMS for schemas that are not an object with
+    // at most ToolArgs::MAX_FIELDS properties
+    int compile(const cJSON* schema);
+
+    // A missing arguments object counts as empty. On failure `error` names
+    // the offending argument.
+    int validate(const cJSON* args, ToolArgs& out, std::string* error = nullptr) const;
+
+    size_t getFieldCount() const { return fields_.size(); }
+
+private:
+    friend class ToolArgs;
+
+    struct Field {
+        uint16_t name;          // Offsets into strings_
+        uint16_t enumValues;    // First of enumCount NUL-terminated values
+        uint8_t enumCount;
+        Type type;
+        bool required;
+        int8_t items;           // Index into children_, -1 without an object item schema
+        int32_t minimum;        // Value range for integers, item count for arrays
+        int32_t maximum;
+    };
+
+    int compileField(const char* name, const cJSON* property);
+    uint16_t addString(const char* text);
+    int findField(const char* name) const;
+    int checkValue(const Field& field, const cJSON* item, int32_t& value, std::string* error) const;
+
+    std::vector<Field> fields_;
+    std::string strings_;
+    std::vector<ArgValidator> children_;
+};
+
+// Reads a minified JSON schema at compile time, so handlers can name their
+// argument slots without repeating the property order:
+//
+//   static constexpr char SCHEMA[] = R"json({"type":"object","properties":{"pin":{...}}})json";
+//   static constexpr int ARG_PIN = SchemaText::propertyIndex(SCHEMA, "pin");
+namespace SchemaText {
+    // Not constexpr: a name that is not in the schema fails compilation
+    inline int propertyNotFound() { return -1; }
+
+    constexpr const char* skipString(const char* p) {
+        for (++p; *p && *p != '"'; ++p) {
+            if (*p == '\\' && p[1]) {
+                ++p;
+            }
+        }
+        return *p ? p + 1 : p;
+    }
+
+    constexpr const char* skipValue(const char* p) {
+        if (*p == '"') {
+            return skipString(p);
+        }
+        if (*p != '{' && *p != '[') {
+            while (*p && *p != ',' && *p != '}' && *p != ']') {
+                ++p;
+            }
+            return p;
+        }
+        int depth = 0;
+        do {
+            if (*p == '"') {
+                p = skipString(p);
+                continue;
+            }
+            if (*p == '{' || *p == '[') {
+                depth++;
+            } else if (*p == '}' || *p == ']') {
+                depth--;
+            }
+            ++p;
+        } while (*p && depth > 0);
+        return p;
+    }
+
+    constexpr bool keyEquals(const char* p, const char* key) {
+        for (++p; *key && *p == *key; ++p, ++key) {
+        }
+        return !*key && *p == '"';
+    }
+
+    // Position of `key` among the keys of the object at `object`, or -1
+    constexpr int keyIndex(const char* object, const char* key) {
+        if (!object || *object != '{') {
+            return -1;
+        }
+        const char* p = object + 1;
+        for (int index = 0; *p == '"'; index++) {
+            if (keyEquals(p, key)) {
+                return index;
+            }
+            p = skipString(p);
+            if (*p++ != ':') {
+                return -1;
+            }
+            p = skipValue(p);
+            if (*p++ != ',') {
+                return -1;
+            }
+        }
+        return -1;
+    }
+
+    // Value of `key` in the object at `object`, or nullptr
+    constexpr const char* findKey(const char* object, const char* key) {
+        int index = keyIndex(object, key);
+        if (index < 0) {
+            return nullptr;
+        }
+        const char* p = object + 1;
+        for (int i = 0; i < index; i++) {
+            p = skipValue(skipString(p) + 1) + 1;
+        }
+        return skipString(p) + 1;
+    }
+
+    constexpr int propertyIndex(const char* schema, const char* name) {
+        int index = keyIndex(findKey(schema, "properties"), name);
+        return index >= 0 ? index : propertyNotFound();
+    }
+
+    // Slot of `name` in the item schema of the array property `array`
+    constexpr int itemPropertyIndex(const char* schema, const char* array, const char* name) {
+        return propertyIndex(findKey(findKey(findKey(schema, "properties"), array), "items"), name);
+    }
+}
+
+} // namespace tinymcp
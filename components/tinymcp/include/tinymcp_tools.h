@@ -4,19 +4,66 @@
 // Provides concrete tool examples for ESP8266/ESP32 platforms
 
 #include "tinymcp_session.h"
+#include "tinymcp_network_scanner.h"
+#include "tinymcp_tool_args.h"
 #include <memory>
 #include <string>
 #include <functional>
 #include <climits>
+#include <atomic>
+#include <map>
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_system.h"
 #include "esp_log.h"
 
+// SPIFFS mount point for the file tools; the host build uses a local directory
+#ifndef TINYMCP_FS_BASE_PATH
+#define TINYMCP_FS_BASE_PATH "/spiffs"
+#endif
+
 namespace tinymcp {
 
-// Tool registry for managing available tools
+// Entry points of a tool as plain function pointers; they get arguments
+// already checked against the tool's input schema
+using ToolHandlerFn = int (*)(const ToolArgs& args, cJSON** result);
+using ToolTaskFactory = std::unique_ptr<AsyncTask> (*)(const MessageId& requestId, const ToolArgs& args);
+
+// Tool whose definition is all constants, so a table of them stays in
+// flash. The schema is minified JSON text that tools/list splices in as is.
+// Tables are sorted by name (checked with isSortedToolTable) for binary search.
+struct StaticToolDefinition {
+    const char* name;
+    const char* description;
+    const char* inputSchema;
+    ToolHandlerFn handler;          // Synchronous tools
+    ToolTaskFactory createTask;     // Async tools
+    uint32_t estimatedDurationMs;
+    int (*init)();                  // Run once when installed; the tool is left out unless
+                                    // it returns TINYMCP_SUCCESS. nullptr for none.
+};
+
+constexpr int compareToolNames(const char* a, const char* b) {
+    while (*a && *a == *b) {
+        ++a;
+        ++b;
+    }
+    return static_cast<unsigned char>(*a) - static_cast<unsigned char>(*b);
+}
+
+template <size_t N>
+constexpr bool isSortedToolTable(const StaticToolDefinition (&table)[N]) {
+    for (size_t i = 1; i < N; i++) {
+        if (compareToolNames(table[i - 1].name, table[i].name) >= 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Tool registry: a static table of built-in tools plus tools registered at
+// runtime. A runtime tool with the name of a static one replaces it.
 class ToolRegistry {
 public:
     // Tool definition structure
@@ -25,13 +72,15 @@ public:
         std::string description;
         cJSON* inputSchema;
         std::function<int(const cJSON*, cJSON**)> handler;
+        ToolTaskFactory createTask;     // Set for async tools
+        ArgValidator validator;         // Compiled from inputSchema by registerTool
         bool requiresAsync;
         uint32_t estimatedDurationMs;
         
         ToolDefinition(const std::string& n, const std::string& d, 
                       std::function<int(const cJSON*, cJSON**)> h,
                       bool async = false, uint32_t duration = 1000) :
-            name(n), description(d), inputSchema(nullptr), handler(h),
+            name(n), description(d), inputSchema(nullptr), handler(h), createTask(nullptr),
             requiresAsync(async), estimatedDurationMs(duration) {}
         
         ~ToolDefinition() {
@@ -41,25 +90,99 @@ public:
         }
     };
     
+    // Async tools estimated at or above this run at TaskPriority::LOW
+    static const uint32_t LONG_TASK_DURATION_MS = 5000;
+    
+    static const size_t MAX_STATIC_TOOLS = 32;
+    
     static ToolRegistry& getInstance();
     
+    // Installs a sorted table that outlives the registry. Nothing is run
+    // yet: each tool's schema is compiled and its init hook called the first
+    // time it is looked up, or all of them on the first listing. Entries
+    // whose init hook fails or whose schema does not compile are left out.
+    void setStaticTools(const StaticToolDefinition* tools, size_t count);
+    
     // Tool management
     void registerTool(std::unique_ptr<ToolDefinition> tool);
     void unregisterTool(const std::string& name);
     bool hasTool(const std::string& name) const;
-    const ToolDefinition* getTool(const std::string& name) const;
+    const ToolDefinition* getTool(const std::string& name) const;      // Runtime tools only
+    const StaticToolDefinition* getStaticTool(const std::string& name) const;
+    const char* getDescription(const std::string& name) const;         // Either kind; nullptr if unknown
     std::vector<std::string> getToolNames() const;
     
+    // Bumped on every register/unregister; 0 means no tool was ever registered
+    uint32_t getGeneration() const { return generation_; }
+    
+    // Minified tools/list "tools" array, rebuilt only when the generation
+    // changes and shared by every session until then
+    std::shared_ptr<const std::string> getToolsListPayload(uint32_t* generation = nullptr);
+    
+    // One tools/list page: the tools after `cursor` in name order whose
+    // serialized array fits in `budget` bytes. nextCursor is left empty on
+    // the last page. The first page is cached like the full payload.
+    struct ToolsPage {
+        std::shared_ptr<const std::string> tools;
+        std::string nextCursor;
+        uint32_t generation;
+        
+        ToolsPage() : generation(0) {}
+    };
+    
+    int getToolsPage(const std::string& cursor, size_t budget, size_t maxResults, ToolsPage& page);
+    
     // Tool execution
     std::unique_ptr<AsyncTask> createToolTask(const MessageId& requestId, 
                                              const std::string& toolName,
                                              const cJSON* arguments);
 
 private:
-    ToolRegistry() = default;
+    ToolRegistry() : staticTools_(nullptr), staticCount_(0), staticEnabled_(0), staticPrepared_(0),
+                     prepareMutex_(nullptr), registryMutex_(nullptr),
+                     generation_(0), cachedGeneration_(0), cachedFirstPageBudget_(0) {}
+    
+    // Compiles the schema and runs the init hook of each static tool in
+    // `mask` that has not been prepared yet. Callers do not hold registryMutex_.
+    void prepareStaticTools(uint32_t mask) const;
+    void prepareStaticTool(const std::string& name) const;
+    void prepareAllStaticTools() const;
+    
+    // Index of the static tool called `name`, staticCount_ if there is none
+    size_t findStaticIndex(const std::string& name) const;
+    
+    // Callers hold registryMutex_
+    const StaticToolDefinition* findStaticTool(const std::string& name) const;
+    const ArgValidator* getStaticValidator(const StaticToolDefinition* tool) const {
+        return &staticValidators_[tool - staticTools_];
+    }
+    
+    // Calls visit(name, tool, staticTool) for each tool named after `after`, in
+    // name order, until it returns false. Exactly one of the two is non-null.
+    template <typename Visitor>
+    void forEachTool(const std::string& after, Visitor visit) const;
+    
+    std::shared_ptr<const std::string> buildToolsListPayload() const;
+    int buildToolsPage(const std::string& cursor, size_t budget, size_t maxResults, ToolsPage& page) const;
+    
     static ToolRegistry instance_;
-    std::unordered_map<std::string, std::unique_ptr<ToolDefinition>> tools_;
+    const StaticToolDefinition* staticTools_;
+    // Filled in as tools are prepared; an entry is read only once its
+    // staticPrepared_ bit is set
+    mutable std::vector<ArgValidator> staticValidators_;     // One per staticTools_ entry
+    size_t staticCount_;
+    mutable uint32_t staticEnabled_;                // Bit i set when staticTools_[i] passed its init hook
+    mutable std::atomic<uint32_t> staticPrepared_;  // Bit i set once staticTools_[i] was prepared
+    SemaphoreHandle_t prepareMutex_;                // Runs each init hook once
+    std::map<std::string, std::unique_ptr<ToolDefinition>> tools_;   // Ordered for stable cursors
     SemaphoreHandle_t registryMutex_;
+    
+    // tools/list cache
+    std::atomic<uint32_t> generation_;
+    uint32_t cachedGeneration_;
+    std::shared_ptr<const std::string> cachedToolsList_;
+    ToolsPage cachedFirstPage_;
+    size_t cachedFirstPageBudget_;
 };
 
 // Base class for custom tool tasks
@@ -75,45 +198,112 @@ private:
     std::function<int(const cJSON*, cJSON**)> toolHandler_;
 };
 
+// Task for a synchronous static tool; the schema check runs on the task's own
+// copy of the arguments, which the handler's ToolArgs then point into
+class StaticToolTask : public CallToolTask {
+public:
+    StaticToolTask(const MessageId& requestId, const std::string& toolName, const cJSON* args,
+                   ToolHandlerFn handler, const ArgValidator& validator);
+    
+    bool isValid() const override;
+    const std::string& getValidationError() const { return validationError_; }
+    
+protected:
+    int executeToolLogic(const cJSON* args, cJSON** result) override;
+    
+private:
+    ToolHandlerFn handler_;
+    ToolArgs args_;
+    bool argsValid_;
+    std::string validationError_;
+};
+
 // Example tool implementations
 
 // System Information Tool
 class SystemInfoTool {
 public:
-    static void registerTool();
-    static int execute(const cJSON* args, cJSON** result);
+    static int execute(const ToolArgs& args, cJSON** result);
     
 private:
-    static cJSON* createInputSchema();
     static cJSON* getSystemInfo();
     static cJSON* getMemoryInfo();
     static cJSON* getWiFiInfo();
     static cJSON* getTaskInfo();
 };
 
-// GPIO Control Tool
+#if TINYMCP_METRICS
+// Server Statistics Tool: latency histograms and hot-path counters
+class ServerStatsTool {
+public:
+    static int execute(const ToolArgs& args, cJSON** result);
+    
+private:
+    static cJSON* getHeapInfo();
+    static cJSON* getExecutorStats();
+    static cJSON* getScannerStats();
+    static cJSON* getLogStats();
+    static cJSON* getTimerStats();
+};
+#endif
+
+// GPIO Control Tool. Pin modes are cached so a pin is reconfigured only when
+// its mode changes; gpio_batch applies levels as set/clear masks.
 class GPIOControlTool {
 public:
-    static void registerTool();
-    static int execute(const cJSON* args, cJSON** result);
+    static int init();
+    static int execute(const ToolArgs& args, cJSON** result);
+    static int executeBatch(const ToolArgs& args, cJSON** result);
     
 private:
-    static cJSON* createInputSchema();
+    static constexpr size_t PIN_COUNT = 17;
+    
+    enum class PinMode : uint8_t {
+        UNCONFIGURED,
+        INPUT,
+        INPUT_PULLUP,
+        OUTPUT,
+        OUTPUT_OD
+    };
+    
+    // One gpio_batch sequence entry: masks applied together, then a pause
+    struct SequenceStep {
+        uint32_t setMask;
+        uint32_t clearMask;
+        uint32_t delayUs;
+    };
+    
+    static const char* pinModeToString(PinMode mode);
+    static bool isOutputMode(PinMode mode);
+    static bool isValidPinMask(uint32_t mask);
+    
+    // Callers hold gpioMutex_
+    static int configurePins(uint32_t mask, PinMode mode);
+    static int writeLevels(uint32_t setMask, uint32_t clearMask);
+    static void waitUntil(int64_t deadlineUs);
+    
     static int setGPIOPin(int pin, bool state);
     static int getGPIOPin(int pin, bool* state);
     static bool isValidGPIOPin(int pin);
+    
+    static PinMode pinModes_[PIN_COUNT];
+    static SemaphoreHandle_t gpioMutex_;
 };
 
-// Network Scanner Tool (async example)
+// Network Scanner Tool (async). Results come from the shared NetworkScanner:
+// execute() never waits for the radio but returns unfinished, so the session
+// runs it again after taskPollIntervalMs until the scan is done.
 class NetworkScannerTask : public AsyncTask {
 public:
-    NetworkScannerTask(const MessageId& requestId, const cJSON* args);
+    NetworkScannerTask(const MessageId& requestId, const ToolArgs& args);
+    ~NetworkScannerTask() override;
     
     bool isValid() const override;
     int execute() override;
+    void cancel() override;
+    bool isWaiting() const override;
     
-    static void registerTool();
-    static std::unique_ptr<AsyncTask> create(const MessageId& requestId, const cJSON* args);
+    static std::unique_ptr<AsyncTask> create(const MessageId& requestId, const ToolArgs& args);
     
 private:
     struct ScanParams {
@@ -122,25 +312,32 @@ private:
         bool includeChannel;
         int maxResults;
         uint32_t timeoutMs;
+        uint32_t maxAgeMs;
+        NetworkScanner::Options options;
         
         ScanParams() : includeBSSID(true), includeRSSI(true), 
-                      includeChannel(true), maxResults(20), timeoutMs(10000) {}
+                      includeChannel(true), maxResults(20), timeoutMs(10000),
+                      maxAgeMs(CONFIG_TINYMCP_SCAN_CACHE_TTL_MS) {}
     };
     
     ScanParams params_;
-    cJSON* scanResults_;
+    uint32_t ticket_;
+    bool started_;
     
-    static cJSON* createInputSchema();
-    int performWiFiScan();
-    cJSON* formatScanResults();
-    void parseArguments(const cJSON* args);
+    cJSON* formatScanResults(const NetworkScanner::Result& scan);
+    void parseArguments(const ToolArgs& args);
 };
 
-// File System Tool
+// File System Tool. Reads return at most FILE_READ_MAX_LENGTH bytes from
+// an offset; larger files are paged or streamed with file_stream.
 class FileSystemTool {
 public:
-    static void registerTool();
-    static int execute(const cJSON* args, cJSON** result);
+    static int mount();
+    static int execute(const ToolArgs& args, cJSON** result);
+    
+    // Path validation and mapping onto the mount point, shared with FileStreamTask
+    static bool isValidPath(const std::string& path);
+    static std::string toFullPath(const std::string& path);
     
 private:
     enum class Operation {
@@ -151,36 +348,62 @@ private:
         GET_INFO
     };
     
-    static cJSON* createInputSchema();
-    static Operation parseOperation(const cJSON* args);
-    static int listFiles(const std::string& path, cJSON** result);
-    static int readFile(const std::string& filename, cJSON** result);
-    static int writeFile(const std::string& filename, const std::string& content, cJSON** result);
+    static int listFiles(cJSON** result);
+    static int readFile(const std::string& filename, uint32_t offset, uint32_t length, bool base64,
+                        cJSON** result);
+    static int writeFile(const std::string& filename, const std::string& content, bool append,
+                         cJSON** result);
     static int deleteFile(const std::string& filename, cJSON** result);
     static int getFileInfo(const std::string& filename, cJSON** result);
-    static bool isValidPath(const std::string& path);
 };
 
-// Echo/Test Tool (simple synchronous example)
-class EchoTool {
+// File Stream Tool (async): sends a file range as successive progress
+// notifications of FILE_CHUNK_SIZE bytes read into one reused buffer, so
+// memory use does not depend on the file size
+class FileStreamTask : public AsyncTask {
 public:
-    static void registerTool();
-    static int execute(const cJSON* args, cJSON** result);
+    FileStreamTask(const MessageId& requestId, const ToolArgs& args);
+    
+    bool isValid() const override;
+    int execute() override;
+    
+    static std::unique_ptr<AsyncTask> create(const MessageId& requestId, const ToolArgs& args);
     
 private:
-    static cJSON* createInputSchema();
+    struct StreamParams {
+        std::string path;
+        uint32_t offset;
+        uint32_t length;        // 0 streams to the end of the file
+        bool base64;
+        bool valid;
+        
+        StreamParams() : offset(0), length(0), base64(false), valid(false) {}
+    };
+    
+    StreamParams params_;
+    char chunk_[FILE_CHUNK_SIZE];
+    char encoded_[(FILE_CHUNK_SIZE + 2) / 3 * 4 + 1];
+    
+    void parseArguments(const ToolArgs& args);
+    int streamFile(uint32_t& bytesSent, uint32_t& chunksSent, uint32_t& fileSize);
+};
+
+// Echo/Test Tool (simple synchronous example)
+class EchoTool {
+public:
+    static int execute(const ToolArgs& args, cJSON** result);
 };
 
 // Long Running Task Example (demonstrates progress reporting)
 class LongRunningTask : public AsyncTask {
 public:
-    LongRunningTask(const MessageId& requestId, const cJSON* args);
+    LongRunningTask(const MessageId& requestId, const ToolArgs& args);
     
     bool isValid() const override;
     int execute() override;
     
     static void registerTool();
-    static std::unique_ptr<AsyncTask> create(const MessageId& requestId, const cJSON* args);
+    static std::unique_ptr<AsyncTask> create(const MessageId& requestId, const ToolArgs& args);
     
 private:
     struct TaskParams {
@@ -194,8 +417,7 @@ private:
     
     TaskParams params_;
     
-    static cJSON* createInputSchema();
-    void parseArguments(const cJSON* args);
+    void parseArguments(const ToolArgs& args);
     int performLongRunningWork();
 };
 
@@ -203,7 +425,7 @@ private:
 class I2CScannerTool {
 public:
     static void registerTool();
-    static int execute(const cJSON* args, cJSON** result);
+    static int execute(const ToolArgs& args, cJSON** result);
     
 private:
     static cJSON* createInputSchema();
@@ -218,6 +440,7 @@ namespace ToolHelpers {
     cJSON* createIntegerProperty(const std::string& description, int min = INT_MIN, int max = INT_MAX, bool required = false);
     cJSON* createBooleanProperty(const std::string& description, bool required = false);
     cJSON* createEnumProperty(const std::string& description, const std::vector<std::string>& values, bool required = false);
+    cJSON* createArrayProperty(const std::string& description, cJSON* items, int maxItems = INT_MAX, bool required = false);
     cJSON* createObjectSchema(const std::vector<std::pair<std::string, cJSON*>>& properties);
     
     // Validation helpers
@@ -235,6 +458,10 @@ namespace ToolHelpers {
     std::string formatDuration(uint32_t milliseconds);
     bool isValidFileName(const std::string& filename);
     std::string sanitizePath(const std::string& path);
+    
+    // Base64 (RFC 4648, padded); out must hold (length + 2) / 3 * 4 + 1 bytes
+    size_t base64Encode(const uint8_t* data, size_t length, char* out);
+    bool base64Decode(const std::string& in, std::string& out);
 }
 
 // Auto-registration helper macro
@@ -243,7 +470,7 @@ namespace ToolHelpers {
         ToolClass::registerTool(); \
     }
 
-// Default tool registration function
+// Default tool registration function: installs the built-in static tool table
 void registerDefaultTools();
 
 } // namespace tinymcp
\ No newline at end of file
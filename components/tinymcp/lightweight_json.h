@@ -207,7 +207,7 @@ public:
             char* str = cJSON_Print(m_json);
             if (str) {
                 std::string result(str);
-                free(str);
+                cJSON_free(str);
                 return result;
             }
         }
@@ -221,7 +221,7 @@ public:
             if (str) {
                 printf("DEBUG: Serialized JSON: '%s'\n", str);
                 std::string result(str);
-                free(str);
+                cJSON_free(str);
                 return result;
             } else {
                 printf("DEBUG: ERROR - cJSON_PrintUnformatted returned NULL!\n");
@@ -236,7 +236,12 @@ public:
 class JsonReader {
 public:
     bool parse(const std::string& json, JsonValue& root) {
-        cJSON* parsed = cJSON_Parse(json.c_str());
+        return parse(json.c_str(), root);
+    }
+
+    // Parses a NUL-terminated buffer in place, e.g. a transport frame view
+    bool parse(const char* json, JsonValue& root) {
+        cJSON* parsed = cJSON_Parse(json);
         if (parsed) {
             root = JsonValue(parsed, true);
             return true;
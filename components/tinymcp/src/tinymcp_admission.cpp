@@ -0,0 +1,48 @@
+// Heap-based admission control for TinyMCP
+// Maps the current free heap onto the watermarks of an AdmissionConfig
+
+#include "tinymcp_admission.h"
+
+#include "esp_system.h"
+#include "sdkconfig.h"
+
+#if defined(CONFIG_IDF_TARGET_ESP32)
+#include "esp_heap_caps.h"
+#endif
+
+namespace tinymcp {
+
+uint32_t AdmissionControl::getFreeHeap() {
+    return esp_get_free_heap_size();
+}
+
+uint32_t AdmissionControl::getLargestFreeBlock() {
+#if defined(CONFIG_IDF_TARGET_ESP32)
+    return heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+#else
+    // ESP8266 has no heap_caps; free heap is the best available bound
+    return esp_get_free_heap_size();
+#endif
+}
+
+AdmissionLevel AdmissionControl::evaluate(const AdmissionConfig& config) {
+    uint32_t freeHeap = getFreeHeap();
+
+    if (freeHeap < config.minFreeHeapForReads) {
+        return AdmissionLevel::PAUSE_READS;
+    }
+
+    if (freeHeap < config.minFreeHeapForRequests ||
+        (config.minLargestBlockForRequests > 0 &&
+         getLargestFreeBlock() < config.minLargestBlockForRequests)) {
+        return AdmissionLevel::REJECT_REQUESTS;
+    }
+
+    if (freeHeap < config.minFreeHeapForAccept) {
+        return AdmissionLevel::REFUSE_CONNECTIONS;
+    }
+
+    return AdmissionLevel::NORMAL;
+}
+
+} // namespace tinymcp
@@ -0,0 +1,201 @@
+// Per-request bump arena for cJSON allocations
+// Parse, dispatch and response building share one block that is reset at once
+
+#include "tinymcp_arena.h"
+#include "tinymcp_constants.h"
+
+#include "cJSON.h"
+#include "esp_log.h"
+#include <cstdlib>
+#include <new>
+
+static const char* TAG = "tinymcp_arena";
+
+namespace tinymcp {
+
+// JsonArena implementation
+void JsonArena::attach(uint8_t* block, size_t capacity) {
+    block_ = block;
+    capacity_ = capacity;
+    offset_ = 0;
+}
+
+void* JsonArena::allocate(size_t size) {
+    // Keep every allocation aligned for the doubles inside cJSON nodes
+    const size_t align = alignof(double);
+    size_t start = (offset_ + align - 1) & ~(align - 1);
+
+    if (!block_ || size > capacity_ || start > capacity_ - size) {
+        return nullptr;
+    }
+
+    offset_ = start + size;
+    return block_ + start;
+}
+
+// JsonArenaPool implementation
+JsonArenaPool JsonArenaPool::instance_;
+
+JsonArenaPool::JsonArenaPool() : arenaCount_(0), initialized_(false) {
+    for (size_t i = 0; i < MAX_ARENAS; ++i) {
+        inUse_[i] = false;
+    }
+    for (size_t i = 0; i < MAX_BINDINGS; ++i) {
+        bindings_[i].task = nullptr;
+        bindings_[i].arena = nullptr;
+    }
+}
+
+JsonArenaPool& JsonArenaPool::getInstance() {
+    return instance_;
+}
+
+int JsonArenaPool::initialize(size_t arenaCount, size_t arenaSize) {
+    if (initialized_) {
+        return TINYMCP_SUCCESS;
+    }
+
+    if (arenaCount > MAX_ARENAS) {
+        arenaCount = MAX_ARENAS;
+    }
+
+    // Blocks live for the lifetime of the firmware, so allocate them once
+    for (size_t i = 0; i < arenaCount; ++i) {
+        uint8_t* block = new (std::nothrow) uint8_t[arenaSize];
+        if (!block) {
+            ESP_LOGW(TAG, "Only %u of %u arenas allocated", (unsigned)i, (unsigned)arenaCount);
+            break;
+        }
+        arenas_[i].attach(block, arenaSize);
+        arenaCount_++;
+    }
+
+    cJSON_Hooks hooks;
+    hooks.malloc_fn = hookMalloc;
+    hooks.free_fn = hookFree;
+    cJSON_InitHooks(&hooks);
+
+    initialized_ = true;
+    ESP_LOGI(TAG, "JSON arena pool ready: %u x %u bytes", (unsigned)arenaCount_, (unsigned)arenaSize);
+    return arenaCount_ > 0 ? TINYMCP_SUCCESS : TINYMCP_ERROR_OUT_OF_MEMORY;
+}
+
+JsonArena* JsonArenaPool::acquire() {
+    JsonArena* arena = nullptr;
+
+    vTaskSuspendAll();
+    for (size_t i = 0; i < arenaCount_; ++i) {
+        if (!inUse_[i]) {
+            inUse_[i] = true;
+            arena = &arenas_[i];
+            break;
+        }
+    }
+    xTaskResumeAll();
+
+    if (!arena && initialized_) {
+        stats_.exhausted++;
+    }
+
+    return arena;
+}
+
+void JsonArenaPool::release(JsonArena* arena) {
+    if (!arena) {
+        return;
+    }
+
+    if (arena->used() > stats_.peakUsage) {
+        stats_.peakUsage = arena->used();
+    }
+
+    arena->reset();
+    stats_.resets++;
+
+    vTaskSuspendAll();
+    for (size_t i = 0; i < arenaCount_; ++i) {
+        if (&arenas_[i] == arena) {
+            inUse_[i] = false;
+            break;
+        }
+    }
+    xTaskResumeAll();
+}
+
+JsonArena* JsonArenaPool::getCurrent() const {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    for (size_t i = 0; i < MAX_BINDINGS; ++i) {
+        if (bindings_[i].task == self) {
+            return bindings_[i].arena;
+        }
+    }
+    return nullptr;
+}
+
+void JsonArenaPool::setCurrent(JsonArena* arena) {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+
+    vTaskSuspendAll();
+    Binding* freeSlot = nullptr;
+    Binding* ownSlot = nullptr;
+    for (size_t i = 0; i < MAX_BINDINGS; ++i) {
+        if (bindings_[i].task == self) {
+            ownSlot = &bindings_[i];
+        } else if (!bindings_[i].task && !freeSlot) {
+            freeSlot = &bindings_[i];
+        }
+    }
+
+    if (!arena) {
+        if (ownSlot) {
+            ownSlot->task = nullptr;
+            ownSlot->arena = nullptr;
+        }
+    } else if (Binding* slot = ownSlot ? ownSlot : freeSlot) {
+        slot->task = self;
+        slot->arena = arena;
+    }
+    // No slot left: the task simply keeps using the heap
+    xTaskResumeAll();
+}
+
+void* JsonArenaPool::hookMalloc(size_t size) {
+    JsonArena* arena = instance_.getCurrent();
+    if (arena) {
+        void* ptr = arena->allocate(size);
+        if (ptr) {
+            instance_.stats_.arenaAllocations++;
+            instance_.stats_.arenaBytes += size;
+            return ptr;
+        }
+        instance_.stats_.heapFallbacks++;
+    }
+    return malloc(size);
+}
+
+void JsonArenaPool::hookFree(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+
+    // Arena memory is reclaimed wholesale by release()
+    for (size_t i = 0; i < instance_.arenaCount_; ++i) {
+        if (instance_.arenas_[i].owns(ptr)) {
+            return;
+        }
+    }
+    free(ptr);
+}
+
+// ArenaScope implementation
+ArenaScope::ArenaScope(JsonArena* arena) {
+    JsonArenaPool& pool = JsonArenaPool::getInstance();
+    previous_ = pool.getCurrent();
+    pool.setCurrent(arena);
+}
+
+ArenaScope::~ArenaScope() {
+    JsonArenaPool::getInstance().setCurrent(previous_);
+}
+
+} // namespace tinymcp
@@ -0,0 +1,322 @@
+// CBOR Codec for TinyMCP
+// Header and number encoding for JsonWriter, recursive decoding into cJSON
+
+#include "tinymcp_cbor.h"
+
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <string>
+
+namespace tinymcp {
+
+const char* wireFormatToString(WireFormat format) {
+    switch (format) {
+        case WireFormat::JSON: return "json";
+        case WireFormat::CBOR: return "cbor";
+        default: return "unknown";
+    }
+}
+
+bool wireFormatFromString(const char* name, WireFormat& format) {
+    if (!name) {
+        return false;
+    }
+    if (strcmp(name, "json") == 0) {
+        format = WireFormat::JSON;
+        return true;
+    }
+    if (strcmp(name, "cbor") == 0) {
+        format = WireFormat::CBOR;
+        return true;
+    }
+    return false;
+}
+
+namespace Cbor {
+
+size_t encodeHeader(uint8_t major, uint64_t argument, uint8_t* out) {
+    if (argument < 24) {
+        out[0] = major | static_cast<uint8_t>(argument);
+        return 1;
+    }
+
+    uint8_t info;
+    size_t bytes;
+    if (argument <= 0xFF) {
+        info = 24;
+        bytes = 1;
+    } else if (argument <= 0xFFFF) {
+        info = 25;
+        bytes = 2;
+    } else if (argument <= 0xFFFFFFFFull) {
+        info = 26;
+        bytes = 4;
+    } else {
+        info = 27;
+        bytes = 8;
+    }
+
+    out[0] = major | info;
+    for (size_t i = 0; i < bytes; i++) {
+        out[bytes - i] = static_cast<uint8_t>(argument >> (8 * i));
+    }
+    return bytes + 1;
+}
+
+size_t encodeNumber(double number, uint8_t* out) {
+    if (number != number || number > DBL_MAX || number < -DBL_MAX) {
+        out[0] = NULL_VALUE;
+        return 1;
+    }
+
+    // Every integer up to 2^53 is exact in a double
+    if (number == std::floor(number) && std::fabs(number) <= 9007199254740992.0) {
+        if (number >= 0) {
+            return encodeHeader(MAJOR_UNSIGNED, static_cast<uint64_t>(number), out);
+        }
+        return encodeHeader(MAJOR_NEGATIVE, static_cast<uint64_t>(-1.0 - number), out);
+    }
+
+    float single = static_cast<float>(number);
+    if (static_cast<double>(single) == number) {
+        uint32_t bits;
+        memcpy(&bits, &single, sizeof(bits));
+        out[0] = FLOAT32;
+        for (size_t i = 0; i < 4; i++) {
+            out[4 - i] = static_cast<uint8_t>(bits >> (8 * i));
+        }
+        return 5;
+    }
+
+    uint64_t bits;
+    memcpy(&bits, &number, sizeof(bits));
+    out[0] = FLOAT64;
+    for (size_t i = 0; i < 8; i++) {
+        out[8 - i] = static_cast<uint8_t>(bits >> (8 * i));
+    }
+    return 9;
+}
+
+namespace {
+
+struct Reader {
+    const uint8_t* pos;
+    const uint8_t* end;
+    std::string scratch;    // NUL-terminated copy of the current text for cJSON
+};
+
+bool readArgument(Reader& reader, uint8_t info, uint64_t& argument, bool& indefinite) {
+    indefinite = false;
+    if (info < 24) {
+        argument = info;
+        return true;
+    }
+    if (info == INDEFINITE) {
+        indefinite = true;
+        return true;
+    }
+    if (info > 27) {
+        return false;
+    }
+
+    size_t bytes = static_cast<size_t>(1) << (info - 24);
+    if (static_cast<size_t>(reader.end - reader.pos) < bytes) {
+        return false;
+    }
+    argument = 0;
+    for (size_t i = 0; i < bytes; i++) {
+        argument = (argument << 8) | *reader.pos++;
+    }
+    return true;
+}
+
+double decodeHalf(uint16_t half) {
+    int exponent = (half >> 10) & 0x1F;
+    int mantissa = half & 0x3FF;
+    double value;
+    if (exponent == 0) {
+        value = std::ldexp(mantissa, -24);
+    } else if (exponent != 31) {
+        value = std::ldexp(mantissa + 1024, exponent - 25);
+    } else {
+        value = mantissa == 0 ? INFINITY : NAN;
+    }
+    return (half & 0x8000) ? -value : value;
+}
+
+// Appends a definite text string or the chunks of an indefinite one
+bool readText(Reader& reader, uint64_t length, bool indefinite, std::string& out) {
+    if (!indefinite) {
+        if (length > static_cast<uint64_t>(reader.end - reader.pos)) {
+            return false;
+        }
+        out.append(reinterpret_cast<const char*>(reader.pos), static_cast<size_t>(length));
+        reader.pos += length;
+        return true;
+    }
+
+    while (reader.pos < reader.end && *reader.pos != BREAK) {
+        uint8_t initial = *reader.pos++;
+        uint64_t chunkLength;
+        bool chunkIndefinite;
+        if ((initial & 0xE0) != MAJOR_TEXT ||
+            !readArgument(reader, initial & 0x1F, chunkLength, chunkIndefinite) || chunkIndefinite ||
+            !readText(reader, chunkLength, false, out)) {
+            return false;
+        }
+    }
+    if (reader.pos == reader.end) {
+        return false;
+    }
+    reader.pos++;
+    return true;
+}
+
+// Definite containers count their items down, indefinite ones end at BREAK
+bool atContainerEnd(Reader& reader, uint64_t& remaining, bool indefinite) {
+    if (indefinite) {
+        if (reader.pos < reader.end && *reader.pos == BREAK) {
+            reader.pos++;
+            return true;
+        }
+        return false;
+    }
+    if (remaining == 0) {
+        return true;
+    }
+    remaining--;
+    return false;
+}
+
+cJSON* decodeItem(Reader& reader, uint32_t depth) {
+    if (reader.pos >= reader.end || depth > MAX_DEPTH) {
+        return nullptr;
+    }
+
+    uint8_t initial = *reader.pos++;
+    uint8_t major = initial & 0xE0;
+    uint8_t info = initial & 0x1F;
+    uint64_t argument = 0;
+    bool indefinite;
+    if (!readArgument(reader, info, argument, indefinite)) {
+        return nullptr;
+    }
+
+    switch (major) {
+        case MAJOR_UNSIGNED:
+            return indefinite ? nullptr : cJSON_CreateNumber(static_cast<double>(argument));
+
+        case MAJOR_NEGATIVE:
+            return indefinite ? nullptr : cJSON_CreateNumber(-1.0 - static_cast<double>(argument));
+
+        case MAJOR_TEXT:
+            reader.scratch.clear();
+            if (!readText(reader, argument, indefinite, reader.scratch)) {
+                return nullptr;
+            }
+            return cJSON_CreateString(reader.scratch.c_str());
+
+        case MAJOR_ARRAY: {
+            cJSON* array = cJSON_CreateArray();
+            if (!array) {
+                return nullptr;
+            }
+            while (!atContainerEnd(reader, argument, indefinite)) {
+                cJSON* item = decodeItem(reader, depth + 1);
+                if (!item) {
+                    cJSON_Delete(array);
+                    return nullptr;
+                }
+                cJSON_AddItemToArray(array, item);
+            }
+            return array;
+        }
+
+        case MAJOR_MAP: {
+            cJSON* object = cJSON_CreateObject();
+            if (!object) {
+                return nullptr;
+            }
+            std::string key;
+            while (!atContainerEnd(reader, argument, indefinite)) {
+                // JSON objects only have text keys
+                uint64_t keyLength = 0;
+                bool keyIndefinite;
+                key.clear();
+                if (reader.pos >= reader.end || (*reader.pos & 0xE0) != MAJOR_TEXT) {
+                    cJSON_Delete(object);
+                    return nullptr;
+                }
+                uint8_t keyInfo = *reader.pos++ & 0x1F;
+                if (!readArgument(reader, keyInfo, keyLength, keyIndefinite) ||
+                    !readText(reader, keyLength, keyIndefinite, key)) {
+                    cJSON_Delete(object);
+                    return nullptr;
+                }
+
+                cJSON* item = decodeItem(reader, depth + 1);
+                if (!item) {
+                    cJSON_Delete(object);
+                    return nullptr;
+                }
+                cJSON_AddItemToObject(object, key.c_str(), item);
+            }
+            return object;
+        }
+
+        case MAJOR_TAG:
+            // Tags carry no meaning in the JSON data model; keep the content.
+            // Each tag counts as a level, so a chain of them is bounded too.
+            return indefinite ? nullptr : decodeItem(reader, depth + 1);
+
+        case MAJOR_SIMPLE:
+            switch (info) {
+                case 20: return cJSON_CreateFalse();
+                case 21: return cJSON_CreateTrue();
+                case 22:
+                case 23: return cJSON_CreateNull();
+                case 25: return cJSON_CreateNumber(decodeHalf(static_cast<uint16_t>(argument)));
+                case 26: {
+                    uint32_t bits = static_cast<uint32_t>(argument);
+                    float single;
+                    memcpy(&single, &bits, sizeof(single));
+                    return cJSON_CreateNumber(single);
+                }
+                case 27: {
+                    double number;
+                    memcpy(&number, &argument, sizeof(number));
+                    return cJSON_CreateNumber(number);
+                }
+                default:
+                    return nullptr;
+            }
+
+        default:
+            // Byte strings have no JSON equivalent
+            return nullptr;
+    }
+}
+
+} // namespace
+
+cJSON* decode(const char* data, size_t length) {
+    if (!data || length == 0) {
+        return nullptr;
+    }
+
+    Reader reader;
+    reader.pos = reinterpret_cast<const uint8_t*>(data);
+    reader.end = reader.pos + length;
+
+    cJSON* root = decodeItem(reader, 1);
+    if (root && reader.pos != reader.end) {
+        cJSON_Delete(root);
+        return nullptr;
+    }
+    return root;
+}
+
+} // namespace Cbor
+
+} // namespace tinymcp
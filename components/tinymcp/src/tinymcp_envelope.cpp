@@ -0,0 +1,317 @@
+// JSON-RPC envelope scanner for TinyMCP
+// Routing and admission look at these spans before, or instead of, a full parse
+
+#include "tinymcp_envelope.h"
+#include "tinymcp_message.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace tinymcp {
+
+namespace {
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+const char* skipSpace(const char* p, const char* end) {
+    while (p < end && isSpace(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+// Past the closing quote of the string at p, or nullptr if unterminated
+const char* skipString(const char* p, const char* end, bool* escaped = nullptr) {
+    for (++p; p < end; ++p) {
+        if (*p == '"') {
+            return p + 1;
+        }
+        if (*p == '\\') {
+            if (escaped) {
+                *escaped = true;
+            }
+            ++p;
+        }
+    }
+    return nullptr;
+}
+
+// Past the value at p: strings must terminate and brackets balance, scalars
+// are taken up to the next delimiter
+const char* skipValue(const char* p, const char* end) {
+    if (p >= end) {
+        return nullptr;
+    }
+    if (*p == '"') {
+        return skipString(p, end);
+    }
+    if (*p != '{' && *p != '[') {
+        const char* start = p;
+        while (p < end && !isSpace(*p) && *p != ',' && *p != '}' && *p != ']') {
+            ++p;
+        }
+        return p > start ? p : nullptr;
+    }
+
+    // Bit n is set while nesting level n is an object
+    uint64_t objects = 0;
+    uint32_t depth = 0;
+    while (p < end) {
+        char c = *p;
+        if (c == '"') {
+            p = skipString(p, end);
+            if (!p) {
+                return nullptr;
+            }
+            continue;
+        }
+        if (c == '{' || c == '[') {
+            if (depth == JsonRpcEnvelope::MAX_DEPTH) {
+                return nullptr;
+            }
+            objects = (objects & ~(1ULL << depth)) | (static_cast<uint64_t>(c == '{') << depth);
+            depth++;
+        } else if (c == '}' || c == ']') {
+            depth--;
+            if (((objects >> depth) & 1) != (c == '}')) {
+                return nullptr;
+            }
+            if (depth == 0) {
+                return p + 1;
+            }
+        }
+        ++p;
+    }
+    return nullptr;
+}
+
+bool hasEscape(std::string_view span) {
+    return span.find('\\') != std::string_view::npos;
+}
+
+// Value of a scanned span as a cJSON item; escape-free strings are copied
+// directly, everything else goes through the parser
+cJSON* createItem(std::string_view span) {
+    if (span.size() >= 2 && span.front() == '"' && !hasEscape(span)) {
+        return cJSON_CreateString(std::string(span.substr(1, span.size() - 2)).c_str());
+    }
+    const char* parseEnd = nullptr;
+    cJSON* item = cJSON_ParseWithOpts(span.data(), &parseEnd, false);
+    if (item && parseEnd != span.data() + span.size()) {
+        cJSON_Delete(item);
+        return nullptr;
+    }
+    return item;
+}
+
+bool addItem(cJSON* root, const char* key, std::string_view span) {
+    if (span.empty()) {
+        return true;
+    }
+    cJSON* item = createItem(span);
+    if (!item) {
+        return false;
+    }
+    cJSON_AddItemToObject(root, key, item);
+    return true;
+}
+
+} // namespace
+
+void JsonRpcEnvelope::reset() {
+    kind_ = Kind::INVALID;
+    plain_ = true;
+    jsonrpc_ = std::string_view();
+    id_ = std::string_view();
+    method_ = std::string_view();
+    params_ = std::string_view();
+    result_ = std::string_view();
+    error_ = std::string_view();
+}
+
+int JsonRpcEnvelope::scan(const char* data, size_t length) {
+    reset();
+    if (!data) {
+        return TINYMCP_ERROR_INVALID_MESSAGE;
+    }
+
+    const char* end = data + length;
+    const char* p = skipSpace(data, end);
+    if (p < end && *p == '[') {
+        p = skipValue(p, end);
+        if (!p || skipSpace(p, end) != end) {
+            return TINYMCP_ERROR_INVALID_MESSAGE;
+        }
+        kind_ = Kind::BATCH;
+        return TINYMCP_SUCCESS;
+    }
+    if (p == end || *p != '{') {
+        return TINYMCP_ERROR_INVALID_MESSAGE;
+    }
+
+    p = skipSpace(p + 1, end);
+    if (p < end && *p == '}') {
+        ++p;
+    } else {
+        for (;;) {
+            if (p == end || *p != '"') {
+                return TINYMCP_ERROR_INVALID_MESSAGE;
+            }
+            bool escaped = false;
+            const char* keyEnd = skipString(p, end, &escaped);
+            if (!keyEnd) {
+                return TINYMCP_ERROR_INVALID_MESSAGE;
+            }
+            std::string_view key(p + 1, keyEnd - p - 2);
+
+            p = skipSpace(keyEnd, end);
+            if (p == end || *p != ':') {
+                return TINYMCP_ERROR_INVALID_MESSAGE;
+            }
+            const char* value = skipSpace(p + 1, end);
+            p = skipValue(value, end);
+            if (!p) {
+                return TINYMCP_ERROR_INVALID_MESSAGE;
+            }
+            std::string_view span(value, p - value);
+
+            std::string_view* slot = nullptr;
+            if (!escaped) {
+                if (key == MSG_KEY_JSONRPC) {
+                    slot = &jsonrpc_;
+                } else if (key == MSG_KEY_ID) {
+                    slot = &id_;
+                } else if (key == MSG_KEY_METHOD) {
+                    slot = &method_;
+                } else if (key == MSG_KEY_PARAMS) {
+                    slot = &params_;
+                } else if (key == MSG_KEY_RESULT) {
+                    slot = &result_;
+                } else if (key == MSG_KEY_ERROR) {
+                    slot = &error_;
+                }
+            }
+            // Unknown or repeated members and responses are left to the
+            // full parser
+            if (!slot || !slot->empty() || slot == &result_ || slot == &error_) {
+                plain_ = false;
+            }
+            if (slot && slot->empty()) {
+                *slot = span;
+            }
+
+            p = skipSpace(p, end);
+            if (p < end && *p == ',') {
+                p = skipSpace(p + 1, end);
+                continue;
+            }
+            if (p < end && *p == '}') {
+                ++p;
+                break;
+            }
+            return TINYMCP_ERROR_INVALID_MESSAGE;
+        }
+    }
+
+    if (skipSpace(p, end) != end) {
+        return TINYMCP_ERROR_INVALID_MESSAGE;
+    }
+    if (method_.size() < 2 || method_.front() != '"' || hasEscape(method_)) {
+        plain_ = false;
+    }
+    kind_ = Kind::OBJECT;
+    return TINYMCP_SUCCESS;
+}
+
+MessageCategory JsonRpcEnvelope::getCategory() const {
+    if (kind_ != Kind::OBJECT) {
+        return MessageCategory::UNKNOWN;
+    }
+    bool hasMethod = !method_.empty();
+    if (hasMethod) {
+        return hasId() ? MessageCategory::REQUEST : MessageCategory::NOTIFICATION;
+    }
+    if (hasId() && (!result_.empty() || !error_.empty())) {
+        return MessageCategory::RESPONSE;
+    }
+    return MessageCategory::UNKNOWN;
+}
+
+bool JsonRpcEnvelope::getMethod(std::string_view& method) const {
+    if (method_.size() < 2 || method_.front() != '"' || hasEscape(method_)) {
+        return false;
+    }
+    method = method_.substr(1, method_.size() - 2);
+    return true;
+}
+
+bool JsonRpcEnvelope::getStringId(std::string_view& id) const {
+    if (id_.size() < 2 || id_.front() != '"' || hasEscape(id_)) {
+        return false;
+    }
+    id = id_.substr(1, id_.size() - 2);
+    return true;
+}
+
+bool JsonRpcEnvelope::getId(MessageId& id) const {
+    if (id_.empty()) {
+        return false;
+    }
+    if (id_.front() == '"') {
+        if (!hasEscape(id_)) {
+            id = MessageId(std::string(id_.substr(1, id_.size() - 2)));
+            return true;
+        }
+        cJSON* item = createItem(id_);
+        bool valid = cJSON_IsString(item);
+        if (valid) {
+            id = MessageId(std::string(item->valuestring));
+        }
+        cJSON_Delete(item);
+        return valid;
+    }
+
+    // Numbers end at a delimiter that is still inside the frame, so strtod
+    // cannot run past the span; the character check keeps out what strtod
+    // accepts beyond JSON (hex, inf, nan)
+    if (id_.find_first_not_of("0123456789+-.eE") != std::string_view::npos) {
+        return false;
+    }
+    char* numberEnd = nullptr;
+    double number = strtod(id_.data(), &numberEnd);
+    if (numberEnd != id_.data() + id_.size()) {
+        return false;
+    }
+    id = MessageId(static_cast<int>(number));
+    return true;
+}
+
+cJSON* JsonRpcEnvelope::buildTree() const {
+    if (!canBuildTree()) {
+        return nullptr;
+    }
+    cJSON* root = cJSON_CreateObject();
+    if (!root) {
+        return nullptr;
+    }
+    if (!addItem(root, MSG_KEY_JSONRPC, jsonrpc_) || !addItem(root, MSG_KEY_ID, id_) ||
+        !addItem(root, MSG_KEY_METHOD, method_) || !addItem(root, MSG_KEY_PARAMS, params_)) {
+        cJSON_Delete(root);
+        return nullptr;
+    }
+    return root;
+}
+
+bool JsonRpcEnvelope::looksLikeHttp(const char* data, size_t length) {
+    size_t i = 0;
+    while (i < length && ((data[i] >= 'A' && data[i] <= 'Z') || (data[i] >= 'a' && data[i] <= 'z') ||
+                          data[i] == '-')) {
+        i++;
+    }
+    return i >= 3 && i < length && (data[i] == ' ' || data[i] == ':');
+}
+
+} // namespace tinymcp
@@ -0,0 +1,246 @@
+// Shared worker pool for TinyMCP async tool tasks
+// Runs AsyncTask::execute() off the session tasks, with a fast lane for short tools
+
+#include "tinymcp_executor.h"
+#include "tinymcp_session.h"
+
+#include "esp_log.h"
+#include <algorithm>
+#include <cstdio>
+
+static const char* TAG = "tinymcp_executor";
+
+namespace tinymcp {
+
+TaskExecutor TaskExecutor::instance_;
+
+TaskExecutor::TaskExecutor() :
+    workerCount_(0), nextSequence_(0), mutex_(nullptr), initialized_(false) {
+    
+    for (auto& worker : workers_) {
+        worker.handle = nullptr;
+        worker.fastLaneOnly = false;
+    }
+}
+
+TaskExecutor& TaskExecutor::getInstance() {
+    return instance_;
+}
+
+int TaskExecutor::initialize(size_t workerCount, uint32_t stackSize, UBaseType_t priority) {
+    if (initialized_) {
+        return TINYMCP_SUCCESS;
+    }
+    
+    mutex_ = xSemaphoreCreateMutex();
+    if (!mutex_) {
+        return TINYMCP_ERROR_OUT_OF_MEMORY;
+    }
+    
+    workerCount = std::min(std::max(workerCount, static_cast<size_t>(1)), static_cast<size_t>(MAX_WORKERS));
+    
+    for (size_t i = 0; i < workerCount; ++i) {
+        Worker& worker = workers_[i];
+        
+        // With more than one worker the first is reserved for the fast lane
+        worker.fastLaneOnly = (i == 0 && workerCount > 1);
+        
+        char name[16];
+        snprintf(name, sizeof(name), "mcp_exec%u", static_cast<unsigned>(i));
+        
+        if (xTaskCreate(workerTask, name, stackSize, &worker, priority, &worker.handle) != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create executor worker %u", static_cast<unsigned>(i));
+            worker.handle = nullptr;
+            break;
+        }
+        workerCount_++;
+    }
+    
+    if (workerCount_ == 0) {
+        vSemaphoreDelete(mutex_);
+        mutex_ = nullptr;
+        return TINYMCP_ERROR_TASK_CREATION_FAILED;
+    }
+    
+    // A lone surviving worker has to serve both lanes
+    if (workerCount_ == 1) {
+        workers_[0].fastLaneOnly = false;
+    }
+    
+    initialized_ = true;
+    ESP_LOGI(TAG, "Executor started: %u workers, %u byte stacks",
+             static_cast<unsigned>(workerCount_), static_cast<unsigned>(stackSize));
+    return TINYMCP_SUCCESS;
+}
+
+int TaskExecutor::submit(const std::shared_ptr<AsyncTask>& task, const void* owner,
+                         const TaskNotify& notify) {
+    if (!task) {
+        return TINYMCP_ERROR_INVALID_PARAMS;
+    }
+    
+    if (!initialized_) {
+        return TINYMCP_ERROR_INVALID_STATE;
+    }
+    
+    xSemaphoreTake(mutex_, portMAX_DELAY);
+    
+    JobQueue& queue = task->isFastLane() ? fastLane_ : general_;
+    if (queue.count >= MAX_QUEUED_JOBS) {
+        stats_.rejected++;
+        xSemaphoreGive(mutex_);
+        return TINYMCP_ERROR_RESOURCE_LIMIT;
+    }
+    
+    Job job;
+    job.task = task;
+    job.owner = owner;
+    job.notify = notify;
+    job.priority = static_cast<uint8_t>(task->getPriority());
+    job.sequence = nextSequence_++;
+    
+    task->scheduled_ = true;
+    if (task->isFastLane()) {
+        pushFast(queue, std::move(job));
+    } else {
+        pushHeap(queue, std::move(job));
+    }
+    
+    uint32_t queued = static_cast<uint32_t>(fastLane_.count + general_.count);
+    stats_.peakQueued = std::max(stats_.peakQueued, queued);
+    
+    xSemaphoreGive(mutex_);
+    
+    wakeWorkers();
+    return TINYMCP_SUCCESS;
+}
+
+void TaskExecutor::detach(const void* owner) {
+    if (!initialized_ || !owner) {
+        return;
+    }
+    
+    xSemaphoreTake(mutex_, portMAX_DELAY);
+    
+    dropOwner(fastLane_, owner, false);
+    dropOwner(general_, owner, true);
+    
+    // Running jobs finish, but their completion no longer reaches the owner
+    for (size_t i = 0; i < workerCount_; ++i) {
+        if (workers_[i].current.owner == owner) {
+            workers_[i].current.notify = TaskNotify();
+        }
+    }
+    
+    xSemaphoreGive(mutex_);
+}
+
+void TaskExecutor::workerTask(void* pvParameters) {
+    Worker* worker = static_cast<Worker*>(pvParameters);
+    TaskExecutor& executor = getInstance();
+    
+    while (true) {
+        if (!executor.takeJob(*worker)) {
+            // submit() notifies every worker; the count survives a missed wait
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+        
+        worker->current.task->execute();
+        executor.finishJob(*worker);
+    }
+}
+
+bool TaskExecutor::takeJob(Worker& worker) {
+    xSemaphoreTake(mutex_, portMAX_DELAY);
+    
+    bool taken = true;
+    if (fastLane_.count > 0) {
+        popFast(fastLane_, worker.current);
+        stats_.fastLaneJobs++;
+    } else if (!worker.fastLaneOnly && general_.count > 0) {
+        popHeap(general_, worker.current);
+    } else {
+        taken = false;
+    }
+    
+    xSemaphoreGive(mutex_);
+    return taken;
+}
+
+void TaskExecutor::finishJob(Worker& worker) {
+    xSemaphoreTake(mutex_, portMAX_DELAY);
+    
+    Job& job = worker.current;
+    job.task->lastRunTime_ = xTaskGetTickCount();
+    job.task->scheduled_ = false;
+    stats_.jobsExecuted++;
+    
+    job.notify.signal();
+    
+    // Release the task reference; the session may already have dropped it
+    job = Job();
+    
+    xSemaphoreGive(mutex_);
+}
+
+void TaskExecutor::wakeWorkers() {
+    for (size_t i = 0; i < workerCount_; ++i) {
+        if (workers_[i].handle) {
+            xTaskNotifyGive(workers_[i].handle);
+        }
+    }
+}
+
+bool TaskExecutor::runsBefore(const Job& a, const Job& b) {
+    if (a.priority != b.priority) {
+        return a.priority > b.priority;
+    }
+    // Wrap-safe FIFO order within a priority
+    return static_cast<int32_t>(a.sequence - b.sequence) < 0;
+}
+
+void TaskExecutor::pushFast(JobQueue& queue, Job&& job) {
+    queue.jobs[queue.count++] = std::move(job);
+}
+
+void TaskExecutor::popFast(JobQueue& queue, Job& job) {
+    job = std::move(queue.jobs[0]);
+    std::move(queue.jobs + 1, queue.jobs + queue.count, queue.jobs);
+    queue.jobs[--queue.count] = Job();
+}
+
+void TaskExecutor::pushHeap(JobQueue& queue, Job&& job) {
+    queue.jobs[queue.count++] = std::move(job);
+    // std::push_heap keeps the largest element on top; invert runsBefore
+    std::push_heap(queue.jobs, queue.jobs + queue.count,
+                   [](const Job& a, const Job& b) { return runsBefore(b, a); });
+}
+
+void TaskExecutor::popHeap(JobQueue& queue, Job& job) {
+    std::pop_heap(queue.jobs, queue.jobs + queue.count,
+                  [](const Job& a, const Job& b) { return runsBefore(b, a); });
+    job = std::move(queue.jobs[--queue.count]);
+    queue.jobs[queue.count] = Job();
+}
+
+void TaskExecutor::dropOwner(JobQueue& queue, const void* owner, bool heap) {
+    Job* end = std::remove_if(queue.jobs, queue.jobs + queue.count,
+                              [owner](const Job& job) { return job.owner == owner; });
+    size_t kept = static_cast<size_t>(end - queue.jobs);
+    
+    for (size_t i = kept; i < queue.count; ++i) {
+        if (queue.jobs[i].task) {
+            queue.jobs[i].task->scheduled_ = false;
+        }
+        queue.jobs[i] = Job();
+    }
+    queue.count = kept;
+    
+    if (heap) {
+        std::make_heap(queue.jobs, queue.jobs + queue.count,
+                       [](const Job& a, const Job& b) { return runsBefore(b, a); });
+    }
+}
+
+} // namespace tinymcp
@@ -2,11 +2,96 @@
 // Implementation of lightweight JSON utilities for ESP32/ESP8266
 
 #include "tinymcp_json.h"
+#include "tinymcp_cbor.h"
 #include <algorithm>
+#include <cfloat>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
 
 namespace tinymcp {
 
+namespace {
+
+// Same choices as cJSON's printer, so both paths produce identical output
+int formatNumber(double number, char* buffer, size_t size) {
+    if (number != number || number > DBL_MAX || number < -DBL_MAX) {
+        return snprintf(buffer, size, "null");
+    }
+    if (number >= INT_MIN && number <= INT_MAX &&
+        number == static_cast<double>(static_cast<int>(number))) {
+        return snprintf(buffer, size, "%d", static_cast<int>(number));
+    }
+    int length = snprintf(buffer, size, "%1.15g", number);
+    if (strtod(buffer, nullptr) != number) {
+        length = snprintf(buffer, size, "%1.17g", number);
+    }
+    return length;
+}
+
+// Quoted and escaped like JsonWriter::putString()
+size_t escapedSize(const char* str) {
+    size_t size = 2;
+    for (const unsigned char* p = reinterpret_cast<const unsigned char*>(str); *p; ++p) {
+        switch (*p) {
+            case '"':
+            case '\\':
+            case '\b':
+            case '\f':
+            case '\n':
+            case '\r':
+            case '\t':
+                size += 2;
+                break;
+            default:
+                size += *p < 0x20 ? 6 : 1;
+                break;
+        }
+    }
+    return size;
+}
+
+// Minified size of a tree; stops descending once the total passes `limit`
+size_t measureTree(const cJSON* json, size_t limit) {
+    switch (json->type & 0xFF) {
+        case cJSON_NULL:
+        case cJSON_True:
+            return 4;
+        case cJSON_False:
+            return 5;
+        case cJSON_Number: {
+            char buffer[32];
+            int length = formatNumber(json->valuedouble, buffer, sizeof(buffer));
+            return length > 0 ? static_cast<size_t>(length) : 0;
+        }
+        case cJSON_String:
+            return json->valuestring ? escapedSize(json->valuestring) : 2;
+        case cJSON_Raw:
+            return json->valuestring ? strlen(json->valuestring) : 0;
+        case cJSON_Array:
+        case cJSON_Object: {
+            bool isObject = (json->type & 0xFF) == cJSON_Object;
+            size_t size = 2;
+            for (const cJSON* child = json->child; child && size <= limit; child = child->next) {
+                if (child != json->child) {
+                    size++;
+                }
+                if (isObject) {
+                    size += escapedSize(child->string ? child->string : "") + 1;
+                }
+                size += measureTree(child, limit - std::min(size, limit));
+            }
+            return size;
+        }
+        default:
+            return 0;
+    }
+}
+
+} // namespace
+
 // JsonHelper implementation
 
 bool JsonHelper::hasField(const cJSON* json, const char* key) {
@@ -249,23 +334,53 @@ bool JsonHelper::setId(cJSON* json, int id) {
 std::string JsonHelper::toString(const cJSON* json, bool formatted) {
     if (!json) return "";
     
+    // Minified text is measured first and printed once into its final buffer
+    if (!formatted) {
+        std::string result(getSerializedSize(json) + PRINT_SLACK, '\0');
+        if (cJSON_PrintPreallocated(const_cast<cJSON*>(json), &result[0], static_cast<int>(result.size()), false)) {
+            result.resize(strlen(result.c_str()));
+            return result;
+        }
+    }
+    
     char* str = formatted ? cJSON_Print(json) : cJSON_PrintUnformatted(json);
     if (!str) return "";
     
     std::string result(str);
-    free(str);
+    cJSON_free(str);
     return result;
 }
 
 size_t JsonHelper::getSerializedSize(const cJSON* json) {
-    if (!json) return 0;
-    
-    char* str = cJSON_PrintUnformatted(json);
-    if (!str) return 0;
-    
-    size_t size = strlen(str);
-    free(str);
-    return size;
+    return json ? measureTree(json, SIZE_MAX) : 0;
+}
+
+void JsonHelper::appendEscapedString(std::string& out, const char* value, size_t length) {
+    static const char HEX[] = "0123456789abcdef";
+    
+    out += '"';
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = static_cast<unsigned char>(value[i]);
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    out += "\\u00";
+                    out += HEX[c >> 4];
+                    out += HEX[c & 0x0f];
+                } else {
+                    out += static_cast<char>(c);
+                }
+                break;
+        }
+    }
+    out += '"';
 }
 
 JsonValue JsonHelper::createErrorResponse(const std::string& id, int code, const std::string& message, const std::string& data) {
@@ -553,7 +668,7 @@ cJSON* JsonHelper::createServerCapabilities(bool toolsListChanged, bool progress
 }
 
 bool JsonHelper::exceedsMaxSize(const cJSON* json, size_t maxSize) {
-    return getSerializedSize(json) > maxSize;
+    return json && measureTree(json, maxSize) > maxSize;
 }
 
 size_t JsonHelper::estimateMemoryUsage(const cJSON* json) {
@@ -621,4 +736,418 @@ size_t JsonHelper::calculateStringSize(const cJSON* json) {
     return json->valuestring ? strlen(json->valuestring) : 0;
 }
 
-} // namespace tinymcp
\ No newline at end of file
+// JsonWriter implementation
+
+JsonWriter::JsonWriter(JsonSink* sink, WireFormat format) :
+    sink_(sink), used_(0), written_(0), status_(TINYMCP_SUCCESS),
+    depth_(0), hasItems_(0), afterKey_(false), embedded_(false), format_(format) {
+}
+
+JsonWriter& JsonWriter::beginObject() {
+    separator();
+    push('{');
+    return *this;
+}
+
+JsonWriter& JsonWriter::endObject() {
+    pop('}');
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray() {
+    separator();
+    push('[');
+    return *this;
+}
+
+JsonWriter& JsonWriter::endArray() {
+    pop(']');
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(const char* name) {
+    separator();
+    putString(name, name ? strlen(name) : 0);
+    if (format_ == WireFormat::JSON) {
+        put(':');
+    }
+    afterKey_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(const char* str) {
+    if (!str) {
+        return nullValue();
+    }
+    separator();
+    putString(str, strlen(str));
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(const std::string& str) {
+    separator();
+    putString(str.data(), str.size());
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(const char* str, size_t length) {
+    separator();
+    putString(str, length);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(int number) {
+    separator();
+    if (format_ == WireFormat::CBOR) {
+        putNumber(number);
+        return *this;
+    }
+    char buffer[16];
+    int length = snprintf(buffer, sizeof(buffer), "%d", number);
+    put(buffer, length > 0 ? static_cast<size_t>(length) : 0);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(double number) {
+    separator();
+    putNumber(number);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(bool flag) {
+    separator();
+    putBool(flag);
+    return *this;
+}
+
+JsonWriter& JsonWriter::nullValue() {
+    separator();
+    putNull();
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(const cJSON* json) {
+    separator();
+    putTree(json);
+    return *this;
+}
+
+JsonWriter& JsonWriter::jsonText(const cJSON* json) {
+    if (embedded_) {
+        status_ = TINYMCP_ERROR_INVALID_STATE;
+        return *this;
+    }
+    
+    separator();
+    if (format_ == WireFormat::CBOR) {
+        // A CBOR text string needs its length up front but no escaping
+        JsonWriter counter;
+        counter.value(json);
+        putHeader(Cbor::MAJOR_TEXT, counter.size());
+        format_ = WireFormat::JSON;
+        putTree(json);
+        format_ = WireFormat::CBOR;
+        return *this;
+    }
+    
+    put('"');
+    embedded_ = true;
+    putTree(json);
+    embedded_ = false;
+    put('"');
+    return *this;
+}
+
+JsonWriter& JsonWriter::raw(const char* json, size_t length) {
+    separator();
+    if (format_ == WireFormat::CBOR) {
+        putTranscoded(json, length);
+        return *this;
+    }
+    put(json, length);
+    return *this;
+}
+
+int JsonWriter::finish() {
+    if (depth_ != 0 && status_ == TINYMCP_SUCCESS) {
+        status_ = TINYMCP_ERROR_INVALID_STATE;
+    }
+    flushChunk();
+    return status_;
+}
+
+void JsonWriter::separator() {
+    if (afterKey_ || format_ == WireFormat::CBOR) {
+        afterKey_ = false;
+        return;
+    }
+    
+    if (depth_ > 0) {
+        uint32_t bit = 1u << (depth_ - 1);
+        if (hasItems_ & bit) {
+            put(',');
+        }
+        hasItems_ |= bit;
+    }
+}
+
+void JsonWriter::push(char open) {
+    if (depth_ >= MAX_DEPTH) {
+        status_ = TINYMCP_ERROR_INVALID_PARAMS;
+        return;
+    }
+    if (format_ == WireFormat::CBOR) {
+        put(static_cast<char>((open == '{' ? Cbor::MAJOR_MAP : Cbor::MAJOR_ARRAY) | Cbor::INDEFINITE));
+    } else {
+        put(open);
+    }
+    depth_++;
+    hasItems_ &= ~(1u << (depth_ - 1));
+}
+
+void JsonWriter::pop(char close) {
+    if (depth_ == 0) {
+        status_ = TINYMCP_ERROR_INVALID_STATE;
+        return;
+    }
+    depth_--;
+    afterKey_ = false;
+    put(format_ == WireFormat::CBOR ? static_cast<char>(Cbor::BREAK) : close);
+}
+
+void JsonWriter::put(char c) {
+    if (embedded_ && (c == '"' || c == '\\')) {
+        char escaped[2] = { '\\', c };
+        embedded_ = false;
+        put(escaped, sizeof(escaped));
+        embedded_ = true;
+        return;
+    }
+    
+    written_++;
+    if (!sink_ || status_ != TINYMCP_SUCCESS) {
+        return;
+    }
+    
+    if (used_ == CHUNK_SIZE) {
+        flushChunk();
+    }
+    chunk_[used_++] = c;
+}
+
+void JsonWriter::put(const char* data, size_t length) {
+    if (embedded_) {
+        for (size_t i = 0; i < length; i++) {
+            put(data[i]);
+        }
+        return;
+    }
+    
+    written_ += length;
+    if (!sink_ || status_ != TINYMCP_SUCCESS) {
+        return;
+    }
+    
+    while (length > 0) {
+        if (used_ == CHUNK_SIZE) {
+            flushChunk();
+            if (status_ != TINYMCP_SUCCESS) {
+                return;
+            }
+        }
+        size_t n = std::min(length, CHUNK_SIZE - used_);
+        memcpy(chunk_ + used_, data, n);
+        used_ += n;
+        data += n;
+        length -= n;
+    }
+}
+
+void JsonWriter::putString(const char* str, size_t length) {
+    static const char HEX[] = "0123456789abcdef";
+    
+    if (format_ == WireFormat::CBOR) {
+        putHeader(Cbor::MAJOR_TEXT, length);
+        put(str, length);
+        return;
+    }
+    
+    put('"');
+    
+    // Copy runs that need no escaping in one go
+    size_t runStart = 0;
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = static_cast<unsigned char>(str[i]);
+        const char* escape = nullptr;
+        char unicode[6];
+        
+        switch (c) {
+            case '"':  escape = "\\\""; break;
+            case '\\': escape = "\\\\"; break;
+            case '\b': escape = "\\b"; break;
+            case '\f': escape = "\\f"; break;
+            case '\n': escape = "\\n"; break;
+            case '\r': escape = "\\r"; break;
+            case '\t': escape = "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    unicode[0] = '\\';
+                    unicode[1] = 'u';
+                    unicode[2] = '0';
+                    unicode[3] = '0';
+                    unicode[4] = HEX[c >> 4];
+                    unicode[5] = HEX[c & 0x0f];
+                }
+                break;
+        }
+        
+        if (!escape && c >= 0x20) {
+            continue;
+        }
+        
+        put(str + runStart, i - runStart);
+        if (escape) {
+            put(escape, 2);
+        } else {
+            put(unicode, sizeof(unicode));
+        }
+        runStart = i + 1;
+    }
+    put(str + runStart, length - runStart);
+    
+    put('"');
+}
+
+void JsonWriter::putNumber(double number) {
+    if (format_ == WireFormat::CBOR) {
+        uint8_t encoded[Cbor::MAX_HEADER_SIZE];
+        put(reinterpret_cast<const char*>(encoded), Cbor::encodeNumber(number, encoded));
+        return;
+    }
+    
+    char buffer[32];
+    int length = formatNumber(number, buffer, sizeof(buffer));
+    put(buffer, length > 0 ? static_cast<size_t>(length) : 0);
+}
+
+void JsonWriter::putHeader(uint8_t major, uint64_t argument) {
+    uint8_t header[Cbor::MAX_HEADER_SIZE];
+    put(reinterpret_cast<const char*>(header), Cbor::encodeHeader(major, argument, header));
+}
+
+void JsonWriter::putNull() {
+    if (format_ == WireFormat::CBOR) {
+        put(static_cast<char>(Cbor::NULL_VALUE));
+    } else {
+        put("null", 4);
+    }
+}
+
+void JsonWriter::putBool(bool flag) {
+    if (format_ == WireFormat::CBOR) {
+        put(static_cast<char>(flag ? Cbor::TRUE_VALUE : Cbor::FALSE_VALUE));
+    } else if (flag) {
+        put("true", 4);
+    } else {
+        put("false", 5);
+    }
+}
+
+void JsonWriter::putTranscoded(const char* json, size_t length) {
+    // Pre-serialized JSON has to be parsed before it can be re-encoded
+    std::string text(json, length);
+    cJSON* tree = cJSON_Parse(text.c_str());
+    if (!tree) {
+        status_ = TINYMCP_ERROR_INVALID_PARAMS;
+        return;
+    }
+    putTree(tree);
+    cJSON_Delete(tree);
+}
+
+void JsonWriter::putTree(const cJSON* json) {
+    if (!json) {
+        putNull();
+        return;
+    }
+    
+    switch (json->type & 0xFF) {
+        case cJSON_NULL:
+            putNull();
+            break;
+        case cJSON_False:
+            putBool(false);
+            break;
+        case cJSON_True:
+            putBool(true);
+            break;
+        case cJSON_Number:
+            putNumber(json->valuedouble);
+            break;
+        case cJSON_String:
+            putString(json->valuestring ? json->valuestring : "",
+                      json->valuestring ? strlen(json->valuestring) : 0);
+            break;
+        case cJSON_Raw:
+            if (json->valuestring) {
+                if (format_ == WireFormat::CBOR) {
+                    putTranscoded(json->valuestring, strlen(json->valuestring));
+                } else {
+                    put(json->valuestring, strlen(json->valuestring));
+                }
+            }
+            break;
+        case cJSON_Array:
+        case cJSON_Object: {
+            bool isObject = (json->type & 0xFF) == cJSON_Object;
+            if (format_ == WireFormat::CBOR) {
+                // The tree already knows its counts, so use definite lengths
+                size_t count = 0;
+                for (const cJSON* child = json->child; child; child = child->next) {
+                    count++;
+                }
+                putHeader(isObject ? Cbor::MAJOR_MAP : Cbor::MAJOR_ARRAY, count);
+                for (const cJSON* child = json->child; child; child = child->next) {
+                    if (isObject) {
+                        const char* name = child->string ? child->string : "";
+                        putString(name, strlen(name));
+                    }
+                    putTree(child);
+                }
+                break;
+            }
+            put(isObject ? '{' : '[');
+            for (const cJSON* child = json->child; child; child = child->next) {
+                if (child != json->child) {
+                    put(',');
+                }
+                if (isObject) {
+                    const char* name = child->string ? child->string : "";
+                    putString(name, strlen(name));
+                    put(':');
+                }
+                putTree(child);
+            }
+            put(isObject ? '}' : ']');
+            break;
+        }
+        default:
+            status_ = TINYMCP_ERROR_INVALID_PARAMS;
+            break;
+    }
+}
+
+void JsonWriter::flushChunk() {
+    if (!sink_ || used_ == 0 || status_ != TINYMCP_SUCCESS) {
+        used_ = 0;
+        return;
+    }
+    
+    int result = sink_->write(chunk_, used_);
+    if (result != TINYMCP_SUCCESS) {
+        status_ = result;
+    }
+    used_ = 0;
+}
+
+} // namespace tinymcp
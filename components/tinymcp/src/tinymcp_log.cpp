@@ -0,0 +1,339 @@
+// Deferred binary logging for TinyMCP
+// Hot-path log calls store compact records in a ring; a low-priority task
+// formats them and does the slow UART write
+
+#include "tinymcp_log.h"
+#include "tinymcp_constants.h"
+
+#include "esp_timer.h"
+#include <algorithm>
+#include <cstdio>
+
+static const char* TAG = "tinymcp_log";
+
+namespace tinymcp {
+
+// LogRecord implementation
+
+void LogRecord::begin(esp_log_level_t recordLevel, const char* recordTag, const char* recordFormat) {
+    timestampMs = static_cast<uint32_t>(esp_timer_get_time() / 1000);
+    tag = recordTag;
+    format = recordFormat;
+    level = static_cast<uint8_t>(recordLevel);
+    argCount = 0;
+    stringArgs = 0;
+    textLength = 0;
+}
+
+void LogRecord::addWord(uint32_t value) {
+    if (argCount < MAX_ARGS) {
+        args[argCount++] = value;
+    }
+}
+
+void LogRecord::addString(const char* str, size_t length) {
+    if (argCount >= MAX_ARGS) {
+        return;
+    }
+
+    if (!str) {
+        str = "(null)";
+        length = 6;
+    }
+
+    // Strings share the text area; once it is full they render empty
+    size_t space = TEXT_BYTES - textLength;
+    if (space == 0) {
+        args[argCount] = TEXT_BYTES;
+    } else {
+        length = std::min(length, space - 1);
+        memcpy(text + textLength, str, length);
+        text[textLength + length] = '\0';
+        args[argCount] = textLength;
+        textLength = static_cast<uint8_t>(textLength + length + 1);
+    }
+    stringArgs |= static_cast<uint8_t>(1u << argCount);
+    argCount++;
+}
+
+size_t LogRecord::render(char* out, size_t size) const {
+    if (size == 0) {
+        return 0;
+    }
+
+    size_t length = 0;
+    size_t next = 0;
+
+    auto isString = [this](size_t index) {
+        return index < argCount && (stringArgs & (1u << index)) != 0;
+    };
+    auto takeInt = [&]() {
+        int value = next < argCount && !isString(next) ? static_cast<int>(args[next]) : 0;
+        next++;
+        return value;
+    };
+    auto appendField = [&](int written) {
+        if (written > 0) {
+            length += std::min(static_cast<size_t>(written), size - 1 - length);
+        }
+    };
+
+    const char* p = format;
+    while (*p && length + 1 < size) {
+        if (*p != '%') {
+            const char* start = p;
+            while (*p && *p != '%') {
+                p++;
+            }
+            size_t count = std::min(static_cast<size_t>(p - start), size - 1 - length);
+            memcpy(out + length, start, count);
+            length += count;
+            continue;
+        }
+
+        if (p[1] == '%') {
+            out[length++] = '%';
+            p += 2;
+            continue;
+        }
+
+        // Rebuild the conversion with '*' resolved and length modifiers
+        // dropped, then let snprintf do the field formatting
+        char spec[24];
+        size_t specLength = 0;
+        spec[specLength++] = *p++;
+        while (*p && strchr("-+ #0", *p) && specLength < 6) {
+            spec[specLength++] = *p++;
+        }
+        auto appendStar = [&]() {
+            // Widths and precisions beyond 999 are clamped, they never fit a line
+            int value = std::max(-999, std::min(999, takeInt()));
+            specLength += static_cast<size_t>(snprintf(spec + specLength, 5, "%d", value));
+        };
+        if (*p == '*') {
+            p++;
+            appendStar();
+        } else {
+            while (*p >= '0' && *p <= '9' && specLength < 12) {
+                spec[specLength++] = *p++;
+            }
+        }
+        if (*p == '.') {
+            spec[specLength++] = *p++;
+            if (*p == '*') {
+                p++;
+                appendStar();
+            } else {
+                while (*p >= '0' && *p <= '9' && specLength < 20) {
+                    spec[specLength++] = *p++;
+                }
+            }
+        }
+        while (*p && strchr("hlLqjzt", *p)) {
+            p++;
+        }
+
+        char conversion = *p;
+        if (!conversion) {
+            break;
+        }
+        p++;
+        spec[specLength++] = conversion;
+        spec[specLength] = '\0';
+
+        size_t index = next++;
+        bool missing = index >= argCount;
+        char* field = out + length;
+        size_t available = size - length;
+
+        switch (conversion) {
+            case 'd':
+            case 'i':
+            case 'c':
+                appendField(missing || isString(index) ? snprintf(field, available, "?") :
+                            snprintf(field, available, spec, static_cast<int>(args[index])));
+                break;
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X':
+                appendField(missing || isString(index) ? snprintf(field, available, "?") :
+                            snprintf(field, available, spec, static_cast<unsigned>(args[index])));
+                break;
+            case 's':
+                if (isString(index)) {
+                    const char* value = args[index] < TEXT_BYTES ? text + args[index] : "";
+                    appendField(snprintf(field, available, spec, value));
+                } else {
+                    appendField(snprintf(field, available, "?"));
+                }
+                break;
+            default:
+                // Floating point and pointers are never captured
+                appendField(snprintf(field, available, "?"));
+                break;
+        }
+    }
+
+    out[length] = '\0';
+    return length;
+}
+
+// DeferredLog implementation
+
+static_assert((DeferredLog::CAPACITY & (DeferredLog::CAPACITY - 1)) == 0,
+              "CONFIG_TINYMCP_LOG_RING_RECORDS must be a power of two");
+
+DeferredLog DeferredLog::instance_;
+
+DeferredLog::DeferredLog() :
+    enqueuePos_(0), dequeuePos_(0), running_(false), task_(nullptr),
+    written_(0), dropped_(0), reportedDrops_(0), peakQueued_(0) {
+
+    // A slot is free for position p when its sequence is p and holds a
+    // record for p once it is p + 1
+    for (size_t i = 0; i < sizeof(slots_) / sizeof(slots_[0]); ++i) {
+        slots_[i].sequence.store(static_cast<uint32_t>(i), std::memory_order_relaxed);
+    }
+}
+
+DeferredLog& DeferredLog::getInstance() {
+    return instance_;
+}
+
+int DeferredLog::start(uint32_t stackSize, UBaseType_t priority) {
+#if TINYMCP_DEFERRED_LOG
+    if (isRunning()) {
+        return TINYMCP_SUCCESS;
+    }
+
+    if (xTaskCreate(drainTask, "mcp_log", stackSize, this, priority, &task_) != pdPASS) {
+        task_ = nullptr;
+        ESP_LOGE(TAG, "Failed to create log drain task, logging inline");
+        return TINYMCP_ERROR_TASK_CREATION_FAILED;
+    }
+
+    running_.store(true, std::memory_order_release);
+    ESP_LOGI(TAG, "Deferred logging started: %u records", static_cast<unsigned>(CAPACITY));
+#else
+    (void)stackSize;
+    (void)priority;
+#endif
+    return TINYMCP_SUCCESS;
+}
+
+DeferredLog::Stats DeferredLog::getStats() const {
+    Stats stats;
+    stats.written = written_.load(std::memory_order_relaxed);
+    stats.dropped = dropped_.load(std::memory_order_relaxed);
+    stats.peakQueued = peakQueued_;
+    return stats;
+}
+
+LogRecord* DeferredLog::claim(uint32_t& position) {
+#if TINYMCP_DEFERRED_LOG
+    if (!isRunning()) {
+        return nullptr;
+    }
+
+    position = enqueuePos_.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot& slot = slots_[position % CAPACITY];
+        uint32_t sequence = slot.sequence.load(std::memory_order_acquire);
+        int32_t difference = static_cast<int32_t>(sequence - position);
+
+        if (difference == 0) {
+            if (enqueuePos_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                return &slot.record;
+            }
+        } else if (difference < 0) {
+            // Still held by the drain task from the previous lap
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        } else {
+            position = enqueuePos_.load(std::memory_order_relaxed);
+        }
+    }
+#else
+    (void)position;
+    return nullptr;
+#endif
+}
+
+void DeferredLog::publish(uint32_t position, esp_log_level_t level) {
+    slots_[position % CAPACITY].sequence.store(position + 1, std::memory_order_release);
+    written_.fetch_add(1, std::memory_order_relaxed);
+
+    // The drain task sleeps while the ring is empty, so the first record
+    // wakes it; warnings, errors and a filling ring wake it early. Records
+    // landing behind a pending one wait for its drain interval. The fence
+    // pairs with drainTask's: either this sees the ring emptied or the
+    // drain task sees this record pending.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    uint32_t queued = position + 1 - dequeuePos_.load(std::memory_order_relaxed);
+    if (queued == 1 || level <= ESP_LOG_WARN || queued >= CAPACITY / 2) {
+        xTaskNotifyGive(task_);
+    }
+}
+
+size_t DeferredLog::drain() {
+    uint32_t position = dequeuePos_.load(std::memory_order_relaxed);
+    uint32_t queued = enqueuePos_.load(std::memory_order_relaxed) - position;
+    peakQueued_ = std::max(peakQueued_, queued);
+
+    size_t count = 0;
+    LogRecord record;
+    for (;;) {
+        Slot& slot = slots_[position % CAPACITY];
+        if (slot.sequence.load(std::memory_order_acquire) != position + 1) {
+            break;
+        }
+
+        // Copied out so producers can reuse the slot during the slow write
+        record = slot.record;
+        slot.sequence.store(position + CAPACITY, std::memory_order_release);
+        dequeuePos_.store(++position, std::memory_order_relaxed);
+
+        print(record);
+        count++;
+    }
+
+    uint32_t dropped = dropped_.load(std::memory_order_relaxed);
+    if (dropped != reportedDrops_) {
+        ESP_LOGW(TAG, "%u log records dropped, ring full", static_cast<unsigned>(dropped - reportedDrops_));
+        reportedDrops_ = dropped;
+    }
+    return count;
+}
+
+void DeferredLog::print(const LogRecord& record) {
+    static const char LEVEL_LETTERS[] = "NEWIDV";
+
+    char line[MAX_LINE_LENGTH];
+    record.render(line, sizeof(line));
+
+    char letter = record.level < sizeof(LEVEL_LETTERS) - 1 ? LEVEL_LETTERS[record.level] : '?';
+    esp_log_write(static_cast<esp_log_level_t>(record.level), record.tag, "%c (%u) %s: %s\n",
+                  letter, static_cast<unsigned>(record.timestampMs), record.tag, line);
+}
+
+void DeferredLog::drainTask(void* pvParameters) {
+    DeferredLog* log = static_cast<DeferredLog*>(pvParameters);
+
+    TickType_t waitTicks = portMAX_DELAY;
+
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, waitTicks);
+        log->drain();
+
+        // A record claimed but not yet published stops the drain early;
+        // come back for it rather than waiting on a notification that
+        // publish() may have skipped
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool pending = log->enqueuePos_.load(std::memory_order_relaxed) !=
+                       log->dequeuePos_.load(std::memory_order_relaxed);
+        waitTicks = pending ? pdMS_TO_TICKS(DRAIN_INTERVAL_MS) : portMAX_DELAY;
+    }
+}
+
+} // namespace tinymcp
@@ -2,6 +2,11 @@
 // Implementation of foundational message architecture for ESP32/ESP8266
 
 #include "tinymcp_message.h"
+#include "tinymcp_request.h"
+#include "tinymcp_response.h"
+#include "tinymcp_notification.h"
+#include "tinymcp_method_table.h"
+#include "tinymcp_cbor.h"
 #include <chrono>
 #include <cstring>
 #include <algorithm>
@@ -45,6 +50,47 @@ bool MessageId::addToJson(cJSON* json) const {
     return false;
 }
 
+void MessageId::appendJson(std::string& out) const {
+    if (type_ == DataType::STRING) {
+        JsonHelper::appendEscapedString(out, stringId_.data(), stringId_.size());
+    } else if (type_ == DataType::INTEGER) {
+        out += std::to_string(intId_);
+    } else {
+        out += "null";
+    }
+}
+
+void MessageId::writeJson(JsonWriter& writer) const {
+    if (type_ == DataType::STRING) {
+        writer.value(stringId_);
+    } else if (type_ == DataType::INTEGER) {
+        writer.value(intId_);
+    } else {
+        writer.nullValue();
+    }
+}
+
+uint32_t MessageId::hash() const {
+    // FNV-1a; the type is mixed in so "1" and 1 land apart
+    uint32_t h = 2166136261u ^ static_cast<uint32_t>(type_);
+    h *= 16777619u;
+    
+    if (type_ == DataType::STRING) {
+        for (char c : stringId_) {
+            h ^= static_cast<uint8_t>(c);
+            h *= 16777619u;
+        }
+    } else if (type_ == DataType::INTEGER) {
+        uint32_t value = static_cast<uint32_t>(intId_);
+        for (int i = 0; i < 4; ++i) {
+            h ^= (value >> (i * 8)) & 0xFF;
+            h *= 16777619u;
+        }
+    }
+    
+    return h;
+}
+
 bool MessageId::operator==(const MessageId& other) const {
     if (type_ != other.type_) return false;
     
@@ -73,16 +119,23 @@ std::unique_ptr<Message> Message::createFromJson(const std::string& jsonStr) {
     JsonValue json = JsonValue::parse(jsonStr);
     if (!json.isValid()) return nullptr;
     
-    MessageType type = detectMessageType(json.get());
-    MessageCategory category = detectMessageCategory(json.get());
+    return createFromJson(json.get());
+}
+
+std::unique_ptr<Message> Message::createFromJson(const cJSON* json) {
+    if (!json) return nullptr;
     
-    if (type == MessageType::UNKNOWN || category == MessageCategory::UNKNOWN) {
-        return nullptr;
+    // The factories deserialize straight from this tree
+    switch (detectMessageCategory(json)) {
+        case MessageCategory::REQUEST:
+            return RequestFactory::createFromJson(json);
+        case MessageCategory::RESPONSE:
+            return ResponseFactory::createFromJson(json);
+        case MessageCategory::NOTIFICATION:
+            return NotificationFactory::createFromJson(json);
+        default:
+            return nullptr;
     }
-    
-    // Factory creation would go here - for now return nullptr
-    // This would be implemented by the request/response/notification factories
-    return nullptr;
 }
 
 MessageType Message::detectMessageType(const cJSON* json) {
@@ -93,21 +146,11 @@ MessageType Message::detectMessageType(const cJSON* json) {
     bool hasResult = JsonHelper::hasField(json, MSG_KEY_RESULT);
     bool hasError = JsonHelper::hasField(json, MSG_KEY_ERROR);
     
-    if (hasMethod && hasId) {
-        // Request - determine type by method
-        std::string method = JsonHelper::getString(json, MSG_KEY_METHOD);
-        if (method == METHOD_INITIALIZE) return MessageType::INITIALIZE_REQUEST;
-        if (method == METHOD_TOOLS_LIST) return MessageType::LIST_TOOLS_REQUEST;
-        if (method == METHOD_TOOLS_CALL) return MessageType::CALL_TOOL_REQUEST;
-        if (method == METHOD_PING) return MessageType::PING_REQUEST;
-        return MessageType::UNKNOWN;
-    } else if (hasMethod && !hasId) {
-        // Notification - determine type by method
-        std::string method = JsonHelper::getString(json, MSG_KEY_METHOD);
-        if (method == METHOD_INITIALIZED) return MessageType::INITIALIZED_NOTIFICATION;
-        if (method == METHOD_PROGRESS) return MessageType::PROGRESS_NOTIFICATION;
-        if (method == METHOD_CANCELLED) return MessageType::CANCELLED_NOTIFICATION;
-        return MessageType::UNKNOWN;
+    if (hasMethod) {
+        // Requests carry an id, notifications do not
+        const MethodEntry* entry = MethodTable::find(json);
+        MessageCategory expected = hasId ? MessageCategory::REQUEST : MessageCategory::NOTIFICATION;
+        return (entry && entry->category == expected) ? entry->type : MessageType::UNKNOWN;
     } else if (!hasMethod && hasId && (hasResult || hasError)) {
         // Response - would need more context to determine exact type
         if (hasError) return MessageType::ERROR_RESPONSE;
@@ -137,16 +180,28 @@ MessageCategory Message::detectMessageCategory(const cJSON* json) {
     return MessageCategory::UNKNOWN;
 }
 
+int Message::write(JsonWriter& writer) const {
+    JsonValue json = JsonValue::createObject();
+    if (!json.isValid()) return TINYMCP_ERROR_OUT_OF_MEMORY;
+    
+    int result = doSerialize(json.get());
+    if (result != 0) return result;
+    
+    writer.value(json.get());
+    return writer.getStatus();
+}
+
 bool Message::exceedsMaxSize() const {
-    std::string jsonStr;
-    if (serialize(jsonStr) != 0) return true;
-    return jsonStr.length() > MAX_MESSAGE_SIZE;
+    JsonWriter counter;
+    if (write(counter) != 0) return true;
+    return counter.size() > MAX_MESSAGE_SIZE;
 }
 
 size_t Message::estimateSize() const {
-    std::string jsonStr;
-    if (serialize(jsonStr) != 0) return 0;
-    return jsonStr.length();
+    // A writer without a sink only counts, nothing is materialized
+    JsonWriter counter;
+    if (write(counter) != 0) return 0;
+    return counter.size();
 }
 
 bool Message::validateCommonFields(const cJSON* json) const {
@@ -180,6 +235,14 @@ bool Message::addCommonFields(cJSON* json) const {
     return true;
 }
 
+void Message::writeCommonFields(JsonWriter& writer) const {
+    writer.key(MSG_KEY_JSONRPC).value(JSON_RPC_VERSION);
+    
+    if (!progressToken_.empty()) {
+        writer.key(MSG_KEY_PROGRESS_TOKEN).value(progressToken_);
+    }
+}
+
 uint64_t Message::generateTimestamp() {
     auto now = std::chrono::system_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch());
@@ -365,6 +428,20 @@ cJSON* ServerCapabilities::toJson() const {
         }
     }
     
+    // Negotiated encoding: experimental.encoding.format
+    if (wireFormat_ != WireFormat::JSON) {
+        cJSON* experimental = cJSON_CreateObject();
+        cJSON* encoding = cJSON_CreateObject();
+        if (experimental && encoding) {
+            JsonHelper::setString(encoding, MSG_KEY_FORMAT, wireFormatToString(wireFormat_));
+            JsonHelper::setObject(experimental, MSG_KEY_ENCODING, encoding);
+            JsonHelper::setObject(json, MSG_KEY_EXPERIMENTAL, experimental);
+        } else {
+            cJSON_Delete(experimental);
+            cJSON_Delete(encoding);
+        }
+    }
+    
     return json;
 }
 
@@ -380,6 +457,13 @@ bool ServerCapabilities::fromJson(const cJSON* json) {
     // Parse other capabilities
     progressNotifications_ = JsonHelper::hasField(json, "logging");
     
+    wireFormat_ = WireFormat::JSON;
+    cJSON* experimental = JsonHelper::getObject(json, MSG_KEY_EXPERIMENTAL);
+    cJSON* encoding = experimental ? JsonHelper::getObject(experimental, MSG_KEY_ENCODING) : nullptr;
+    if (encoding) {
+        wireFormatFromString(JsonHelper::getString(encoding, MSG_KEY_FORMAT).c_str(), wireFormat_);
+    }
+    
     return true;
 }
 
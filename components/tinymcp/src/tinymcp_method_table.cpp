@@ -0,0 +1,143 @@
+// JSON-RPC method dispatch table for TinyMCP Protocol
+// Maps method names to message types and constructors without temporary strings
+
+#include "tinymcp_method_table.h"
+#include "tinymcp_request.h"
+#include "tinymcp_notification.h"
+
+#include "esp_log.h"
+#include <algorithm>
+#include <iterator>
+
+static const char* TAG = "tinymcp_methods";
+
+namespace tinymcp {
+
+namespace {
+
+// Deserialize a freshly constructed message in place, dropping it on failure
+template <typename T>
+std::unique_ptr<Message> deserializeInto(std::unique_ptr<T> message, const cJSON* json) {
+    if (!message || message->deserializeFrom(json) != 0) {
+        return nullptr;
+    }
+    return message;
+}
+
+template <typename T>
+std::unique_ptr<Message> createRequest(const cJSON* json) {
+    MessageId id;
+    if (!id.setFromJson(json)) return nullptr;
+    return deserializeInto(std::make_unique<T>(id), json);
+}
+
+std::unique_ptr<Message> createCallToolRequest(const cJSON* json) {
+    MessageId id;
+    if (!id.setFromJson(json)) return nullptr;
+    return deserializeInto(std::make_unique<CallToolRequest>(id, ""), json);
+}
+
+std::unique_ptr<Message> createInitializedNotification(const cJSON* json) {
+    return deserializeInto(std::make_unique<InitializedNotification>(), json);
+}
+
+std::unique_ptr<Message> createProgressNotification(const cJSON* json) {
+    return deserializeInto(std::make_unique<ProgressNotification>(ProgressToken(), 0, 100), json);
+}
+
+std::unique_ptr<Message> createCancelledNotification(const cJSON* json) {
+    return deserializeInto(std::make_unique<CancelledNotification>("", ""), json);
+}
+
+// Must stay sorted by name; checked at compile time below
+constexpr MethodEntry BUILTIN_METHODS[] = {
+    { METHOD_INITIALIZE,  MessageCategory::REQUEST,      MessageType::INITIALIZE_REQUEST,       createRequest<InitializeRequest> },
+    { METHOD_CANCELLED,   MessageCategory::NOTIFICATION, MessageType::CANCELLED_NOTIFICATION,   createCancelledNotification },
+    { METHOD_INITIALIZED, MessageCategory::NOTIFICATION, MessageType::INITIALIZED_NOTIFICATION, createInitializedNotification },
+    { METHOD_PROGRESS,    MessageCategory::NOTIFICATION, MessageType::PROGRESS_NOTIFICATION,    createProgressNotification },
+    { METHOD_PING,        MessageCategory::REQUEST,      MessageType::PING_REQUEST,             createRequest<PingRequest> },
+    { METHOD_TOOLS_CALL,  MessageCategory::REQUEST,      MessageType::CALL_TOOL_REQUEST,        createCallToolRequest },
+    { METHOD_TOOLS_LIST,  MessageCategory::REQUEST,      MessageType::LIST_TOOLS_REQUEST,       createRequest<ListToolsRequest> },
+};
+
+constexpr bool isSortedByName(const MethodEntry* entries, size_t count) {
+    for (size_t i = 1; i < count; ++i) {
+        if (!(entries[i - 1].name < entries[i].name)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(isSortedByName(BUILTIN_METHODS, std::size(BUILTIN_METHODS)),
+              "BUILTIN_METHODS must be sorted by name for binary search");
+
+const MethodEntry* findBuiltin(std::string_view method) {
+    const MethodEntry* begin = std::begin(BUILTIN_METHODS);
+    const MethodEntry* end = std::end(BUILTIN_METHODS);
+    const MethodEntry* it = std::lower_bound(begin, end, method,
+        [](const MethodEntry& entry, std::string_view name) { return entry.name < name; });
+    return (it != end && it->name == method) ? it : nullptr;
+}
+
+} // namespace
+
+// MethodTable implementation
+MethodEntry MethodTable::userMethods_[MAX_USER_METHODS];
+size_t MethodTable::userCount_ = 0;
+
+const MethodEntry* MethodTable::find(std::string_view method) {
+    if (method.empty() || method.size() > MAX_METHOD_NAME_LENGTH) {
+        return nullptr;
+    }
+
+    if (const MethodEntry* entry = findBuiltin(method)) {
+        return entry;
+    }
+
+    for (size_t i = 0; i < userCount_; ++i) {
+        if (userMethods_[i].name == method) {
+            return &userMethods_[i];
+        }
+    }
+
+    return nullptr;
+}
+
+const MethodEntry* MethodTable::find(const cJSON* json) {
+    const cJSON* method = json ? cJSON_GetObjectItem(json, MSG_KEY_METHOD) : nullptr;
+    if (!method || !cJSON_IsString(method) || !method->valuestring) {
+        return nullptr;
+    }
+    return find(std::string_view(method->valuestring));
+}
+
+int MethodTable::registerMethod(const char* name, MessageCategory category, MessageCreator create) {
+    if (!name || !create ||
+        (category != MessageCategory::REQUEST && category != MessageCategory::NOTIFICATION)) {
+        return TINYMCP_ERROR_INVALID_PARAMS;
+    }
+
+    if (find(std::string_view(name))) {
+        ESP_LOGW(TAG, "Method already registered: %s", name);
+        return TINYMCP_ERROR_INVALID_STATE;
+    }
+
+    if (userCount_ >= MAX_USER_METHODS) {
+        ESP_LOGW(TAG, "Method table full, cannot register %s", name);
+        return TINYMCP_ERROR_RESOURCE_LIMIT;
+    }
+
+    MethodEntry& entry = userMethods_[userCount_];
+    entry.name = name;
+    entry.category = category;
+    entry.type = category == MessageCategory::REQUEST ?
+        MessageType::CUSTOM_REQUEST : MessageType::CUSTOM_NOTIFICATION;
+    entry.create = create;
+    userCount_++;
+
+    ESP_LOGI(TAG, "Registered method: %s", name);
+    return TINYMCP_SUCCESS;
+}
+
+} // namespace tinymcp
@@ -0,0 +1,275 @@
+// Request latency instrumentation for TinyMCP
+// Fixed-bucket histograms per method/tool and stage, scraped via server_stats
+
+#include "tinymcp_metrics.h"
+
+#include "esp_timer.h"
+#include "esp_log.h"
+#include <atomic>
+
+static const char* TAG = "tinymcp_metrics";
+
+namespace tinymcp {
+
+// Boot milestones, kept with metrics compiled out
+
+static std::atomic<uint32_t> firstRequestMs(0);
+
+void noteRequestReceived() {
+    if (firstRequestMs.load(std::memory_order_relaxed) != 0) {
+        return;
+    }
+
+    // At least 1 so that 0 keeps meaning "none yet"
+    uint32_t elapsedMs = static_cast<uint32_t>(esp_timer_get_time() / 1000);
+    elapsedMs = elapsedMs ? elapsedMs : 1;
+    uint32_t expected = 0;
+    if (firstRequestMs.compare_exchange_strong(expected, elapsedMs, std::memory_order_relaxed)) {
+        ESP_LOGI(TAG, "Time to first request: %u ms", static_cast<unsigned>(elapsedMs));
+    }
+}
+
+uint32_t getFirstRequestMs() {
+    return firstRequestMs.load(std::memory_order_relaxed);
+}
+
+} // namespace tinymcp
+
+#if TINYMCP_METRICS
+
+#include "esp_system.h"
+#include <cstring>
+
+namespace tinymcp {
+
+// Roughly x3 steps from 100us to 1s, then one open-ended bucket
+const uint32_t Metrics::BUCKET_BOUNDS_US[Metrics::BUCKET_COUNT - 1] = {
+    100, 300, 1000, 3000, 10000, 30000, 100000, 300000, 1000000
+};
+
+static const TickType_t RECORD_LOCK_TICKS = pdMS_TO_TICKS(5);
+static const TickType_t SNAPSHOT_LOCK_TICKS = pdMS_TO_TICKS(100);
+
+const char* metricStageToString(MetricStage stage) {
+    switch (stage) {
+        case MetricStage::PARSE: return "parse";
+        case MetricStage::QUEUE_WAIT: return "queue_wait";
+        case MetricStage::EXECUTE: return "execute";
+        case MetricStage::SEND: return "send";
+        default: return "unknown";
+    }
+}
+
+Metrics Metrics::instance_;
+
+Metrics::Metrics() : keyCount_(1) {
+    memset(entries_, 0, sizeof(entries_));
+    memset(taskKeys_, 0, sizeof(taskKeys_));
+    strncpy(entries_[OTHER_KEY].name, "(other)", MAX_KEY_LENGTH);
+
+    for (auto& entry : entries_) {
+        for (auto& histogram : entry.stages) {
+            histogram.heapLowWater = UINT32_MAX;
+        }
+    }
+
+    mutex_ = xSemaphoreCreateMutex();
+}
+
+Metrics& Metrics::getInstance() {
+    return instance_;
+}
+
+uint32_t Metrics::nowUs() {
+    // Wraps after ~71 minutes; durations use unsigned differences
+    return static_cast<uint32_t>(esp_timer_get_time());
+}
+
+bool Metrics::lock() {
+    // Samples are dropped rather than stall the request path
+    return mutex_ && xSemaphoreTake(mutex_, RECORD_LOCK_TICKS) == pdTRUE;
+}
+
+uint8_t Metrics::keyFor(const char* name) {
+    if (!name || !*name) {
+        return OTHER_KEY;
+    }
+
+    // Names longer than a slot are compared on their truncated prefix
+    if (!lock()) {
+        return OTHER_KEY;
+    }
+
+    uint8_t key = OTHER_KEY;
+    for (size_t i = 1; i < keyCount_; ++i) {
+        if (strncmp(entries_[i].name, name, MAX_KEY_LENGTH) == 0) {
+            key = static_cast<uint8_t>(i);
+            break;
+        }
+    }
+
+    if (key == OTHER_KEY && keyCount_ < MAX_KEYS) {
+        key = static_cast<uint8_t>(keyCount_++);
+        strncpy(entries_[key].name, name, MAX_KEY_LENGTH);
+        entries_[key].name[MAX_KEY_LENGTH] = '\0';
+    }
+
+    unlock();
+    return key;
+}
+
+void Metrics::record(uint8_t key, MetricStage stage, uint32_t startUs) {
+    uint32_t elapsedUs = nowUs() - startUs;
+    uint32_t freeHeap = esp_get_free_heap_size();
+
+    size_t bucket = 0;
+    while (bucket < BUCKET_COUNT - 1 && elapsedUs > BUCKET_BOUNDS_US[bucket]) {
+        bucket++;
+    }
+
+    if (key >= MAX_KEYS || stage >= MetricStage::COUNT || !lock()) {
+        return;
+    }
+
+    Histogram& histogram = entries_[key].stages[static_cast<size_t>(stage)];
+    if (histogram.buckets[bucket] < UINT16_MAX) {
+        histogram.buckets[bucket]++;
+    }
+    histogram.count++;
+    histogram.totalUs += elapsedUs;
+    if (elapsedUs > histogram.maxUs) {
+        histogram.maxUs = elapsedUs;
+    }
+    if (freeHeap < histogram.heapLowWater) {
+        histogram.heapLowWater = freeHeap;
+    }
+
+    unlock();
+}
+
+uint8_t Metrics::getTaskKey() {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    uint8_t key = OTHER_KEY;
+
+    if (lock()) {
+        for (const auto& taskKey : taskKeys_) {
+            if (taskKey.task == self) {
+                key = taskKey.key;
+                break;
+            }
+        }
+        unlock();
+    }
+
+    return key;
+}
+
+void Metrics::setTaskKey(uint8_t key) {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    if (!lock()) {
+        return;
+    }
+
+    TaskKey* slot = nullptr;
+    for (auto& taskKey : taskKeys_) {
+        if (taskKey.task == self) {
+            slot = &taskKey;
+            break;
+        }
+        if (!slot && !taskKey.task) {
+            slot = &taskKey;
+        }
+    }
+
+    // With every slot taken the task's samples fall back to OTHER_KEY
+    if (slot) {
+        slot->task = self;
+        slot->key = key;
+    }
+
+    unlock();
+}
+
+void Metrics::clearTaskKey() {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    if (!lock()) {
+        return;
+    }
+
+    for (auto& taskKey : taskKeys_) {
+        if (taskKey.task == self) {
+            taskKey.task = nullptr;
+            taskKey.key = OTHER_KEY;
+        }
+    }
+
+    unlock();
+}
+
+cJSON* Metrics::toJson() {
+    cJSON* json = cJSON_CreateObject();
+    if (!json) {
+        return nullptr;
+    }
+
+    cJSON* bounds = cJSON_AddArrayToObject(json, "bucket_bounds_us");
+    for (uint32_t bound : BUCKET_BOUNDS_US) {
+        cJSON_AddItemToArray(bounds, cJSON_CreateNumber(bound));
+    }
+
+    cJSON* methods = cJSON_AddObjectToObject(json, "methods");
+    if (!mutex_ || xSemaphoreTake(mutex_, SNAPSHOT_LOCK_TICKS) != pdTRUE) {
+        ESP_LOGW(TAG, "Metrics busy, returning empty snapshot");
+        return json;
+    }
+
+    for (size_t i = 0; i < keyCount_; ++i) {
+        const Entry& entry = entries_[i];
+        cJSON* method = nullptr;
+
+        for (size_t s = 0; s < static_cast<size_t>(MetricStage::COUNT); ++s) {
+            const Histogram& histogram = entry.stages[s];
+            if (histogram.count == 0) {
+                continue;
+            }
+
+            if (!method) {
+                method = cJSON_AddObjectToObject(methods, entry.name);
+            }
+
+            cJSON* stage = cJSON_AddObjectToObject(method, metricStageToString(static_cast<MetricStage>(s)));
+            cJSON_AddNumberToObject(stage, "count", histogram.count);
+            cJSON_AddNumberToObject(stage, "avg_us", static_cast<double>(histogram.totalUs / histogram.count));
+            cJSON_AddNumberToObject(stage, "max_us", histogram.maxUs);
+            cJSON_AddNumberToObject(stage, "heap_low_water", histogram.heapLowWater);
+
+            cJSON* buckets = cJSON_AddArrayToObject(stage, "buckets");
+            for (uint16_t count : histogram.buckets) {
+                cJSON_AddItemToArray(buckets, cJSON_CreateNumber(count));
+            }
+        }
+    }
+
+    unlock();
+    return json;
+}
+
+void Metrics::reset() {
+    if (!mutex_ || xSemaphoreTake(mutex_, SNAPSHOT_LOCK_TICKS) != pdTRUE) {
+        return;
+    }
+
+    // Keys stay allocated so cached slot numbers remain valid
+    for (size_t i = 0; i < keyCount_; ++i) {
+        for (auto& histogram : entries_[i].stages) {
+            memset(&histogram, 0, sizeof(histogram));
+            histogram.heapLowWater = UINT32_MAX;
+        }
+    }
+
+    unlock();
+}
+
+} // namespace tinymcp
+
+#endif // TINYMCP_METRICS
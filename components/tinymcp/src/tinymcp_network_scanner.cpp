@@ -0,0 +1,290 @@
+// Shared WiFi scan cache for TinyMCP
+// Non-blocking esp_wifi_scan_start, completed by the WIFI_EVENT_SCAN_DONE handler
+
+#include "tinymcp_network_scanner.h"
+#include "tinymcp_constants.h"
+
+#include "esp_event.h"
+#include "esp_log.h"
+#include "esp_wifi.h"
+#include "freertos/task.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+static const char* TAG = "tinymcp_scanner";
+
+namespace tinymcp {
+
+NetworkScanner& NetworkScanner::getInstance() {
+    static NetworkScanner instance;
+    return instance;
+}
+
+NetworkScanner::NetworkScanner() :
+    mutex_(xSemaphoreCreateMutex()), handlerRegistered_(false), scanning_(false), scanStartTime_(0),
+    completed_(0), lastStatus_(TINYMCP_SUCCESS), scanTimer_(onScanTimeout, this) {}
+
+bool NetworkScanner::poll(const Options& options, uint32_t maxAgeMs, uint32_t& ticket, Result& result,
+                          const void* owner, const TaskNotify& notify) {
+    if (!mutex_ || xSemaphoreTake(mutex_, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return false;
+    }
+
+    TickType_t now = xTaskGetTickCount();
+    bool done = false;
+
+    // scanTimer_ wakes the waiters of a lost scan so one of them gets here
+    if (scanning_ && (now - scanStartTime_) >= pdMS_TO_TICKS(SCAN_DONE_TIMEOUT_MS)) {
+        ESP_LOGW(TAG, "No WIFI_EVENT_SCAN_DONE after %u ms", (unsigned)SCAN_DONE_TIMEOUT_MS);
+        esp_wifi_scan_stop();
+        scanning_ = false;
+        completed_++;
+        lastStatus_ = TINYMCP_ERROR_TIMEOUT;
+        stats_.scansFailed++;
+        wakeWaiters();
+    }
+
+    if (ticket != 0 && completed_ >= ticket) {
+        const CacheEntry* entry = findCache(options, ticket, portMAX_DELAY, now);
+        if (entry) {
+            copyCache(*entry, options, result, now);
+            done = true;
+        } else if (completed_ == ticket && lastStatus_ != TINYMCP_SUCCESS) {
+            result.status = lastStatus_;
+            done = true;
+        } else {
+            // Evicted by scans with other options before we looked; scan again
+            ticket = 0;
+        }
+    } else if (ticket == 0) {
+        const CacheEntry* entry = findCache(options, 1, pdMS_TO_TICKS(maxAgeMs), now);
+        if (entry) {
+            copyCache(*entry, options, result, now);
+            result.cached = true;
+            stats_.cacheHits++;
+            done = true;
+        }
+    }
+
+    if (!done && ticket == 0) {
+        if (!scanning_) {
+            int status = startScan(options);
+            if (status == TINYMCP_SUCCESS) {
+                ticket = completed_ + 1;
+            } else {
+                result.status = status;
+                done = true;
+            }
+        } else if (scanOptions_.covers(options)) {
+            ticket = completed_ + 1;
+            stats_.scansJoined++;
+        }
+        // Otherwise the radio is busy with other options; try again once it is free
+    }
+
+    if (!done && scanning_ && notify.isSet()) {
+        addWaiter(owner, notify);
+    }
+
+    xSemaphoreGive(mutex_);
+    return done;
+}
+
+bool NetworkScanner::isWaiting(const void* owner) {
+    if (!mutex_ || xSemaphoreTake(mutex_, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return false;
+    }
+    bool waiting = std::any_of(waiters_.begin(), waiters_.end(),
+                               [owner](const Waiter& waiter) { return waiter.owner == owner; });
+    xSemaphoreGive(mutex_);
+    return waiting;
+}
+
+void NetworkScanner::removeWaiter(const void* owner) {
+    if (!mutex_ || xSemaphoreTake(mutex_, portMAX_DELAY) != pdTRUE) {
+        return;
+    }
+    waiters_.erase(std::remove_if(waiters_.begin(), waiters_.end(),
+                                  [owner](const Waiter& waiter) { return waiter.owner == owner; }),
+                   waiters_.end());
+    xSemaphoreGive(mutex_);
+}
+
+NetworkScanner::Stats NetworkScanner::getStats() {
+    Stats stats;
+    if (mutex_ && xSemaphoreTake(mutex_, pdMS_TO_TICKS(100)) == pdTRUE) {
+        stats = stats_;
+        xSemaphoreGive(mutex_);
+    }
+    return stats;
+}
+
+int NetworkScanner::startScan(const Options& options) {
+    if (!handlerRegistered_) {
+        if (esp_event_handler_register(WIFI_EVENT, WIFI_EVENT_SCAN_DONE, &NetworkScanner::eventHandler, this) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to register the scan-done handler");
+            return TINYMCP_ERROR_HARDWARE_FAILED;
+        }
+        handlerRegistered_ = true;
+    }
+
+    wifi_scan_config_t config = {};
+    config.ssid = nullptr;
+    config.bssid = nullptr;
+    config.channel = options.channel;
+    config.show_hidden = options.showHidden;
+    if (options.passive) {
+        config.scan_type = WIFI_SCAN_TYPE_PASSIVE;
+        config.scan_time.passive = options.dwellMs ? options.dwellMs : 360;
+    } else {
+        config.scan_type = WIFI_SCAN_TYPE_ACTIVE;
+        config.scan_time.active.min = options.dwellMs ? options.dwellMs / 3 : 100;
+        config.scan_time.active.max = options.dwellMs ? options.dwellMs : 300;
+    }
+
+    esp_err_t err = esp_wifi_scan_start(&config, false);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "esp_wifi_scan_start failed: %s", esp_err_to_name(err));
+        stats_.scansFailed++;
+        return TINYMCP_ERROR_HARDWARE_FAILED;
+    }
+
+    scanning_ = true;
+    scanOptions_ = options;
+    scanStartTime_ = xTaskGetTickCount();
+    TimerWheel::getInstance().arm(scanTimer_, SCAN_DONE_TIMEOUT_MS);
+    stats_.scansStarted++;
+    ESP_LOGD(TAG, "Scan started (channel %u, %s)", options.channel, options.passive ? "passive" : "active");
+    return TINYMCP_SUCCESS;
+}
+
+const NetworkScanner::CacheEntry* NetworkScanner::findCache(const Options& options, uint32_t minGeneration,
+                                                            TickType_t maxAge, TickType_t now) const {
+    const CacheEntry* newest = nullptr;
+    for (const auto& entry : cache_) {
+        if (entry.options.covers(options) && entry.generation >= minGeneration &&
+            (now - entry.time) <= maxAge && (!newest || entry.generation > newest->generation)) {
+            newest = &entry;
+        }
+    }
+    return newest;
+}
+
+void NetworkScanner::copyCache(const CacheEntry& entry, const Options& options, Result& result,
+                               TickType_t now) const {
+    result.status = TINYMCP_SUCCESS;
+    result.networks.clear();
+    for (const auto& network : entry.networks) {
+        if (options.channel == 0 || network.channel == options.channel) {
+            result.networks.push_back(network);
+        }
+    }
+    result.ageMs = (now - entry.time) * portTICK_PERIOD_MS;
+}
+
+void NetworkScanner::addWaiter(const void* owner, const TaskNotify& notify) {
+    for (auto& waiter : waiters_) {
+        if (waiter.owner == owner) {
+            waiter.notify = notify;
+            return;
+        }
+    }
+    waiters_.push_back({owner, notify});
+}
+
+void NetworkScanner::wakeWaiters() {
+    for (const auto& waiter : waiters_) {
+        waiter.notify.signal();
+    }
+    waiters_.clear();
+}
+
+void NetworkScanner::onScanDone(uint32_t status) {
+    // Fetching the records also frees the driver's copy, so do it even when
+    // the scan timed out on our side
+    uint16_t count = MAX_RECORDS;
+    wifi_ap_record_t* records = static_cast<wifi_ap_record_t*>(malloc(sizeof(wifi_ap_record_t) * count));
+    esp_err_t err = ESP_FAIL;
+    if (records) {
+        err = esp_wifi_scan_get_ap_records(&count, records);
+    }
+
+    std::vector<Network> networks;
+    int result = TINYMCP_SUCCESS;
+    if (!records) {
+        result = TINYMCP_ERROR_OUT_OF_MEMORY;
+    } else if (status != 0 || err != ESP_OK) {
+        result = TINYMCP_ERROR_HARDWARE_FAILED;
+    } else {
+        networks.resize(count);
+        for (uint16_t i = 0; i < count; i++) {
+            Network& network = networks[i];
+            memcpy(network.ssid, records[i].ssid, sizeof(network.ssid));
+            network.ssid[sizeof(network.ssid) - 1] = '\0';
+            memcpy(network.bssid, records[i].bssid, sizeof(network.bssid));
+            network.channel = records[i].primary;
+            network.rssi = records[i].rssi;
+            network.authmode = static_cast<uint8_t>(records[i].authmode);
+        }
+    }
+    free(records);
+
+    TimerWheel::getInstance().disarm(scanTimer_);
+    if (xSemaphoreTake(mutex_, portMAX_DELAY) != pdTRUE) {
+        return;
+    }
+    if (scanning_) {
+        scanning_ = false;
+        completed_++;
+        lastStatus_ = result;
+        if (result == TINYMCP_SUCCESS) {
+            // Replace the entry for these options, else the oldest once full
+            auto slot = std::find_if(cache_.begin(), cache_.end(),
+                                     [this](const CacheEntry& entry) { return entry.options == scanOptions_; });
+            if (slot == cache_.end() && cache_.size() >= MAX_CACHED_SCANS) {
+                slot = std::min_element(cache_.begin(), cache_.end(),
+                                        [](const CacheEntry& a, const CacheEntry& b) { return a.generation < b.generation; });
+            }
+            if (slot == cache_.end()) {
+                slot = cache_.insert(cache_.end(), CacheEntry());
+            }
+            slot->options = scanOptions_;
+            slot->networks.swap(networks);
+            slot->generation = completed_;
+            slot->time = xTaskGetTickCount();
+            ESP_LOGD(TAG, "Scan %u done, %u networks", (unsigned)completed_, (unsigned)slot->networks.size());
+        } else {
+            stats_.scansFailed++;
+            ESP_LOGW(TAG, "Scan %u failed: %d", (unsigned)completed_, result);
+        }
+        wakeWaiters();
+    }
+    xSemaphoreGive(mutex_);
+}
+
+void NetworkScanner::onScanTimeout(void* arg) {
+    NetworkScanner* scanner = static_cast<NetworkScanner*>(arg);
+
+    // Runs with the wheel locked and must not block, so stopping the radio
+    // is left to the next poll; if the lock is busy, retry a step later
+    if (xSemaphoreTake(scanner->mutex_, 0) != pdTRUE) {
+        TimerWheel::getInstance().arm(scanner->scanTimer_, TimerWheel::RESOLUTION_MS);
+        return;
+    }
+    if (scanner->scanning_) {
+        scanner->wakeWaiters();
+    }
+    xSemaphoreGive(scanner->mutex_);
+}
+
+void NetworkScanner::eventHandler(void* arg, const char* base, int32_t id, void* data) {
+    if (base != WIFI_EVENT || id != WIFI_EVENT_SCAN_DONE) {
+        return;
+    }
+    const wifi_event_sta_scan_done_t* event = static_cast<const wifi_event_sta_scan_done_t*>(data);
+    static_cast<NetworkScanner*>(arg)->onScanDone(event ? event->status : 0);
+}
+
+} // namespace tinymcp
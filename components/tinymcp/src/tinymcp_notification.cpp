@@ -2,6 +2,7 @@
 // Implementation of JSON-RPC 2.0 compliant notification messages for ESP32/ESP8266
 
 #include "tinymcp_notification.h"
+#include "tinymcp_method_table.h"
 #include <algorithm>
 #include <cstring>
 
@@ -570,40 +571,11 @@ std::unique_ptr<Notification> NotificationFactory::createFromJson(const std::str
 std::unique_ptr<Notification> NotificationFactory::createFromJson(const cJSON* json) {
     if (!json || !JsonHelper::validateNotification(json)) return nullptr;
     
-    std::string method = JsonHelper::getString(json, MSG_KEY_METHOD);
-    MessageType type = getNotificationType(method);
-    
-    if (type == MessageType::UNKNOWN) return nullptr;
-    
-    std::unique_ptr<Notification> notification;
-    
-    switch (type) {
-        case MessageType::INITIALIZED_NOTIFICATION: {
-            auto initNotif = std::make_unique<InitializedNotification>();
-            if (initNotif->deserialize(JsonHelper::toString(json)) == 0) {
-                notification = std::move(initNotif);
-            }
-            break;
-        }
-        case MessageType::PROGRESS_NOTIFICATION: {
-            auto progNotif = std::make_unique<ProgressNotification>(ProgressToken(), 0, 100);
-            if (progNotif->deserialize(JsonHelper::toString(json)) == 0) {
-                notification = std::move(progNotif);
-            }
-            break;
-        }
-        case MessageType::CANCELLED_NOTIFICATION: {
-            auto cancelNotif = std::make_unique<CancelledNotification>("", "");
-            if (cancelNotif->deserialize(JsonHelper::toString(json)) == 0) {
-                notification = std::move(cancelNotif);
-            }
-            break;
-        }
-        default:
-            break;
-    }
+    const MethodEntry* entry = MethodTable::find(json);
+    if (!entry || entry->category != MessageCategory::NOTIFICATION) return nullptr;
     
-    return notification;
+    // Notification entries always construct a Notification subclass
+    return std::unique_ptr<Notification>(static_cast<Notification*>(entry->create(json).release()));
 }
 
 std::unique_ptr<InitializedNotification> NotificationFactory::createInitializedNotification(
@@ -648,13 +620,6 @@ std::unique_ptr<LogNotification> NotificationFactory::createLogNotification(
     return notification;
 }
 
-MessageType NotificationFactory::getNotificationType(const std::string& method) {
-    if (method == METHOD_INITIALIZED) return MessageType::INITIALIZED_NOTIFICATION;
-    if (method == METHOD_PROGRESS) return MessageType::PROGRESS_NOTIFICATION;
-    if (method == METHOD_CANCELLED) return MessageType::CANCELLED_NOTIFICATION;
-    return MessageType::UNKNOWN;
-}
-
 // NotificationValidator implementation
 
 bool NotificationValidator::validateInitializedNotification(const cJSON* json) {
@@ -0,0 +1,346 @@
+// Single-task select() reactor for TinyMCP sessions
+// Serves many clients from one FreeRTOS task instead of four tasks per session
+
+#include "tinymcp_reactor.h"
+#include "tinymcp_constants.h"
+
+#include "esp_log.h"
+#include <cstring>
+#include <algorithm>
+#include <errno.h>
+
+static const char* TAG = "tinymcp_reactor";
+
+namespace tinymcp {
+
+// SessionReactor implementation
+SessionReactor::SessionReactor(EspSocketServer& server, const ReactorConfig& config) :
+    server_(server), config_(config), running_(false), reactorHandle_(nullptr),
+    wakeSocket_(-1), wakePending_(false) {
+
+    // Sessions served here must never spawn their own tasks
+    config_.sessionConfig.reactorMode = true;
+    sessions_.reserve(config_.maxSessions);
+}
+
+SessionReactor::~SessionReactor() {
+    stop();
+
+    // Let the reactor task observe the stop before tearing down sessions
+    while (reactorHandle_) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+
+    while (!sessions_.empty()) {
+        closeSession(sessions_.size() - 1);
+    }
+    closeWakeSocket();
+}
+
+int SessionReactor::start() {
+    if (running_) {
+        return TINYMCP_SUCCESS;
+    }
+
+    if (!server_.isRunning()) {
+        int result = server_.start();
+        if (result != TINYMCP_SUCCESS) {
+            return result;
+        }
+    }
+
+    // Without it a finished tool task would wait for the next socket event
+    if (wakeSocket_ < 0) {
+        int result = openWakeSocket();
+        if (result != TINYMCP_SUCCESS) {
+            return result;
+        }
+    }
+
+    // accept() must never block the reactor
+    SocketUtils::setSocketNonBlocking(server_.getListenSocket(), true);
+    server_.setAdmissionConfig(config_.sessionConfig.admission);
+
+    // Reconnecting clients then reuse a session's queues and locks instead
+    // of allocating them per connection
+    SessionManager& manager = SessionManager::getInstance();
+    if (config_.poolSessions && manager.getPoolSize() == 0 &&
+        manager.initializePool(config_.maxSessions, config_.sessionConfig) != TINYMCP_SUCCESS) {
+        ESP_LOGW(TAG, "Session pool incomplete, extra sessions allocated per connection");
+    }
+
+    running_ = true;
+
+    BaseType_t result = xTaskCreate(
+        reactorTask,
+        "mcp_reactor",
+        config_.taskStackSize,
+        this,
+        config_.taskPriority,
+        &reactorHandle_
+    );
+
+    if (result != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create reactor task");
+        running_ = false;
+        return TINYMCP_ERROR_TASK_CREATION_FAILED;
+    }
+
+    ESP_LOGI(TAG, "Reactor started for up to %u sessions on port %d",
+             (unsigned)config_.maxSessions, server_.getPort());
+    return TINYMCP_SUCCESS;
+}
+
+int SessionReactor::stop() {
+    if (!running_) {
+        return TINYMCP_SUCCESS;
+    }
+
+    // Closing the listen socket makes the pending select() return; the
+    // wakeup covers a loop that is not watching it
+    running_ = false;
+    server_.stop();
+    wake(this);
+
+    ESP_LOGI(TAG, "Reactor stopping");
+    return TINYMCP_SUCCESS;
+}
+
+void SessionReactor::reactorTask(void* pvParameters) {
+    SessionReactor* reactor = static_cast<SessionReactor*>(pvParameters);
+
+    ESP_LOGI(TAG, "Reactor task started");
+
+    while (reactor->running_) {
+        int result = reactor->runOnce();
+        if (result != TINYMCP_SUCCESS && reactor->running_) {
+            ESP_LOGE(TAG, "Reactor iteration failed: %d", result);
+            vTaskDelay(pdMS_TO_TICKS(100)); // Back off instead of spinning on a broken socket
+        }
+    }
+
+    while (!reactor->sessions_.empty()) {
+        reactor->closeSession(reactor->sessions_.size() - 1);
+    }
+    reactor->closeWakeSocket();
+
+    ESP_LOGI(TAG, "Reactor task ended");
+    reactor->reactorHandle_ = nullptr;
+    vTaskDelete(NULL);
+}
+
+int SessionReactor::runOnce(uint32_t maxWaitMs) {
+    fd_set readSet;
+    FD_ZERO(&readSet);
+    int maxFd = -1;
+
+    TickType_t waitTicks = maxWaitMs == UINT32_MAX ? portMAX_DELAY : pdMS_TO_TICKS(maxWaitMs);
+
+    // Under memory pressure leave session data in the socket buffers so TCP
+    // flow control throttles the clients, and re-check the heap shortly
+    const AdmissionConfig& admission = config_.sessionConfig.admission;
+    const bool readsPaused = !AdmissionControl::canRead(admission);
+    if (readsPaused) {
+        stats_.readPauses++;
+        waitTicks = std::min(waitTicks, pdMS_TO_TICKS(admission.pauseRetryMs));
+    }
+
+    // Run due timers and tasks first; anything a previous read submitted
+    // executes here before we sleep again
+    for (size_t i = sessions_.size(); i-- > 0;) {
+        TickType_t nextWakeup = portMAX_DELAY;
+        int socket = sessions_[i]->getSocket();
+
+        if (sessions_[i]->poll(&nextWakeup) != TINYMCP_SUCCESS || socket < 0) {
+            closeSession(i);
+            continue;
+        }
+
+        waitTicks = std::min(waitTicks, nextWakeup);
+        if (!readsPaused) {
+            FD_SET(socket, &readSet);
+            maxFd = std::max(maxFd, socket);
+        }
+    }
+
+    // Only watch the listen socket while there is room for another session
+    int listenSocket = server_.getListenSocket();
+    if (listenSocket >= 0 && sessions_.size() < config_.maxSessions) {
+        FD_SET(listenSocket, &readSet);
+        maxFd = std::max(maxFd, listenSocket);
+    }
+
+    if (maxFd < 0) {
+        if (readsPaused) {
+            vTaskDelay(waitTicks);
+            return TINYMCP_SUCCESS;
+        }
+        return TINYMCP_ERROR_INVALID_STATE;
+    }
+
+    // Watched even while reads are paused: it carries no client data
+    if (wakeSocket_ >= 0) {
+        FD_SET(wakeSocket_, &readSet);
+        maxFd = std::max(maxFd, wakeSocket_);
+    }
+
+    struct timeval timeout;
+    struct timeval* timeoutPtr = nullptr;
+    if (waitTicks != portMAX_DELAY) {
+        uint32_t waitMs = waitTicks * portTICK_PERIOD_MS;
+        timeout.tv_sec = waitMs / 1000;
+        timeout.tv_usec = (waitMs % 1000) * 1000;
+        timeoutPtr = &timeout;
+    }
+
+    int ready = select(maxFd + 1, &readSet, NULL, NULL, timeoutPtr);
+    stats_.wakeups++;
+
+    if (ready < 0) {
+        if (errno == EINTR || !running_) {
+            return TINYMCP_SUCCESS;
+        }
+        ESP_LOGW(TAG, "select() failed: %s", strerror(errno));
+        return TINYMCP_ERROR_TRANSPORT_FAILED;
+    }
+
+    if (ready == 0) {
+        return TINYMCP_SUCCESS; // Timer wakeup, handled by the next poll pass
+    }
+
+    // The finished task is picked up by the next poll pass
+    if (wakeSocket_ >= 0 && FD_ISSET(wakeSocket_, &readSet)) {
+        drainWakeSocket();
+    }
+
+    for (size_t i = sessions_.size(); i-- > 0;) {
+        int socket = sessions_[i]->getSocket();
+        if (socket >= 0 && FD_ISSET(socket, &readSet)) {
+            if (sessions_[i]->onReadable() == TINYMCP_ERROR_TRANSPORT_FAILED) {
+                closeSession(i);
+            }
+        }
+    }
+
+    if (listenSocket >= 0 && FD_ISSET(listenSocket, &readSet)) {
+        acceptPending();
+    }
+
+    return TINYMCP_SUCCESS;
+}
+
+int SessionReactor::acceptPending() {
+    while (sessions_.size() < config_.maxSessions) {
+        auto transport = server_.acceptConnection(0);
+        if (!transport) {
+            break; // Listen socket drained
+        }
+
+        ESP_LOGI(TAG, "New client connection: %s", transport->getClientInfo().c_str());
+
+        auto session = SessionManager::getInstance().createSession(std::move(transport),
+                                                                   config_.sessionConfig);
+        if (!session || session->getState() == SessionState::ERROR_STATE) {
+            ESP_LOGE(TAG, "Failed to create session");
+            stats_.connectionsRejected++;
+            continue;
+        }
+
+        if (sessionSetup_) {
+            sessionSetup_(*session);
+        }
+        session->setWakeup(&SessionReactor::wake, this);
+
+        int result = session->initialize();
+        if (result != TINYMCP_SUCCESS) {
+            ESP_LOGE(TAG, "Failed to initialize session: %d", result);
+            SessionManager::getInstance().removeSession(session);
+            stats_.connectionsRejected++;
+            continue;
+        }
+
+        sessions_.push_back(session);
+        stats_.connectionsAccepted++;
+    }
+
+    return TINYMCP_SUCCESS;
+}
+
+int SessionReactor::openWakeSocket() {
+    // A UDP socket bound to loopback and connected to itself, so wake()
+    // needs no address and nothing else can send to it
+    int wakeSocket = socket(AF_INET, SOCK_DGRAM, 0);
+    if (wakeSocket < 0) {
+        ESP_LOGE(TAG, "Failed to create wake socket: %s", strerror(errno));
+        return TINYMCP_ERROR_TRANSPORT_FAILED;
+    }
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    socklen_t length = sizeof(address);
+
+    if (bind(wakeSocket, (struct sockaddr*)&address, sizeof(address)) != 0 ||
+        getsockname(wakeSocket, (struct sockaddr*)&address, &length) != 0 ||
+        connect(wakeSocket, (struct sockaddr*)&address, sizeof(address)) != 0 ||
+        SocketUtils::setSocketNonBlocking(wakeSocket, true) != TINYMCP_SUCCESS) {
+        ESP_LOGE(TAG, "Failed to set up wake socket: %s", strerror(errno));
+        close(wakeSocket);
+        return TINYMCP_ERROR_TRANSPORT_FAILED;
+    }
+
+    wakeSocket_ = wakeSocket;
+    wakePending_ = false;
+    return TINYMCP_SUCCESS;
+}
+
+void SessionReactor::closeWakeSocket() {
+    if (wakeSocket_ >= 0) {
+        close(wakeSocket_);
+        wakeSocket_ = -1;
+    }
+}
+
+void SessionReactor::drainWakeSocket() {
+    char buffer[16];
+    while (recv(wakeSocket_, buffer, sizeof(buffer), 0) > 0) {
+    }
+    stats_.taskWakeups++;
+
+    // Cleared only once drained: a wake() in between skips its send, but
+    // the poll pass this return leads to sees its task anyway
+    wakePending_ = false;
+}
+
+void SessionReactor::wake(void* arg) {
+    SessionReactor* reactor = static_cast<SessionReactor*>(arg);
+    int wakeSocket = reactor->wakeSocket_;
+    if (wakeSocket < 0 || reactor->wakePending_.exchange(true)) {
+        return;
+    }
+
+    char byte = 0;
+    if (send(wakeSocket, &byte, 1, 0) != 1) {
+        reactor->wakePending_ = false;
+    }
+}
+
+void SessionReactor::closeSession(size_t index) {
+    if (index >= sessions_.size()) {
+        return;
+    }
+
+    std::shared_ptr<Session> session = sessions_[index];
+    sessions_[index] = sessions_.back();
+    sessions_.pop_back();
+
+    session->shutdown();
+    SessionManager::getInstance().removeSession(session);
+    stats_.sessionsClosed++;
+
+    ESP_LOGI(TAG, "Session closed, %u active", (unsigned)sessions_.size());
+}
+
+} // namespace tinymcp
@@ -2,6 +2,8 @@
 // Implementation of JSON-RPC 2.0 compliant request messages for ESP32/ESP8266
 
 #include "tinymcp_request.h"
+#include "tinymcp_method_table.h"
+#include "tinymcp_cbor.h"
 #include <algorithm>
 #include <cstring>
 
@@ -80,6 +82,12 @@ int Request::doDeserialize(const cJSON* json) {
     // Deserialize parameters (implemented by derived classes)
     cJSON* params = JsonHelper::getObject(json, MSG_KEY_PARAMS);
     if (params) {
+        // MCP carries the token in params._meta
+        cJSON* meta = JsonHelper::getObject(params, MSG_KEY_META);
+        if (meta && JsonHelper::isString(meta, MSG_KEY_PROGRESS_TOKEN)) {
+            setProgressToken(JsonHelper::getString(meta, MSG_KEY_PROGRESS_TOKEN));
+        }
+        
         int result = deserializeParams(params);
         if (result != 0) return result;
     }
@@ -96,6 +104,23 @@ void InitializeRequest::setClientCapabilities(cJSON* capabilities) {
     clientCapabilities_ = capabilities;
 }
 
+WireFormat InitializeRequest::getPreferredWireFormat() const {
+    // capabilities.experimental.encoding.formats, in client preference order
+    const cJSON* experimental = clientCapabilities_ ?
+        JsonHelper::getObject(clientCapabilities_, MSG_KEY_EXPERIMENTAL) : nullptr;
+    const cJSON* encoding = experimental ? JsonHelper::getObject(experimental, MSG_KEY_ENCODING) : nullptr;
+    const cJSON* formats = encoding ? JsonHelper::getArray(encoding, MSG_KEY_FORMATS) : nullptr;
+    
+    const cJSON* item = nullptr;
+    cJSON_ArrayForEach(item, formats) {
+        WireFormat format;
+        if (cJSON_IsString(item) && wireFormatFromString(item->valuestring, format)) {
+            return format;
+        }
+    }
+    return WireFormat::JSON;
+}
+
 bool InitializeRequest::validateParams(const cJSON* params) const {
     if (!params) return false;
     
@@ -410,51 +435,11 @@ std::unique_ptr<Request> RequestFactory::createFromJson(const std::string& jsonS
 std::unique_ptr<Request> RequestFactory::createFromJson(const cJSON* json) {
     if (!json || !JsonHelper::validateRequest(json)) return nullptr;
     
-    std::string method = JsonHelper::getString(json, MSG_KEY_METHOD);
-    MessageType type = getRequestType(method);
-    
-    if (type == MessageType::UNKNOWN) return nullptr;
-    
-    // Extract ID
-    MessageId id;
-    if (!id.setFromJson(json)) return nullptr;
-    
-    std::unique_ptr<Request> request;
-    
-    switch (type) {
-        case MessageType::INITIALIZE_REQUEST: {
-            auto initReq = std::make_unique<InitializeRequest>(id);
-            if (initReq->deserialize(JsonHelper::toString(json)) == 0) {
-                request = std::move(initReq);
-            }
-            break;
-        }
-        case MessageType::LIST_TOOLS_REQUEST: {
-            auto listReq = std::make_unique<ListToolsRequest>(id);
-            if (listReq->deserialize(JsonHelper::toString(json)) == 0) {
-                request = std::move(listReq);
-            }
-            break;
-        }
-        case MessageType::CALL_TOOL_REQUEST: {
-            auto callReq = std::make_unique<CallToolRequest>(id, "");
-            if (callReq->deserialize(JsonHelper::toString(json)) == 0) {
-                request = std::move(callReq);
-            }
-            break;
-        }
-        case MessageType::PING_REQUEST: {
-            auto pingReq = std::make_unique<PingRequest>(id);
-            if (pingReq->deserialize(JsonHelper::toString(json)) == 0) {
-                request = std::move(pingReq);
-            }
-            break;
-        }
-        default:
-            break;
-    }
+    const MethodEntry* entry = MethodTable::find(json);
+    if (!entry || entry->category != MessageCategory::REQUEST) return nullptr;
     
-    return request;
+    // Request entries always construct a Request subclass
+    return std::unique_ptr<Request>(static_cast<Request*>(entry->create(json).release()));
 }
 
 std::unique_ptr<InitializeRequest> RequestFactory::createInitializeRequest(
@@ -493,14 +478,6 @@ std::unique_ptr<PingRequest> RequestFactory::createPingRequest(const MessageId&
     return std::make_unique<PingRequest>(id);
 }
 
-MessageType RequestFactory::getRequestType(const std::string& method) {
-    if (method == METHOD_INITIALIZE) return MessageType::INITIALIZE_REQUEST;
-    if (method == METHOD_TOOLS_LIST) return MessageType::LIST_TOOLS_REQUEST;
-    if (method == METHOD_TOOLS_CALL) return MessageType::CALL_TOOL_REQUEST;
-    if (method == METHOD_PING) return MessageType::PING_REQUEST;
-    return MessageType::UNKNOWN;
-}
-
 // RequestValidator implementation
 
 bool RequestValidator::validateInitializeRequest(const cJSON* json) {
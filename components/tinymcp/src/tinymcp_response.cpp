@@ -30,6 +30,32 @@ int Response::serialize(std::string& jsonOut) const {
     return jsonOut.empty() ? -1 : 0;
 }
 
+int Response::write(JsonWriter& writer) const {
+    writer.beginObject();
+    writeCommonFields(writer);
+    writer.key(MSG_KEY_ID);
+    id_.writeJson(writer);
+    
+    int result = writeResult(writer);
+    if (result != 0) return result;
+    
+    writer.endObject();
+    return writer.getStatus();
+}
+
+int Response::writeResult(JsonWriter& writer) const {
+    JsonValue json = JsonValue::createObject();
+    if (!json.isValid()) return TINYMCP_ERROR_OUT_OF_MEMORY;
+    
+    int result = serializeResult(json.get());
+    if (result != 0) return result;
+    
+    for (const cJSON* item = json.get()->child; item; item = item->next) {
+        writer.key(item->string).value(item);
+    }
+    return writer.getStatus();
+}
+
 int Response::deserialize(const std::string& jsonIn) {
     JsonValue json = JsonValue::parse(jsonIn);
     if (!json.isValid()) return TINYMCP_PARSE_ERROR;
@@ -354,7 +380,16 @@ cJSON* ToolContent::toJson() const {
                          (type_ == ContentType::IMAGE) ? "image" : "resource";
     
     JsonHelper::setString(json, MSG_KEY_TYPE, typeStr);
-    JsonHelper::setString(json, MSG_KEY_TEXT, text_);
+    if (json_) {
+        std::string text = JsonHelper::toString(json_.get());
+        if (text.empty()) {
+            cJSON_Delete(json);
+            return nullptr;
+        }
+        JsonHelper::setString(json, MSG_KEY_TEXT, text);
+    } else {
+        JsonHelper::setString(json, MSG_KEY_TEXT, text_);
+    }
     
     if (!mimeType_.empty()) {
         JsonHelper::setString(json, MSG_KEY_MIMETYPE, mimeType_);
@@ -383,6 +418,24 @@ bool ToolContent::fromJson(const cJSON* json) {
     return !text_.empty();
 }
 
+void ToolContent::write(JsonWriter& writer) const {
+    const char* typeStr = (type_ == ContentType::TEXT) ? "text" : 
+                         (type_ == ContentType::IMAGE) ? "image" : "resource";
+    
+    writer.beginObject();
+    writer.key(MSG_KEY_TYPE).value(typeStr);
+    writer.key(MSG_KEY_TEXT);
+    if (json_) {
+        writer.jsonText(json_.get());
+    } else {
+        writer.value(text_);
+    }
+    if (!mimeType_.empty()) {
+        writer.key(MSG_KEY_MIMETYPE).value(mimeType_);
+    }
+    writer.endObject();
+}
+
 ToolContent ToolContent::createText(const std::string& text) {
     return ToolContent(ContentType::TEXT, text);
 }
@@ -395,6 +448,10 @@ ToolContent ToolContent::createJson(const std::string& json) {
     return ToolContent(ContentType::TEXT, json, "application/json");
 }
 
+ToolContent ToolContent::createJson(cJSON* json) {
+    return ToolContent(ContentType::TEXT, std::shared_ptr<cJSON>(json, cJSON_Delete));
+}
+
 // CallToolResponse implementation
 
 void CallToolResponse::addTextContent(const std::string& text) {
@@ -410,6 +467,36 @@ void CallToolResponse::addJsonContent(const std::string& json) {
     content_.push_back(ToolContent::createJson(json));
 }
 
+void CallToolResponse::addJsonContent(cJSON* json) {
+    if (json) {
+        content_.push_back(ToolContent::createJson(json));
+    }
+}
+
+int CallToolResponse::writeResult(JsonWriter& writer) const {
+    writer.key(MSG_KEY_RESULT).beginObject();
+    
+    writer.key(MSG_KEY_CONTENT).beginArray();
+    for (const auto& content : content_) {
+        content.write(writer);
+    }
+    writer.endArray();
+    
+    if (isError_) {
+        writer.key(MSG_KEY_IS_ERROR).value(true);
+    }
+    
+    if (progress_ >= 0) {
+        writer.key(MSG_KEY_META).beginObject();
+        writer.key(MSG_KEY_PROGRESS).value(progress_);
+        writer.key(MSG_KEY_TOTAL).value(total_);
+        writer.endObject();
+    }
+    
+    writer.endObject();
+    return writer.getStatus();
+}
+
 int CallToolResponse::serializeResult(cJSON* json) const {
     if (!json) return -1;
     
@@ -544,7 +631,7 @@ std::unique_ptr<Response> ResponseFactory::createFromJson(const cJSON* json) {
     
     if (isErrorResponse(json)) {
         auto errorResp = std::make_unique<ErrorResponse>(id, Error(0, ""));
-        if (errorResp->deserialize(JsonHelper::toString(json)) == 0) {
+        if (errorResp->deserializeFrom(json) == 0) {
             response = std::move(errorResp);
         }
     } else {
@@ -555,28 +642,28 @@ std::unique_ptr<Response> ResponseFactory::createFromJson(const cJSON* json) {
         switch (type) {
             case MessageType::INITIALIZE_RESPONSE: {
                 auto initResp = std::make_unique<InitializeResponse>(id);
-                if (initResp->deserialize(JsonHelper::toString(json)) == 0) {
+                if (initResp->deserializeFrom(json) == 0) {
                     response = std::move(initResp);
                 }
                 break;
             }
             case MessageType::LIST_TOOLS_RESPONSE: {
                 auto listResp = std::make_unique<ListToolsResponse>(id);
-                if (listResp->deserialize(JsonHelper::toString(json)) == 0) {
+                if (listResp->deserializeFrom(json) == 0) {
                     response = std::move(listResp);
                 }
                 break;
             }
             case MessageType::CALL_TOOL_RESPONSE: {
                 auto callResp = std::make_unique<CallToolResponse>(id);
-                if (callResp->deserialize(JsonHelper::toString(json)) == 0) {
+                if (callResp->deserializeFrom(json) == 0) {
                     response = std::move(callResp);
                 }
                 break;
             }
             case MessageType::PING_RESPONSE: {
                 auto pingResp = std::make_unique<PingResponse>(id);
-                if (pingResp->deserialize(JsonHelper::toString(json)) == 0) {
+                if (pingResp->deserializeFrom(json) == 0) {
                     response = std::move(pingResp);
                 }
                 break;
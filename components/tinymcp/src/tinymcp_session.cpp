@@ -3,6 +3,10 @@
 
 #include "tinymcp_session.h"
 #include "tinymcp_json.h"
+#include "tinymcp_tools.h"
+#include "tinymcp_cbor.h"
+#include "tinymcp_method_table.h"
+#include "tinymcp_log.h"
 
 #include "esp_log.h"
 #include "esp_system.h"
@@ -13,6 +17,37 @@ static const char* TAG = "tinymcp_session";
 
 namespace tinymcp {
 
+namespace {
+
+// Forwards JsonWriter chunks into an open transport stream
+class TransportJsonSink : public JsonSink {
+public:
+    explicit TransportJsonSink(SessionTransport& transport) : transport_(transport) {}
+    int write(const char* data, size_t length) override {
+        return transport_.streamChunk(data, length);
+    }
+
+private:
+    SessionTransport& transport_;
+};
+
+// Method name that keys the latency samples of a message
+const char* metricKeyOf(const Message* message) {
+    if (!message) {
+        return "batch";
+    }
+    switch (message->getCategory()) {
+        case MessageCategory::REQUEST:
+            return static_cast<const Request*>(message)->getMethod().c_str();
+        case MessageCategory::NOTIFICATION:
+            return static_cast<const Notification*>(message)->getMethod().c_str();
+        default:
+            return "response";
+    }
+}
+
+} // namespace
+
 // Session Manager singleton
 SessionManager SessionManager::instance_;
 
@@ -32,12 +67,16 @@ const char* sessionStateToString(SessionState state) {
 
 bool isValidSessionTransition(SessionState from, SessionState to) {
     switch (from) {
+        // Clients may disconnect before the handshake completes
         case SessionState::UNINITIALIZED:
-            return to == SessionState::INITIALIZING || to == SessionState::ERROR_STATE;
+            return to == SessionState::INITIALIZING || to == SessionState::SHUTTING_DOWN ||
+                   to == SessionState::ERROR_STATE;
         case SessionState::INITIALIZING:
-            return to == SessionState::INITIALIZED || to == SessionState::ERROR_STATE;
+            return to == SessionState::INITIALIZED || to == SessionState::SHUTTING_DOWN ||
+                   to == SessionState::ERROR_STATE;
         case SessionState::INITIALIZED:
-            return to == SessionState::ACTIVE || to == SessionState::ERROR_STATE;
+            return to == SessionState::ACTIVE || to == SessionState::SHUTTING_DOWN ||
+                   to == SessionState::ERROR_STATE;
         case SessionState::ACTIVE:
             return to == SessionState::SHUTTING_DOWN || to == SessionState::ERROR_STATE;
         case SessionState::SHUTTING_DOWN:
@@ -54,12 +93,27 @@ bool isValidSessionTransition(SessionState from, SessionState to) {
 // AsyncTask implementation
 AsyncTask::AsyncTask(const MessageId& requestId, const std::string& method) :
     requestId_(requestId), method_(method), finished_(false), cancelled_(false),
-    startTime_(xTaskGetTickCount()), timeoutTicks_(pdMS_TO_TICKS(30000)) {
+    startTime_(xTaskGetTickCount()), timeoutTicks_(pdMS_TO_TICKS(30000)),
+    progressIntervalTicks_(pdMS_TO_TICKS(DEFAULT_PROGRESS_INTERVAL_MS)),
+    priority_(TaskPriority::NORMAL), fastLane_(false), scheduled_(false), lastRunTime_(0),
+    timedOut_(false), timeoutTimer_(onTimeout, this) {
     
     taskMutex_ = xSemaphoreCreateMutex();
-    if (!taskMutex_) {
+    progressMutex_ = xSemaphoreCreateMutex();
+    if (!taskMutex_ || !progressMutex_) {
         ESP_LOGE(TAG, "Failed to create task mutex for request %s", requestId.asString().c_str());
     }
+    
+    memset(&progress_, 0, sizeof(progress_));
+}
+
+AsyncTask::~AsyncTask() {
+    if (taskMutex_) {
+        vSemaphoreDelete(taskMutex_);
+    }
+    if (progressMutex_) {
+        vSemaphoreDelete(progressMutex_);
+    }
 }
 
 void AsyncTask::cancel() {
@@ -72,6 +126,10 @@ void AsyncTask::cancel() {
 }
 
 int AsyncTask::reportProgress(int current, int total, const std::string& message) {
+    return reportProgress(current, total, message.c_str());
+}
+
+int AsyncTask::reportProgress(int current, int total, const char* message) {
     if (cancelled_ || finished_) {
         return TINYMCP_ERROR_CANCELLED;
     }
@@ -80,50 +138,136 @@ int AsyncTask::reportProgress(int current, int total, const std::string& message
         return TINYMCP_ERROR_NO_PROGRESS_TOKEN;
     }
     
-    // Create progress notification
-    cJSON* params = cJSON_CreateObject();
-    if (!params) {
-        return TINYMCP_ERROR_OUT_OF_MEMORY;
+    if (total <= 0 || !progressMutex_) {
+        return TINYMCP_ERROR_INVALID_PARAMS;
     }
     
-    cJSON* progressTokenJson = cJSON_CreateString(progressToken_.c_str());
-    cJSON* progressJson = cJSON_CreateNumber((double)current / total * 100.0);
+    xSemaphoreTake(progressMutex_, portMAX_DELAY);
     
-    if (progressTokenJson && progressJson) {
-        cJSON_AddItemToObject(params, "progressToken", progressTokenJson);
-        cJSON_AddItemToObject(params, "progress", progressJson);
-        
-        if (!message.empty()) {
-            cJSON* messageJson = cJSON_CreateString(message.c_str());
-            if (messageJson) {
-                cJSON_AddItemToObject(params, "message", messageJson);
-            }
-        }
+    // Keep only the latest value; the message is copied into a fixed buffer
+    progress_.current = std::min(std::max(current, 0), total);
+    progress_.total = total;
+    strncpy(progress_.message, message ? message : "", sizeof(progress_.message) - 1);
+    progress_.message[sizeof(progress_.message) - 1] = '\0';
+    progress_.pending = true;
+    
+    int percent = static_cast<int>(static_cast<int64_t>(progress_.current) * 100 / total);
+    bool due = !progress_.sentAny ||
+               progress_.current == total ||
+               percent - progress_.lastSentPercent >= PROGRESS_MIN_STEP_PERCENT ||
+               (xTaskGetTickCount() - progress_.lastSentTime) >= progressIntervalTicks_;
+    
+    int result = due ? sendPendingProgress() : TINYMCP_SUCCESS;
+    
+    xSemaphoreGive(progressMutex_);
+    return result;
+}
+
+void AsyncTask::flushProgress() {
+    if (!progressMutex_) {
+        return;
     }
     
-    // This would normally send the notification through the session
-    // For now, just log it
-    ESP_LOGI(TAG, "Progress %d/%d for request %s: %s", 
-             current, total, requestId_.asString().c_str(), message.c_str());
+    xSemaphoreTake(progressMutex_, portMAX_DELAY);
+    if (progress_.pending &&
+        (xTaskGetTickCount() - progress_.lastSentTime) >= progressIntervalTicks_) {
+        sendPendingProgress();
+    }
+    xSemaphoreGive(progressMutex_);
+}
+
+int AsyncTask::reportPartialResult(int current, int total, const char* data, size_t length) {
+    if (cancelled_ || finished_) {
+        return TINYMCP_ERROR_CANCELLED;
+    }
     
-    cJSON_Delete(params);
-    return TINYMCP_SUCCESS;
+    if (progressToken_.empty()) {
+        return TINYMCP_ERROR_NO_PROGRESS_TOKEN;
+    }
+    
+    if (total <= 0 || !progressMutex_) {
+        return TINYMCP_ERROR_INVALID_PARAMS;
+    }
+    
+    xSemaphoreTake(progressMutex_, portMAX_DELAY);
+    
+    // Every piece has to arrive, so nothing is coalesced; without a sender
+    // (progress reporting disabled) the data has nowhere to go
+    int result = TINYMCP_ERROR_INVALID_STATE;
+    if (progressSender_) {
+        current = std::min(std::max(current, 0), total);
+        result = progressSender_(progressToken_, current, total, nullptr, data, length);
+        progress_.pending = false;
+        progress_.sentAny = true;
+        progress_.current = current;
+        progress_.total = total;
+        progress_.lastSentPercent = static_cast<int>(static_cast<int64_t>(current) * 100 / total);
+        progress_.lastSentTime = xTaskGetTickCount();
+    }
+    
+    xSemaphoreGive(progressMutex_);
+    return result;
+}
+
+void AsyncTask::setProgressSender(ProgressSender sender, uint32_t intervalMs) {
+    if (!progressMutex_) {
+        return;
+    }
+    
+    // Waits out a send in progress, so the old sender is never used after this
+    xSemaphoreTake(progressMutex_, portMAX_DELAY);
+    progressSender_ = std::move(sender);
+    progressIntervalTicks_ = pdMS_TO_TICKS(intervalMs);
+    xSemaphoreGive(progressMutex_);
+}
+
+int AsyncTask::sendPendingProgress() {
+    if (!progress_.pending || !progressSender_) {
+        return TINYMCP_SUCCESS;
+    }
+    
+    int result = progressSender_(progressToken_, progress_.current, progress_.total,
+                                 progress_.message[0] ? progress_.message : nullptr, nullptr, 0);
+    
+    progress_.pending = false;
+    progress_.sentAny = true;
+    progress_.lastSentPercent = static_cast<int>(static_cast<int64_t>(progress_.current) * 100 /
+                                                 progress_.total);
+    progress_.lastSentTime = xTaskGetTickCount();
+    return result;
 }
 
 void AsyncTask::setTimeout(uint32_t timeoutMs) {
     timeoutTicks_ = pdMS_TO_TICKS(timeoutMs);
+    if (timeoutTimer_.isArmed()) {
+        armTimeout(timeoutNotify_);
+    }
+}
+
+void AsyncTask::armTimeout(const TaskNotify& notify) {
+    timeoutNotify_ = notify;
+    
+    TickType_t elapsed = xTaskGetTickCount() - startTime_;
+    TickType_t remaining = elapsed < timeoutTicks_ ? timeoutTicks_ - elapsed : 0;
+    TimerWheel::getInstance().arm(timeoutTimer_, remaining * portTICK_PERIOD_MS);
 }
 
-std::unique_ptr<Response> AsyncTask::createResponse(const cJSON* result) {
+void AsyncTask::disarmTimeout() {
+    TimerWheel::getInstance().disarm(timeoutTimer_);
+    timeoutNotify_ = TaskNotify();
+}
+
+void AsyncTask::onTimeout(void* arg) {
+    // Runs on the timer service task: flag it and let the session cancel it
+    AsyncTask* task = static_cast<AsyncTask*>(arg);
+    task->timedOut_ = true;
+    task->timeoutNotify_.signal();
+}
+
+std::unique_ptr<Response> AsyncTask::createResponse(cJSON* result) {
+    // The tree is kept and streamed as the content text when sent
     auto response = std::make_unique<CallToolResponse>(requestId_);
-    if (result) {
-        // Convert cJSON result to tool content
-        char* resultStr = cJSON_Print(result);
-        if (resultStr) {
-            response->addJsonContent(std::string(resultStr));
-            free(resultStr);
-        }
-    }
+    response->addJsonContent(result);
     return response;
 }
 
@@ -131,36 +275,220 @@ std::unique_ptr<Response> AsyncTask::createErrorResponse(int errorCode, const st
     return std::make_unique<ErrorResponse>(requestId_, errorCode, message);
 }
 
+// PendingTaskTable implementation
+PendingTaskTable::PendingTaskTable(size_t capacity) :
+    capacity_(std::min(std::max(capacity, static_cast<size_t>(1)), static_cast<size_t>(MAX_SLOTS))),
+    count_(0), freeHead_(END_OF_LIST) {
+    
+    clear();
+}
+
+int PendingTaskTable::insert(std::shared_ptr<AsyncTask> task) {
+    if (!task) {
+        return TINYMCP_ERROR_INVALID_PARAMS;
+    }
+    
+    if (freeHead_ == END_OF_LIST) {
+        return TINYMCP_ERROR_RESOURCE_LIMIT;
+    }
+    
+    if (find(task->getRequestId()) != NO_SLOT) {
+        return TINYMCP_ERROR_INVALID_STATE;
+    }
+    
+    Slot& slot = slots_[freeHead_];
+    freeHead_ = slot.nextFree;
+    slot.hash = task->getRequestId().hash();
+    slot.task = std::move(task);
+    slot.nextFree = END_OF_LIST;
+    count_++;
+    return TINYMCP_SUCCESS;
+}
+
+size_t PendingTaskTable::find(const MessageId& requestId) const {
+    uint32_t hash = requestId.hash();
+    for (size_t i = 0; i < capacity_; ++i) {
+        const Slot& slot = slots_[i];
+        if (slot.task && slot.hash == hash && slot.task->getRequestId() == requestId) {
+            return i;
+        }
+    }
+    return NO_SLOT;
+}
+
+void PendingTaskTable::remove(size_t slot) {
+    if (slot >= capacity_ || !slots_[slot].task) {
+        return;
+    }
+    
+    slots_[slot].task.reset();
+    slots_[slot].nextFree = freeHead_;
+    freeHead_ = static_cast<uint8_t>(slot);
+    count_--;
+}
+
+void PendingTaskTable::clear() {
+    // Rebuild the free list in slot order
+    for (size_t i = 0; i < capacity_; ++i) {
+        slots_[i].task.reset();
+        slots_[i].hash = 0;
+        slots_[i].nextFree = (i + 1 < capacity_) ? static_cast<uint8_t>(i + 1) : END_OF_LIST;
+    }
+    freeHead_ = 0;
+    count_ = 0;
+}
+
 // Session implementation
 Session::Session(std::unique_ptr<SessionTransport> transport, const SessionConfig& config) :
     config_(config), state_(SessionState::UNINITIALIZED), transport_(std::move(transport)),
-    serverName_("TinyMCP ESP8266"), serverVersion_("1.0.0"), initialized_(false),
-    protocolInitialized_(false), lastHeartbeat_(0) {
-    
-    // Initialize FreeRTOS resources
-    messageQueue_ = xQueueCreate(config_.messageQueueSize, sizeof(MessageContext*));
+    serverName_("TinyMCP ESP8266"), serverVersion_("1.0.0"), wireFormat_(WireFormat::JSON),
+    messageProcessorHandle_(nullptr), asyncManagerHandle_(nullptr), writerHandle_(nullptr),
+    wake_(nullptr), wakeArg_(nullptr), activityTimer_(onActivityTimer, this), idleExpired_(false),
+    pendingTasks_(config.maxPendingTasks), collecting_(nullptr), collectingTask_(nullptr),
+    initialized_(false), protocolInitialized_(false), listedToolsGeneration_(0), lastHeartbeat_(0) {
+    
+    // Initialize FreeRTOS resources; reactor mode processes messages inline
+    // and needs no message queue
+    messageQueue_ = config_.reactorMode ? nullptr :
+                    xQueueCreate(config_.messageQueueSize, sizeof(MessageContext*));
     taskQueue_ = xQueueCreate(config_.maxPendingTasks, sizeof(AsyncTask*));
+    
+    // Small frames go through the outbound queue when the transport
+    // coalesces; a pooled session (no transport yet) may get one that does
+    outboundQueue_ = (config_.outboundQueueSize > 0 && (!transport_ || transport_->getCoalesceLimit() > 0)) ?
+                     xQueueCreate(config_.outboundQueueSize, sizeof(std::string*)) : nullptr;
     sessionMutex_ = xSemaphoreCreateRecursiveMutex();
+    sendMutex_ = xSemaphoreCreateMutex();
     sessionEvents_ = xEventGroupCreate();
     
-    if (!messageQueue_ || !taskQueue_ || !sessionMutex_ || !sessionEvents_) {
+    if ((!messageQueue_ && !config_.reactorMode) || !taskQueue_ || !sessionMutex_ ||
+        !sendMutex_ || !sessionEvents_) {
         ESP_LOGE(TAG, "Failed to create FreeRTOS resources for session");
         state_ = SessionState::ERROR_STATE;
         return;
     }
     
+    if (config_.enableJsonArena) {
+        JsonArenaPool::getInstance().initialize();
+    }
+    
     // Initialize statistics
     stats_.sessionStartTime = xTaskGetTickCount();
     stats_.lastActivityTime = stats_.sessionStartTime;
     
-    ESP_LOGI(TAG, "Session created with client: %s", transport_->getClientInfo().c_str());
+    if (transport_) {
+        ESP_LOGI(TAG, "Session created with client: %s", transport_->getClientInfo().c_str());
+    }
 }
 
 Session::~Session() {
     shutdown();
+    
+    // Last resort for a task that outlived shutdown()'s wait; the queues
+    // and locks it uses are about to be deleted
+    if (tasksRunning()) {
+        ESP_LOGE(TAG, "Deleting session tasks that did not stop");
+        EventBits_t exited = xEventGroupGetBits(sessionEvents_);
+        if (messageProcessorHandle_ && !(exited & EVENT_PROCESSOR_EXITED)) {
+            vTaskDelete(messageProcessorHandle_);
+        }
+        if (asyncManagerHandle_ && !(exited & EVENT_MANAGER_EXITED)) {
+            vTaskDelete(asyncManagerHandle_);
+        }
+        if (writerHandle_ && !(exited & EVENT_WRITER_EXITED)) {
+            vTaskDelete(writerHandle_);
+        }
+    }
+    messageProcessorHandle_ = nullptr;
+    asyncManagerHandle_ = nullptr;
+    writerHandle_ = nullptr;
+    
     cleanup();
 }
 
+bool Session::tasksRunning() const {
+    if (!sessionEvents_) {
+        return false;
+    }
+    EventBits_t exited = xEventGroupGetBits(sessionEvents_);
+    return (messageProcessorHandle_ && !(exited & EVENT_PROCESSOR_EXITED)) ||
+           (asyncManagerHandle_ && !(exited & EVENT_MANAGER_EXITED)) ||
+           (writerHandle_ && !(exited & EVENT_WRITER_EXITED));
+}
+
+bool Session::isReusableFor(const SessionConfig& config) const {
+    SessionState state = state_;
+    if (state != SessionState::UNINITIALIZED && state != SessionState::SHUTDOWN) {
+        return false;
+    }
+    
+    // A task that never stopped may still hold the session's locks
+    if (tasksRunning()) {
+        return false;
+    }
+    
+    // Queues and the task table were sized at construction
+    return sessionEvents_ && config.reactorMode == config_.reactorMode &&
+           config.messageQueueSize == config_.messageQueueSize &&
+           config.maxPendingTasks == config_.maxPendingTasks &&
+           config.outboundQueueSize == config_.outboundQueueSize;
+}
+
+void Session::attach(std::unique_ptr<SessionTransport> transport, const SessionConfig& config) {
+    // The previous connection's tasks have exited (isReusableFor checked);
+    // drop what they left queued, including shutdown()'s wakeup entries
+    messageProcessorHandle_ = nullptr;
+    asyncManagerHandle_ = nullptr;
+    writerHandle_ = nullptr;
+    if (messageQueue_) {
+        MessageContext* context = nullptr;
+        while (xQueueReceive(messageQueue_, &context, 0) == pdTRUE) {
+            delete context;
+        }
+    }
+    if (outboundQueue_) {
+        std::string* frame = nullptr;
+        while (xQueueReceive(outboundQueue_, &frame, 0) == pdTRUE) {
+            delete frame;
+        }
+    }
+    xEventGroupClearBits(sessionEvents_, EVENT_SHUTDOWN_REQUEST | EVENT_MESSAGE_RECEIVED |
+                         EVENT_TASK_COMPLETED | EVENT_TASK_SUBMITTED | EVENT_TIMER_DUE |
+                         EVENT_TASKS_EXITED);
+    
+    config_ = config;
+    transport_ = std::move(transport);
+    
+    // Per-connection state back to the constructor's; containers keep
+    // their capacity
+    serverName_ = "TinyMCP ESP8266";
+    serverVersion_ = "1.0.0";
+    capabilities_ = ServerCapabilities();
+    wireFormat_ = WireFormat::JSON;
+    supportedTools_.clear();
+    customHandler_ = nullptr;
+    wake_ = nullptr;
+    wakeArg_ = nullptr;
+    pendingTasks_.clear();
+    openBatches_.clear();
+    collecting_ = nullptr;
+    collectingTask_ = nullptr;
+    idleExpired_ = false;
+    initialized_ = false;
+    protocolInitialized_ = false;
+    listedToolsGeneration_ = 0;
+    lastHeartbeat_ = 0;
+    
+    stats_ = SessionStats();
+    stats_.sessionStartTime = xTaskGetTickCount();
+    stats_.lastActivityTime = stats_.sessionStartTime;
+    
+    // SHUTDOWN is terminal for a connection, not for the pooled object
+    state_ = SessionState::UNINITIALIZED;
+    
+    ESP_LOGI(TAG, "Pooled session attached to client: %s", transport_->getClientInfo().c_str());
+}
+
 int Session::initialize() {
     if (state_ != SessionState::UNINITIALIZED) {
         ESP_LOGW(TAG, "Session already initialized or in error state");
@@ -174,6 +502,34 @@ int Session::initialize() {
     
     transitionState(SessionState::INITIALIZING);
     
+    // Tool tasks run on the shared pool; without it they fall back to
+    // running inline from serviceTasks()
+    if (TaskExecutor::getInstance().initialize(config_.executorWorkers, config_.taskStackSize,
+                                               config_.taskPriority) != TINYMCP_SUCCESS) {
+        ESP_LOGW(TAG, "Task executor unavailable, running tool tasks inline");
+    }
+    
+    // Request-path logging is queued from here on; without the drain task
+    // it stays inline
+    DeferredLog::getInstance().start();
+    
+    // Idle timeout, keep-alive pings and task timeouts are deadlines on the
+    // shared wheel rather than per-session tasks or scans
+    if (TimerWheel::getInstance().initialize() != TINYMCP_SUCCESS) {
+        ESP_LOGE(TAG, "Failed to start timer wheel");
+        transitionState(SessionState::ERROR_STATE);
+        return TINYMCP_ERROR_OUT_OF_MEMORY;
+    }
+    TimerWheel::getInstance().arm(activityTimer_, std::min(config_.sessionTimeoutMs, static_cast<uint32_t>(KEEPALIVE_IDLE_MS)));
+    
+    if (config_.reactorMode) {
+        // SessionReactor drives onReadable()/poll(); no tasks to spawn
+        initialized_ = true;
+        transitionState(SessionState::INITIALIZED);
+        ESP_LOGI(TAG, "Session initialized in reactor mode");
+        return TINYMCP_SUCCESS;
+    }
+    
     // Create message processor task
     BaseType_t result = xTaskCreate(
         messageProcessorTask,
@@ -206,20 +562,22 @@ int Session::initialize() {
         return TINYMCP_ERROR_TASK_CREATION_FAILED;
     }
     
-    // Create keep-alive task
-    result = xTaskCreate(
-        keepAliveTask,
-        "mcp_keepalive",
-        1024, // Smaller stack for keep-alive
-        this,
-        config_.taskPriority - 1,
-        &keepAliveHandle_
-    );
-    
-    if (result != pdPASS) {
-        ESP_LOGE(TAG, "Failed to create keep-alive task");
-        transitionState(SessionState::ERROR_STATE);
-        return TINYMCP_ERROR_TASK_CREATION_FAILED;
+    // Create outbound writer; without it frames are sent inline
+    if (outboundQueue_ && transport_->getCoalesceLimit() > 0) {
+        result = xTaskCreate(
+            outboundWriterTask,
+            "mcp_writer",
+            WRITER_STACK_SIZE,
+            this,
+            config_.taskPriority,
+            &writerHandle_
+        );
+        
+        if (result != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create outbound writer task");
+            transitionState(SessionState::ERROR_STATE);
+            return TINYMCP_ERROR_TASK_CREATION_FAILED;
+        }
     }
     
     initialized_ = true;
@@ -237,9 +595,11 @@ int Session::run() {
     
     ESP_LOGI(TAG, "Starting session run loop");
     
-    std::string messageBuffer;
+    std::string& messageBuffer = receiveBuffer_;
     messageBuffer.reserve(transport_->getMaxMessageSize());
     
+    const bool eventDriven = config_.enableEventDrivenLoop;
+    
     while (state_ != SessionState::SHUTDOWN && state_ != SessionState::ERROR_STATE) {
         // Check for shutdown request
         EventBits_t events = xEventGroupWaitBits(
@@ -247,7 +607,7 @@ int Session::run() {
             EVENT_SHUTDOWN_REQUEST,
             pdFALSE,
             pdFALSE,
-            pdMS_TO_TICKS(100)
+            eventDriven ? 0 : pdMS_TO_TICKS(100)
         );
         
         if (events & EVENT_SHUTDOWN_REQUEST) {
@@ -255,30 +615,29 @@ int Session::run() {
             break;
         }
         
+        // Set by the async task manager when the idle timer expires
+        if (idleExpired_) {
+            break;
+        }
+        
+        // In event-driven mode block on socket readability; shutdown() and
+        // an expired idle timer close the transport to unblock the receive.
+        const uint32_t receiveTimeoutMs = eventDriven ? config_.sessionTimeoutMs : 1000;
+        
+        // Leave data in the socket while the heap is low; TCP flow control
+        // then throttles the client instead of us dropping its messages
+        if (!AdmissionControl::canRead(config_.admission)) {
+            stats_.readPauses++;
+            vTaskDelay(pdMS_TO_TICKS(config_.admission.pauseRetryMs));
+            continue;
+        }
+        
         // Receive message from transport
         messageBuffer.clear();
-        int result = transport_->receive(messageBuffer, 1000);
+        int result = transport_->receive(messageBuffer, receiveTimeoutMs);
         
         if (result == TINYMCP_SUCCESS && !messageBuffer.empty()) {
-            updateActivity();
-            stats_.messagesReceived++;
-            
-            // Parse message
-            auto message = Message::createFromJson(messageBuffer);
-            if (message) {
-                auto context = std::make_unique<MessageContext>(std::move(message), messageBuffer);
-                
-                // Queue message for processing
-                MessageContext* contextPtr = context.release();
-                if (xQueueSend(messageQueue_, &contextPtr, pdMS_TO_TICKS(100)) != pdTRUE) {
-                    ESP_LOGW(TAG, "Message queue full, dropping message");
-                    delete contextPtr;
-                    stats_.errors++;
-                }
-            } else {
-                ESP_LOGW(TAG, "Failed to parse message: %s", messageBuffer.c_str());
-                stats_.errors++;
-            }
+            handleIncomingMessage(messageBuffer);
         } else if (result != TINYMCP_ERROR_TIMEOUT) {
             ESP_LOGE(TAG, "Transport receive error: %d", result);
             if (!transport_->isConnected()) {
@@ -286,13 +645,6 @@ int Session::run() {
                 break;
             }
         }
-        
-        // Check for session timeout
-        TickType_t now = xTaskGetTickCount();
-        if ((now - stats_.lastActivityTime) > pdMS_TO_TICKS(config_.sessionTimeoutMs)) {
-            ESP_LOGW(TAG, "Session timeout reached");
-            break;
-        }
     }
     
     ESP_LOGI(TAG, "Session run loop ended");
@@ -311,122 +663,661 @@ int Session::shutdown() {
     // Signal shutdown to all tasks
     xEventGroupSetBits(sessionEvents_, EVENT_SHUTDOWN_REQUEST);
     
-    // Wait for tasks to finish with timeout
-    const TickType_t shutdownTimeout = pdMS_TO_TICKS(5000);
+    // Wake the message processor out of its blocking receive
+    if (messageQueue_) {
+        MessageContext* wakeup = nullptr;
+        xQueueSendToFront(messageQueue_, &wakeup, 0);
+    }
+    if (writerHandle_) {
+        std::string* wakeup = nullptr;
+        xQueueSendToFront(outboundQueue_, &wakeup, 0);
+    }
     
-    if (messageProcessorHandle_) {
-        vTaskDelete(messageProcessorHandle_);
-        messageProcessorHandle_ = nullptr;
+    // Unblock a task stuck writing to a client that stopped reading
+    if (transport_) {
+        transport_->close();
     }
     
-    if (asyncManagerHandle_) {
-        vTaskDelete(asyncManagerHandle_);
-        asyncManagerHandle_ = nullptr;
+    // Let the tasks finish the message or frame in hand and return. Deleting
+    // them here could strand a held sendMutex_, sessionMutex_ or progress
+    // lock, and a pooled session reuses all of them.
+    const TickType_t shutdownTimeout = pdMS_TO_TICKS(5000);
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    EventBits_t waitBits = 0;
+    if (messageProcessorHandle_ && messageProcessorHandle_ != self) {
+        waitBits |= EVENT_PROCESSOR_EXITED;
+    }
+    if (asyncManagerHandle_ && asyncManagerHandle_ != self) {
+        waitBits |= EVENT_MANAGER_EXITED;
+    }
+    if (writerHandle_ && writerHandle_ != self) {
+        waitBits |= EVENT_WRITER_EXITED;
     }
     
-    if (keepAliveHandle_) {
-        vTaskDelete(keepAliveHandle_);
-        keepAliveHandle_ = nullptr;
+    if (waitBits) {
+        EventBits_t exited = xEventGroupWaitBits(sessionEvents_, waitBits, pdFALSE, pdTRUE,
+                                                 shutdownTimeout);
+        if (exited & EVENT_PROCESSOR_EXITED) {
+            messageProcessorHandle_ = nullptr;
+        }
+        if (exited & EVENT_MANAGER_EXITED) {
+            asyncManagerHandle_ = nullptr;
+        }
+        if (exited & EVENT_WRITER_EXITED) {
+            writerHandle_ = nullptr;
+        }
+        if ((exited & waitBits) != waitBits) {
+            // Keep the handles so the slot is never handed to a new client
+            ESP_LOGE(TAG, "Session tasks did not stop within %u ms",
+                     (unsigned)(shutdownTimeout * portTICK_PERIOD_MS));
+        }
     }
     
+    // Drop queued executor jobs and timers before the event group they
+    // signal goes away
+    TaskExecutor::getInstance().detach(this);
+    TimerWheel::getInstance().disarm(activityTimer_);
+    
     // Cancel all pending tasks
-    for (auto& [id, task] : pendingTasks_) {
-        task->cancel();
-        stats_.tasksCancelled++;
+    for (size_t slot = 0; slot < pendingTasks_.capacity(); ++slot) {
+        const auto& task = pendingTasks_.at(slot);
+        if (task) {
+            task->disarmTimeout();
+            task->setProgressSender(nullptr, 0);
+            task->cancel();
+            stats_.tasksCancelled++;
+        }
     }
     pendingTasks_.clear();
+    openBatches_.clear();
     
-    // Close transport
-    if (transport_) {
-        transport_->close();
+    transitionState(SessionState::SHUTDOWN);
+    ESP_LOGI(TAG, "Session shutdown complete");
+    
+    return TINYMCP_SUCCESS;
+}
+
+int Session::onReadable() {
+    if (state_ == SessionState::SHUTDOWN || state_ == SessionState::ERROR_STATE) {
+        return TINYMCP_ERROR_INVALID_STATE;
+    }
+    
+    // Drain a bounded number of complete frames so one chatty client
+    // cannot starve the others sharing the reactor
+    std::string& messageBuffer = receiveBuffer_;
+    for (uint32_t i = 0; i < REACTOR_MAX_FRAMES_PER_WAKEUP; ++i) {
+        int result = transport_->tryReceive(messageBuffer);
+        if (result == TINYMCP_ERROR_TIMEOUT) {
+            break;
+        }
+        
+        if (result != TINYMCP_SUCCESS) {
+            ESP_LOGI(TAG, "Transport receive error: %d", result);
+            return transport_->isConnected() ? result : TINYMCP_ERROR_TRANSPORT_FAILED;
+        }
+        
+        if (!messageBuffer.empty()) {
+            handleIncomingMessage(messageBuffer);
+        }
+    }
+    
+    // Replies to every frame of this wakeup leave in one write
+    flushOutbound();
+    return TINYMCP_SUCCESS;
+}
+
+TaskNotify Session::taskNotify() const {
+    TaskNotify notify(sessionEvents_, EVENT_TASK_COMPLETED);
+    notify.wake = wake_;
+    notify.wakeArg = wakeArg_;
+    return notify;
+}
+
+int Session::poll(TickType_t* nextWakeup) {
+    if (state_ == SessionState::SHUTDOWN || state_ == SessionState::ERROR_STATE) {
+        return TINYMCP_ERROR_INVALID_STATE;
+    }
+    
+    if ((xEventGroupClearBits(sessionEvents_, EVENT_TIMER_DUE) & EVENT_TIMER_DUE) && !serviceTimers()) {
+        return TINYMCP_ERROR_TIMEOUT;
+    }
+    
+    TickType_t taskWakeup = portMAX_DELAY;
+    if (serviceTasks()) {
+        taskWakeup = pdMS_TO_TICKS(config_.taskPollIntervalMs);
+    }
+    
+    checkToolsListChanged();
+    flushOutbound();
+    
+    // Shared by every session, so an early wakeup here can belong to
+    // another session's deadline
+    if (nextWakeup) {
+        *nextWakeup = std::min(taskWakeup, TimerWheel::getInstance().getNextExpiry());
+    }
+    
+    return TINYMCP_SUCCESS;
+}
+
+int Session::handleIncomingMessage(const std::string& json) {
+    updateActivity();
+    stats_.messagesReceived++;
+    noteRequestReceived();
+#if TINYMCP_METRICS
+    const uint32_t receivedUs = Metrics::nowUs();
+#endif
+    
+    // Parse once into a per-message arena; the tree travels with the context
+    // to the handler and everything is released in one reset at the end
+    JsonArena* arena = config_.enableJsonArena ? JsonArenaPool::getInstance().acquire() : nullptr;
+    cJSON* root = nullptr;
+    std::unique_ptr<Message> message;
+    // Frames are sniffed rather than switched on the negotiated format, so
+    // requests pipelined behind initialize decode either way
+    bool binary = config_.enableCborEncoding && Cbor::isCborFrame(json.data(), json.size());
+    
+    // Text frames are routed on their envelope first; what is answered or
+    // dropped there is never parsed
+    JsonRpcEnvelope envelope;
+    if (!binary && config_.enableLazyParsing) {
+        if (envelope.scan(json.data(), json.size()) != TINYMCP_SUCCESS) {
+            JsonArenaPool::getInstance().release(arena);
+            TINYMCP_LOGW(TAG, "Dropping %u-byte frame that is not JSON", json.size());
+            stats_.errors++;
+            return TINYMCP_ERROR_INVALID_MESSAGE;
+        }
+        int routed = TINYMCP_SUCCESS;
+        if (routeEnvelope(envelope, routed)) {
+            JsonArenaPool::getInstance().release(arena);
+            return routed;
+        }
+    }
+    
+    {
+        ArenaScope scope(arena);
+        if (binary) {
+            root = Cbor::decode(json.data(), json.size());
+        } else if (envelope.canBuildTree()) {
+            // Only the params span goes through the parser
+            root = envelope.buildTree();
+        } else {
+            root = cJSON_Parse(json.c_str());
+        }
+        if (root && !cJSON_IsArray(root)) {
+            message = Message::createFromJson(root);
+        }
+    }
+    
+    // Batches are split into messages by processBatch()
+    if (!message && !cJSON_IsArray(root)) {
+        if (root) {
+            cJSON_Delete(root);
+        }
+        JsonArenaPool::getInstance().release(arena);
+        if (binary) {
+            TINYMCP_LOGW(TAG, "Failed to decode %u-byte CBOR message", json.size());
+        } else {
+            TINYMCP_LOGW(TAG, "Failed to parse message: %s", json);
+        }
+        stats_.errors++;
+        return TINYMCP_ERROR_INVALID_MESSAGE;
+    }
+    
+    auto context = std::make_unique<MessageContext>(std::move(message), root, arena);
+#if TINYMCP_KEEP_RAW_JSON
+    context->rawJson = json;
+#endif
+#if TINYMCP_METRICS
+    Metrics::getInstance().record(metricKeyOf(context->message.get()), MetricStage::PARSE, receivedUs);
+    context->queuedUs = Metrics::nowUs();
+#endif
+    
+    // Reactor mode processes inline on the reactor task
+    if (!messageQueue_) {
+        return processMessage(std::move(context));
+    }
+    
+    // Queue message for processing. A full queue holds the reader, so
+    // nothing more is read from the socket until the processor catches up
+    MessageContext* contextPtr = context.release();
+    const TickType_t waitSlice = pdMS_TO_TICKS(100);
+    TickType_t waited = 0;
+    while (xQueueSend(messageQueue_, &contextPtr, waitSlice) != pdTRUE) {
+        waited += waitSlice;
+        bool stopping = state_ == SessionState::SHUTTING_DOWN || state_ == SessionState::SHUTDOWN;
+        if (stopping || waited >= pdMS_TO_TICKS(config_.admission.queueFullTimeoutMs)) {
+            std::unique_ptr<MessageContext> rejected(contextPtr);
+            TINYMCP_LOGW(TAG, "Message queue full, rejecting message");
+            stats_.errors++;
+            return rejectMessage(*rejected, "Server busy");
+        }
+    }
+    
+    return TINYMCP_SUCCESS;
+}
+
+bool Session::serviceTasks() {
+    bool needsRerun = false;
+    std::vector<std::unique_ptr<Response>> responses;
+    std::vector<std::string> batchFrames;
+    TaskExecutor& executor = TaskExecutor::getInstance();
+    
+    if (xSemaphoreTakeRecursive(sessionMutex_, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return true;
+    }
+    
+    for (size_t slot = 0; slot < pendingTasks_.capacity(); ++slot) {
+        const std::shared_ptr<AsyncTask>& task = pendingTasks_.at(slot);
+        if (!task) {
+            continue;
+        }
+        
+        std::unique_ptr<Response> response;
+        if (!task->isCancelled() && !task->isFinished()) {
+            // Flagged by the task's deadline on the timer wheel
+            TickType_t now = xTaskGetTickCount();
+            if (task->isTimedOut()) {
+                TINYMCP_LOGW(TAG, "Task timeout for request %s", task->getRequestId().asString());
+                task->cancel();
+                stats_.tasksCancelled++;
+                response = std::make_unique<ErrorResponse>(
+                    task->getRequestId(), TINYMCP_ERROR_TIMEOUT, "Tool execution timed out");
+            } else if (task->isScheduled() || task->isWaiting()) {
+                // Running or queued on the executor, or parked on an outside
+                // event; either signals taskNotify() when done
+                task->flushProgress();
+            } else if (!executor.isInitialized()) {
+                task->execute();
+                needsRerun |= !task->isFinished() && !task->isCancelled() && !task->isWaiting();
+            } else if (task->getLastRunTime() != 0 &&
+                       (now - task->getLastRunTime()) < pdMS_TO_TICKS(config_.taskPollIntervalMs)) {
+                // Yielded without finishing; re-run after the poll interval
+                needsRerun = true;
+            } else if (executor.submit(task, this, taskNotify()) != TINYMCP_SUCCESS) {
+                needsRerun = true;
+            }
+        }
+        
+        if (task->isCancelled() || task->isFinished()) {
+            // A cancelled task may still be running on the executor
+            task->disarmTimeout();
+            task->setProgressSender(nullptr, 0);
+            
+            if (!task->isCancelled()) {
+                response = task->takeResponse();
+            }
+            
+            if (task->isFinished() && !task->isCancelled()) {
+                stats_.tasksCompleted++;
+            }
+            
+            // Results of batched requests join their batch's array instead
+            if (!routeToBatch(task->getRequestId(), response.get(), batchFrames) && response) {
+                responses.push_back(std::move(response));
+            }
+            pendingTasks_.remove(slot);
+        }
+    }
+    
+    xSemaphoreGiveRecursive(sessionMutex_);
+    
+    // Send outside the session lock so a slow client cannot stall submissions
+#if TINYMCP_METRICS
+    MetricTaskScope metricScope(Metrics::getInstance().keyFor(METHOD_TOOLS_CALL));
+#endif
+    for (const auto& response : responses) {
+        sendMessage(*response);
+    }
+    for (const auto& frame : batchFrames) {
+        sendSerialized(frame);
+    }
+    
+    return needsRerun;
+}
+
+TickType_t Session::serviceKeepAlive() {
+    const TickType_t pingIdleTicks = pdMS_TO_TICKS(KEEPALIVE_IDLE_MS);
+    
+    // Send ping if no recent activity
+    TickType_t now = xTaskGetTickCount();
+    TickType_t idle = now - stats_.lastActivityTime;
+    if (idle > pingIdleTicks) {
+        sendNotification("notifications/ping");
+        stats_.lastActivityTime = now;
+        idle = 0;
+    }
+    
+    return pingIdleTicks - idle + 1;
+}
+
+bool Session::serviceTimers() {
+    TickType_t idleRemaining = getIdleTimeoutRemaining();
+    if (idleRemaining == 0) {
+        ESP_LOGW(TAG, "Session timeout reached");
+        return false;
+    }
+    
+    TickType_t keepAliveDue = serviceKeepAlive();
+    checkToolsListChanged();
+    
+    // Activity since arming only pushed the deadline out, so it is
+    // recomputed here instead of re-armed on every message
+    TimerWheel::getInstance().arm(activityTimer_, std::min(idleRemaining, keepAliveDue) * portTICK_PERIOD_MS);
+    return true;
+}
+
+void Session::checkToolsListChanged() {
+    // Tell clients that already listed tools when the registry changed
+    if (listedToolsGeneration_ != 0 && capabilities_.hasToolsListChanged()) {
+        uint32_t generation = ToolRegistry::getInstance().getGeneration();
+        if (generation != listedToolsGeneration_) {
+            listedToolsGeneration_ = generation;
+            sendMessage(ToolsListChangedNotification());
+        }
+    }
+}
+
+void Session::onActivityTimer(void* arg) {
+    // Runs on the timer service task; the session's own task does the work
+    Session* session = static_cast<Session*>(arg);
+    xEventGroupSetBits(session->sessionEvents_, EVENT_TIMER_DUE);
+}
+
+void Session::setServerInfo(const std::string& name, const std::string& version) {
+    if (xSemaphoreTakeRecursive(sessionMutex_, pdMS_TO_TICKS(1000)) == pdTRUE) {
+        serverName_ = name;
+        serverVersion_ = version;
+        xSemaphoreGiveRecursive(sessionMutex_);
+    }
+}
+
+void Session::setServerCapabilities(const ServerCapabilities& capabilities) {
+    if (xSemaphoreTakeRecursive(sessionMutex_, pdMS_TO_TICKS(1000)) == pdTRUE) {
+        capabilities_ = capabilities;
+        xSemaphoreGiveRecursive(sessionMutex_);
+    }
+}
+
+void Session::addTool(const std::string& name, const std::string& description, const cJSON* schema) {
+    if (xSemaphoreTakeRecursive(sessionMutex_, pdMS_TO_TICKS(1000)) == pdTRUE) {
+        supportedTools_.push_back(name);
+        xSemaphoreGiveRecursive(sessionMutex_);
+        ESP_LOGI(TAG, "Added tool: %s", name.c_str());
+    }
+}
+
+int Session::submitTask(std::unique_ptr<AsyncTask> task) {
+    if (!task || !task->isValid()) {
+        return TINYMCP_ERROR_INVALID_PARAMS;
+    }
+    
+    if (config_.enableProgressReporting) {
+        task->setProgressSender([this](const std::string& token, int progress, int total, const char* message,
+                                       const char* data, size_t dataLength) {
+            return sendProgress(token, progress, total, message, data, dataLength);
+        }, config_.progressIntervalMs);
+    }
+    
+    if (xSemaphoreTakeRecursive(sessionMutex_, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        return TINYMCP_ERROR_RESOURCE_LIMIT;
+    }
+    
+    MessageId requestId = task->getRequestId();
+    AsyncTask* pending = task.get();
+    int result = pendingTasks_.insert(std::move(task));
+    if (result == TINYMCP_SUCCESS) {
+        stats_.tasksCreated++;
+        pending->armTimeout(taskNotify());
+        // Registered under the same lock so the result cannot beat the
+        // batch to serviceTasks()
+        if (isCollectingBatch()) {
+            collecting_->awaiting.push_back(requestId);
+        }
+    }
+    xSemaphoreGiveRecursive(sessionMutex_);
+    
+    if (result != TINYMCP_SUCCESS) {
+        TINYMCP_LOGW(TAG, "%s", result == TINYMCP_ERROR_RESOURCE_LIMIT ?
+                     "Too many pending tasks" : "Duplicate request id for pending task");
+        return result;
+    }
+    
+    wakeTaskManager(EVENT_TASK_SUBMITTED);
+    return TINYMCP_SUCCESS;
+}
+
+int Session::cancelTask(const MessageId& requestId) {
+    if (xSemaphoreTakeRecursive(sessionMutex_, pdMS_TO_TICKS(1000)) == pdTRUE) {
+        size_t slot = pendingTasks_.find(requestId);
+        if (slot != PendingTaskTable::NO_SLOT) {
+            pendingTasks_.at(slot)->cancel();
+            stats_.tasksCancelled++;
+            xSemaphoreGiveRecursive(sessionMutex_);
+            wakeTaskManager(EVENT_TASK_COMPLETED);
+            TINYMCP_LOGD(TAG, "Cancelled task for request %s", requestId.asString());
+            return TINYMCP_SUCCESS;
+        }
+        xSemaphoreGiveRecursive(sessionMutex_);
+    }
+    
+    return TINYMCP_ERROR_NOT_FOUND;
+}
+
+size_t Session::getPendingTaskCount() const {
+    return pendingTasks_.size();
+}
+
+int Session::sendMessage(const Message& message) {
+    return sendStreamed([&message](JsonWriter& writer) { return message.write(writer); });
+}
+
+int Session::sendSerialized(const std::string& json) {
+    // sendStreamed() records the send span for transcoded frames
+    if (wireFormat_ == WireFormat::CBOR && !isCollectingBatch()) {
+        return sendTranscoded(json);
+    }
+    
+    MetricSpan sendSpan(MetricStage::SEND);
+    
+    if (isCollectingBatch()) {
+        appendToBatch(*collecting_, json, collecting_->currentId);
+        return TINYMCP_SUCCESS;
+    }
+    
+    if (outboundQueue_ && json.size() <= transport_->getCoalesceLimit()) {
+        return enqueueFrame(std::make_unique<std::string>(json));
+    }
+    
+    if (xSemaphoreTake(sendMutex_, portMAX_DELAY) != pdTRUE) {
+        return TINYMCP_ERROR_TRANSPORT_FAILED;
+    }
+    drainOutbound();
+    int result = transport_->send(json);
+    xSemaphoreGive(sendMutex_);
+    
+    if (result == TINYMCP_SUCCESS) {
+        stats_.messagesSent++;
+        updateActivity();
+    }
+    
+    return result;
+}
+
+int Session::sendStreamed(const std::function<int(JsonWriter&)>& write) {
+    MetricSpan sendSpan(MetricStage::SEND);
+    
+    // Replies to batch elements are rendered into the batch array, which
+    // is assembled as JSON text and transcoded once complete
+    if (isCollectingBatch()) {
+        std::string element;
+        StringJsonSink sink(element);
+        JsonWriter writer(&sink);
+        int result = write(writer);
+        if (result == TINYMCP_SUCCESS) {
+            result = writer.finish();
+        }
+        if (result == TINYMCP_SUCCESS) {
+            appendToBatch(*collecting_, element, collecting_->currentId);
+        }
+        return result;
+    }
+    
+    // Length-prefixed framing needs the size first: one counting pass,
+    // then the real pass through a single chunk buffer into the socket
+    const WireFormat format = wireFormat_;
+    JsonWriter counter(nullptr, format);
+    int result = write(counter);
+    if (result == TINYMCP_SUCCESS) {
+        result = counter.finish();
+    }
+    if (result != TINYMCP_SUCCESS) {
+        return result;
+    }
+    
+    // Small frames are rendered for the writer to coalesce; larger ones
+    // stream straight to the socket behind whatever is already queued
+    if (outboundQueue_ && counter.size() <= transport_->getCoalesceLimit()) {
+        auto frame = std::make_unique<std::string>();
+        frame->reserve(counter.size());
+        StringJsonSink sink(*frame);
+        JsonWriter writer(&sink, format);
+        result = write(writer);
+        if (result == TINYMCP_SUCCESS) {
+            result = writer.finish();
+        }
+        return result == TINYMCP_SUCCESS ? enqueueFrame(std::move(frame)) : result;
+    }
+    
+    if (xSemaphoreTake(sendMutex_, portMAX_DELAY) != pdTRUE) {
+        return TINYMCP_ERROR_TRANSPORT_FAILED;
+    }
+    
+    drainOutbound();
+    result = transport_->beginStream(counter.size());
+    if (result == TINYMCP_SUCCESS) {
+        TransportJsonSink sink(*transport_);
+        JsonWriter writer(&sink, format);
+        result = write(writer);
+        if (result == TINYMCP_SUCCESS) {
+            result = writer.finish();
+        }
+        
+        int endResult = transport_->endStream();
+        if (result == TINYMCP_SUCCESS) {
+            result = endResult;
+        }
     }
     
-    transitionState(SessionState::SHUTDOWN);
-    ESP_LOGI(TAG, "Session shutdown complete");
+    xSemaphoreGive(sendMutex_);
     
-    return TINYMCP_SUCCESS;
-}
-
-void Session::setServerInfo(const std::string& name, const std::string& version) {
-    if (xSemaphoreTakeRecursive(sessionMutex_, pdMS_TO_TICKS(1000)) == pdTRUE) {
-        serverName_ = name;
-        serverVersion_ = version;
-        xSemaphoreGiveRecursive(sessionMutex_);
-    }
-}
-
-void Session::setServerCapabilities(const ServerCapabilities& capabilities) {
-    if (xSemaphoreTakeRecursive(sessionMutex_, pdMS_TO_TICKS(1000)) == pdTRUE) {
-        capabilities_ = capabilities;
-        xSemaphoreGiveRecursive(sessionMutex_);
+    if (result == TINYMCP_SUCCESS) {
+        stats_.messagesSent++;
+        updateActivity();
     }
+    
+    return result;
 }
 
-void Session::addTool(const std::string& name, const std::string& description, const cJSON* schema) {
-    if (xSemaphoreTakeRecursive(sessionMutex_, pdMS_TO_TICKS(1000)) == pdTRUE) {
-        supportedTools_.push_back(name);
-        xSemaphoreGiveRecursive(sessionMutex_);
-        ESP_LOGI(TAG, "Added tool: %s", name.c_str());
-    }
+int Session::sendTranscoded(const std::string& json) {
+    // Cached and assembled frames exist only as JSON text
+    cJSON* tree = cJSON_Parse(json.c_str());
+    if (!tree) {
+        TINYMCP_LOGE(TAG, "Failed to transcode %u-byte frame", json.size());
+        return TINYMCP_ERROR_INVALID_MESSAGE;
+    }
+    
+    int result = sendStreamed([tree](JsonWriter& writer) {
+        writer.value(tree);
+        return writer.getStatus();
+    });
+    cJSON_Delete(tree);
+    return result;
 }
 
-int Session::submitTask(std::unique_ptr<AsyncTask> task) {
-    if (!task || !task->isValid()) {
-        return TINYMCP_ERROR_INVALID_PARAMS;
+int Session::enqueueFrame(std::unique_ptr<std::string> frame) {
+    std::string* queued = frame.get();
+    if (xQueueSend(outboundQueue_, &queued, 0) == pdTRUE) {
+        frame.release();
+        return TINYMCP_SUCCESS;
     }
     
-    if (pendingTasks_.size() >= config_.maxPendingTasks) {
-        ESP_LOGW(TAG, "Too many pending tasks");
-        return TINYMCP_ERROR_RESOURCE_LIMIT;
+    // Queue full: write it here, after everything queued before it
+    if (xSemaphoreTake(sendMutex_, portMAX_DELAY) != pdTRUE) {
+        return TINYMCP_ERROR_TRANSPORT_FAILED;
     }
+    drainOutbound();
+    int result = transport_->send(*frame);
+    xSemaphoreGive(sendMutex_);
     
-    if (xSemaphoreTakeRecursive(sessionMutex_, pdMS_TO_TICKS(1000)) == pdTRUE) {
-        std::string taskId = task->getRequestId().asString();
-        pendingTasks_[taskId] = std::shared_ptr<AsyncTask>(task.release());
-        stats_.tasksCreated++;
-        xSemaphoreGiveRecursive(sessionMutex_);
-        
-        ESP_LOGI(TAG, "Submitted task for request %s", taskId.c_str());
-        return TINYMCP_SUCCESS;
+    if (result == TINYMCP_SUCCESS) {
+        stats_.messagesSent++;
+        updateActivity();
     }
     
-    return TINYMCP_ERROR_RESOURCE_LIMIT;
+    return result;
 }
 
-int Session::cancelTask(const MessageId& requestId) {
-    std::string taskId = requestId.asString();
+int Session::drainOutbound() {
+    if (!outboundQueue_) {
+        return TINYMCP_SUCCESS;
+    }
     
-    if (xSemaphoreTakeRecursive(sessionMutex_, pdMS_TO_TICKS(1000)) == pdTRUE) {
-        auto it = pendingTasks_.find(taskId);
-        if (it != pendingTasks_.end()) {
-            it->second->cancel();
-            stats_.tasksCancelled++;
-            xSemaphoreGiveRecursive(sessionMutex_);
-            ESP_LOGI(TAG, "Cancelled task for request %s", taskId.c_str());
-            return TINYMCP_SUCCESS;
+    const size_t limit = transport_->getCoalesceLimit();
+    std::string* frames[SessionTransport::MAX_COALESCED_FRAMES];
+    int result = TINYMCP_SUCCESS;
+    
+    for (;;) {
+        // Group queued frames until the next one would overflow the write
+        size_t count = 0;
+        size_t bytes = 0;
+        std::string* frame = nullptr;
+        while (count < SessionTransport::MAX_COALESCED_FRAMES &&
+               xQueuePeek(outboundQueue_, &frame, 0) == pdTRUE) {
+            if (frame && count > 0 && bytes + frame->size() > limit) {
+                break;
+            }
+            xQueueReceive(outboundQueue_, &frame, 0);
+            if (!frame) {
+                continue;   // Writer wakeup posted by shutdown()
+            }
+            frames[count++] = frame;
+            bytes += frame->size();
+        }
+        
+        if (count == 0) {
+            break;
+        }
+        
+        int sendResult;
+        {
+            MetricSpan sendSpan(MetricStage::SEND, "(outbound)");
+            sendResult = transport_->sendFrames(frames, count);
+        }
+        if (sendResult == TINYMCP_SUCCESS) {
+            stats_.messagesSent += count;
+            updateActivity();
+        } else {
+            result = sendResult;
+        }
+        
+        for (size_t i = 0; i < count; ++i) {
+            delete frames[i];
         }
-        xSemaphoreGiveRecursive(sessionMutex_);
     }
     
-    return TINYMCP_ERROR_NOT_FOUND;
-}
-
-size_t Session::getPendingTaskCount() const {
-    return pendingTasks_.size();
+    return result;
 }
 
-int Session::sendMessage(const Message& message) {
-    std::string jsonStr;
-    int result = message.serialize(jsonStr);
-    if (result != TINYMCP_SUCCESS) {
-        return result;
+int Session::flushOutbound() {
+    if (!outboundQueue_ || uxQueueMessagesWaiting(outboundQueue_) == 0) {
+        return TINYMCP_SUCCESS;
     }
     
-    result = transport_->send(jsonStr);
-    if (result == TINYMCP_SUCCESS) {
-        stats_.messagesSent++;
-        updateActivity();
+    if (xSemaphoreTake(sendMutex_, portMAX_DELAY) != pdTRUE) {
+        return TINYMCP_ERROR_TRANSPORT_FAILED;
     }
+    int result = drainOutbound();
+    xSemaphoreGive(sendMutex_);
     
     return result;
 }
@@ -450,6 +1341,28 @@ int Session::sendNotification(const std::string& method, const cJSON* params) {
     }
 }
 
+int Session::sendProgress(const std::string& token, int progress, int total, const char* message,
+                          const char* data, size_t dataLength) {
+    return sendStreamed([&](JsonWriter& writer) {
+        writer.beginObject();
+        writer.key(MSG_KEY_JSONRPC).value(JSON_RPC_VERSION);
+        writer.key(MSG_KEY_METHOD).value(METHOD_PROGRESS);
+        writer.key(MSG_KEY_PARAMS).beginObject();
+        writer.key(MSG_KEY_PROGRESS_TOKEN).value(token);
+        writer.key(MSG_KEY_PROGRESS).value(progress);
+        writer.key(MSG_KEY_TOTAL).value(total);
+        if (message) {
+            writer.key(MSG_KEY_MESSAGE).value(message);
+        }
+        if (data) {
+            writer.key(MSG_KEY_DATA).value(data, dataLength);
+        }
+        writer.endObject();
+        writer.endObject();
+        return writer.getStatus();
+    });
+}
+
 // Static task functions
 void Session::messageProcessorTask(void* pvParameters) {
     Session* session = static_cast<Session*>(pvParameters);
@@ -471,8 +1384,10 @@ void Session::messageProcessorTask(void* pvParameters) {
             break;
         }
         
-        // Wait for messages
-        if (xQueueReceive(session->messageQueue_, &context, pdMS_TO_TICKS(100)) == pdTRUE) {
+        // Wait for messages; shutdown() posts a null context to wake us
+        TickType_t waitTicks = session->config_.enableEventDrivenLoop ?
+                               portMAX_DELAY : pdMS_TO_TICKS(100);
+        if (xQueueReceive(session->messageQueue_, &context, waitTicks) == pdTRUE) {
             if (context) {
                 session->processMessage(std::unique_ptr<MessageContext>(context));
                 context = nullptr;
@@ -481,76 +1396,70 @@ void Session::messageProcessorTask(void* pvParameters) {
     }
     
     ESP_LOGI(TAG, "Message processor task ended");
+    xEventGroupSetBits(session->sessionEvents_, EVENT_PROCESSOR_EXITED);
     vTaskDelete(NULL);
 }
 
 void Session::asyncTaskManager(void* pvParameters) {
     Session* session = static_cast<Session*>(pvParameters);
+    const bool eventDriven = session->config_.enableEventDrivenLoop;
+    const EventBits_t workBits = EVENT_TASK_SUBMITTED | EVENT_TASK_COMPLETED | EVENT_TIMER_DUE;
+    TickType_t waitTicks = 0;
     
     ESP_LOGI(TAG, "Async task manager started");
     
     while (session->state_ != SessionState::SHUTDOWN) {
-        // Check for shutdown
+        // Sleep until a task is submitted, completed, cancelled or timed
+        // out, or a session timer is due; polling mode keeps the fixed delay.
         EventBits_t events = xEventGroupWaitBits(
             session->sessionEvents_,
-            EVENT_SHUTDOWN_REQUEST,
+            eventDriven ? (EVENT_SHUTDOWN_REQUEST | workBits) : EVENT_SHUTDOWN_REQUEST,
             pdFALSE,
             pdFALSE,
-            0
+            waitTicks
         );
         
         if (events & EVENT_SHUTDOWN_REQUEST) {
             break;
         }
         
-        // Process pending tasks
-        if (xSemaphoreTakeRecursive(session->sessionMutex_, pdMS_TO_TICKS(100)) == pdTRUE) {
-            auto it = session->pendingTasks_.begin();
-            while (it != session->pendingTasks_.end()) {
-                auto& task = it->second;
-                
-                if (task->isCancelled() || task->isFinished()) {
-                    // Move to completed tasks
-                    session->completedTasks_.push_back(task);
-                    if (task->isFinished() && !task->isCancelled()) {
-                        session->stats_.tasksCompleted++;
-                    }
-                    it = session->pendingTasks_.erase(it);
-                } else {
-                    // Check for timeout
-                    TickType_t now = xTaskGetTickCount();
-                    if ((now - task->getStartTime()) > task->getTimeout()) {
-                        ESP_LOGW(TAG, "Task timeout for request %s", 
-                                task->getRequestId().asString().c_str());
-                        task->cancel();
-                        session->stats_.tasksCancelled++;
-                    } else {
-                        // Execute task (non-blocking)
-                        task->execute();
-                    }
-                    ++it;
-                }
-            }
-            
-            // Cleanup completed tasks (keep last few for debugging)
-            while (session->completedTasks_.size() > 10) {
-                session->completedTasks_.pop_front();
+        // The timer wheel sets its bits in polling mode too
+        events = xEventGroupClearBits(session->sessionEvents_, workBits);
+        
+        if ((events & EVENT_TIMER_DUE) && !session->idleExpired_ && !session->serviceTimers()) {
+            // run() notices on its next pass; in event-driven mode it is
+            // blocked in receive until the transport closes
+            session->idleExpired_ = true;
+            if (eventDriven) {
+                session->transport_->close();
             }
-            
-            xSemaphoreGiveRecursive(session->sessionMutex_);
         }
         
-        vTaskDelay(pdMS_TO_TICKS(50)); // Small delay to prevent busy waiting
+        // Process pending tasks
+        bool needsRerun = session->serviceTasks();
+        
+        if (!eventDriven) {
+            waitTicks = 0;
+            vTaskDelay(pdMS_TO_TICKS(50)); // Small delay to prevent busy waiting
+        } else if (needsRerun) {
+            // Tasks that yielded without finishing get re-run shortly
+            waitTicks = pdMS_TO_TICKS(session->config_.taskPollIntervalMs);
+        } else {
+            waitTicks = portMAX_DELAY;
+        }
     }
     
     ESP_LOGI(TAG, "Async task manager ended");
+    xEventGroupSetBits(session->sessionEvents_, EVENT_MANAGER_EXITED);
     vTaskDelete(NULL);
 }
 
-void Session::keepAliveTask(void* pvParameters) {
+void Session::outboundWriterTask(void* pvParameters) {
     Session* session = static_cast<Session*>(pvParameters);
+    const TickType_t window = pdMS_TO_TICKS(session->transport_->getCoalesceWindowMs());
+    std::string* frame = nullptr;
     
-    ESP_LOGI(TAG, "Keep-alive task started");
+    ESP_LOGI(TAG, "Outbound writer task started");
     
     while (session->state_ != SessionState::SHUTDOWN) {
         // Check for shutdown
@@ -559,30 +1468,51 @@ void Session::keepAliveTask(void* pvParameters) {
             EVENT_SHUTDOWN_REQUEST,
             pdFALSE,
             pdFALSE,
-            pdMS_TO_TICKS(30000) // 30 second intervals
+            0
         );
         
         if (events & EVENT_SHUTDOWN_REQUEST) {
             break;
         }
         
-        // Send ping if no recent activity
-        TickType_t now = xTaskGetTickCount();
-        if ((now - session->stats_.lastActivityTime) > pdMS_TO_TICKS(60000)) { // 1 minute
-            session->sendNotification("notifications/ping");
-            session->stats_.lastActivityTime = now;
+        // Sleep until a frame is queued; shutdown() posts a null frame
+        TickType_t waitTicks = session->config_.enableEventDrivenLoop ?
+                               portMAX_DELAY : pdMS_TO_TICKS(100);
+        if (xQueuePeek(session->outboundQueue_, &frame, waitTicks) != pdTRUE) {
+            continue;
+        }
+        
+        // Let frames produced right behind this one join the same write
+        if (frame && window > 0) {
+            vTaskDelay(window);
         }
+        session->flushOutbound();
     }
     
-    ESP_LOGI(TAG, "Keep-alive task ended");
+    ESP_LOGI(TAG, "Outbound writer task ended");
+    xEventGroupSetBits(session->sessionEvents_, EVENT_WRITER_EXITED);
     vTaskDelete(NULL);
 }
 
 int Session::processMessage(std::unique_ptr<MessageContext> context) {
-    if (!context || !context->message) {
+    if (!context || (!context->message && !cJSON_IsArray(context->root))) {
         return TINYMCP_ERROR_INVALID_PARAMS;
     }
     
+    ArenaScope scope(context->arena);
+    
+    // Handler time includes its reply; sends made on the way are keyed
+    // by this message's method
+    MetricSpan executeSpan(MetricStage::EXECUTE, metricKeyOf(context->message.get()));
+    MetricTaskScope metricScope(executeSpan.getKey());
+#if TINYMCP_METRICS
+    Metrics::getInstance().record(executeSpan.getKey(), MetricStage::QUEUE_WAIT, context->queuedUs);
+#endif
+    
+    if (!context->message) {
+        return processBatch(context->root);
+    }
+    
     Message* msg = context->message.get();
     
     switch (msg->getCategory()) {
@@ -593,32 +1523,116 @@ int Session::processMessage(std::unique_ptr<MessageContext> context) {
         case MessageCategory::NOTIFICATION:
             return processNotification(static_cast<const Notification&>(*msg));
         default:
-            ESP_LOGW(TAG, "Unknown message category");
+            TINYMCP_LOGW(TAG, "Unknown message category");
             return TINYMCP_ERROR_INVALID_MESSAGE;
     }
 }
 
+// Answers what the envelope alone decides: unknown methods, ping and requests
+// refused for low memory. Returns false when the frame needs a full parse.
+bool Session::routeEnvelope(const JsonRpcEnvelope& envelope, int& result) {
+    MessageCategory category = envelope.getCategory();
+    std::string_view method;
+    if ((category != MessageCategory::REQUEST && category != MessageCategory::NOTIFICATION) ||
+        !envelope.isJsonRpc2() || !envelope.getMethod(method)) {
+        return false;
+    }
+    
+    const MethodEntry* entry = MethodTable::find(method);
+    bool known = entry && entry->category == category;
+    if (category == MessageCategory::NOTIFICATION) {
+        if (!known) {
+            TINYMCP_LOGD(TAG, "Ignoring notification %s", method);
+            result = TINYMCP_SUCCESS;
+        }
+        return !known;
+    }
+    
+    MessageId id;
+    if (!envelope.getId(id)) {
+        return false;
+    }
+    
+    if (!known) {
+        TINYMCP_LOGW(TAG, "Unknown method: %s", method);
+        result = sendErrorResponse(id, TINYMCP_METHOD_NOT_FOUND, "Method not found: " + std::string(method));
+        return true;
+    }
+    
+    if (entry->type == MessageType::PING_REQUEST) {
+        MetricSpan executeSpan(MetricStage::EXECUTE, entry->name.data());
+        MetricTaskScope metricScope(executeSpan.getKey());
+        result = sendMessage(PingResponse(id));
+        return true;
+    }
+    
+    // Same rule as processRequest(), applied before the params are parsed
+    if (!AdmissionControl::canAdmitRequest(config_.admission)) {
+        TINYMCP_LOGW(TAG, "Low memory (%u bytes free), rejecting %s",
+                     AdmissionControl::getFreeHeap(), method);
+        stats_.requestsRejected++;
+        result = sendErrorResponse(id, TINYMCP_ERROR_RESOURCE_LIMIT, "Server low on memory");
+        return true;
+    }
+    
+    return false;
+}
+
+// Explicit TINYMCP_ERROR_RESOURCE_LIMIT reply for a message we cannot take;
+// notifications and responses are dropped as they expect no reply
+int Session::rejectMessage(const MessageContext& context, const char* reason) {
+    stats_.requestsRejected++;
+    
+    if (!context.message) {
+        sendErrorResponse(MessageId(), TINYMCP_ERROR_RESOURCE_LIMIT, reason);
+    } else if (context.message->getCategory() == MessageCategory::REQUEST) {
+        sendErrorResponse(static_cast<const Request&>(*context.message).getId(),
+                          TINYMCP_ERROR_RESOURCE_LIMIT, reason);
+    }
+    
+    return TINYMCP_ERROR_RESOURCE_LIMIT;
+}
+
 int Session::processRequest(const Request& request) {
     const std::string& method = request.getMethod();
     
-    ESP_LOGI(TAG, "Processing request: %s", method.c_str());
-    
-    if (method == "initialize") {
-        return handleInitializeRequest(static_cast<const InitializeRequest&>(request));
-    } else if (method == "tools/list") {
-        return handleListToolsRequest(static_cast<const ListToolsRequest&>(request));
-    } else if (method == "tools/call") {
-        return handleCallToolRequest(static_cast<const CallToolRequest&>(request));
-    } else {
-        // Unknown method
-        return sendErrorResponse(request.getId(), 
-                               TINYMCP_METHOD_NOT_FOUND,
-                               "Method not found: " + method);
+    TINYMCP_LOGI(TAG, "Processing request: %s", method);
+    
+    // Under memory pressure only ping is still served
+    if (request.getType() != MessageType::PING_REQUEST &&
+        !AdmissionControl::canAdmitRequest(config_.admission)) {
+        TINYMCP_LOGW(TAG, "Low memory (%u bytes free), rejecting %s",
+                     AdmissionControl::getFreeHeap(), method);
+        stats_.requestsRejected++;
+        return sendErrorResponse(request.getId(), TINYMCP_ERROR_RESOURCE_LIMIT, "Server low on memory");
+    }
+    
+    // The type was resolved once by the method table
+    switch (request.getType()) {
+        case MessageType::INITIALIZE_REQUEST:
+            return handleInitializeRequest(static_cast<const InitializeRequest&>(request));
+        case MessageType::LIST_TOOLS_REQUEST:
+            return handleListToolsRequest(static_cast<const ListToolsRequest&>(request));
+        case MessageType::CALL_TOOL_REQUEST:
+            return handleCallToolRequest(static_cast<const CallToolRequest&>(request));
+        case MessageType::PING_REQUEST:
+            return sendMessage(PingResponse(request.getId()));
+        case MessageType::CUSTOM_REQUEST:
+            if (customHandler_) {
+                return customHandler_(*this, request);
+            }
+            break;
+        default:
+            break;
     }
+    
+    return sendErrorResponse(request.getId(), 
+                           TINYMCP_METHOD_NOT_FOUND,
+                           "Method not found: " + method);
 }
 
 int Session::processResponse(const Response& response) {
-    ESP_LOGI(TAG, "Processing response for request: %s", response.getId().asString().c_str());
+    TINYMCP_LOGI(TAG, "Processing response for request: %s", response.getId().asString());
     // Handle responses if needed
     return TINYMCP_SUCCESS;
 }
@@ -626,17 +1640,170 @@ int Session::processResponse(const Response& response) {
 int Session::processNotification(const Notification& notification) {
     const std::string& method = notification.getMethod();
     
-    ESP_LOGI(TAG, "Processing notification: %s", method.c_str());
+    TINYMCP_LOGI(TAG, "Processing notification: %s", method);
+    
+    switch (notification.getType()) {
+        case MessageType::INITIALIZED_NOTIFICATION:
+            return handleInitializedNotification(static_cast<const InitializedNotification&>(notification));
+        case MessageType::CANCELLED_NOTIFICATION:
+            return handleCancelledNotification(static_cast<const CancelledNotification&>(notification));
+        case MessageType::CUSTOM_NOTIFICATION:
+            return customHandler_ ? customHandler_(*this, notification) : TINYMCP_SUCCESS;
+        default:
+            return TINYMCP_SUCCESS;
+    }
+}
+
+int Session::processBatch(const cJSON* batch) {
+    int count = cJSON_GetArraySize(batch);
+    if (count == 0 || static_cast<uint32_t>(count) > config_.maxBatchSize) {
+        TINYMCP_LOGW(TAG, "Rejecting batch of %d elements", count);
+        stats_.errors++;
+        return sendErrorResponse(MessageId(), TINYMCP_INVALID_REQUEST,
+                                 count == 0 ? ERROR_MSG_INVALID_REQUEST : "Batch too large");
+    }
+    
+    TINYMCP_LOGD(TAG, "Processing batch of %d elements", count);
+    
+    if (xSemaphoreTakeRecursive(sessionMutex_, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        return TINYMCP_ERROR_RESOURCE_LOCK;
+    }
+    openBatches_.push_back(std::make_unique<ResponseBatch>());
+    ResponseBatch* batchState = openBatches_.back().get();
+    collecting_ = batchState;
+    collectingTask_ = xTaskGetCurrentTaskHandle();
+    xSemaphoreGiveRecursive(sessionMutex_);
+    
+    // Every element goes through the regular handlers; their replies are
+    // captured by sendStreamed()/sendSerialized() and async tools run
+    // concurrently on the executor
+    const cJSON* element = nullptr;
+    cJSON_ArrayForEach(element, batch) {
+        MessageId id;
+        if (cJSON_IsObject(element)) {
+            id.setFromJson(element);
+        }
+        batchState->currentId = id;
+        
+        std::unique_ptr<Message> message = cJSON_IsObject(element) ?
+            Message::createFromJson(element) : nullptr;
+        if (!message) {
+            stats_.errors++;
+            sendErrorResponse(id, TINYMCP_INVALID_REQUEST, ERROR_MSG_INVALID_REQUEST);
+            continue;
+        }
+        
+        switch (message->getCategory()) {
+            case MessageCategory::REQUEST:
+                // Elements refused by a full pending table still reply with
+                // an error, so the batch gets one entry per request
+                processRequest(static_cast<const Request&>(*message));
+                break;
+            case MessageCategory::NOTIFICATION:
+                processNotification(static_cast<const Notification&>(*message));
+                break;
+            default:
+                break;
+        }
+    }
+    
+    std::vector<std::string> frames;
+    if (xSemaphoreTakeRecursive(sessionMutex_, portMAX_DELAY) == pdTRUE) {
+        collecting_ = nullptr;
+        collectingTask_ = nullptr;
+        batchState->dispatching = false;
+        for (size_t i = 0; i < openBatches_.size(); ++i) {
+            if (openBatches_[i].get() == batchState) {
+                closeBatchIfDone(i, frames);
+                break;
+            }
+        }
+        xSemaphoreGiveRecursive(sessionMutex_);
+    }
     
-    if (method == "initialized") {
-        return handleInitializedNotification(static_cast<const InitializedNotification&>(notification));
-    } else if (method == "notifications/cancelled") {
-        return handleCancelledNotification(static_cast<const CancelledNotification&>(notification));
+    for (const auto& frame : frames) {
+        sendSerialized(frame);
     }
     
     return TINYMCP_SUCCESS;
 }
 
+bool Session::isCollectingBatch() const {
+    return collecting_ && collectingTask_ == xTaskGetCurrentTaskHandle();
+}
+
+void Session::appendToBatch(ResponseBatch& batch, const std::string& element, const MessageId& id) {
+    if (xSemaphoreTakeRecursive(sessionMutex_, portMAX_DELAY) != pdTRUE) {
+        return;
+    }
+    
+    // The whole array must fit one frame; an element that would overflow it
+    // is replaced by an error for its id
+    size_t separator = batch.responseCount > 0 ? 1 : 0;
+    if (batch.body.size() + separator + element.size() + 1 > transport_->getMaxMessageSize()) {
+        TINYMCP_LOGW(TAG, "Batch response full, dropping result for %s", id.asString());
+        std::string error;
+        StringJsonSink sink(error);
+        JsonWriter writer(&sink);
+        ErrorResponse(id, TINYMCP_ERROR_MESSAGE_TOO_LARGE, "Batch response too large").write(writer);
+        writer.finish();
+        if (batch.body.size() + separator + error.size() + 1 > transport_->getMaxMessageSize()) {
+            xSemaphoreGiveRecursive(sessionMutex_);
+            return;
+        }
+        if (separator) {
+            batch.body += ',';
+        }
+        batch.body += error;
+    } else {
+        if (separator) {
+            batch.body += ',';
+        }
+        batch.body += element;
+    }
+    batch.responseCount++;
+    
+    xSemaphoreGiveRecursive(sessionMutex_);
+}
+
+bool Session::routeToBatch(const MessageId& id, const Message* response, std::vector<std::string>& frames) {
+    for (size_t i = 0; i < openBatches_.size(); ++i) {
+        ResponseBatch& batch = *openBatches_[i];
+        auto it = std::find(batch.awaiting.begin(), batch.awaiting.end(), id);
+        if (it == batch.awaiting.end()) {
+            continue;
+        }
+        
+        batch.awaiting.erase(it);
+        if (response) {
+            std::string element;
+            StringJsonSink sink(element);
+            JsonWriter writer(&sink);
+            if (response->write(writer) == TINYMCP_SUCCESS && writer.finish() == TINYMCP_SUCCESS) {
+                appendToBatch(batch, element, id);
+            }
+        }
+        closeBatchIfDone(i, frames);
+        return true;
+    }
+    
+    return false;
+}
+
+void Session::closeBatchIfDone(size_t index, std::vector<std::string>& frames) {
+    ResponseBatch& batch = *openBatches_[index];
+    if (batch.dispatching || !batch.awaiting.empty()) {
+        return;
+    }
+    
+    // A batch of notifications gets no reply at all
+    if (batch.responseCount > 0) {
+        batch.body += ']';
+        frames.push_back(std::move(batch.body));
+    }
+    openBatches_.erase(openBatches_.begin() + index);
+}
+
 int Session::handleInitializeRequest(const InitializeRequest& request) {
     if (state_ != SessionState::INITIALIZED) {
         return sendErrorResponse(request.getId(), 
@@ -668,14 +1835,23 @@ int Session::handleInitializeRequest(const InitializeRequest& request) {
     }
     cJSON_AddItemToObject(result, "serverInfo", serverInfo);
     
-    // Capabilities
-    cJSON* capabilities = capabilities_.toJson();
+    // Capabilities, including the wire format when the client offered CBOR
+    WireFormat format = config_.enableCborEncoding ? request.getPreferredWireFormat() : WireFormat::JSON;
+    ServerCapabilities negotiated = capabilities_;
+    negotiated.setWireFormat(format);
+    cJSON* capabilities = negotiated.toJson();
     cJSON_AddItemToObject(result, "capabilities", capabilities);
     
+    // The initialize response itself is always JSON
     int sendResult = sendResponse(request.getId(), result);
     cJSON_Delete(result);
     
     if (sendResult == TINYMCP_SUCCESS) {
+        wireFormat_ = format;
+        if (format != WireFormat::JSON) {
+            ESP_LOGI(TAG, "Session switched to %s encoding", wireFormatToString(format));
+        }
+        
         // Wait for initialized notification
         protocolInitialized_ = true;
     }
@@ -690,35 +1866,52 @@ int Session::handleListToolsRequest(const ListToolsRequest& request) {
                                "Session not initialized");
     }
     
-    cJSON* result = cJSON_CreateObject();
-    cJSON* tools = cJSON_CreateArray();
-    
-    if (!result || !tools) {
-        cJSON_Delete(result);
-        cJSON_Delete(tools);
-        return TINYMCP_ERROR_OUT_OF_MEMORY;
-    }
-    
-    // Add supported tools
-    for (const auto& toolName : supportedTools_) {
-        cJSON* tool = cJSON_CreateObject();
-        cJSON* name = cJSON_CreateString(toolName.c_str());
-        if (name) {
-            cJSON_AddItemToObject(tool, "name", name);
+    std::string idJson;
+    request.getId().appendJson(idJson);
+    
+    // The tools array is serialized once per registry generation (or page);
+    // only the request id and cursor are spliced in here
+    ToolRegistry::ToolsPage page;
+    if (config_.enableToolsPagination) {
+        // Envelope: jsonrpc/id/result keys plus the worst-case nextCursor
+        size_t overhead = 64 + idJson.size() + 2 * MAX_TOOL_NAME_LENGTH;
+        size_t maxSize = transport_->getMaxMessageSize();
+        if (maxSize <= overhead) {
+            return sendErrorResponse(request.getId(), 
+                                   TINYMCP_ERROR_RESOURCE_LIMIT,
+                                   "Message size limit too small for tools list");
         }
-        cJSON* description = cJSON_CreateString("Tool description");
-        if (description) {
-            cJSON_AddItemToObject(tool, "description", description);
+        
+        size_t maxResults = request.getMaxResults() > 0 ? request.getMaxResults() : 0;
+        int result = ToolRegistry::getInstance().getToolsPage(request.getCursor(), maxSize - overhead,
+                                                              maxResults, page);
+        if (result != TINYMCP_SUCCESS) {
+            return sendErrorResponse(request.getId(), result, "Failed to build tools list");
         }
-        cJSON_AddItemToArray(tools, tool);
+    } else {
+        page.tools = ToolRegistry::getInstance().getToolsListPayload(&page.generation);
     }
     
-    cJSON_AddItemToObject(result, "tools", tools);
+    if (!page.tools) {
+        return sendErrorResponse(request.getId(), 
+                               TINYMCP_ERROR_OUT_OF_MEMORY,
+                               "Failed to build tools list");
+    }
     
-    int sendResult = sendResponse(request.getId(), result);
-    cJSON_Delete(result);
+    std::string json;
+    json.reserve(page.tools->size() + idJson.size() + page.nextCursor.size() + 64);
+    json += "{\"jsonrpc\":\"2.0\",\"id\":";
+    json += idJson;
+    json += ",\"result\":{\"tools\":";
+    json += *page.tools;
+    if (!page.nextCursor.empty()) {
+        json += ",\"nextCursor\":";
+        JsonHelper::appendEscapedString(json, page.nextCursor.data(), page.nextCursor.size());
+    }
+    json += "}}";
     
-    return sendResult;
+    listedToolsGeneration_ = page.generation;
+    return sendSerialized(json);
 }
 
 int Session::handleCallToolRequest(const CallToolRequest& request) {
@@ -738,11 +1931,38 @@ int Session::handleCallToolRequest(const CallToolRequest& request) {
                                "Tool not found: " + toolName);
     }
     
-    // Create async task for tool execution using ErrorTask as a placeholder
-    // TODO: Implement proper tool registry and execution system
-    auto task = std::make_unique<ErrorTask>(request.getId(), TINYMCP_ERROR_NOT_IMPLEMENTED, "Tool execution not implemented: " + toolName);
+    // Tasks outlive the message, so keep their allocations off the arena
+    ArenaScope heapScope(nullptr);
+    
+    auto task = ToolRegistry::getInstance().createToolTask(request.getId(), toolName,
+                                                           request.getRawArguments());
+    if (!task) {
+        return sendErrorResponse(request.getId(), 
+                               TINYMCP_ERROR_OUT_OF_MEMORY,
+                               "Failed to create tool task");
+    }
+    
+    if (!task->isValid()) {
+        return sendErrorResponse(request.getId(), 
+                               TINYMCP_ERROR_INVALID_PARAMS,
+                               "Invalid arguments for tool: " + toolName);
+    }
+    
+    if (request.hasProgressToken()) {
+        task->setProgressToken(request.getProgressToken());
+    }
     
-    return submitTask(std::move(task));
+    // A request the session cannot take is refused, never left unanswered
+    int result = submitTask(std::move(task));
+    if (result == TINYMCP_ERROR_RESOURCE_LIMIT) {
+        stats_.errors++;
+        return sendErrorResponse(request.getId(), TINYMCP_ERROR_RESOURCE_LIMIT, "Too many pending tasks");
+    }
+    if (result == TINYMCP_ERROR_INVALID_STATE) {
+        stats_.errors++;
+        return sendErrorResponse(request.getId(), TINYMCP_INVALID_REQUEST, "Duplicate request id");
+    }
+    return result;
 }
 
 int Session::handleInitializedNotification(const InitializedNotification& notification) {
@@ -777,15 +1997,20 @@ bool Session::canTransitionTo(SessionState newState) const {
 }
 
 int Session::sendResponse(const MessageId& requestId, const cJSON* result) {
-    auto response = std::make_unique<CallToolResponse>(requestId);
-    if (result) {
-        char* resultStr = cJSON_Print(result);
-        if (resultStr) {
-            response->addJsonContent(std::string(resultStr));
-            free(resultStr);
+    return sendStreamed([&requestId, result](JsonWriter& writer) {
+        writer.beginObject();
+        writer.key(MSG_KEY_JSONRPC).value(JSON_RPC_VERSION);
+        writer.key(MSG_KEY_ID);
+        requestId.writeJson(writer);
+        writer.key(MSG_KEY_RESULT);
+        if (result) {
+            writer.value(result);
+        } else {
+            writer.beginObject().endObject();
         }
-    }
-    return sendMessage(*response);
+        writer.endObject();
+        return writer.getStatus();
+    });
 }
 
 int Session::sendErrorResponse(const MessageId& requestId, int errorCode, const std::string& message) {
@@ -797,6 +2022,18 @@ void Session::updateActivity() {
     stats_.lastActivityTime = xTaskGetTickCount();
 }
 
+TickType_t Session::getIdleTimeoutRemaining() const {
+    TickType_t idle = xTaskGetTickCount() - stats_.lastActivityTime;
+    TickType_t limit = pdMS_TO_TICKS(config_.sessionTimeoutMs);
+    return idle < limit ? limit - idle : 0;
+}
+
+void Session::wakeTaskManager(EventBits_t reason) {
+    if (sessionEvents_ && config_.enableEventDrivenLoop) {
+        xEventGroupSetBits(sessionEvents_, reason);
+    }
+}
+
 void Session::cleanup() {
     // Clean up FreeRTOS resources
     if (messageQueue_) {
@@ -809,11 +2046,25 @@ void Session::cleanup() {
         taskQueue_ = nullptr;
     }
     
+    if (outboundQueue_) {
+        std::string* frame = nullptr;
+        while (xQueueReceive(outboundQueue_, &frame, 0) == pdTRUE) {
+            delete frame;
+        }
+        vQueueDelete(outboundQueue_);
+        outboundQueue_ = nullptr;
+    }
+    
     if (sessionMutex_) {
         vSemaphoreDelete(sessionMutex_);
         sessionMutex_ = nullptr;
     }
     
+    if (sendMutex_) {
+        vSemaphoreDelete(sendMutex_);
+        sendMutex_ = nullptr;
+    }
+    
     if (sessionEvents_) {
         vEventGroupDelete(sessionEvents_);
         sessionEvents_ = nullptr;
@@ -825,11 +2076,58 @@ SessionManager& SessionManager::getInstance() {
     return instance_;
 }
 
+int SessionManager::initializePool(size_t count, const SessionConfig& config) {
+    if (!pool_.empty()) {
+        return TINYMCP_ERROR_INVALID_STATE;
+    }
+    
+    pool_.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        auto session = std::shared_ptr<Session>(new Session(nullptr, config));
+        if (session->getState() == SessionState::ERROR_STATE) {
+            break;
+        }
+        pool_.push_back(std::move(session));
+    }
+    
+    ESP_LOGI(TAG, "Session pool: %u of %u sessions preallocated",
+             static_cast<unsigned>(pool_.size()), static_cast<unsigned>(count));
+    return pool_.size() == count ? TINYMCP_SUCCESS : TINYMCP_ERROR_OUT_OF_MEMORY;
+}
+
 std::shared_ptr<Session> SessionManager::createSession(
     std::unique_ptr<SessionTransport> transport,
     const SessionConfig& config) {
     
-    auto session = std::shared_ptr<Session>(new Session(std::move(transport), config));
+    std::shared_ptr<Session> session;
+    if (!pool_.empty()) {
+        // Finished sessions are dropped first so their slots come free
+        cleanupInactiveSessions();
+        
+        for (const auto& pooled : pool_) {
+            // Held by nobody else, so the previous connection is fully gone
+            if (pooled.use_count() != 1) {
+                continue;
+            }
+            if (pooled->getState() == SessionState::ERROR_STATE) {
+                pooled->shutdown();
+            }
+            if (pooled->isReusableFor(config)) {
+                pooled->attach(std::move(transport), config);
+                session = pooled;
+                globalStats_.pooledSessionsReused++;
+                break;
+            }
+        }
+        
+        if (!session) {
+            globalStats_.poolMisses++;
+        }
+    }
+    
+    if (!session) {
+        session = std::shared_ptr<Session>(new Session(std::move(transport), config));
+    }
     
     if (session->getState() != SessionState::ERROR_STATE) {
         sessions_.push_back(session);
@@ -877,11 +2175,21 @@ void SessionManager::cleanupInactiveSessions() {
 CallToolTask::CallToolTask(const MessageId& requestId, const std::string& toolName, const cJSON* args) :
     AsyncTask(requestId, "tools/call"), toolName_(toolName), arguments_(nullptr) {
     
+#if TINYMCP_METRICS
+    queuedUs_ = Metrics::nowUs();
+#endif
+    
     if (args) {
         arguments_ = cJSON_Duplicate(args, cJSON_True);
     }
 }
 
+CallToolTask::~CallToolTask() {
+    if (arguments_) {
+        cJSON_Delete(arguments_);
+    }
+}
+
 bool CallToolTask::isValid() const {
     return !toolName_.empty();
 }
@@ -891,23 +2199,31 @@ int CallToolTask::execute() {
         return TINYMCP_ERROR_CANCELLED;
     }
     
-    ESP_LOGI(TAG, "Executing tool: %s", toolName_.c_str());
+    TINYMCP_LOGI(TAG, "Executing tool: %s", toolName_);
     
     cJSON* result = nullptr;
-    int executeResult = executeToolLogic(arguments_, &result);
+    int executeResult;
+    {
+        // Progress sent by the tool is attributed to it as well
+        MetricSpan executeSpan(MetricStage::EXECUTE, toolName_.c_str());
+        MetricTaskScope metricScope(executeSpan.getKey());
+#if TINYMCP_METRICS
+        Metrics::getInstance().record(executeSpan.getKey(), MetricStage::QUEUE_WAIT, queuedUs_);
+#endif
+        executeResult = executeToolLogic(arguments_, &result);
+    }
     
     if (executeResult == TINYMCP_SUCCESS) {
-        finished_ = true;
-        // Tool execution successful - result would be sent by derived class
-        ESP_LOGI(TAG, "Tool %s executed successfully", toolName_.c_str());
+        TINYMCP_LOGI(TAG, "Tool %s executed successfully", toolName_);
+        response_ = createResponse(result);
     } else {
-        finished_ = true;
-        ESP_LOGE(TAG, "Tool %s execution failed: %d", toolName_.c_str(), executeResult);
-    }
-    
-    if (result) {
-        cJSON_Delete(result);
+        TINYMCP_LOGE(TAG, "Tool %s execution failed: %d", toolName_, executeResult);
+        if (result) {
+            cJSON_Delete(result);
+        }
+        response_ = createErrorResponse(executeResult, "Tool execution failed: " + toolName_);
     }
+    finished_ = true;
     
     return executeResult;
 }
@@ -915,6 +2231,8 @@ int CallToolTask::execute() {
 // ErrorTask implementation
 ErrorTask::ErrorTask(const MessageId& requestId, int errorCode, const std::string& errorMessage) :
     AsyncTask(requestId, "error"), errorCode_(errorCode), errorMessage_(errorMessage) {
+    
+    setScheduling(TaskPriority::HIGH, true);
 }
 
 bool ErrorTask::isValid() const {
@@ -926,8 +2244,9 @@ int ErrorTask::execute() {
         return TINYMCP_ERROR_CANCELLED;
     }
     
-    ESP_LOGE(TAG, "Error task executing: %d - %s", errorCode_, errorMessage_.c_str());
+    TINYMCP_LOGE(TAG, "Error task executing: %d - %s", errorCode_, errorMessage_);
     
+    response_ = createErrorResponse(errorCode_, errorMessage_);
     finished_ = true;
     return TINYMCP_SUCCESS;
 }
@@ -3,6 +3,7 @@
 
 #include "tinymcp_socket_transport.h"
 #include "tinymcp_constants.h"
+#include "tinymcp_log.h"
 
 #include <sys/socket.h>
 #include <netinet/in.h>
@@ -19,7 +20,8 @@ namespace tinymcp {
 
 // EspSocketTransport implementation
 EspSocketTransport::EspSocketTransport(int socket, const SocketTransportConfig& config) :
-    config_(config), socket_(socket), port_(0), isServer_(true), connected_(true) {
+    config_(config), socket_(socket), port_(0), isServer_(true), connected_(true),
+    streamLength_(0), streamRemaining_(0), streamHeaderSent_(false), streamStatus_(TINYMCP_SUCCESS) {
     
     receiveBuffer_ = std::make_unique<char[]>(config_.receiveBufferSize);
     
@@ -38,7 +40,8 @@ EspSocketTransport::EspSocketTransport(int socket, const SocketTransportConfig&
 }
 
 EspSocketTransport::EspSocketTransport(const std::string& host, uint16_t port, const SocketTransportConfig& config) :
-    config_(config), socket_(-1), hostAddress_(host), port_(port), isServer_(false), connected_(false) {
+    config_(config), socket_(-1), hostAddress_(host), port_(port), isServer_(false), connected_(false),
+    streamLength_(0), streamRemaining_(0), streamHeaderSent_(false), streamStatus_(TINYMCP_SUCCESS) {
     
     receiveBuffer_ = std::make_unique<char[]>(config_.receiveBufferSize);
     clientInfo_ = host + ":" + std::to_string(port);
@@ -52,31 +55,174 @@ EspSocketTransport::~EspSocketTransport() {
 }
 
 int EspSocketTransport::send(const std::string& data) {
+    return sendBuffer(data.data(), data.size());
+}
+
+int EspSocketTransport::sendBuffer(const char* data, size_t length) {
     if (!isConnected()) {
-        ESP_LOGW(TAG, "Attempt to send on disconnected socket");
+        TINYMCP_LOGW(TAG, "Attempt to send on disconnected socket");
         return TINYMCP_ERROR_TRANSPORT_FAILED;
     }
     
-    if (data.empty()) {
+    if (length == 0) {
         return TINYMCP_SUCCESS;
     }
     
-    if (data.size() > config_.maxMessageSize) {
-        ESP_LOGW(TAG, "Message too large: %zu bytes", data.size());
+    if (length > config_.maxMessageSize) {
+        TINYMCP_LOGW(TAG, "Message too large: %zu bytes", length);
         return TINYMCP_ERROR_MESSAGE_TOO_LARGE;
     }
     
-    int result = sendFrame(data);
+    int result = sendFrame(data, length);
+    if (result == TINYMCP_SUCCESS) {
+        stats_.bytesSent += length;
+        stats_.messagesSent++;
+    } else {
+        stats_.sendErrors++;
+    }
+    
+    return result;
+}
+
+int EspSocketTransport::beginStream(size_t length) {
+    if (!isConnected()) {
+        TINYMCP_LOGW(TAG, "Attempt to send on disconnected socket");
+        return TINYMCP_ERROR_TRANSPORT_FAILED;
+    }
+    
+    if (length == 0 || length > config_.maxMessageSize) {
+        TINYMCP_LOGW(TAG, "Invalid streamed message size: %zu bytes", length);
+        return length == 0 ? TINYMCP_ERROR_INVALID_PARAMS : TINYMCP_ERROR_MESSAGE_TOO_LARGE;
+    }
+    
+    streamLength_ = length;
+    streamRemaining_ = length;
+    streamHeaderSent_ = false;
+    streamStatus_ = TINYMCP_SUCCESS;
+    return TINYMCP_SUCCESS;
+}
+
+int EspSocketTransport::streamChunk(const char* data, size_t length) {
+    if (streamStatus_ != TINYMCP_SUCCESS) {
+        return streamStatus_;
+    }
+    
+    // Writing past the announced length would desynchronize the framing
+    if (length > streamRemaining_) {
+        TINYMCP_LOGE(TAG, "Streamed message overran its length by %zu bytes", length - streamRemaining_);
+        streamStatus_ = TINYMCP_ERROR_INVALID_STATE;
+        return streamStatus_;
+    }
+    
+    uint8_t header[MESSAGE_HEADER_SIZE];
+    struct iovec iov[2];
+    int iovCount = 0;
+    
+    if (!streamHeaderSent_) {
+        MessageFraming::encodeHeader(streamLength_, header);
+        iov[iovCount].iov_base = header;
+        iov[iovCount].iov_len = sizeof(header);
+        iovCount++;
+        streamHeaderSent_ = true;
+    }
+    iov[iovCount].iov_base = const_cast<char*>(data);
+    iov[iovCount].iov_len = length;
+    iovCount++;
+    
+    streamStatus_ = sendVectored(iov, iovCount);
+    if (streamStatus_ == TINYMCP_SUCCESS) {
+        streamRemaining_ -= length;
+    }
+    return streamStatus_;
+}
+
+int EspSocketTransport::endStream() {
+    int result = streamStatus_;
+    if (result == TINYMCP_SUCCESS && streamRemaining_ != 0) {
+        TINYMCP_LOGE(TAG, "Streamed message ended %zu bytes short", streamRemaining_);
+        result = TINYMCP_ERROR_INVALID_STATE;
+    }
+    
+    // A broken frame cannot be repaired once its header is on the wire
+    if (result != TINYMCP_SUCCESS && streamHeaderSent_) {
+        connected_ = false;
+    }
+    
     if (result == TINYMCP_SUCCESS) {
-        stats_.bytesSent += data.size();
+        stats_.bytesSent += streamLength_;
         stats_.messagesSent++;
     } else {
         stats_.sendErrors++;
     }
     
+    streamLength_ = 0;
+    streamRemaining_ = 0;
+    streamHeaderSent_ = false;
+    streamStatus_ = TINYMCP_SUCCESS;
     return result;
 }
 
+int EspSocketTransport::sendFrames(const std::string* const* frames, size_t count) {
+    if (!isConnected()) {
+        TINYMCP_LOGW(TAG, "Attempt to send on disconnected socket");
+        return TINYMCP_ERROR_TRANSPORT_FAILED;
+    }
+    
+    for (size_t i = 0; i < count; ++i) {
+        if (frames[i]->size() > config_.maxMessageSize) {
+            TINYMCP_LOGW(TAG, "Message too large: %zu bytes", frames[i]->size());
+            return TINYMCP_ERROR_MESSAGE_TOO_LARGE;
+        }
+    }
+    
+    // Headers and payloads of up to MAX_COALESCED_FRAMES messages go out
+    // in one gather write, i.e. as few segments as the payload allows
+    uint8_t headers[MAX_COALESCED_FRAMES][MESSAGE_HEADER_SIZE];
+    struct iovec iov[2 * MAX_COALESCED_FRAMES];
+    
+    while (count > 0) {
+        size_t group = std::min(count, static_cast<size_t>(MAX_COALESCED_FRAMES));
+        size_t bytes = 0;
+        int iovCount = 0;
+        
+        for (size_t i = 0; i < group; ++i) {
+            MessageFraming::encodeHeader(frames[i]->size(), headers[i]);
+            iov[iovCount].iov_base = headers[i];
+            iov[iovCount].iov_len = MESSAGE_HEADER_SIZE;
+            iovCount++;
+            iov[iovCount].iov_base = const_cast<char*>(frames[i]->data());
+            iov[iovCount].iov_len = frames[i]->size();
+            iovCount++;
+            bytes += frames[i]->size();
+        }
+        
+        int result = sendVectored(iov, iovCount);
+        if (result != TINYMCP_SUCCESS) {
+            stats_.sendErrors++;
+            return result;
+        }
+        
+        stats_.bytesSent += bytes;
+        stats_.messagesSent += group;
+        frames += group;
+        count -= group;
+    }
+    
+    return TINYMCP_SUCCESS;
+}
+
+int EspSocketTransport::sendJson(cJSON* json, char* buffer, size_t bufferSize) {
+    if (!json || !buffer || bufferSize == 0) {
+        return TINYMCP_ERROR_INVALID_PARAMS;
+    }
+    
+    if (!cJSON_PrintPreallocated(json, buffer, static_cast<int>(bufferSize), false)) {
+        return TINYMCP_ERROR_MESSAGE_TOO_LARGE;
+    }
+    
+    return sendBuffer(buffer, strlen(buffer));
+}
+
 int EspSocketTransport::receive(std::string& data, uint32_t timeoutMs) {
     if (!isConnected()) {
         return TINYMCP_ERROR_TRANSPORT_FAILED;
@@ -97,6 +243,65 @@ int EspSocketTransport::receive(std::string& data, uint32_t timeoutMs) {
     return result;
 }
 
+int EspSocketTransport::tryReceive(std::string& data) {
+    if (!isConnected()) {
+        return TINYMCP_ERROR_TRANSPORT_FAILED;
+    }
+    
+    data.clear();
+    
+    // Work out how many bytes the current frame still needs
+    size_t needed = MESSAGE_HEADER_SIZE;
+    if (partialFrame_.size() >= MESSAGE_HEADER_SIZE) {
+        uint32_t messageLength;
+        memcpy(&messageLength, partialFrame_.data(), sizeof(messageLength));
+        messageLength = ntohl(messageLength);
+        
+        if (messageLength > config_.maxMessageSize) {
+            TINYMCP_LOGW(TAG, "Message too large: %u bytes", messageLength);
+            partialFrame_.clear();
+            stats_.receiveErrors++;
+            return TINYMCP_ERROR_MESSAGE_TOO_LARGE;
+        }
+        
+        needed = MESSAGE_HEADER_SIZE + messageLength;
+    }
+    
+    while (partialFrame_.size() < needed) {
+        size_t offset = partialFrame_.size();
+        size_t chunk = std::min(needed - offset, config_.receiveBufferSize);
+        
+        ssize_t result = recv(socket_, receiveBuffer_.get(), chunk, MSG_DONTWAIT);
+        if (result < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return TINYMCP_ERROR_TIMEOUT; // Frame incomplete, keep partial data
+            }
+            TINYMCP_LOGW(TAG, "Receive error: %s", strerror(errno));
+            connected_ = false;
+            stats_.receiveErrors++;
+            return TINYMCP_ERROR_TRANSPORT_FAILED;
+        } else if (result == 0) {
+            TINYMCP_LOGI(TAG, "Connection closed by peer");
+            connected_ = false;
+            return TINYMCP_ERROR_TRANSPORT_FAILED;
+        }
+        
+        partialFrame_.append(receiveBuffer_.get(), result);
+        
+        // Header just completed: re-evaluate the full frame size
+        if (needed == MESSAGE_HEADER_SIZE && partialFrame_.size() == MESSAGE_HEADER_SIZE) {
+            return tryReceive(data);
+        }
+    }
+    
+    data.assign(partialFrame_, MESSAGE_HEADER_SIZE, std::string::npos);
+    partialFrame_.clear();
+    
+    stats_.bytesReceived += data.size();
+    stats_.messagesReceived++;
+    return TINYMCP_SUCCESS;
+}
+
 bool EspSocketTransport::isConnected() const {
     if (!connected_ || !isSocketValid()) {
         return false;
@@ -235,49 +440,43 @@ int EspSocketTransport::configureSocket() {
                                        config_.keepAliveCount);
     }
     
-    // Disable Nagle's algorithm for low latency
-    int flag = 1;
+    // Nagle would hold back small frames waiting for an ACK; the session's
+    // outbound queue does the coalescing without the added latency
+    int flag = config_.enableNoDelay ? 1 : 0;
     setsockopt(socket_, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
     
     return TINYMCP_SUCCESS;
 }
 
-int EspSocketTransport::sendFrame(const std::string& data) {
-    // Encode message with length prefix
-    std::string frame;
-    int result = MessageFraming::encodeMessage(data, frame);
-    if (result != TINYMCP_SUCCESS) {
-        return result;
-    }
+int EspSocketTransport::sendFrame(const char* data, size_t length) {
+    // Send the length prefix and the payload from their own buffers
+    uint8_t header[MESSAGE_HEADER_SIZE];
+    MessageFraming::encodeHeader(length, header);
     
-    // Send frame
-    const char* buffer = frame.c_str();
-    size_t totalSize = frame.size();
-    size_t sent = 0;
+    struct iovec iov[2];
+    iov[0].iov_base = header;
+    iov[0].iov_len = sizeof(header);
+    iov[1].iov_base = const_cast<char*>(data);
+    iov[1].iov_len = length;
     
-    while (sent < totalSize) {
-        ssize_t result = ::send(socket_, buffer + sent, totalSize - sent, MSG_NOSIGNAL);
-        if (result < 0) {
-            if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                // Timeout or would block
-                ESP_LOGW(TAG, "Send timeout");
-                return TINYMCP_ERROR_TIMEOUT;
-            } else if (errno == EPIPE || errno == ECONNRESET) {
-                // Connection closed by peer
-                ESP_LOGW(TAG, "Connection closed during send");
-                connected_ = false;
-                return TINYMCP_ERROR_TRANSPORT_FAILED;
-            } else {
-                ESP_LOGE(TAG, "Send error: %s", strerror(errno));
-                return TINYMCP_ERROR_TRANSPORT_FAILED;
-            }
-        } else if (result == 0) {
-            ESP_LOGW(TAG, "Connection closed by peer");
+    return sendVectored(iov, 2);
+}
+
+int EspSocketTransport::sendVectored(struct iovec* iov, int iovCount) {
+    if (SocketUtils::sendAllVectored(socket_, iov, iovCount) < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            // Timeout or would block
+            TINYMCP_LOGW(TAG, "Send timeout");
+            return TINYMCP_ERROR_TIMEOUT;
+        } else if (errno == EPIPE || errno == ECONNRESET || errno == ENOTCONN) {
+            // Connection closed by peer
+            TINYMCP_LOGW(TAG, "Connection closed during send");
             connected_ = false;
             return TINYMCP_ERROR_TRANSPORT_FAILED;
+        } else {
+            TINYMCP_LOGE(TAG, "Send error: %s", strerror(errno));
+            return TINYMCP_ERROR_TRANSPORT_FAILED;
         }
-        
-        sent += result;
     }
     
     return TINYMCP_SUCCESS;
@@ -302,7 +501,7 @@ int EspSocketTransport::receiveFrame(std::string& data, uint32_t timeoutMs) {
     }
     
     if (messageLength > config_.maxMessageSize) {
-        ESP_LOGW(TAG, "Message too large: %u bytes", messageLength);
+        TINYMCP_LOGW(TAG, "Message too large: %u bytes", messageLength);
         return TINYMCP_ERROR_MESSAGE_TOO_LARGE;
     }
     
@@ -331,18 +530,18 @@ int EspSocketTransport::receiveExact(void* buffer, size_t size, uint32_t timeout
         ssize_t result = recv(socket_, ptr + received, size - received, 0);
         if (result < 0) {
             if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                ESP_LOGW(TAG, "Receive timeout");
+                TINYMCP_LOGW(TAG, "Receive timeout");
                 return TINYMCP_ERROR_TIMEOUT;
             } else if (errno == ECONNRESET) {
-                ESP_LOGW(TAG, "Connection reset by peer");
+                TINYMCP_LOGW(TAG, "Connection reset by peer");
                 connected_ = false;
                 return TINYMCP_ERROR_TRANSPORT_FAILED;
             } else {
-                ESP_LOGE(TAG, "Receive error: %s", strerror(errno));
+                TINYMCP_LOGE(TAG, "Receive error: %s", strerror(errno));
                 return TINYMCP_ERROR_TRANSPORT_FAILED;
             }
         } else if (result == 0) {
-            ESP_LOGW(TAG, "Connection closed by peer");
+            TINYMCP_LOGW(TAG, "Connection closed by peer");
             connected_ = false;
             return TINYMCP_ERROR_TRANSPORT_FAILED;
         }
@@ -409,6 +608,8 @@ int EspSocketServer::stop() {
     running_ = false;
     
     if (listenSocket_ >= 0) {
+        // close() alone does not wake a select() blocked on the socket on every stack
+        ::shutdown(listenSocket_, SHUT_RDWR);
         ::close(listenSocket_);
         listenSocket_ = -1;
     }
@@ -443,11 +644,22 @@ std::unique_ptr<EspSocketTransport> EspSocketServer::acceptConnection(uint32_t t
     
     int clientSocket = accept(listenSocket_, (struct sockaddr*)&clientAddr, &clientAddrLen);
     if (clientSocket < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return nullptr; // Non-blocking listen socket with nothing pending
+        }
         ESP_LOGW(TAG, "Accept failed: %s", strerror(errno));
         stats_.acceptErrors++;
         return nullptr;
     }
     
+    if (!AdmissionControl::canAcceptConnection(admission_)) {
+        ESP_LOGW(TAG, "Low memory (%u bytes free), refusing connection from %s",
+                 (unsigned)AdmissionControl::getFreeHeap(), SocketUtils::formatAddress(clientAddr).c_str());
+        ::close(clientSocket);
+        stats_.connectionsRefused++;
+        return nullptr;
+    }
+    
     stats_.connectionsAccepted++;
     activeConnections_++;
     
@@ -576,6 +788,32 @@ int setSocketReuseAddress(int socket, bool reuse) {
     return TINYMCP_SUCCESS;
 }
 
+int sendAllVectored(int socket, struct iovec* iov, int iovCount) {
+    while (iovCount > 0) {
+        ssize_t sent = writev(socket, iov, iovCount);
+        if (sent < 0) {
+            return -1;
+        } else if (sent == 0) {
+            errno = ENOTCONN;
+            return -1;
+        }
+        
+        // Skip fully written vectors, then trim the partially written one
+        while (iovCount > 0 && static_cast<size_t>(sent) >= iov->iov_len) {
+            sent -= iov->iov_len;
+            ++iov;
+            --iovCount;
+        }
+        
+        if (iovCount > 0) {
+            iov->iov_base = static_cast<char*>(iov->iov_base) + sent;
+            iov->iov_len -= sent;
+        }
+    }
+    
+    return 0;
+}
+
 std::string formatAddress(const struct sockaddr_in& addr) {
     char buffer[INET_ADDRSTRLEN];
     inet_ntop(AF_INET, &addr.sin_addr, buffer, sizeof(buffer));
@@ -634,6 +872,11 @@ int MessageFraming::encodeMessage(const std::string& message, std::string& frame
     return TINYMCP_SUCCESS;
 }
 
+void MessageFraming::encodeHeader(size_t length, uint8_t header[4]) {
+    uint32_t networkLength = htonl(static_cast<uint32_t>(length));
+    memcpy(header, &networkLength, HEADER_SIZE);
+}
+
 int MessageFraming::decodeMessage(const std::string& frame, std::string& message) {
     if (frame.size() < HEADER_SIZE) {
         return TINYMCP_ERROR_INVALID_MESSAGE;
@@ -656,10 +899,12 @@ int MessageFraming::decodeMessage(const std::string& frame, std::string& message
 }
 
 int MessageFraming::sendFramedMessage(int socket, const std::string& message, uint32_t timeoutMs) {
-    std::string frame;
-    int result = encodeMessage(message, frame);
-    if (result != TINYMCP_SUCCESS) {
-        return result;
+    return sendFramedMessage(socket, message.data(), message.size(), timeoutMs);
+}
+
+int MessageFraming::sendFramedMessage(int socket, const char* data, size_t length, uint32_t timeoutMs) {
+    if (length > MAX_MESSAGE_SIZE) {
+        return TINYMCP_ERROR_MESSAGE_TOO_LARGE;
     }
     
     // Set timeout
@@ -668,14 +913,18 @@ int MessageFraming::sendFramedMessage(int socket, const std::string& message, ui
     timeout.tv_usec = (timeoutMs % 1000) * 1000;
     setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
     
-    // Send frame
-    size_t sent = 0;
-    while (sent < frame.size()) {
-        ssize_t result = send(socket, frame.data() + sent, frame.size() - sent, MSG_NOSIGNAL);
-        if (result < 0) {
-            return TINYMCP_ERROR_TRANSPORT_FAILED;
-        }
-        sent += result;
+    // Gather-send header and payload without building a combined frame
+    uint8_t header[HEADER_SIZE];
+    encodeHeader(length, header);
+    
+    struct iovec iov[2];
+    iov[0].iov_base = header;
+    iov[0].iov_len = HEADER_SIZE;
+    iov[1].iov_base = const_cast<char*>(data);
+    iov[1].iov_len = length;
+    
+    if (SocketUtils::sendAllVectored(socket, iov, 2) < 0) {
+        return TINYMCP_ERROR_TRANSPORT_FAILED;
     }
     
     return TINYMCP_SUCCESS;
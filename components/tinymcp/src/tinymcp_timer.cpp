@@ -0,0 +1,277 @@
+// Shared timer wheel for TinyMCP deadlines
+// Session idle timeouts, keep-alives and task timeouts run off one FreeRTOS software timer
+
+#include "tinymcp_timer.h"
+#include "tinymcp_constants.h"
+#include "tinymcp_log.h"
+
+#include "freertos/task.h"
+#include <algorithm>
+
+static const char* TAG = "tinymcp_timer";
+
+namespace tinymcp {
+
+static_assert(TimerWheel::SLOT_COUNT == 64, "occupied_ holds one bit per slot");
+
+// Timer implementation
+
+TimerWheel::Timer::Timer(Callback callback, void* arg) :
+    callback_(callback), arg_(arg), prev_(nullptr), next_(nullptr),
+    rounds_(0), slot_(0), armed_(false) {
+}
+
+TimerWheel::Timer::~Timer() {
+    if (armed_) {
+        TimerWheel::getInstance().disarm(*this);
+    }
+}
+
+// TimerWheel implementation
+
+TimerWheel TimerWheel::instance_;
+
+TimerWheel::TimerWheel() :
+    expired_(nullptr), occupied_(0), position_(0), wakeUnit_(0),
+    scheduled_(false), servicing_(false), origin_(0), resolutionTicks_(1),
+    mutex_(nullptr), timer_(nullptr) {
+
+    for (auto& slot : slots_) {
+        slot = nullptr;
+    }
+}
+
+TimerWheel& TimerWheel::getInstance() {
+    return instance_;
+}
+
+int TimerWheel::initialize() {
+    if (timer_) {
+        return TINYMCP_SUCCESS;
+    }
+
+    // Recursive so callbacks can arm and disarm from inside advance()
+    mutex_ = xSemaphoreCreateRecursiveMutex();
+    if (!mutex_) {
+        return TINYMCP_ERROR_OUT_OF_MEMORY;
+    }
+
+    resolutionTicks_ = std::max(pdMS_TO_TICKS(RESOLUTION_MS), static_cast<TickType_t>(1));
+    origin_ = xTaskGetTickCount();
+    position_ = 0;
+
+    // The period is replaced on every reschedule
+    TimerHandle_t timer = xTimerCreate("mcp_wheel", resolutionTicks_, pdFALSE, this, serviceCallback);
+    if (!timer) {
+        vSemaphoreDelete(mutex_);
+        mutex_ = nullptr;
+        return TINYMCP_ERROR_OUT_OF_MEMORY;
+    }
+
+    timer_ = timer;
+    TINYMCP_LOGI(TAG, "Timer wheel started: %u slots of %u ms",
+                 static_cast<unsigned>(SLOT_COUNT), static_cast<unsigned>(RESOLUTION_MS));
+    return TINYMCP_SUCCESS;
+}
+
+void TimerWheel::arm(Timer& timer, uint32_t delayMs) {
+    if (!timer_) {
+        TINYMCP_LOGE(TAG, "Timer armed before the wheel was initialized");
+        return;
+    }
+
+    xSemaphoreTakeRecursive(mutex_, portMAX_DELAY);
+
+    if (timer.armed_) {
+        unlink(timer);
+    }
+
+    // An empty wheel is not serviced, so position_ may be far behind after
+    // an idle spell; catch it up (every slot in between is empty) rather
+    // than leave advance() and getNextExpiry() to walk the gap
+    if (!occupied_) {
+        position_ = currentUnit();
+    }
+
+    // Counted from now rather than position_, so a late service task never
+    // shortens a deadline
+    uint32_t units = std::max((delayMs + RESOLUTION_MS - 1) / RESOLUTION_MS, static_cast<uint32_t>(1));
+    uint32_t unit = currentUnit() + units;
+    link(timer, unit);
+    timer.armed_ = true;
+    stats_.armed++;
+    stats_.pending++;
+
+    // Inside advance() the wheel is rescheduled once all callbacks have run
+    if (!servicing_ && (!scheduled_ || static_cast<int32_t>(unit - wakeUnit_) < 0)) {
+        reschedule(0);
+    }
+
+    xSemaphoreGiveRecursive(mutex_);
+}
+
+void TimerWheel::disarm(Timer& timer) {
+    if (!timer_) {
+        return;
+    }
+
+    // Callbacks run with the lock held, so once it is ours none is running.
+    // A stale wakeup for an emptied slot is harmless and left in place.
+    xSemaphoreTakeRecursive(mutex_, portMAX_DELAY);
+    if (timer.armed_) {
+        unlink(timer);
+        timer.armed_ = false;
+        stats_.pending--;
+    }
+    xSemaphoreGiveRecursive(mutex_);
+}
+
+TickType_t TimerWheel::getNextExpiry() {
+    if (!timer_) {
+        return portMAX_DELAY;
+    }
+
+    xSemaphoreTakeRecursive(mutex_, portMAX_DELAY);
+
+    TickType_t ticks = portMAX_DELAY;
+    if (occupied_) {
+        TickType_t due = origin_ + (position_ + nextOccupiedDistance()) * resolutionTicks_;
+        TickType_t remaining = due - xTaskGetTickCount();
+        ticks = static_cast<int32_t>(remaining) > 0 ? remaining : 1;
+    }
+
+    xSemaphoreGiveRecursive(mutex_);
+    return ticks;
+}
+
+TimerWheel::Stats TimerWheel::getStats() {
+    if (!timer_) {
+        return stats_;
+    }
+
+    xSemaphoreTakeRecursive(mutex_, portMAX_DELAY);
+    Stats stats = stats_;
+    xSemaphoreGiveRecursive(mutex_);
+    return stats;
+}
+
+void TimerWheel::serviceCallback(TimerHandle_t handle) {
+    TimerWheel* wheel = static_cast<TimerWheel*>(pvTimerGetTimerID(handle));
+
+    xSemaphoreTakeRecursive(wheel->mutex_, portMAX_DELAY);
+    wheel->stats_.wakeups++;
+    wheel->scheduled_ = false;
+    wheel->advance();
+    // Timer callbacks must not block the service task
+    wheel->reschedule(0);
+    xSemaphoreGiveRecursive(wheel->mutex_);
+}
+
+uint32_t TimerWheel::currentUnit() const {
+    return (xTaskGetTickCount() - origin_) / resolutionTicks_;
+}
+
+uint32_t TimerWheel::nextOccupiedDistance() const {
+    // Rotate so the slot after position_ is bit 0
+    size_t start = (position_ + 1) % SLOT_COUNT;
+    uint64_t rotated = start ? (occupied_ >> start) | (occupied_ << (SLOT_COUNT - start)) : occupied_;
+    return static_cast<uint32_t>(__builtin_ctzll(rotated)) + 1;
+}
+
+void TimerWheel::link(Timer& timer, uint32_t unit) {
+    size_t slot = unit % SLOT_COUNT;
+
+    timer.slot_ = static_cast<uint8_t>(slot);
+    timer.rounds_ = (unit - position_ - 1) / SLOT_COUNT;
+    timer.prev_ = nullptr;
+    timer.next_ = slots_[slot];
+    if (timer.next_) {
+        timer.next_->prev_ = &timer;
+    }
+    slots_[slot] = &timer;
+    occupied_ |= 1ull << slot;
+}
+
+void TimerWheel::unlink(Timer& timer) {
+    Timer*& head = timer.slot_ == EXPIRED_SLOT ? expired_ : slots_[timer.slot_];
+
+    if (timer.prev_) {
+        timer.prev_->next_ = timer.next_;
+    } else {
+        head = timer.next_;
+    }
+    if (timer.next_) {
+        timer.next_->prev_ = timer.prev_;
+    }
+    timer.prev_ = nullptr;
+    timer.next_ = nullptr;
+
+    if (!head && timer.slot_ != EXPIRED_SLOT) {
+        occupied_ &= ~(1ull << timer.slot_);
+    }
+}
+
+void TimerWheel::advance() {
+    servicing_ = true;
+
+    uint32_t now = currentUnit();
+    while (static_cast<int32_t>(now - position_) > 0) {
+        position_++;
+        size_t slot = position_ % SLOT_COUNT;
+
+        // Due timers move to expired_ first: a callback may disarm or
+        // re-arm any timer, including ones later in this slot
+        Timer* timer = slots_[slot];
+        while (timer) {
+            Timer* next = timer->next_;
+            if (timer->rounds_ > 0) {
+                timer->rounds_--;
+            } else {
+                unlink(*timer);
+                timer->slot_ = EXPIRED_SLOT;
+                timer->next_ = expired_;
+                if (expired_) {
+                    expired_->prev_ = timer;
+                }
+                expired_ = timer;
+            }
+            timer = next;
+        }
+
+        while (expired_) {
+            Timer* due = expired_;
+            unlink(*due);
+            due->armed_ = false;
+            stats_.pending--;
+            stats_.fired++;
+            due->callback_(due->arg_);
+        }
+    }
+
+    servicing_ = false;
+}
+
+void TimerWheel::reschedule(TickType_t blockTicks) {
+    if (!occupied_) {
+        return;
+    }
+
+    uint32_t unit = position_ + nextOccupiedDistance();
+    if (scheduled_ && unit == wakeUnit_) {
+        return;
+    }
+
+    TickType_t due = origin_ + unit * resolutionTicks_;
+    TickType_t remaining = due - xTaskGetTickCount();
+    TickType_t period = static_cast<int32_t>(remaining) > 0 ? remaining : 1;
+
+    // Also starts the timer when it is dormant. On failure the next arm()
+    // tries again.
+    scheduled_ = xTimerChangePeriod(timer_, period, blockTicks) == pdPASS;
+    wakeUnit_ = unit;
+    if (!scheduled_) {
+        TINYMCP_LOGW(TAG, "Timer command queue full, wheel wakeup deferred");
+    }
+}
+
+} // namespace tinymcp
@@ -0,0 +1,334 @@
+// Tool argument validation for TinyMCP
+// Compiles object schemas into field tables and checks arguments against them in one pass
+
+#include "tinymcp_tool_args.h"
+#include "tinymcp_constants.h"
+
+#include "esp_log.h"
+
+#include <climits>
+#include <cstring>
+
+static const char* TAG = "tinymcp_args";
+
+namespace tinymcp {
+
+static const char* typeName(ArgValidator::Type type) {
+    switch (type) {
+        case ArgValidator::Type::STRING: return "a string";
+        case ArgValidator::Type::INTEGER: return "an integer";
+        case ArgValidator::Type::NUMBER: return "a number";
+        case ArgValidator::Type::BOOLEAN: return "a boolean";
+        case ArgValidator::Type::ARRAY: return "an array";
+        case ArgValidator::Type::OBJECT: return "an object";
+        default: return "a value";
+    }
+}
+
+static bool parseType(const cJSON* type, ArgValidator::Type& out) {
+    const char* name = cJSON_GetStringValue(const_cast<cJSON*>(type));
+    if (!name) {
+        out = ArgValidator::Type::ANY;
+        return !type;
+    }
+    static const struct {
+        const char* name;
+        ArgValidator::Type type;
+    } TYPES[] = {
+        {"string", ArgValidator::Type::STRING},
+        {"integer", ArgValidator::Type::INTEGER},
+        {"number", ArgValidator::Type::NUMBER},
+        {"boolean", ArgValidator::Type::BOOLEAN},
+        {"array", ArgValidator::Type::ARRAY},
+        {"object", ArgValidator::Type::OBJECT},
+    };
+    for (const auto& entry : TYPES) {
+        if (strcmp(name, entry.name) == 0) {
+            out = entry.type;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Schema bounds clamped to the int32 slots
+static int32_t getBound(const cJSON* schema, const char* key, int32_t defaultValue) {
+    const cJSON* bound = cJSON_GetObjectItem(schema, key);
+    if (!cJSON_IsNumber(bound)) {
+        return defaultValue;
+    }
+    if (bound->valuedouble <= INT32_MIN) {
+        return INT32_MIN;
+    }
+    if (bound->valuedouble >= INT32_MAX) {
+        return INT32_MAX;
+    }
+    return static_cast<int32_t>(bound->valuedouble);
+}
+
+int ToolArgs::getElement(int index, const cJSON* element, ToolArgs& out) const {
+    if (!validator_ || index < 0 || static_cast<size_t>(index) >= validator_->fields_.size()) {
+        return TINYMCP_ERROR_INVALID_PARAMS;
+    }
+    int8_t items = validator_->fields_[index].items;
+    if (items < 0 || !cJSON_IsObject(element)) {
+        return TINYMCP_ERROR_INVALID_PARAMS;
+    }
+    return validator_->children_[items].validate(element, out);
+}
+
+int ArgValidator::compile(const cJSON* schema) {
+    fields_.clear();
+    strings_.clear();
+    children_.clear();
+
+    Type type;
+    if (!cJSON_IsObject(schema) || !parseType(cJSON_GetObjectItem(schema, "type"), type) ||
+        (type != Type::OBJECT && type != Type::ANY)) {
+        return TINYMCP_ERROR_INVALID_PARAMS;
+    }
+
+    const cJSON* property;
+    cJSON_ArrayForEach(property, cJSON_GetObjectItem(schema, "properties")) {
+        if (fields_.size() == ToolArgs::MAX_FIELDS) {
+            ESP_LOGE(TAG, "Schema has more than %u properties", (unsigned)ToolArgs::MAX_FIELDS);
+            return TINYMCP_ERROR_INVALID_PARAMS;
+        }
+        int result = compileField(property->string, property);
+        if (result != TINYMCP_SUCCESS) {
+            ESP_LOGE(TAG, "Unsupported schema for property %s", property->string ? property->string : "?");
+            return result;
+        }
+    }
+
+    // Standard form: a list of required names next to the properties
+    const cJSON* name;
+    cJSON_ArrayForEach(name, cJSON_GetObjectItem(schema, "required")) {
+        int index = cJSON_IsString(name) ? findField(name->valuestring) : -1;
+        if (index >= 0) {
+            fields_[index].required = true;
+        }
+    }
+
+    fields_.shrink_to_fit();
+    strings_.shrink_to_fit();
+    children_.shrink_to_fit();
+    return TINYMCP_SUCCESS;
+}
+
+int ArgValidator::compileField(const char* name, const cJSON* property) {
+    Field field = {};
+    field.items = -1;
+    field.minimum = INT32_MIN;
+    field.maximum = INT32_MAX;
+
+    if (!name || !cJSON_IsObject(property) || !parseType(cJSON_GetObjectItem(property, "type"), field.type)) {
+        return TINYMCP_ERROR_INVALID_PARAMS;
+    }
+    field.name = addString(name);
+    field.required = cJSON_IsTrue(cJSON_GetObjectItem(property, "required"));
+
+    switch (field.type) {
+        case Type::STRING: {
+            field.enumValues = static_cast<uint16_t>(strings_.size());
+            const cJSON* value;
+            cJSON_ArrayForEach(value, cJSON_GetObjectItem(property, "enum")) {
+                if (!cJSON_IsString(value) || field.enumCount == UINT8_MAX) {
+                    return TINYMCP_ERROR_INVALID_PARAMS;
+                }
+                addString(value->valuestring);
+                field.enumCount++;
+            }
+            break;
+        }
+
+        case Type::INTEGER:
+            field.minimum = getBound(property, "minimum", INT32_MIN);
+            field.maximum = getBound(property, "maximum", INT32_MAX);
+            break;
+
+        case Type::ARRAY: {
+            field.minimum = getBound(property, "minItems", 0);
+            field.maximum = getBound(property, "maxItems", INT32_MAX);
+            const cJSON* items = cJSON_GetObjectItem(property, "items");
+            if (cJSON_IsObject(cJSON_GetObjectItem(items, "properties"))) {
+                ArgValidator child;
+                if (child.compile(items) != TINYMCP_SUCCESS || children_.size() >= INT8_MAX) {
+                    return TINYMCP_ERROR_INVALID_PARAMS;
+                }
+                field.items = static_cast<int8_t>(children_.size());
+                children_.push_back(std::move(child));
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    if (strings_.size() > UINT16_MAX) {
+        return TINYMCP_ERROR_INVALID_PARAMS;
+    }
+    fields_.push_back(field);
+    return TINYMCP_SUCCESS;
+}
+
+uint16_t ArgValidator::addString(const char* text) {
+    uint16_t offset = static_cast<uint16_t>(strings_.size());
+    strings_.append(text);
+    strings_.push_back('\0');
+    return offset;
+}
+
+int ArgValidator::findField(const char* name) const {
+    for (size_t i = 0; i < fields_.size(); i++) {
+        if (strcmp(&strings_[fields_[i].name], name) == 0) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+int ArgValidator::validate(const cJSON* args, ToolArgs& out, std::string* error) const {
+    out = ToolArgs();
+    out.validator_ = this;
+
+    if (args && !cJSON_IsObject(args)) {
+        if (error) {
+            *error = "arguments must be an object";
+        }
+        return TINYMCP_ERROR_INVALID_PARAMS;
+    }
+
+    // Properties the schema does not know are ignored
+    const cJSON* item;
+    cJSON_ArrayForEach(item, args) {
+        int index = item->string ? findField(item->string) : -1;
+        if (index < 0) {
+            continue;
+        }
+        int32_t value = 0;
+        int result = checkValue(fields_[index], item, value, error);
+        if (result != TINYMCP_SUCCESS) {
+            if (error) {
+                error->insert(0, std::string(item->string) + (error->front() == '[' ? "" : ": "));
+            }
+            return result;
+        }
+        out.slots_[index].item = item;
+        out.slots_[index].value = value;
+    }
+
+    for (size_t i = 0; i < fields_.size(); i++) {
+        if (fields_[i].required && !out.slots_[i].item) {
+            if (error) {
+                *error = std::string(&strings_[fields_[i].name]) + ": required";
+            }
+            return TINYMCP_ERROR_INVALID_PARAMS;
+        }
+    }
+    return TINYMCP_SUCCESS;
+}
+
+int ArgValidator::checkValue(const Field& field, const cJSON* item, int32_t& value, std::string* error) const {
+    bool typeOk = true;
+    switch (field.type) {
+        case Type::STRING: typeOk = cJSON_IsString(item); break;
+        case Type::INTEGER: typeOk = cJSON_IsNumber(item); break;
+        case Type::NUMBER: typeOk = cJSON_IsNumber(item); break;
+        case Type::BOOLEAN: typeOk = cJSON_IsBool(item); break;
+        case Type::ARRAY: typeOk = cJSON_IsArray(item); break;
+        case Type::OBJECT: typeOk = cJSON_IsObject(item); break;
+        default: break;
+    }
+    if (!typeOk) {
+        if (error) {
+            *error = std::string("must be ") + typeName(field.type);
+        }
+        return TINYMCP_ERROR_INVALID_PARAMS;
+    }
+
+    switch (field.type) {
+        case Type::STRING:
+            if (field.enumCount > 0) {
+                const char* text = &strings_[field.enumValues];
+                for (value = 0; value < field.enumCount; value++) {
+                    if (strcmp(text, item->valuestring) == 0) {
+                        return TINYMCP_SUCCESS;
+                    }
+                    text += strlen(text) + 1;
+                }
+                if (error) {
+                    *error = "must be one of";
+                    text = &strings_[field.enumValues];
+                    for (int i = 0; i < field.enumCount; i++) {
+                        *error += (i == 0 ? " " : ", ") + std::string(text);
+                        text += strlen(text) + 1;
+                    }
+                }
+                return TINYMCP_ERROR_INVALID_PARAMS;
+            }
+            break;
+
+        case Type::BOOLEAN:
+            value = cJSON_IsTrue(item) ? 1 : 0;
+            break;
+
+        case Type::INTEGER: {
+            double number = item->valuedouble;
+            if (number < field.minimum || number > field.maximum ||
+                number != static_cast<double>(static_cast<int32_t>(number))) {
+                if (error) {
+                    *error = "must be an integer from " + std::to_string(field.minimum) +
+                             " to " + std::to_string(field.maximum);
+                }
+                return TINYMCP_ERROR_INVALID_PARAMS;
+            }
+            value = static_cast<int32_t>(number);
+            break;
+        }
+
+        case Type::ARRAY: {
+            int count = cJSON_GetArraySize(item);
+            if (count < field.minimum || count > field.maximum) {
+                if (error) {
+                    *error = "must have " + std::to_string(field.minimum) + " to " +
+                             std::to_string(field.maximum) + " items";
+                }
+                return TINYMCP_ERROR_INVALID_PARAMS;
+            }
+            value = count;
+
+            // Elements are checked up front so handlers never act on half a request
+            if (field.items >= 0) {
+                ToolArgs element;
+                int position = 0;
+                const cJSON* entry;
+                cJSON_ArrayForEach(entry, item) {
+                    int result = TINYMCP_ERROR_INVALID_PARAMS;
+                    if (!cJSON_IsObject(entry)) {
+                        if (error) {
+                            *error = "[" + std::to_string(position) + "]: must be an object";
+                        }
+                    } else {
+                        result = children_[field.items].validate(entry, element, error);
+                        if (result != TINYMCP_SUCCESS && error) {
+                            error->insert(0, "[" + std::to_string(position) + "].");
+                        }
+                    }
+                    if (result != TINYMCP_SUCCESS) {
+                        return result;
+                    }
+                    position++;
+                }
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+    return TINYMCP_SUCCESS;
+}
+
+} // namespace tinymcp
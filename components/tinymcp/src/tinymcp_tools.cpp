@@ -3,24 +3,65 @@
 
 #include "tinymcp_tools.h"
 #include "tinymcp_constants.h"
+#include "tinymcp_log.h"
+#include "tinymcp_timer.h"
 
 #include "esp_system.h"
 #include "esp_wifi.h"
 #include "esp_log.h"
 #include "esp_spiffs.h"
+#include "sdkconfig.h"
 #include "driver/gpio.h"
+#include "esp_timer.h"
+#if defined(CONFIG_IDF_TARGET_ESP8266)
+#include "esp8266/gpio_struct.h"
+#endif
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
+#include <cstdio>
 #include <cstring>
 #include <algorithm>
 #include <fstream>
 #include <dirent.h>
+#include <sys/stat.h>
 
 static const char* TAG = "tinymcp_tools";
 
 namespace tinymcp {
 
+// tools/list entry for one tool; references avoid deep-copying the schema
+static cJSON* createToolEntry(const ToolRegistry::ToolDefinition& tool) {
+    cJSON* entry = cJSON_CreateObject();
+    if (!entry) {
+        return nullptr;
+    }
+    cJSON_AddItemToObject(entry, MSG_KEY_NAME, cJSON_CreateStringReference(tool.name.c_str()));
+    cJSON_AddItemToObject(entry, MSG_KEY_DESCRIPTION, cJSON_CreateStringReference(tool.description.c_str()));
+    if (tool.inputSchema) {
+        cJSON_AddItemReferenceToObject(entry, MSG_KEY_INPUT_SCHEMA, tool.inputSchema);
+    }
+    return entry;
+}
+
+// Static tools print their schema text as is: a raw item that references it
+static cJSON* createToolEntry(const StaticToolDefinition& tool) {
+    cJSON* entry = cJSON_CreateObject();
+    if (!entry) {
+        return nullptr;
+    }
+    cJSON_AddItemToObject(entry, MSG_KEY_NAME, cJSON_CreateStringReference(tool.name));
+    cJSON_AddItemToObject(entry, MSG_KEY_DESCRIPTION, cJSON_CreateStringReference(tool.description));
+    if (tool.inputSchema) {
+        cJSON* schema = cJSON_CreateStringReference(tool.inputSchema);
+        if (schema) {
+            schema->type = cJSON_Raw | cJSON_IsReference;
+            cJSON_AddItemToObject(entry, MSG_KEY_INPUT_SCHEMA, schema);
+        }
+    }
+    return entry;
+}
+
 // ToolRegistry singleton
 ToolRegistry ToolRegistry::instance_;
 
@@ -28,15 +69,179 @@ ToolRegistry& ToolRegistry::getInstance() {
     return instance_;
 }
 
+void ToolRegistry::setStaticTools(const StaticToolDefinition* tools, size_t count) {
+    if (count > MAX_STATIC_TOOLS) {
+        ESP_LOGE(TAG, "Static tool table has %u entries, only %u are used",
+                 (unsigned)count, (unsigned)MAX_STATIC_TOOLS);
+        count = MAX_STATIC_TOOLS;
+    }
+    
+    if (!registryMutex_) {
+        registryMutex_ = xSemaphoreCreateMutex();
+    }
+    if (!prepareMutex_) {
+        prepareMutex_ = xSemaphoreCreateMutex();
+    }
+    if (!prepareMutex_) {
+        ESP_LOGE(TAG, "Failed to create static tool lock");
+        return;
+    }
+    
+    // Schemas and init hooks are left for first use, which keeps them off
+    // the boot path
+    ArenaScope heapScope(nullptr);
+    std::vector<ArgValidator> validators(count);
+    xSemaphoreTake(prepareMutex_, portMAX_DELAY);
+    if (xSemaphoreTake(registryMutex_, pdMS_TO_TICKS(1000)) == pdTRUE) {
+        staticTools_ = tools;
+        staticValidators_.swap(validators);
+        staticCount_ = count;
+        staticEnabled_ = 0;
+        staticPrepared_.store(0, std::memory_order_release);
+        generation_++;
+        xSemaphoreGive(registryMutex_);
+        ESP_LOGI(TAG, "Installed %u static tools", (unsigned)count);
+    }
+    xSemaphoreGive(prepareMutex_);
+}
+
+void ToolRegistry::prepareStaticTools(uint32_t mask) const {
+    if ((staticPrepared_.load(std::memory_order_acquire) & mask) == mask) {
+        return;
+    }
+    
+    // Init hooks may mount filesystems; run them outside registryMutex_ so
+    // runtime tools stay reachable meanwhile. The schema text is parsed
+    // only to compile its validator.
+    xSemaphoreTake(prepareMutex_, portMAX_DELAY);
+    uint32_t pending = mask & ~staticPrepared_.load(std::memory_order_relaxed);
+    uint32_t enabled = 0;
+    if (pending) {
+        ArenaScope heapScope(nullptr);
+        for (size_t i = 0; i < staticCount_; i++) {
+            if (!(pending & (1u << i))) {
+                continue;
+            }
+            
+            const StaticToolDefinition& tool = staticTools_[i];
+            cJSON* schema = tool.inputSchema ? cJSON_Parse(tool.inputSchema) : nullptr;
+            int compiled = !tool.inputSchema ? TINYMCP_SUCCESS :
+                           schema ? staticValidators_[i].compile(schema) : TINYMCP_ERROR_INVALID_PARAMS;
+            cJSON_Delete(schema);
+            if (compiled != TINYMCP_SUCCESS) {
+                ESP_LOGE(TAG, "Tool %s has an unsupported input schema, not listed", tool.name);
+            } else if (!tool.init || tool.init() == TINYMCP_SUCCESS) {
+                enabled |= 1u << i;
+            } else {
+                ESP_LOGW(TAG, "Tool %s unavailable, not listed", tool.name);
+            }
+        }
+        
+        // A tool that fails here was never listed (listing prepares them
+        // all first), so the generation is left alone
+        xSemaphoreTake(registryMutex_, portMAX_DELAY);
+        staticEnabled_ |= enabled;
+        staticPrepared_.fetch_or(pending, std::memory_order_release);
+        xSemaphoreGive(registryMutex_);
+        ESP_LOGD(TAG, "Prepared %u static tools", (unsigned)__builtin_popcount(pending));
+    }
+    xSemaphoreGive(prepareMutex_);
+}
+
+void ToolRegistry::prepareStaticTool(const std::string& name) const {
+    size_t index = findStaticIndex(name);
+    if (index < staticCount_) {
+        prepareStaticTools(1u << index);
+    }
+}
+
+void ToolRegistry::prepareAllStaticTools() const {
+    if (staticCount_ > 0) {
+        prepareStaticTools(staticCount_ >= 32 ? UINT32_MAX : (1u << staticCount_) - 1);
+    }
+}
+
+size_t ToolRegistry::findStaticIndex(const std::string& name) const {
+    size_t low = 0;
+    size_t high = staticCount_;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        int order = compareToolNames(staticTools_[mid].name, name.c_str());
+        if (order == 0) {
+            return mid;
+        }
+        if (order < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return staticCount_;
+}
+
+const StaticToolDefinition* ToolRegistry::findStaticTool(const std::string& name) const {
+    size_t index = findStaticIndex(name);
+    if (index < staticCount_ && (staticEnabled_ & (1u << index))) {
+        return &staticTools_[index];
+    }
+    return nullptr;
+}
+
+template <typename Visitor>
+void ToolRegistry::forEachTool(const std::string& after, Visitor visit) const {
+    auto it = after.empty() ? tools_.begin() : tools_.upper_bound(after);
+    size_t index = 0;
+    while (index < staticCount_ && !after.empty() &&
+           compareToolNames(staticTools_[index].name, after.c_str()) <= 0) {
+        index++;
+    }
+    
+    // Merge the two sorted sequences; a runtime tool hides a static one of the same name
+    while (true) {
+        while (index < staticCount_ && !(staticEnabled_ & (1u << index))) {
+            index++;
+        }
+        bool haveDynamic = it != tools_.end();
+        bool haveStatic = index < staticCount_;
+        if (!haveDynamic && !haveStatic) {
+            return;
+        }
+        
+        int order = !haveStatic ? -1 : !haveDynamic ? 1 :
+            compareToolNames(it->first.c_str(), staticTools_[index].name);
+        bool more;
+        if (order <= 0) {
+            more = visit(it->first.c_str(), it->second.get(), nullptr);
+            ++it;
+            if (order == 0) {
+                index++;
+            }
+        } else {
+            more = visit(staticTools_[index].name, nullptr, &staticTools_[index]);
+            index++;
+        }
+        if (!more) {
+            return;
+        }
+    }
+}
+
 void ToolRegistry::registerTool(std::unique_ptr<ToolDefinition> tool) {
     if (!registryMutex_) {
         registryMutex_ = xSemaphoreCreateMutex();
     }
     
+    if (tool->inputSchema && tool->validator.compile(tool->inputSchema) != TINYMCP_SUCCESS) {
+        ESP_LOGW(TAG, "Input schema of %s not checked: unsupported", tool->name.c_str());
+        tool->validator = ArgValidator();
+    }
+    
     if (xSemaphoreTake(registryMutex_, pdMS_TO_TICKS(1000)) == pdTRUE) {
-        tools_[tool->name] = std::move(tool);
+        std::string name = tool->name;
+        tools_[name] = std::move(tool);
+        generation_++;
         xSemaphoreGive(registryMutex_);
-        ESP_LOGI(TAG, "Registered tool: %s", tool->name.c_str());
+        ESP_LOGI(TAG, "Registered tool: %s", name.c_str());
     }
 }
 
@@ -45,6 +250,7 @@ void ToolRegistry::unregisterTool(const std::string& name) {
         auto it = tools_.find(name);
         if (it != tools_.end()) {
             tools_.erase(it);
+            generation_++;
             ESP_LOGI(TAG, "Unregistered tool: %s", name.c_str());
         }
         xSemaphoreGive(registryMutex_);
@@ -54,9 +260,10 @@ void ToolRegistry::unregisterTool(const std::string& name) {
 bool ToolRegistry::hasTool(const std::string& name) const {
     if (!registryMutex_) return false;
     
+    prepareStaticTool(name);
     bool found = false;
     if (xSemaphoreTake(registryMutex_, pdMS_TO_TICKS(1000)) == pdTRUE) {
-        found = tools_.find(name) != tools_.end();
+        found = tools_.find(name) != tools_.end() || findStaticTool(name);
         xSemaphoreGive(registryMutex_);
     }
     return found;
@@ -76,39 +283,237 @@ const ToolRegistry::ToolDefinition* ToolRegistry::getTool(const std::string& nam
     return tool;
 }
 
+const StaticToolDefinition* ToolRegistry::getStaticTool(const std::string& name) const {
+    if (!registryMutex_) return nullptr;
+    
+    prepareStaticTool(name);
+    const StaticToolDefinition* tool = nullptr;
+    if (xSemaphoreTake(registryMutex_, pdMS_TO_TICKS(1000)) == pdTRUE) {
+        if (tools_.find(name) == tools_.end()) {
+            tool = findStaticTool(name);
+        }
+        xSemaphoreGive(registryMutex_);
+    }
+    return tool;
+}
+
+const char* ToolRegistry::getDescription(const std::string& name) const {
+    if (const ToolDefinition* tool = getTool(name)) {
+        return tool->description.c_str();
+    }
+    const StaticToolDefinition* tool = getStaticTool(name);
+    return tool ? tool->description : nullptr;
+}
+
 std::vector<std::string> ToolRegistry::getToolNames() const {
     std::vector<std::string> names;
     if (!registryMutex_) return names;
     
+    prepareAllStaticTools();
     if (xSemaphoreTake(registryMutex_, pdMS_TO_TICKS(1000)) == pdTRUE) {
-        for (const auto& [name, tool] : tools_) {
+        forEachTool("", [&names](const char* name, const ToolDefinition*, const StaticToolDefinition*) {
             names.push_back(name);
-        }
+            return true;
+        });
         xSemaphoreGive(registryMutex_);
     }
     return names;
 }
 
+std::shared_ptr<const std::string> ToolRegistry::getToolsListPayload(uint32_t* generation) {
+    if (!registryMutex_) {
+        registryMutex_ = xSemaphoreCreateMutex();
+    }
+    
+    prepareAllStaticTools();
+    std::shared_ptr<const std::string> payload;
+    if (xSemaphoreTake(registryMutex_, pdMS_TO_TICKS(1000)) == pdTRUE) {
+        if (!cachedToolsList_ || cachedGeneration_ != generation_) {
+            cachedToolsList_ = buildToolsListPayload();
+            cachedGeneration_ = generation_;
+            ESP_LOGI(TAG, "Rebuilt tools/list cache: %u bytes",
+                     cachedToolsList_ ? (unsigned)cachedToolsList_->size() : 0);
+        }
+        payload = cachedToolsList_;
+        if (generation) {
+            *generation = cachedGeneration_;
+        }
+        xSemaphoreGive(registryMutex_);
+    }
+    return payload;
+}
+
+std::shared_ptr<const std::string> ToolRegistry::buildToolsListPayload() const {
+    // The cache outlives any request, so build it off the request arena
+    ArenaScope heapScope(nullptr);
+    
+    cJSON* tools = cJSON_CreateArray();
+    if (!tools) {
+        return nullptr;
+    }
+    
+    forEachTool("", [tools](const char*, const ToolDefinition* tool, const StaticToolDefinition* staticTool) {
+        cJSON* entry = tool ? createToolEntry(*tool) : createToolEntry(*staticTool);
+        if (entry) {
+            cJSON_AddItemToArray(tools, entry);
+        }
+        return true;
+    });
+    
+    auto payload = std::make_shared<const std::string>(JsonHelper::toString(tools));
+    cJSON_Delete(tools);
+    if (payload->empty()) {
+        return nullptr;
+    }
+    return payload;
+}
+
+int ToolRegistry::getToolsPage(const std::string& cursor, size_t budget, size_t maxResults, ToolsPage& page) {
+    if (!registryMutex_) {
+        registryMutex_ = xSemaphoreCreateMutex();
+    }
+    
+    prepareAllStaticTools();
+    if (xSemaphoreTake(registryMutex_, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        return TINYMCP_ERROR_TIMEOUT;
+    }
+    
+    // Reconnecting clients nearly always ask for the first page
+    bool firstPage = cursor.empty() && maxResults == 0;
+    int result = TINYMCP_SUCCESS;
+    if (firstPage && cachedFirstPage_.tools && cachedFirstPage_.generation == generation_ &&
+        cachedFirstPageBudget_ == budget) {
+        page = cachedFirstPage_;
+    } else {
+        result = buildToolsPage(cursor, budget, maxResults, page);
+        if (result == TINYMCP_SUCCESS && firstPage) {
+            cachedFirstPage_ = page;
+            cachedFirstPageBudget_ = budget;
+        }
+    }
+    
+    xSemaphoreGive(registryMutex_);
+    return result;
+}
+
+int ToolRegistry::buildToolsPage(const std::string& cursor, size_t budget, size_t maxResults, ToolsPage& page) const {
+    if (budget < 2) {
+        return TINYMCP_ERROR_INVALID_PARAMS;
+    }
+    
+    // Pages are printed straight into one buffer of the budget size, so the
+    // listing never holds more than a page no matter how many tools exist.
+    // The slack lets cJSON print an entry that ends right at the budget.
+    ArenaScope heapScope(nullptr);
+    std::string buffer(budget + JsonHelper::PRINT_SLACK, '\0');
+    size_t length = 0;
+    size_t count = 0;
+    buffer[length++] = '[';
+    
+    page.nextCursor.clear();
+    page.generation = generation_;
+    
+    const char* lastListed = nullptr;
+    bool outOfMemory = false;
+    forEachTool(cursor, [&](const char* name, const ToolDefinition* tool, const StaticToolDefinition* staticTool) {
+        if (maxResults > 0 && count == maxResults) {
+            page.nextCursor = lastListed;
+            return false;
+        }
+        
+        cJSON* entry = tool ? createToolEntry(*tool) : createToolEntry(*staticTool);
+        if (!entry) {
+            outOfMemory = true;
+            return false;
+        }
+        
+        // Measured first, so an entry is only printed once it is known to
+        // fit next to the separator and the closing bracket
+        size_t offset = length + (count > 0 ? 1 : 0);
+        size_t size = JsonHelper::getSerializedSize(entry);
+        bool printed = offset + size + 1 <= budget &&
+            cJSON_PrintPreallocated(entry, &buffer[offset], (int)(size + JsonHelper::PRINT_SLACK), false);
+        cJSON_Delete(entry);
+        
+        if (!printed) {
+            if (count == 0) {
+                // Would never fit on any page; skip it rather than stall the listing
+                ESP_LOGW(TAG, "Tool %s exceeds the page budget of %u bytes, not listed",
+                         name, (unsigned)budget);
+                lastListed = name;
+                return true;
+            }
+            page.nextCursor = lastListed;
+            return false;
+        }
+        
+        if (count > 0) {
+            buffer[length] = ',';
+        }
+        length = offset + strlen(&buffer[offset]);
+        count++;
+        lastListed = name;
+        return true;
+    });
+    if (outOfMemory) {
+        return TINYMCP_ERROR_OUT_OF_MEMORY;
+    }
+    
+    buffer[length++] = ']';
+    buffer.resize(length);
+    page.tools = std::make_shared<const std::string>(std::move(buffer));
+    return TINYMCP_SUCCESS;
+}
+
 std::unique_ptr<AsyncTask> ToolRegistry::createToolTask(const MessageId& requestId, 
                                                        const std::string& toolName,
                                                        const cJSON* arguments) {
     const ToolDefinition* tool = getTool(toolName);
-    if (!tool) {
+    const StaticToolDefinition* staticTool = tool ? nullptr : getStaticTool(toolName);
+    if (!tool && !staticTool) {
         return std::make_unique<ErrorTask>(requestId, TINYMCP_ERROR_TOOL_NOT_FOUND, 
                                           "Tool not found: " + toolName);
     }
     
-    if (tool->requiresAsync) {
-        // Special handling for async tools
-        if (toolName == "network_scan") {
-            return NetworkScannerTask::create(requestId, arguments);
-        } else if (toolName == "long_running_task") {
-            return LongRunningTask::create(requestId, arguments);
+    ToolTaskFactory createTask = tool ? (tool->requiresAsync ? tool->createTask : nullptr) :
+                                        staticTool->createTask;
+    uint32_t estimatedDurationMs = tool ? tool->estimatedDurationMs : staticTool->estimatedDurationMs;
+    // Static tools are never removed, so their validators stay put without the lock
+    const ArgValidator& validator = tool ? tool->validator : *getStaticValidator(staticTool);
+    
+    std::unique_ptr<AsyncTask> task;
+    if (createTask || tool) {
+        // Async tasks take what they need from the arguments up front, and
+        // runtime handlers still read the cJSON tree, so check it in place
+        ToolArgs args;
+        std::string error;
+        if (validator.validate(arguments, args, &error) != TINYMCP_SUCCESS) {
+            return std::make_unique<ErrorTask>(requestId, TINYMCP_ERROR_INVALID_PARAMS,
+                                               "Invalid arguments for tool " + toolName + ": " + error);
+        }
+        if (createTask) {
+            task = createTask(requestId, args);
+            // Long async work yields the general workers to shorter jobs
+            task->setScheduling(estimatedDurationMs >= LONG_TASK_DURATION_MS ?
+                                TaskPriority::LOW : TaskPriority::NORMAL, false);
+            return task;
+        }
+        task = std::make_unique<CustomToolTask>(requestId, toolName, arguments, tool->handler);
+    } else {
+        auto staticTask = std::make_unique<StaticToolTask>(requestId, toolName, arguments,
+                                                           staticTool->handler, validator);
+        if (!staticTask->isValid()) {
+            return std::make_unique<ErrorTask>(requestId, TINYMCP_ERROR_INVALID_PARAMS,
+                                               "Invalid arguments for tool " + toolName + ": " +
+                                               staticTask->getValidationError());
         }
+        task = std::move(staticTask);
     }
     
-    // Create a synchronous tool task
-    return std::make_unique<CustomToolTask>(requestId, toolName, arguments, tool->handler);
+    // Synchronous tool tasks; short ones bypass the general queue
+    task->setScheduling(TaskPriority::HIGH,
+                        estimatedDurationMs <= TaskExecutor::FAST_LANE_MAX_DURATION_MS);
+    return task;
 }
 
 // CustomToolTask implementation
@@ -125,20 +530,32 @@ int CustomToolTask::executeToolLogic(const cJSON* args, cJSON** result) {
     return toolHandler_(args, result);
 }
 
-// SystemInfoTool implementation
-void SystemInfoTool::registerTool() {
-    auto tool = std::make_unique<ToolRegistry::ToolDefinition>(
-        "system_info",
-        "Get ESP8266/ESP32 system information including memory, WiFi status, and running tasks",
-        [](const cJSON* args, cJSON** result) { return SystemInfoTool::execute(args, result); }
-    );
+// StaticToolTask implementation
+StaticToolTask::StaticToolTask(const MessageId& requestId, const std::string& toolName, const cJSON* args,
+                               ToolHandlerFn handler, const ArgValidator& validator) :
+    CallToolTask(requestId, toolName, args), handler_(handler) {
     
-    tool->inputSchema = createInputSchema();
-    ToolRegistry::getInstance().registerTool(std::move(tool));
+    argsValid_ = validator.validate(arguments_, args_, &validationError_) == TINYMCP_SUCCESS;
+}
+
+bool StaticToolTask::isValid() const {
+    return argsValid_ && handler_ && CallToolTask::isValid();
+}
+
+int StaticToolTask::executeToolLogic(const cJSON* args, cJSON** result) {
+    return handler_(args_, result);
 }
 
-int SystemInfoTool::execute(const cJSON* args, cJSON** result) {
-    ESP_LOGI(TAG, "Executing system_info tool");
+// SystemInfoTool implementation
+static constexpr char SYSTEM_INFO_SCHEMA[] =
+    R"json({"type":"object","properties":{)json"
+    R"json("include_tasks":{"type":"boolean","description":"Include FreeRTOS task information"},)json"
+    R"json("include_wifi":{"type":"boolean","description":"Include WiFi status information"}}})json";
+static constexpr int SYSTEM_INFO_INCLUDE_TASKS = SchemaText::propertyIndex(SYSTEM_INFO_SCHEMA, "include_tasks");
+static constexpr int SYSTEM_INFO_INCLUDE_WIFI = SchemaText::propertyIndex(SYSTEM_INFO_SCHEMA, "include_wifi");
+
+int SystemInfoTool::execute(const ToolArgs& args, cJSON** result) {
+    TINYMCP_LOGI(TAG, "Executing system_info tool");
     
     cJSON* response = cJSON_CreateObject();
     if (!response) {
@@ -148,20 +565,17 @@ int SystemInfoTool::execute(const cJSON* args, cJSON** result) {
     // Add system information sections
     cJSON_AddItemToObject(response, "system", getSystemInfo());
     cJSON_AddItemToObject(response, "memory", getMemoryInfo());
-    cJSON_AddItemToObject(response, "wifi", getWiFiInfo());
-    cJSON_AddItemToObject(response, "tasks", getTaskInfo());
+    if (args.getBool(SYSTEM_INFO_INCLUDE_WIFI, true)) {
+        cJSON_AddItemToObject(response, "wifi", getWiFiInfo());
+    }
+    if (args.getBool(SYSTEM_INFO_INCLUDE_TASKS, true)) {
+        cJSON_AddItemToObject(response, "tasks", getTaskInfo());
+    }
     
     *result = response;
     return TINYMCP_SUCCESS;
 }
 
-cJSON* SystemInfoTool::createInputSchema() {
-    return ToolHelpers::createObjectSchema({
-        {"include_tasks", ToolHelpers::createBooleanProperty("Include FreeRTOS task information", false)},
-        {"include_wifi", ToolHelpers::createBooleanProperty("Include WiFi status information", false)}
-    });
-}
-
 cJSON* SystemInfoTool::getSystemInfo() {
     cJSON* system = cJSON_CreateObject();
     
@@ -183,345 +597,1159 @@ cJSON* SystemInfoTool::getSystemInfo() {
     // Uptime
     cJSON_AddNumberToObject(system, "uptime_ms", xTaskGetTickCount() * portTICK_PERIOD_MS);
     
-    return system;
+    return system;
+}
+
+cJSON* SystemInfoTool::getMemoryInfo() {
+    cJSON* memory = cJSON_CreateObject();
+    
+    // Heap information
+    cJSON_AddNumberToObject(memory, "free_heap", esp_get_free_heap_size());
+    cJSON_AddNumberToObject(memory, "minimum_free_heap", esp_get_minimum_free_heap_size());
+    cJSON_AddNumberToObject(memory, "largest_free_block", esp_get_free_heap_size());
+    
+    // Internal memory (ESP8266 doesn't have heap_caps, use free heap)
+    cJSON_AddNumberToObject(memory, "free_internal", esp_get_free_heap_size());
+    
+    return memory;
+}
+
+cJSON* SystemInfoTool::getWiFiInfo() {
+    cJSON* wifi = cJSON_CreateObject();
+    
+    wifi_mode_t mode;
+    if (esp_wifi_get_mode(&mode) == ESP_OK) {
+        const char* modeStr = "UNKNOWN";
+        switch (mode) {
+            case WIFI_MODE_STA: modeStr = "STA"; break;
+            case WIFI_MODE_AP: modeStr = "AP"; break;
+            case WIFI_MODE_APSTA: modeStr = "AP+STA"; break;
+            default: break;
+        }
+        cJSON_AddStringToObject(wifi, "mode", modeStr);
+        
+        if (mode == WIFI_MODE_STA || mode == WIFI_MODE_APSTA) {
+            wifi_ap_record_t ap_info;
+            if (esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK) {
+                cJSON_AddStringToObject(wifi, "ssid", (char*)ap_info.ssid);
+                cJSON_AddNumberToObject(wifi, "rssi", ap_info.rssi);
+                cJSON_AddNumberToObject(wifi, "channel", ap_info.primary);
+            }
+        }
+    }
+    
+    return wifi;
+}
+
+cJSON* SystemInfoTool::getTaskInfo() {
+    cJSON* tasks = cJSON_CreateArray();
+    
+    // Get task count
+    UBaseType_t taskCount = uxTaskGetNumberOfTasks();
+    cJSON_AddNumberToObject(tasks, "task_count", taskCount);
+    
+    // Note: Getting detailed task information requires more complex FreeRTOS APIs
+    // that may not be available in all configurations
+    
+    return tasks;
+}
+
+#if TINYMCP_METRICS
+// ServerStatsTool implementation
+static constexpr char SERVER_STATS_SCHEMA[] =
+    R"json({"type":"object","properties":{)json"
+    R"json("reset":{"type":"boolean","description":"Clear the histograms after reading them"}}})json";
+static constexpr int SERVER_STATS_RESET = SchemaText::propertyIndex(SERVER_STATS_SCHEMA, "reset");
+
+int ServerStatsTool::execute(const ToolArgs& args, cJSON** result) {
+    bool reset = args.getBool(SERVER_STATS_RESET, false);
+    
+    cJSON* response = Metrics::getInstance().toJson();
+    if (!response) {
+        return TINYMCP_ERROR_OUT_OF_MEMORY;
+    }
+    
+    cJSON_AddNumberToObject(response, "uptime_ms", xTaskGetTickCount() * portTICK_PERIOD_MS);
+    cJSON_AddNumberToObject(response, "first_request_ms", getFirstRequestMs());
+    cJSON_AddNumberToObject(response, "sessions", SessionManager::getInstance().getSessionCount());
+    cJSON_AddItemToObject(response, "heap", getHeapInfo());
+    cJSON_AddItemToObject(response, "executor", getExecutorStats());
+    cJSON_AddItemToObject(response, "wifi_scan", getScannerStats());
+    cJSON_AddItemToObject(response, "log", getLogStats());
+    cJSON_AddItemToObject(response, "timers", getTimerStats());
+    
+    // Reset after the snapshot so no samples are lost between scrapes
+    if (reset) {
+        Metrics::getInstance().reset();
+    }
+    
+    *result = response;
+    return TINYMCP_SUCCESS;
+}
+
+cJSON* ServerStatsTool::getHeapInfo() {
+    cJSON* heap = cJSON_CreateObject();
+    
+    cJSON_AddNumberToObject(heap, "free", esp_get_free_heap_size());
+    cJSON_AddNumberToObject(heap, "minimum_free", esp_get_minimum_free_heap_size());
+    
+    return heap;
+}
+
+cJSON* ServerStatsTool::getExecutorStats() {
+    cJSON* executor = cJSON_CreateObject();
+    
+    const TaskExecutor& pool = TaskExecutor::getInstance();
+    const TaskExecutor::Stats& stats = pool.getStats();
+    cJSON_AddNumberToObject(executor, "workers", pool.getWorkerCount());
+    cJSON_AddNumberToObject(executor, "jobs_executed", stats.jobsExecuted);
+    cJSON_AddNumberToObject(executor, "fast_lane_jobs", stats.fastLaneJobs);
+    cJSON_AddNumberToObject(executor, "rejected", stats.rejected);
+    cJSON_AddNumberToObject(executor, "peak_queued", stats.peakQueued);
+    
+    return executor;
+}
+
+cJSON* ServerStatsTool::getScannerStats() {
+    cJSON* scanner = cJSON_CreateObject();
+    
+    NetworkScanner::Stats stats = NetworkScanner::getInstance().getStats();
+    cJSON_AddNumberToObject(scanner, "started", stats.scansStarted);
+    cJSON_AddNumberToObject(scanner, "joined", stats.scansJoined);
+    cJSON_AddNumberToObject(scanner, "cache_hits", stats.cacheHits);
+    cJSON_AddNumberToObject(scanner, "failed", stats.scansFailed);
+    
+    return scanner;
+}
+
+cJSON* ServerStatsTool::getLogStats() {
+    cJSON* log = cJSON_CreateObject();
+    
+    const DeferredLog& deferred = DeferredLog::getInstance();
+    DeferredLog::Stats stats = deferred.getStats();
+    cJSON_AddBoolToObject(log, "deferred", deferred.isRunning());
+    cJSON_AddNumberToObject(log, "written", stats.written);
+    cJSON_AddNumberToObject(log, "dropped", stats.dropped);
+    cJSON_AddNumberToObject(log, "peak_queued", stats.peakQueued);
+    
+    return log;
+}
+
+cJSON* ServerStatsTool::getTimerStats() {
+    cJSON* timers = cJSON_CreateObject();
+    
+    TimerWheel::Stats stats = TimerWheel::getInstance().getStats();
+    cJSON_AddNumberToObject(timers, "armed", stats.armed);
+    cJSON_AddNumberToObject(timers, "fired", stats.fired);
+    cJSON_AddNumberToObject(timers, "wakeups", stats.wakeups);
+    cJSON_AddNumberToObject(timers, "pending", stats.pending);
+    
+    return timers;
+}
+#endif // TINYMCP_METRICS
+
+// GPIOControlTool implementation
+GPIOControlTool::PinMode GPIOControlTool::pinModes_[GPIOControlTool::PIN_COUNT] = {};
+SemaphoreHandle_t GPIOControlTool::gpioMutex_ = nullptr;
+
+static constexpr char GPIO_CONTROL_SCHEMA[] =
+    R"json({"type":"object","properties":{)json"
+    R"json("operation":{"type":"string","description":"GPIO operation","enum":["set","get"],"required":true},)json"
+    R"json("pin":{"type":"integer","description":"GPIO pin number","minimum":0,"maximum":16,"required":true},)json"
+    R"json("state":{"type":"boolean","description":"Pin state (for set operation)"}}})json";
+static constexpr int GPIO_CONTROL_OPERATION = SchemaText::propertyIndex(GPIO_CONTROL_SCHEMA, "operation");
+static constexpr int GPIO_CONTROL_PIN = SchemaText::propertyIndex(GPIO_CONTROL_SCHEMA, "pin");
+static constexpr int GPIO_CONTROL_STATE = SchemaText::propertyIndex(GPIO_CONTROL_SCHEMA, "state");
+
+// The limits below are spelled out in the text
+static_assert(GPIO_BATCH_MAX_ACTIONS == 17 && GPIO_BATCH_MAX_STEPS == 64 && GPIO_BATCH_MAX_DURATION_US == 1000000,
+              "update GPIO_BATCH_SCHEMA");
+static constexpr char GPIO_BATCH_SCHEMA[] =
+    R"json({"type":"object","properties":{)json"
+    R"json("actions":{"type":"array","description":"Pin modes and levels, applied together","items":{)json"
+        R"json("type":"object","properties":{)json"
+        R"json("pin":{"type":"integer","description":"GPIO pin number","minimum":0,"maximum":16,"required":true},)json"
+        R"json("mode":{"type":"string","description":"Pin mode; a pin given only a state becomes an output",)json"
+            R"json("enum":["input","input_pullup","output","output_od"]},)json"
+        R"json("state":{"type":"boolean","description":"Output level"}}},)json"
+        R"json("maxItems":17,"required":true},)json"
+    R"json("sequence":{"type":"array","description":"Timed level changes run after the actions","items":{)json"
+        R"json("type":"object","properties":{)json"
+        R"json("set_mask":{"type":"integer","description":"Output pins to drive high, bit n for GPIOn","minimum":0,"maximum":131071},)json"
+        R"json("clear_mask":{"type":"integer","description":"Output pins to drive low","minimum":0,"maximum":131071},)json"
+        R"json("delay_us":{"type":"integer","description":"Pause before the next step","minimum":0,"maximum":1000000}}},)json"
+        R"json("maxItems":64}}})json";
+static constexpr int GPIO_BATCH_ACTIONS = SchemaText::propertyIndex(GPIO_BATCH_SCHEMA, "actions");
+static constexpr int GPIO_BATCH_SEQUENCE = SchemaText::propertyIndex(GPIO_BATCH_SCHEMA, "sequence");
+static constexpr int GPIO_ACTION_PIN = SchemaText::itemPropertyIndex(GPIO_BATCH_SCHEMA, "actions", "pin");
+static constexpr int GPIO_ACTION_MODE = SchemaText::itemPropertyIndex(GPIO_BATCH_SCHEMA, "actions", "mode");
+static constexpr int GPIO_ACTION_STATE = SchemaText::itemPropertyIndex(GPIO_BATCH_SCHEMA, "actions", "state");
+static constexpr int GPIO_STEP_SET_MASK = SchemaText::itemPropertyIndex(GPIO_BATCH_SCHEMA, "sequence", "set_mask");
+static constexpr int GPIO_STEP_CLEAR_MASK = SchemaText::itemPropertyIndex(GPIO_BATCH_SCHEMA, "sequence", "clear_mask");
+static constexpr int GPIO_STEP_DELAY_US = SchemaText::itemPropertyIndex(GPIO_BATCH_SCHEMA, "sequence", "delay_us");
+
+int GPIOControlTool::init() {
+    if (!gpioMutex_) {
+        gpioMutex_ = xSemaphoreCreateMutex();
+    }
+    return gpioMutex_ ? TINYMCP_SUCCESS : TINYMCP_ERROR_OUT_OF_MEMORY;
+}
+
+int GPIOControlTool::execute(const ToolArgs& args, cJSON** result) {
+    bool set = args.getEnum(GPIO_CONTROL_OPERATION, 0) == 0;
+    int pin = args.getInt(GPIO_CONTROL_PIN, -1);
+    
+    if (!isValidGPIOPin(pin)) {
+        *result = ToolHelpers::createErrorResponse("Invalid GPIO pin: " + std::to_string(pin));
+        return TINYMCP_SUCCESS;
+    }
+    
+    cJSON* response = cJSON_CreateObject();
+    
+    if (set) {
+        if (!args.has(GPIO_CONTROL_STATE)) {
+            cJSON_Delete(response);
+            return TINYMCP_ERROR_INVALID_PARAMS;
+        }
+        bool state = args.getBool(GPIO_CONTROL_STATE, false);
+        
+        int result_code = setGPIOPin(pin, state);
+        if (result_code == TINYMCP_SUCCESS) {
+            cJSON_AddStringToObject(response, "status", "success");
+            cJSON_AddNumberToObject(response, "pin", pin);
+            cJSON_AddBoolToObject(response, "state", state);
+        } else {
+            cJSON_Delete(response);
+            *result = ToolHelpers::createErrorResponse("Failed to set GPIO pin");
+            return TINYMCP_SUCCESS;
+        }
+    } else {
+        bool state;
+        int result_code = getGPIOPin(pin, &state);
+        if (result_code == TINYMCP_SUCCESS) {
+            cJSON_AddStringToObject(response, "status", "success");
+            cJSON_AddNumberToObject(response, "pin", pin);
+            cJSON_AddBoolToObject(response, "state", state);
+        } else {
+            cJSON_Delete(response);
+            *result = ToolHelpers::createErrorResponse("Failed to read GPIO pin");
+            return TINYMCP_SUCCESS;
+        }
+    }
+    
+    *result = response;
+    return TINYMCP_SUCCESS;
+}
+
+int GPIOControlTool::executeBatch(const ToolArgs& args, cJSON** result) {
+    // Types, ranges and array sizes were checked against the schema; what is
+    // left is validated before the first pin is touched
+    PinMode requested[PIN_COUNT] = {};
+    uint32_t actionMask = 0;
+    uint32_t setMask = 0;
+    uint32_t clearMask = 0;
+    ToolArgs actionArgs;
+    const cJSON* entry;
+    cJSON_ArrayForEach(entry, args.getItem(GPIO_BATCH_ACTIONS)) {
+        args.getElement(GPIO_BATCH_ACTIONS, entry, actionArgs);
+        int pin = actionArgs.getInt(GPIO_ACTION_PIN, -1);
+        if (!isValidGPIOPin(pin)) {
+            *result = ToolHelpers::createErrorResponse("Invalid GPIO pin: " + std::to_string(pin));
+            return TINYMCP_SUCCESS;
+        }
+        
+        // The mode enum lists the configured PinModes in order
+        uint32_t bit = 1u << pin;
+        bool hasState = actionArgs.has(GPIO_ACTION_STATE);
+        PinMode mode = static_cast<PinMode>(actionArgs.getEnum(GPIO_ACTION_MODE, -1) + 1);
+        if ((actionMask & bit) || (hasState && mode != PinMode::UNCONFIGURED && !isOutputMode(mode))) {
+            return TINYMCP_ERROR_INVALID_PARAMS;
+        }
+        requested[pin] = mode;
+        actionMask |= bit;
+        if (hasState) {
+            (actionArgs.getBool(GPIO_ACTION_STATE, false) ? setMask : clearMask) |= bit;
+        }
+    }
+    
+    std::vector<SequenceStep> steps;
+    uint64_t totalDelayUs = 0;
+    ToolArgs stepArgs;
+    cJSON_ArrayForEach(entry, args.getItem(GPIO_BATCH_SEQUENCE)) {
+        args.getElement(GPIO_BATCH_SEQUENCE, entry, stepArgs);
+        uint32_t set = stepArgs.getInt(GPIO_STEP_SET_MASK, 0);
+        uint32_t clear = stepArgs.getInt(GPIO_STEP_CLEAR_MASK, 0);
+        uint32_t delayUs = stepArgs.getInt(GPIO_STEP_DELAY_US, 0);
+        if ((set & clear) || !isValidPinMask(set) || !isValidPinMask(clear)) {
+            return TINYMCP_ERROR_INVALID_PARAMS;
+        }
+        totalDelayUs += delayUs;
+        steps.push_back({set, clear, delayUs});
+    }
+    if (totalDelayUs > GPIO_BATCH_MAX_DURATION_US) {
+        *result = ToolHelpers::createErrorResponse("Sequence exceeds " +
+            std::to_string(GPIO_BATCH_MAX_DURATION_US / 1000) + " ms");
+        return TINYMCP_SUCCESS;
+    }
+    
+    if (!gpioMutex_ || xSemaphoreTake(gpioMutex_, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        *result = ToolHelpers::createErrorResponse("GPIO busy");
+        return TINYMCP_SUCCESS;
+    }
+    
+    // Pins that get a level but no mode become outputs unless they already are
+    // one; the rest are configured one gpio_config call per distinct mode
+    uint32_t modeMasks[static_cast<int>(PinMode::OUTPUT_OD) + 1] = {};
+    uint32_t outputMask = 0;
+    for (size_t pin = 0; pin < PIN_COUNT; pin++) {
+        uint32_t bit = 1u << pin;
+        PinMode mode = requested[pin];
+        if (mode == PinMode::UNCONFIGURED && ((setMask | clearMask) & bit) && !isOutputMode(pinModes_[pin])) {
+            mode = PinMode::OUTPUT;
+        }
+        if (mode != PinMode::UNCONFIGURED && mode != pinModes_[pin]) {
+            modeMasks[static_cast<int>(mode)] |= bit;
+        }
+        if (isOutputMode(mode == PinMode::UNCONFIGURED ? pinModes_[pin] : mode)) {
+            outputMask |= bit;
+        }
+    }
+    
+    // Sequence steps may only drive pins that are outputs once the actions apply
+    int status = TINYMCP_SUCCESS;
+    for (const auto& step : steps) {
+        if (((step.setMask | step.clearMask) & ~outputMask) != 0) {
+            status = TINYMCP_ERROR_INVALID_PARAMS;
+        }
+    }
+    
+    int reconfigured = 0;
+    for (int mode = static_cast<int>(PinMode::INPUT);
+         mode <= static_cast<int>(PinMode::OUTPUT_OD) && status == TINYMCP_SUCCESS; mode++) {
+        if (modeMasks[mode]) {
+            status = configurePins(modeMasks[mode], static_cast<PinMode>(mode));
+            reconfigured += __builtin_popcount(modeMasks[mode]);
+        }
+    }
+    
+    if (status == TINYMCP_SUCCESS) {
+        status = writeLevels(setMask, clearMask);
+    }
+    
+    // Steps are scheduled against the start time, so lateness never accumulates
+    int64_t start = esp_timer_get_time();
+    int64_t deadline = start;
+    int64_t maxLateUs = 0;
+    for (size_t i = 0; i < steps.size() && status == TINYMCP_SUCCESS; i++) {
+        waitUntil(deadline);
+        status = writeLevels(steps[i].setMask, steps[i].clearMask);
+        maxLateUs = std::max(maxLateUs, esp_timer_get_time() - deadline);
+        deadline += steps[i].delayUs;
+    }
+    if (!steps.empty() && status == TINYMCP_SUCCESS) {
+        waitUntil(deadline);
+    }
+    int64_t elapsedUs = esp_timer_get_time() - start;
+    
+    cJSON* pins = cJSON_CreateArray();
+    for (size_t pin = 0; pin < PIN_COUNT && status == TINYMCP_SUCCESS; pin++) {
+        if (!(actionMask & (1u << pin))) {
+            continue;
+        }
+        cJSON* item = cJSON_CreateObject();
+        cJSON_AddNumberToObject(item, "pin", pin);
+        cJSON_AddStringToObject(item, "mode", pinModeToString(pinModes_[pin]));
+        cJSON_AddBoolToObject(item, "state", gpio_get_level(static_cast<gpio_num_t>(pin)) == 1);
+        cJSON_AddItemToArray(pins, item);
+    }
+    
+    xSemaphoreGive(gpioMutex_);
+    
+    if (status == TINYMCP_ERROR_INVALID_PARAMS) {
+        cJSON_Delete(pins);
+        return status;
+    }
+    if (status != TINYMCP_SUCCESS) {
+        cJSON_Delete(pins);
+        *result = ToolHelpers::createErrorResponse("Failed to apply GPIO batch");
+        return TINYMCP_SUCCESS;
+    }
+    
+    cJSON* response = cJSON_CreateObject();
+    cJSON_AddStringToObject(response, "status", "success");
+    cJSON_AddItemToObject(response, "pins", pins);
+    cJSON_AddNumberToObject(response, "reconfigured", reconfigured);
+    cJSON_AddNumberToObject(response, "steps", steps.size());
+    cJSON_AddNumberToObject(response, "elapsed_us", static_cast<double>(elapsedUs));
+    cJSON_AddNumberToObject(response, "max_late_us", static_cast<double>(maxLateUs));
+    *result = response;
+    return TINYMCP_SUCCESS;
+}
+
+const char* GPIOControlTool::pinModeToString(PinMode mode) {
+    switch (mode) {
+        case PinMode::INPUT: return "input";
+        case PinMode::INPUT_PULLUP: return "input_pullup";
+        case PinMode::OUTPUT: return "output";
+        case PinMode::OUTPUT_OD: return "output_od";
+        default: return "unconfigured";
+    }
+}
+
+bool GPIOControlTool::isOutputMode(PinMode mode) {
+    return mode == PinMode::OUTPUT || mode == PinMode::OUTPUT_OD;
+}
+
+bool GPIOControlTool::isValidPinMask(uint32_t mask) {
+    for (size_t pin = 0; pin < 32; pin++) {
+        if ((mask & (1u << pin)) && !isValidGPIOPin(pin)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int GPIOControlTool::configurePins(uint32_t mask, PinMode mode) {
+    gpio_config_t config = {};
+    config.pin_bit_mask = mask;
+    config.mode = isOutputMode(mode) ? (mode == PinMode::OUTPUT_OD ? GPIO_MODE_OUTPUT_OD : GPIO_MODE_OUTPUT)
+                                     : GPIO_MODE_INPUT;
+    config.pull_up_en = mode == PinMode::INPUT_PULLUP ? GPIO_PULLUP_ENABLE : GPIO_PULLUP_DISABLE;
+    config.pull_down_en = GPIO_PULLDOWN_DISABLE;
+    config.intr_type = GPIO_INTR_DISABLE;
+    
+    if (gpio_config(&config) != ESP_OK) {
+        // The hardware state is unknown now; configure again next time
+        for (size_t pin = 0; pin < PIN_COUNT; pin++) {
+            if (mask & (1u << pin)) {
+                pinModes_[pin] = PinMode::UNCONFIGURED;
+            }
+        }
+        return TINYMCP_ERROR_HARDWARE_FAILED;
+    }
+    
+    for (size_t pin = 0; pin < PIN_COUNT; pin++) {
+        if (mask & (1u << pin)) {
+            pinModes_[pin] = mode;
+        }
+    }
+    return TINYMCP_SUCCESS;
+}
+
+int GPIOControlTool::writeLevels(uint32_t setMask, uint32_t clearMask) {
+#if defined(CONFIG_IDF_TARGET_ESP8266)
+    // GPIO0-15 change in one write to each of the set and clear registers;
+    // GPIO16 sits in the RTC block and goes through the driver
+    const uint32_t registerPins = 0xFFFF;
+    if (setMask & registerPins) {
+        GPIO.out_w1ts = setMask & registerPins;
+    }
+    if (clearMask & registerPins) {
+        GPIO.out_w1tc = clearMask & registerPins;
+    }
+    setMask &= ~registerPins;
+    clearMask &= ~registerPins;
+#endif
+    for (size_t pin = 0; pin < PIN_COUNT; pin++) {
+        uint32_t bit = 1u << pin;
+        if (((setMask | clearMask) & bit) &&
+            gpio_set_level(static_cast<gpio_num_t>(pin), (setMask & bit) ? 1 : 0) != ESP_OK) {
+            return TINYMCP_ERROR_HARDWARE_FAILED;
+        }
+    }
+    return TINYMCP_SUCCESS;
+}
+
+void GPIOControlTool::waitUntil(int64_t deadlineUs) {
+    // Sleep whole ticks while more than two remain, then spin to the deadline
+    const int64_t tickUs = portTICK_PERIOD_MS * 1000;
+    int64_t remaining = deadlineUs - esp_timer_get_time();
+    if (remaining > 2 * tickUs) {
+        vTaskDelay(static_cast<TickType_t>(remaining / tickUs - 1));
+    }
+    while (esp_timer_get_time() < deadlineUs) {
+    }
+}
+
+int GPIOControlTool::setGPIOPin(int pin, bool state) {
+    if (!gpioMutex_ || xSemaphoreTake(gpioMutex_, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        return TINYMCP_ERROR_HARDWARE_FAILED;
+    }
+    
+    int status = TINYMCP_SUCCESS;
+    if (!isOutputMode(pinModes_[pin])) {
+        status = configurePins(1u << pin, PinMode::OUTPUT);
+    }
+    if (status == TINYMCP_SUCCESS) {
+        status = writeLevels(state ? 1u << pin : 0, state ? 0 : 1u << pin);
+    }
+    
+    xSemaphoreGive(gpioMutex_);
+    return status;
+}
+
+int GPIOControlTool::getGPIOPin(int pin, bool* state) {
+    if (!gpioMutex_ || xSemaphoreTake(gpioMutex_, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        return TINYMCP_ERROR_HARDWARE_FAILED;
+    }
+    
+    // Configured pins are read in their current mode, outputs included
+    int status = TINYMCP_SUCCESS;
+    if (pinModes_[pin] == PinMode::UNCONFIGURED) {
+        status = configurePins(1u << pin, PinMode::INPUT_PULLUP);
+    }
+    if (status == TINYMCP_SUCCESS) {
+        *state = gpio_get_level((gpio_num_t)pin) == 1;
+    }
+    
+    xSemaphoreGive(gpioMutex_);
+    return status;
+}
+
+bool GPIOControlTool::isValidGPIOPin(int pin) {
+    // ESP8266 has GPIO pins 0-16, but some are restricted
+    return (pin >= 0 && pin <= 16 && pin != 6 && pin != 7 && pin != 8 && pin != 11);
+}
+
+// EchoTool implementation
+static constexpr char ECHO_SCHEMA[] =
+    R"json({"type":"object","properties":{)json"
+    R"json("message":{"type":"string","description":"Message to echo back"}}})json";
+static constexpr int ECHO_MESSAGE = SchemaText::propertyIndex(ECHO_SCHEMA, "message");
+
+int EchoTool::execute(const ToolArgs& args, cJSON** result) {
+    cJSON* response = cJSON_CreateObject();
+    cJSON_AddStringToObject(response, "echo", args.getString(ECHO_MESSAGE, "Hello from TinyMCP!"));
+    cJSON_AddNumberToObject(response, "timestamp", xTaskGetTickCount() * portTICK_PERIOD_MS);
+    cJSON_AddStringToObject(response, "source", "ESP8266 TinyMCP Server");
+    
+    *result = response;
+    return TINYMCP_SUCCESS;
+}
+
+// NetworkScannerTask implementation
+static_assert(NetworkScanner::MAX_RECORDS == 50, "update NETWORK_SCAN_SCHEMA");
+static constexpr char NETWORK_SCAN_SCHEMA[] =
+    R"json({"type":"object","properties":{)json"
+    R"json("include_bssid":{"type":"boolean","description":"Include BSSID in results"},)json"
+    R"json("include_rssi":{"type":"boolean","description":"Include signal strength"},)json"
+    R"json("include_channel":{"type":"boolean","description":"Include channel information"},)json"
+    R"json("max_results":{"type":"integer","description":"Maximum number of results","minimum":1,"maximum":50},)json"
+    R"json("timeout_ms":{"type":"integer","description":"Scan timeout in milliseconds","minimum":1000,"maximum":30000},)json"
+    R"json("channel":{"type":"integer","description":"Only scan this channel, 0 for all","minimum":0,"maximum":14},)json"
+    R"json("passive":{"type":"boolean","description":"Listen for beacons instead of probing"},)json"
+    R"json("show_hidden":{"type":"boolean","description":"Include networks with a hidden SSID"},)json"
+    R"json("dwell_ms":{"type":"integer","description":"Time per channel, 0 for the defaults","minimum":0,"maximum":1500},)json"
+    R"json("max_age_ms":{"type":"integer","description":"Accept cached results up to this age, 0 for a fresh scan",)json"
+        R"json("minimum":0,"maximum":600000}}})json";
+static constexpr int NETWORK_SCAN_INCLUDE_BSSID = SchemaText::propertyIndex(NETWORK_SCAN_SCHEMA, "include_bssid");
+static constexpr int NETWORK_SCAN_INCLUDE_RSSI = SchemaText::propertyIndex(NETWORK_SCAN_SCHEMA, "include_rssi");
+static constexpr int NETWORK_SCAN_INCLUDE_CHANNEL = SchemaText::propertyIndex(NETWORK_SCAN_SCHEMA, "include_channel");
+static constexpr int NETWORK_SCAN_MAX_RESULTS = SchemaText::propertyIndex(NETWORK_SCAN_SCHEMA, "max_results");
+static constexpr int NETWORK_SCAN_TIMEOUT_MS = SchemaText::propertyIndex(NETWORK_SCAN_SCHEMA, "timeout_ms");
+static constexpr int NETWORK_SCAN_CHANNEL = SchemaText::propertyIndex(NETWORK_SCAN_SCHEMA, "channel");
+static constexpr int NETWORK_SCAN_PASSIVE = SchemaText::propertyIndex(NETWORK_SCAN_SCHEMA, "passive");
+static constexpr int NETWORK_SCAN_SHOW_HIDDEN = SchemaText::propertyIndex(NETWORK_SCAN_SCHEMA, "show_hidden");
+static constexpr int NETWORK_SCAN_DWELL_MS = SchemaText::propertyIndex(NETWORK_SCAN_SCHEMA, "dwell_ms");
+static constexpr int NETWORK_SCAN_MAX_AGE_MS = SchemaText::propertyIndex(NETWORK_SCAN_SCHEMA, "max_age_ms");
+
+NetworkScannerTask::NetworkScannerTask(const MessageId& requestId, const ToolArgs& args) :
+    AsyncTask(requestId, "network_scan"), ticket_(0), started_(false) {
+    
+    parseArguments(args);
+    setTimeout(params_.timeoutMs);
+}
+
+NetworkScannerTask::~NetworkScannerTask() {
+    NetworkScanner::getInstance().removeWaiter(this);
+}
+
+bool NetworkScannerTask::isValid() const {
+    return params_.maxResults > 0 && params_.timeoutMs > 0;
+}
+
+std::unique_ptr<AsyncTask> NetworkScannerTask::create(const MessageId& requestId, const ToolArgs& args) {
+    return std::make_unique<NetworkScannerTask>(requestId, args);
+}
+
+void NetworkScannerTask::cancel() {
+    // The session deletes the event group the scanner would signal
+    NetworkScanner::getInstance().removeWaiter(this);
+    AsyncTask::cancel();
+}
+
+bool NetworkScannerTask::isWaiting() const {
+    return !finished_ && NetworkScanner::getInstance().isWaiting(this);
+}
+
+int NetworkScannerTask::execute() {
+    if (cancelled_ || finished_) {
+        return TINYMCP_ERROR_CANCELLED;
+    }
+    
+    // The scanner signals our timeout notify when the scan ends, which
+    // brings the session back to run us again
+    NetworkScanner::Result scan;
+    if (!NetworkScanner::getInstance().poll(params_.options, params_.maxAgeMs, ticket_, scan,
+                                            this, timeoutNotify_)) {
+        if (!started_) {
+            TINYMCP_LOGI(TAG, "Waiting for WiFi scan");
+            reportProgress(0, 100, "Scanning networks...");
+            started_ = true;
+        }
+        return TINYMCP_SUCCESS;
+    }
+    
+    if (scan.status == TINYMCP_SUCCESS) {
+        reportProgress(100, 100, "WiFi scan completed");
+        response_ = createResponse(formatScanResults(scan));
+    } else if (!cancelled_) {
+        ESP_LOGE(TAG, "WiFi scan failed: %d", scan.status);
+        response_ = createErrorResponse(scan.status, scan.status == TINYMCP_ERROR_TIMEOUT ?
+                                        "WiFi scan did not complete" : "WiFi scan failed");
+    }
+    finished_ = true;
+    
+    return scan.status;
+}
+
+cJSON* NetworkScannerTask::formatScanResults(const NetworkScanner::Result& scan) {
+    cJSON* result = cJSON_CreateObject();
+    cJSON* networks = cJSON_CreateArray();
+    size_t count = std::min(scan.networks.size(), static_cast<size_t>(params_.maxResults));
+    for (size_t i = 0; i < count; i++) {
+        const NetworkScanner::Network& ap = scan.networks[i];
+        cJSON* network = cJSON_CreateObject();
+        cJSON_AddStringToObject(network, "ssid", ap.ssid);
+        
+        if (params_.includeRSSI) {
+            cJSON_AddNumberToObject(network, "rssi", ap.rssi);
+        }
+        
+        if (params_.includeChannel) {
+            cJSON_AddNumberToObject(network, "channel", ap.channel);
+        }
+        
+        if (params_.includeBSSID) {
+            char bssid_str[18];
+            snprintf(bssid_str, sizeof(bssid_str), "%02x:%02x:%02x:%02x:%02x:%02x",
+                    ap.bssid[0], ap.bssid[1], ap.bssid[2],
+                    ap.bssid[3], ap.bssid[4], ap.bssid[5]);
+            cJSON_AddStringToObject(network, "bssid", bssid_str);
+        }
+        
+        cJSON_AddItemToArray(networks, network);
+    }
+    
+    cJSON_AddStringToObject(result, "status", "success");
+    cJSON_AddItemToObject(result, "networks", networks);
+    cJSON_AddNumberToObject(result, "count", count);
+    cJSON_AddNumberToObject(result, "found", scan.networks.size());
+    cJSON_AddBoolToObject(result, "cached", scan.cached);
+    cJSON_AddNumberToObject(result, "age_ms", scan.ageMs);
+    return result;
+}
+
+void NetworkScannerTask::parseArguments(const ToolArgs& args) {
+    params_.includeBSSID = args.getBool(NETWORK_SCAN_INCLUDE_BSSID, params_.includeBSSID);
+    params_.includeRSSI = args.getBool(NETWORK_SCAN_INCLUDE_RSSI, params_.includeRSSI);
+    params_.includeChannel = args.getBool(NETWORK_SCAN_INCLUDE_CHANNEL, params_.includeChannel);
+    params_.maxResults = args.getInt(NETWORK_SCAN_MAX_RESULTS, params_.maxResults);
+    params_.timeoutMs = args.getInt(NETWORK_SCAN_TIMEOUT_MS, params_.timeoutMs);
+    params_.maxAgeMs = args.getInt(NETWORK_SCAN_MAX_AGE_MS, params_.maxAgeMs);
+    params_.options.channel = args.getInt(NETWORK_SCAN_CHANNEL, 0);
+    params_.options.passive = args.getBool(NETWORK_SCAN_PASSIVE, false);
+    params_.options.showHidden = args.getBool(NETWORK_SCAN_SHOW_HIDDEN, false);
+    params_.options.dwellMs = args.getInt(NETWORK_SCAN_DWELL_MS, 0);
+}
+
+// FileSystemTool implementation
+static_assert(FILE_READ_MAX_LENGTH == 2048, "update FILE_SYSTEM_SCHEMA");
+static constexpr char FILE_SYSTEM_SCHEMA[] =
+    R"json({"type":"object","properties":{)json"
+    R"json("operation":{"type":"string","description":"File operation","enum":["list","read","write","delete","info"],)json"
+        R"json("required":true},)json"
+    R"json("path":{"type":"string","description":"File name relative to the SPIFFS root"},)json"
+    R"json("offset":{"type":"integer","description":"Read start in bytes","minimum":0},)json"
+    R"json("length":{"type":"integer","description":"Bytes to read","minimum":1,"maximum":2048},)json"
+    R"json("content":{"type":"string","description":"Data to write"},)json"
+    R"json("append":{"type":"boolean","description":"Append instead of replacing the file"},)json"
+    R"json("encoding":{"type":"string","description":"Content encoding","enum":["text","base64"]}}})json";
+static constexpr int FILE_SYSTEM_OPERATION = SchemaText::propertyIndex(FILE_SYSTEM_SCHEMA, "operation");
+static constexpr int FILE_SYSTEM_PATH = SchemaText::propertyIndex(FILE_SYSTEM_SCHEMA, "path");
+static constexpr int FILE_SYSTEM_OFFSET = SchemaText::propertyIndex(FILE_SYSTEM_SCHEMA, "offset");
+static constexpr int FILE_SYSTEM_LENGTH = SchemaText::propertyIndex(FILE_SYSTEM_SCHEMA, "length");
+static constexpr int FILE_SYSTEM_CONTENT = SchemaText::propertyIndex(FILE_SYSTEM_SCHEMA, "content");
+static constexpr int FILE_SYSTEM_APPEND = SchemaText::propertyIndex(FILE_SYSTEM_SCHEMA, "append");
+static constexpr int FILE_SYSTEM_ENCODING = SchemaText::propertyIndex(FILE_SYSTEM_SCHEMA, "encoding");
+
+int FileSystemTool::mount() {
+    static bool mounted = false;
+    if (mounted) {
+        return TINYMCP_SUCCESS;
+    }
+    
+    esp_vfs_spiffs_conf_t conf = {};
+    conf.base_path = TINYMCP_FS_BASE_PATH;
+    conf.partition_label = nullptr;
+    conf.max_files = 4;
+    conf.format_if_mount_failed = false;
+    
+    // ESP_ERR_INVALID_STATE: the application mounted it already
+    esp_err_t err = esp_vfs_spiffs_register(&conf);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+        ESP_LOGW(TAG, "SPIFFS mount at %s failed: %d", TINYMCP_FS_BASE_PATH, err);
+        return TINYMCP_ERROR_HARDWARE_FAILED;
+    }
+    
+    mounted = true;
+    return TINYMCP_SUCCESS;
 }
 
-cJSON* SystemInfoTool::getMemoryInfo() {
-    cJSON* memory = cJSON_CreateObject();
-    
-    // Heap information
-    cJSON_AddNumberToObject(memory, "free_heap", esp_get_free_heap_size());
-    cJSON_AddNumberToObject(memory, "minimum_free_heap", esp_get_minimum_free_heap_size());
-    cJSON_AddNumberToObject(memory, "largest_free_block", esp_get_free_heap_size());
+int FileSystemTool::execute(const ToolArgs& args, cJSON** result) {
+    // The operation enum lists the Operations in order
+    Operation operation = static_cast<Operation>(args.getEnum(FILE_SYSTEM_OPERATION, 0));
+    if (operation == Operation::LIST_FILES) {
+        return listFiles(result);
+    }
     
-    // Internal memory (ESP8266 doesn't have heap_caps, use free heap)
-    cJSON_AddNumberToObject(memory, "free_internal", esp_get_free_heap_size());
+    // Every other operation names a file; info without one reports the partition
+    if (!args.has(FILE_SYSTEM_PATH) && operation != Operation::GET_INFO) {
+        return TINYMCP_ERROR_INVALID_PARAMS;
+    }
+    std::string path = args.getString(FILE_SYSTEM_PATH, "");
+    if (!path.empty() && !isValidPath(path)) {
+        *result = ToolHelpers::createErrorResponse("Invalid path: " + path);
+        return TINYMCP_SUCCESS;
+    }
     
-    return memory;
+    bool base64 = args.getEnum(FILE_SYSTEM_ENCODING, 0) == 1;
+    switch (operation) {
+        case Operation::READ_FILE:
+            return readFile(path, args.getInt(FILE_SYSTEM_OFFSET, 0),
+                            args.getInt(FILE_SYSTEM_LENGTH, FILE_READ_MAX_LENGTH), base64, result);
+        
+        case Operation::WRITE_FILE: {
+            if (!args.has(FILE_SYSTEM_CONTENT)) {
+                return TINYMCP_ERROR_INVALID_PARAMS;
+            }
+            std::string content = args.getString(FILE_SYSTEM_CONTENT);
+            bool append = args.getBool(FILE_SYSTEM_APPEND, false);
+            if (base64) {
+                std::string decoded;
+                if (!ToolHelpers::base64Decode(content, decoded)) {
+                    return TINYMCP_ERROR_INVALID_PARAMS;
+                }
+                content.swap(decoded);
+            }
+            return writeFile(path, content, append, result);
+        }
+        
+        case Operation::DELETE_FILE:
+            return deleteFile(path, result);
+        
+        default:
+            return getFileInfo(path, result);
+    }
 }
 
-cJSON* SystemInfoTool::getWiFiInfo() {
-    cJSON* wifi = cJSON_CreateObject();
+int FileSystemTool::listFiles(cJSON** result) {
+    DIR* dir = opendir(TINYMCP_FS_BASE_PATH);
+    if (!dir) {
+        *result = ToolHelpers::createErrorResponse("Failed to open " TINYMCP_FS_BASE_PATH);
+        return TINYMCP_SUCCESS;
+    }
     
-    wifi_mode_t mode;
-    if (esp_wifi_get_mode(&mode) == ESP_OK) {
-        const char* modeStr = "UNKNOWN";
-        switch (mode) {
-            case WIFI_MODE_STA: modeStr = "STA"; break;
-            case WIFI_MODE_AP: modeStr = "AP"; break;
-            case WIFI_MODE_APSTA: modeStr = "AP+STA"; break;
-            default: break;
+    cJSON* response = cJSON_CreateObject();
+    cJSON* files = cJSON_CreateArray();
+    size_t totalBytes = 0;
+    
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        if (entry->d_name[0] == '.') {
+            continue;
         }
-        cJSON_AddStringToObject(wifi, "mode", modeStr);
         
-        if (mode == WIFI_MODE_STA || mode == WIFI_MODE_APSTA) {
-            wifi_ap_record_t ap_info;
-            if (esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK) {
-                cJSON_AddStringToObject(wifi, "ssid", (char*)ap_info.ssid);
-                cJSON_AddNumberToObject(wifi, "rssi", ap_info.rssi);
-                cJSON_AddNumberToObject(wifi, "channel", ap_info.primary);
-            }
+        struct stat info;
+        if (stat(toFullPath(entry->d_name).c_str(), &info) != 0 || !S_ISREG(info.st_mode)) {
+            continue;
         }
+        
+        cJSON* file = cJSON_CreateObject();
+        cJSON_AddStringToObject(file, "name", entry->d_name);
+        cJSON_AddNumberToObject(file, "size", info.st_size);
+        cJSON_AddItemToArray(files, file);
+        totalBytes += info.st_size;
     }
+    closedir(dir);
     
-    return wifi;
+    cJSON_AddStringToObject(response, "status", "success");
+    cJSON_AddItemToObject(response, "files", files);
+    cJSON_AddNumberToObject(response, "total_bytes", totalBytes);
+    *result = response;
+    return TINYMCP_SUCCESS;
 }
 
-cJSON* SystemInfoTool::getTaskInfo() {
-    cJSON* tasks = cJSON_CreateArray();
+int FileSystemTool::readFile(const std::string& filename, uint32_t offset, uint32_t length, bool base64,
+                             cJSON** result) {
+    FILE* file = fopen(toFullPath(filename).c_str(), "rb");
+    if (!file) {
+        *result = ToolHelpers::createErrorResponse("File not found: " + filename);
+        return TINYMCP_SUCCESS;
+    }
     
-    // Get task count
-    UBaseType_t taskCount = uxTaskGetNumberOfTasks();
-    cJSON_AddNumberToObject(tasks, "task_count", taskCount);
+    struct stat info;
+    uint32_t fileSize = fstat(fileno(file), &info) == 0 ? static_cast<uint32_t>(info.st_size) : 0;
+    if (offset > fileSize || fseek(file, offset, SEEK_SET) != 0) {
+        fclose(file);
+        *result = ToolHelpers::createErrorResponse("Offset beyond end of file: " + std::to_string(offset));
+        return TINYMCP_SUCCESS;
+    }
     
-    // Note: Getting detailed task information requires more complex FreeRTOS APIs
-    // that may not be available in all configurations
+    // Only the requested range is ever held in memory
+    std::string data(std::min(length, fileSize - offset), '\0');
+    size_t bytesRead = data.empty() ? 0 : fread(&data[0], 1, data.size(), file);
+    bool failed = bytesRead < data.size() && ferror(file);
+    fclose(file);
+    if (failed) {
+        *result = ToolHelpers::createErrorResponse("Failed to read file: " + filename);
+        return TINYMCP_SUCCESS;
+    }
+    data.resize(bytesRead);
     
-    return tasks;
-}
-
-// GPIOControlTool implementation
-void GPIOControlTool::registerTool() {
-    auto tool = std::make_unique<ToolRegistry::ToolDefinition>(
-        "gpio_control",
-        "Control ESP8266/ESP32 GPIO pins - set output state or read input state",
-        [](const cJSON* args, cJSON** result) { return GPIOControlTool::execute(args, result); }
-    );
+    cJSON* response = cJSON_CreateObject();
+    cJSON_AddStringToObject(response, "status", "success");
+    cJSON_AddStringToObject(response, "path", filename.c_str());
+    cJSON_AddNumberToObject(response, "offset", offset);
+    cJSON_AddNumberToObject(response, "length", bytesRead);
+    cJSON_AddNumberToObject(response, "size", fileSize);
+    cJSON_AddBoolToObject(response, "eof", offset + bytesRead >= fileSize);
+    cJSON_AddStringToObject(response, "encoding", base64 ? "base64" : "text");
+    if (base64) {
+        std::string encoded((bytesRead + 2) / 3 * 4 + 1, '\0');
+        encoded.resize(ToolHelpers::base64Encode(reinterpret_cast<const uint8_t*>(data.data()),
+                                                 bytesRead, &encoded[0]));
+        cJSON_AddStringToObject(response, "content", encoded.c_str());
+    } else {
+        cJSON_AddStringToObject(response, "content", data.c_str());
+    }
     
-    tool->inputSchema = createInputSchema();
-    ToolRegistry::getInstance().registerTool(std::move(tool));
+    *result = response;
+    return TINYMCP_SUCCESS;
 }
 
-int GPIOControlTool::execute(const cJSON* args, cJSON** result) {
-    if (!args) {
-        return TINYMCP_ERROR_INVALID_PARAMS;
+int FileSystemTool::writeFile(const std::string& filename, const std::string& content, bool append,
+                              cJSON** result) {
+    FILE* file = fopen(toFullPath(filename).c_str(), append ? "ab" : "wb");
+    if (!file) {
+        *result = ToolHelpers::createErrorResponse("Failed to open file for writing: " + filename);
+        return TINYMCP_SUCCESS;
     }
     
-    std::string operation;
-    int pin;
-    
-    if (!ToolHelpers::validateStringParam(args, "operation", operation) ||
-        !ToolHelpers::validateIntParam(args, "pin", pin)) {
-        return TINYMCP_ERROR_INVALID_PARAMS;
+    size_t written = content.empty() ? 0 : fwrite(content.data(), 1, content.size(), file);
+    bool failed = fclose(file) != 0 || written != content.size();
+    if (failed) {
+        *result = ToolHelpers::createErrorResponse("Failed to write file (filesystem full?): " + filename);
+        return TINYMCP_SUCCESS;
     }
     
-    if (!isValidGPIOPin(pin)) {
-        *result = ToolHelpers::createErrorResponse("Invalid GPIO pin: " + std::to_string(pin));
+    struct stat info;
+    cJSON* response = cJSON_CreateObject();
+    cJSON_AddStringToObject(response, "status", "success");
+    cJSON_AddStringToObject(response, "path", filename.c_str());
+    cJSON_AddNumberToObject(response, "written", written);
+    if (stat(toFullPath(filename).c_str(), &info) == 0) {
+        cJSON_AddNumberToObject(response, "size", info.st_size);
+    }
+    *result = response;
+    return TINYMCP_SUCCESS;
+}
+
+int FileSystemTool::deleteFile(const std::string& filename, cJSON** result) {
+    if (remove(toFullPath(filename).c_str()) != 0) {
+        *result = ToolHelpers::createErrorResponse("Failed to delete file: " + filename);
         return TINYMCP_SUCCESS;
     }
     
+    cJSON* response = cJSON_CreateObject();
+    cJSON_AddStringToObject(response, "status", "success");
+    cJSON_AddStringToObject(response, "path", filename.c_str());
+    *result = response;
+    return TINYMCP_SUCCESS;
+}
+
+int FileSystemTool::getFileInfo(const std::string& filename, cJSON** result) {
     cJSON* response = cJSON_CreateObject();
     
-    if (operation == "set") {
-        bool state;
-        if (!ToolHelpers::validateBoolParam(args, "state", state)) {
-            cJSON_Delete(response);
-            return TINYMCP_ERROR_INVALID_PARAMS;
-        }
-        
-        int result_code = setGPIOPin(pin, state);
-        if (result_code == TINYMCP_SUCCESS) {
-            cJSON_AddStringToObject(response, "status", "success");
-            cJSON_AddNumberToObject(response, "pin", pin);
-            cJSON_AddBoolToObject(response, "state", state);
-        } else {
-            cJSON_Delete(response);
-            *result = ToolHelpers::createErrorResponse("Failed to set GPIO pin");
-            return TINYMCP_SUCCESS;
-        }
-    } else if (operation == "get") {
-        bool state;
-        int result_code = getGPIOPin(pin, &state);
-        if (result_code == TINYMCP_SUCCESS) {
-            cJSON_AddStringToObject(response, "status", "success");
-            cJSON_AddNumberToObject(response, "pin", pin);
-            cJSON_AddBoolToObject(response, "state", state);
-        } else {
+    if (filename.empty()) {
+        size_t totalBytes = 0;
+        size_t usedBytes = 0;
+        if (esp_spiffs_info(nullptr, &totalBytes, &usedBytes) != ESP_OK) {
             cJSON_Delete(response);
-            *result = ToolHelpers::createErrorResponse("Failed to read GPIO pin");
+            *result = ToolHelpers::createErrorResponse("Failed to read SPIFFS partition info");
             return TINYMCP_SUCCESS;
         }
-    } else {
-        cJSON_Delete(response);
-        *result = ToolHelpers::createErrorResponse("Invalid operation: " + operation);
+        cJSON_AddStringToObject(response, "status", "success");
+        cJSON_AddNumberToObject(response, "total_bytes", totalBytes);
+        cJSON_AddNumberToObject(response, "used_bytes", usedBytes);
+        *result = response;
         return TINYMCP_SUCCESS;
     }
     
+    struct stat info;
+    bool exists = stat(toFullPath(filename).c_str(), &info) == 0;
+    cJSON_AddStringToObject(response, "status", "success");
+    cJSON_AddStringToObject(response, "path", filename.c_str());
+    cJSON_AddBoolToObject(response, "exists", exists);
+    if (exists) {
+        cJSON_AddNumberToObject(response, "size", info.st_size);
+    }
     *result = response;
     return TINYMCP_SUCCESS;
 }
 
-cJSON* GPIOControlTool::createInputSchema() {
-    return ToolHelpers::createObjectSchema({
-        {"operation", ToolHelpers::createEnumProperty("GPIO operation", {"set", "get"}, true)},
-        {"pin", ToolHelpers::createIntegerProperty("GPIO pin number", 0, 16, true)},
-        {"state", ToolHelpers::createBooleanProperty("Pin state (for set operation)", false)}
-    });
-}
-
-int GPIOControlTool::setGPIOPin(int pin, bool state) {
-    gpio_config_t config = {};
-    config.pin_bit_mask = (1ULL << pin);
-    config.mode = GPIO_MODE_OUTPUT;
-    config.pull_up_en = GPIO_PULLUP_DISABLE;
-    config.pull_down_en = GPIO_PULLDOWN_DISABLE;
-    config.intr_type = GPIO_INTR_DISABLE;
-    
-    if (gpio_config(&config) != ESP_OK) {
-        return TINYMCP_ERROR_HARDWARE_FAILED;
+bool FileSystemTool::isValidPath(const std::string& path) {
+    // SPIFFS is flat: names may contain '/' but there are no real directories
+    if (path.empty() || path.size() >= CONFIG_SPIFFS_OBJ_NAME_LEN - 1 || path[0] == '/' ||
+        path.find("..") != std::string::npos) {
+        return false;
     }
     
-    if (gpio_set_level((gpio_num_t)pin, state ? 1 : 0) != ESP_OK) {
-        return TINYMCP_ERROR_HARDWARE_FAILED;
+    for (char c : path) {
+        if (static_cast<unsigned char>(c) < 0x20 || c == '\\') {
+            return false;
+        }
     }
-    
-    return TINYMCP_SUCCESS;
+    return true;
 }
 
-int GPIOControlTool::getGPIOPin(int pin, bool* state) {
-    gpio_config_t config = {};
-    config.pin_bit_mask = (1ULL << pin);
-    config.mode = GPIO_MODE_INPUT;
-    config.pull_up_en = GPIO_PULLUP_ENABLE;
-    config.pull_down_en = GPIO_PULLDOWN_DISABLE;
-    config.intr_type = GPIO_INTR_DISABLE;
+std::string FileSystemTool::toFullPath(const std::string& path) {
+    return std::string(TINYMCP_FS_BASE_PATH "/") + path;
+}
+
+// FileStreamTask implementation
+static constexpr char FILE_STREAM_SCHEMA[] =
+    R"json({"type":"object","properties":{)json"
+    R"json("path":{"type":"string","description":"File name relative to the SPIFFS root","required":true},)json"
+    R"json("offset":{"type":"integer","description":"Start in bytes","minimum":0},)json"
+    R"json("length":{"type":"integer","description":"Bytes to stream, 0 for the rest of the file","minimum":0},)json"
+    R"json("encoding":{"type":"string","description":"Chunk encoding","enum":["text","base64"]}}})json";
+static constexpr int FILE_STREAM_PATH = SchemaText::propertyIndex(FILE_STREAM_SCHEMA, "path");
+static constexpr int FILE_STREAM_OFFSET = SchemaText::propertyIndex(FILE_STREAM_SCHEMA, "offset");
+static constexpr int FILE_STREAM_LENGTH = SchemaText::propertyIndex(FILE_STREAM_SCHEMA, "length");
+static constexpr int FILE_STREAM_ENCODING = SchemaText::propertyIndex(FILE_STREAM_SCHEMA, "encoding");
+
+FileStreamTask::FileStreamTask(const MessageId& requestId, const ToolArgs& args) :
+    AsyncTask(requestId, "file_stream") {
     
-    if (gpio_config(&config) != ESP_OK) {
-        return TINYMCP_ERROR_HARDWARE_FAILED;
+    parseArguments(args);
+    setTimeout(DEFAULT_TOOL_TIMEOUT_MS);
+}
+
+bool FileStreamTask::isValid() const {
+    return params_.valid;
+}
+
+std::unique_ptr<AsyncTask> FileStreamTask::create(const MessageId& requestId, const ToolArgs& args) {
+    return std::make_unique<FileStreamTask>(requestId, args);
+}
+
+int FileStreamTask::execute() {
+    if (cancelled_ || finished_) {
+        return TINYMCP_ERROR_CANCELLED;
     }
     
-    int level = gpio_get_level((gpio_num_t)pin);
-    *state = (level == 1);
+    uint32_t bytesSent = 0;
+    uint32_t chunksSent = 0;
+    uint32_t fileSize = 0;
+    int result = streamFile(bytesSent, chunksSent, fileSize);
     
-    return TINYMCP_SUCCESS;
+    if (result == TINYMCP_SUCCESS) {
+        cJSON* summary = cJSON_CreateObject();
+        cJSON_AddStringToObject(summary, "status", "success");
+        cJSON_AddStringToObject(summary, "path", params_.path.c_str());
+        cJSON_AddNumberToObject(summary, "offset", params_.offset);
+        cJSON_AddNumberToObject(summary, "length", bytesSent);
+        cJSON_AddNumberToObject(summary, "size", fileSize);
+        cJSON_AddNumberToObject(summary, "chunks", chunksSent);
+        cJSON_AddStringToObject(summary, "encoding", params_.base64 ? "base64" : "text");
+        response_ = createResponse(summary);
+    } else if (!cancelled_) {
+        ESP_LOGE(TAG, "File stream of %s failed: %d", params_.path.c_str(), result);
+        const char* message = "Failed to stream file";
+        if (result == TINYMCP_ERROR_NO_PROGRESS_TOKEN) {
+            message = "file_stream needs a progressToken in _meta";
+        } else if (result == TINYMCP_ERROR_NOT_FOUND) {
+            message = "File not found";
+        } else if (result == TINYMCP_ERROR_INVALID_STATE) {
+            message = "Progress reporting is disabled";
+        }
+        response_ = createErrorResponse(result, message);
+    }
+    finished_ = true;
+    
+    return result;
 }
 
-bool GPIOControlTool::isValidGPIOPin(int pin) {
-    // ESP8266 has GPIO pins 0-16, but some are restricted
-    return (pin >= 0 && pin <= 16 && pin != 6 && pin != 7 && pin != 8 && pin != 11);
+void FileStreamTask::parseArguments(const ToolArgs& args) {
+    params_.path = args.getString(FILE_STREAM_PATH, "");
+    params_.offset = args.getInt(FILE_STREAM_OFFSET, 0);
+    params_.length = args.getInt(FILE_STREAM_LENGTH, 0);
+    params_.base64 = args.getEnum(FILE_STREAM_ENCODING, 0) == 1;
+    params_.valid = FileSystemTool::isValidPath(params_.path);
 }
 
-// EchoTool implementation
-void EchoTool::registerTool() {
-    auto tool = std::make_unique<ToolRegistry::ToolDefinition>(
-        "echo",
-        "Simple echo tool that returns the input message for testing",
-        [](const cJSON* args, cJSON** result) { return EchoTool::execute(args, result); }
-    );
+int FileStreamTask::streamFile(uint32_t& bytesSent, uint32_t& chunksSent, uint32_t& fileSize) {
+    // Checked up front so no file is opened for data that cannot be delivered
+    if (progressToken_.empty()) {
+        return TINYMCP_ERROR_NO_PROGRESS_TOKEN;
+    }
     
-    tool->inputSchema = createInputSchema();
-    ToolRegistry::getInstance().registerTool(std::move(tool));
-}
-
-int EchoTool::execute(const cJSON* args, cJSON** result) {
-    std::string message = "Hello from TinyMCP!";
+    FILE* file = fopen(FileSystemTool::toFullPath(params_.path).c_str(), "rb");
+    if (!file) {
+        return TINYMCP_ERROR_NOT_FOUND;
+    }
     
-    if (args) {
-        ToolHelpers::validateStringParam(args, "message", message, false);
+    struct stat info;
+    fileSize = fstat(fileno(file), &info) == 0 ? static_cast<uint32_t>(info.st_size) : 0;
+    if (params_.offset > fileSize || fseek(file, params_.offset, SEEK_SET) != 0) {
+        fclose(file);
+        return TINYMCP_ERROR_INVALID_PARAMS;
     }
     
-    cJSON* response = cJSON_CreateObject();
-    cJSON_AddStringToObject(response, "echo", message.c_str());
-    cJSON_AddNumberToObject(response, "timestamp", xTaskGetTickCount() * portTICK_PERIOD_MS);
-    cJSON_AddStringToObject(response, "source", "ESP8266 TinyMCP Server");
+    uint32_t remaining = fileSize - params_.offset;
+    if (params_.length > 0) {
+        remaining = std::min(remaining, params_.length);
+    }
     
-    *result = response;
-    return TINYMCP_SUCCESS;
+    // progress counts bytes delivered out of the requested range
+    const int total = std::max<int>(remaining, 1);
+    int result = TINYMCP_SUCCESS;
+    while (remaining > 0) {
+        if (cancelled_) {
+            result = TINYMCP_ERROR_CANCELLED;
+            break;
+        }
+        
+        size_t wanted = std::min<size_t>(remaining, sizeof(chunk_));
+        size_t got = fread(chunk_, 1, wanted, file);
+        if (got == 0) {
+            result = ferror(file) ? TINYMCP_ERROR_HARDWARE_FAILED : TINYMCP_SUCCESS;
+            break;
+        }
+        
+        const char* data = chunk_;
+        size_t length = got;
+        if (params_.base64) {
+            length = ToolHelpers::base64Encode(reinterpret_cast<const uint8_t*>(chunk_), got, encoded_);
+            data = encoded_;
+        }
+        
+        result = reportPartialResult(bytesSent + got, total, data, length);
+        if (result != TINYMCP_SUCCESS) {
+            break;
+        }
+        
+        bytesSent += got;
+        remaining -= got;
+        chunksSent++;
+    }
+    
+    fclose(file);
+    return result;
 }
 
-cJSON* EchoTool::createInputSchema() {
-    return ToolHelpers::createObjectSchema({
-        {"message", ToolHelpers::createStringProperty("Message to echo back", false)}
-    });
-}
+// LongRunningTask implementation
+static constexpr char LONG_RUNNING_SCHEMA[] =
+    R"json({"type":"object","properties":{)json"
+    R"json("duration_seconds":{"type":"integer","description":"Total duration in seconds","minimum":1,"maximum":60},)json"
+    R"json("step_count":{"type":"integer","description":"Number of progress steps","minimum":1,"maximum":100},)json"
+    R"json("simulate_error":{"type":"boolean","description":"Fail halfway through"},)json"
+    R"json("message":{"type":"string","description":"Message returned on completion"}}})json";
+static constexpr int LONG_RUNNING_DURATION_SECONDS = SchemaText::propertyIndex(LONG_RUNNING_SCHEMA, "duration_seconds");
+static constexpr int LONG_RUNNING_STEP_COUNT = SchemaText::propertyIndex(LONG_RUNNING_SCHEMA, "step_count");
+static constexpr int LONG_RUNNING_SIMULATE_ERROR = SchemaText::propertyIndex(LONG_RUNNING_SCHEMA, "simulate_error");
+static constexpr int LONG_RUNNING_MESSAGE = SchemaText::propertyIndex(LONG_RUNNING_SCHEMA, "message");
 
-// NetworkScannerTask implementation
-NetworkScannerTask::NetworkScannerTask(const MessageId& requestId, const cJSON* args) :
-    AsyncTask(requestId, "network_scan"), scanResults_(nullptr) {
+LongRunningTask::LongRunningTask(const MessageId& requestId, const ToolArgs& args) :
+    AsyncTask(requestId, "long_running_task") {
     
     parseArguments(args);
-    setTimeout(params_.timeoutMs);
+    setTimeout(params_.durationSeconds * 1000 + 5000);
 }
 
-bool NetworkScannerTask::isValid() const {
-    return params_.maxResults > 0 && params_.timeoutMs > 0;
+bool LongRunningTask::isValid() const {
+    return params_.durationSeconds > 0 && params_.stepCount > 0;
 }
 
-std::unique_ptr<AsyncTask> NetworkScannerTask::create(const MessageId& requestId, const cJSON* args) {
-    return std::make_unique<NetworkScannerTask>(requestId, args);
+std::unique_ptr<AsyncTask> LongRunningTask::create(const MessageId& requestId, const ToolArgs& args) {
+    return std::make_unique<LongRunningTask>(requestId, args);
 }
 
-void NetworkScannerTask::registerTool() {
+void LongRunningTask::registerTool() {
     auto tool = std::make_unique<ToolRegistry::ToolDefinition>(
-        "network_scan",
-        "Scan for available WiFi networks (async operation with progress reporting)",
+        "long_running_task",
+        "Simulated long operation that reports progress at every step",
         nullptr, // No synchronous handler
         true,    // Requires async
         10000    // Estimated 10 seconds
     );
     
-    tool->inputSchema = createInputSchema();
+    tool->createTask = &LongRunningTask::create;
+    tool->inputSchema = cJSON_Parse(LONG_RUNNING_SCHEMA);
     ToolRegistry::getInstance().registerTool(std::move(tool));
 }
 
-int NetworkScannerTask::execute() {
+int LongRunningTask::execute() {
     if (cancelled_ || finished_) {
         return TINYMCP_ERROR_CANCELLED;
     }
     
-    ESP_LOGI(TAG, "Starting WiFi network scan");
-    
-    reportProgress(0, 100, "Starting WiFi scan...");
-    
-    int result = performWiFiScan();
+    int result = performLongRunningWork();
     
     if (result == TINYMCP_SUCCESS) {
-        reportProgress(100, 100, "WiFi scan completed");
-        finished_ = true;
+        cJSON* summary = cJSON_CreateObject();
+        cJSON_AddStringToObject(summary, "message", params_.message.c_str());
+        cJSON_AddNumberToObject(summary, "steps", params_.stepCount);
+        cJSON_AddNumberToObject(summary, "duration_seconds", params_.durationSeconds);
+        response_ = createResponse(summary);
     } else {
-        finished_ = true;
-        ESP_LOGE(TAG, "WiFi scan failed: %d", result);
+        ESP_LOGE(TAG, "Long running task failed: %d", result);
+        response_ = createErrorResponse(result, result == TINYMCP_ERROR_CANCELLED ?
+                                        "Task cancelled" : "Simulated failure");
     }
+    finished_ = true;
     
     return result;
 }
 
-cJSON* NetworkScannerTask::createInputSchema() {
-    return ToolHelpers::createObjectSchema({
-        {"include_bssid", ToolHelpers::createBooleanProperty("Include BSSID in results", false)},
-        {"include_rssi", ToolHelpers::createBooleanProperty("Include signal strength", false)},
-        {"include_channel", ToolHelpers::createBooleanProperty("Include channel information", false)},
-        {"max_results", ToolHelpers::createIntegerProperty("Maximum number of results", 1, 50, false)},
-        {"timeout_ms", ToolHelpers::createIntegerProperty("Scan timeout in milliseconds", 1000, 30000, false)}
-    });
+void LongRunningTask::parseArguments(const ToolArgs& args) {
+    params_.durationSeconds = args.getInt(LONG_RUNNING_DURATION_SECONDS, params_.durationSeconds);
+    params_.stepCount = args.getInt(LONG_RUNNING_STEP_COUNT, params_.stepCount);
+    params_.simulateError = args.getBool(LONG_RUNNING_SIMULATE_ERROR, false);
+    params_.message = args.getString(LONG_RUNNING_MESSAGE, "Long running task completed");
 }
 
-int NetworkScannerTask::performWiFiScan() {
-    wifi_scan_config_t scan_config = {};
-    scan_config.ssid = nullptr;
-    scan_config.bssid = nullptr;
-    scan_config.channel = 0;
-    scan_config.show_hidden = false;
-    scan_config.scan_type = WIFI_SCAN_TYPE_ACTIVE;
-    scan_config.scan_time.active.min = 100;
-    scan_config.scan_time.active.max = 300;
-    
-    if (esp_wifi_scan_start(&scan_config, true) != ESP_OK) {
-        return TINYMCP_ERROR_HARDWARE_FAILED;
-    }
-    
-    reportProgress(50, 100, "Scanning networks...");
-    
-    uint16_t number = params_.maxResults;
-    wifi_ap_record_t* ap_info = (wifi_ap_record_t*)malloc(sizeof(wifi_ap_record_t) * number);
-    if (!ap_info) {
-        return TINYMCP_ERROR_OUT_OF_MEMORY;
-    }
-    
-    if (esp_wifi_scan_get_ap_records(&number, ap_info) != ESP_OK) {
-        free(ap_info);
-        return TINYMCP_ERROR_HARDWARE_FAILED;
-    }
+int LongRunningTask::performLongRunningWork() {
+    TickType_t stepTicks = pdMS_TO_TICKS(params_.durationSeconds * 1000 / params_.stepCount);
     
-    // Format results
-    scanResults_ = cJSON_CreateArray();
-    for (int i = 0; i < number; i++) {
-        cJSON* network = cJSON_CreateObject();
-        cJSON_AddStringToObject(network, "ssid", (char*)ap_info[i].ssid);
-        
-        if (params_.includeRSSI) {
-            cJSON_AddNumberToObject(network, "rssi", ap_info[i].rssi);
-        }
+    for (uint32_t step = 1; step <= params_.stepCount; ++step) {
+        vTaskDelay(stepTicks);
         
-        if (params_.includeChannel) {
-            cJSON_AddNumberToObject(network, "channel", ap_info[i].primary);
+        if (cancelled_) {
+            return TINYMCP_ERROR_CANCELLED;
         }
         
-        if (params_.includeBSSID) {
-            char bssid_str[18];
-            snprintf(bssid_str, sizeof(bssid_str), "%02x:%02x:%02x:%02x:%02x:%02x",
-                    ap_info[i].bssid[0], ap_info[i].bssid[1], ap_info[i].bssid[2],
-                    ap_info[i].bssid[3], ap_info[i].bssid[4], ap_info[i].bssid[5]);
-            cJSON_AddStringToObject(network, "bssid", bssid_str);
+        if (params_.simulateError && step * 2 > params_.stepCount) {
+            return TINYMCP_ERROR_INVALID_OPERATION;
         }
         
-        cJSON_AddItemToArray(scanResults_, network);
+        reportProgress(step, params_.stepCount, "Working...");
     }
     
-    free(ap_info);
     return TINYMCP_SUCCESS;
 }
 
-void NetworkScannerTask::parseArguments(const cJSON* args) {
-    if (!args) return;
-    
-    ToolHelpers::validateBoolParam(args, "include_bssid", params_.includeBSSID, false);
-    ToolHelpers::validateBoolParam(args, "include_rssi", params_.includeRSSI, false);
-    ToolHelpers::validateBoolParam(args, "include_channel", params_.includeChannel, false);
-    ToolHelpers::validateIntParam(args, "max_results", params_.maxResults, false);
-    ToolHelpers::validateIntParam(args, "timeout_ms", (int&)params_.timeoutMs, false);
-}
-
 // ToolHelpers implementation
 namespace ToolHelpers {
 
@@ -574,6 +1802,20 @@ cJSON* createEnumProperty(const std::string& description, const std::vector<std:
     return prop;
 }
 
+cJSON* createArrayProperty(const std::string& description, cJSON* items, int maxItems, bool required) {
+    cJSON* prop = cJSON_CreateObject();
+    cJSON_AddStringToObject(prop, "type", "array");
+    cJSON_AddStringToObject(prop, "description", description.c_str());
+    if (items) {
+        cJSON_AddItemToObject(prop, "items", items);
+    }
+    if (maxItems != INT_MAX) cJSON_AddNumberToObject(prop, "maxItems", maxItems);
+    if (required) {
+        cJSON_AddBoolToObject(prop, "required", true);
+    }
+    return prop;
+}
+
 cJSON* createObjectSchema(const std::vector<std::pair<std::string, cJSON*>>& properties) {
     cJSON* schema = cJSON_CreateObject();
     cJSON_AddStringToObject(schema, "type", "object");
@@ -674,16 +1916,121 @@ std::string formatDuration(uint32_t milliseconds) {
     }
 }
 
+size_t base64Encode(const uint8_t* data, size_t length, char* out) {
+    static const char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    
+    char* start = out;
+    size_t i = 0;
+    for (; i + 2 < length; i += 3) {
+        uint32_t triple = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+        *out++ = ALPHABET[(triple >> 18) & 0x3F];
+        *out++ = ALPHABET[(triple >> 12) & 0x3F];
+        *out++ = ALPHABET[(triple >> 6) & 0x3F];
+        *out++ = ALPHABET[triple & 0x3F];
+    }
+    if (i < length) {
+        uint32_t triple = data[i] << 16;
+        if (i + 1 < length) {
+            triple |= data[i + 1] << 8;
+        }
+        *out++ = ALPHABET[(triple >> 18) & 0x3F];
+        *out++ = ALPHABET[(triple >> 12) & 0x3F];
+        *out++ = i + 1 < length ? ALPHABET[(triple >> 6) & 0x3F] : '=';
+        *out++ = '=';
+    }
+    *out = '\0';
+    return out - start;
+}
+
+bool base64Decode(const std::string& in, std::string& out) {
+    if (in.size() % 4 != 0) {
+        return false;
+    }
+    
+    out.clear();
+    out.reserve(in.size() / 4 * 3);
+    uint32_t bits = 0;
+    int count = 0;
+    size_t padding = 0;
+    for (size_t i = 0; i < in.size(); ++i) {
+        char c = in[i];
+        int value;
+        if (c >= 'A' && c <= 'Z') {
+            value = c - 'A';
+        } else if (c >= 'a' && c <= 'z') {
+            value = c - 'a' + 26;
+        } else if (c >= '0' && c <= '9') {
+            value = c - '0' + 52;
+        } else if (c == '+') {
+            value = 62;
+        } else if (c == '/') {
+            value = 63;
+        } else if (c == '=' && i + 2 >= in.size()) {
+            value = 0;
+            padding++;
+        } else {
+            return false;
+        }
+        if (padding > 0 && c != '=') {
+            return false;
+        }
+        
+        bits = (bits << 6) | value;
+        if (++count == 4) {
+            out += static_cast<char>((bits >> 16) & 0xFF);
+            out += static_cast<char>((bits >> 8) & 0xFF);
+            out += static_cast<char>(bits & 0xFF);
+            bits = 0;
+            count = 0;
+        }
+    }
+    out.resize(out.size() - padding);
+    return true;
+}
+
 } // namespace ToolHelpers
 
+// Built-in tools, sorted by name. Everything here is constant and stays in
+// flash; the file tools drop out when no SPIFFS partition backs them.
+static constexpr StaticToolDefinition STATIC_TOOLS[] = {
+    {"echo",
+     "Simple echo tool that returns the input message for testing",
+     ECHO_SCHEMA, &EchoTool::execute, nullptr, 1000, nullptr},
+    {"file_stream",
+     "Stream a SPIFFS file range as progress notifications carrying the data; needs a progressToken",
+     FILE_STREAM_SCHEMA, nullptr, &FileStreamTask::create, 10000, &FileSystemTool::mount},
+    {"file_system",
+     "List, read, write, append, delete and inspect files on SPIFFS; reads take an offset and length",
+     FILE_SYSTEM_SCHEMA, &FileSystemTool::execute, nullptr, 500, &FileSystemTool::mount},
+    {"gpio_batch",
+     "Configure and set several GPIO pins at once, then run an optional timed sequence of level changes",
+     GPIO_BATCH_SCHEMA, &GPIOControlTool::executeBatch, nullptr, GPIO_BATCH_MAX_DURATION_US / 1000,
+     &GPIOControlTool::init},
+    {"gpio_control",
+     "Control ESP8266/ESP32 GPIO pins - set output state or read input state",
+     GPIO_CONTROL_SCHEMA, &GPIOControlTool::execute, nullptr, 1000, &GPIOControlTool::init},
+    {"network_scan",
+     "Scan for available WiFi networks (async operation with progress reporting)",
+     NETWORK_SCAN_SCHEMA, nullptr, &NetworkScannerTask::create, 10000, nullptr},
+#if TINYMCP_METRICS
+    {"server_stats",
+     "Get per-method latency histograms (parse, queue wait, execute, send), heap low-water marks and executor counters",
+     SERVER_STATS_SCHEMA, &ServerStatsTool::execute, nullptr, 100, nullptr},
+#endif
+    {"system_info",
+     "Get ESP8266/ESP32 system information including memory, WiFi status, and running tasks",
+     SYSTEM_INFO_SCHEMA, &SystemInfoTool::execute, nullptr, 1000, nullptr},
+};
+
+static_assert(isSortedToolTable(STATIC_TOOLS), "STATIC_TOOLS must be sorted by name");
+static_assert(sizeof(STATIC_TOOLS) / sizeof(STATIC_TOOLS[0]) <= ToolRegistry::MAX_STATIC_TOOLS,
+              "too many static tools");
+
 // Default tool registration
 void registerDefaultTools() {
     ESP_LOGI(TAG, "Registering default tools...");
     
-    SystemInfoTool::registerTool();
-    GPIOControlTool::registerTool();
-    EchoTool::registerTool();
-    NetworkScannerTask::registerTool();
+    ToolRegistry::getInstance().setStaticTools(STATIC_TOOLS, sizeof(STATIC_TOOLS) / sizeof(STATIC_TOOLS[0]));
     
     ESP_LOGI(TAG, "Default tools registered");
 }
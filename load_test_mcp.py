@@ -0,0 +1,626 @@
+#!/usr/bin/env python3
+"""
+ESP8266 MCP Load Generator
+
+Opens N concurrent sessions against the EspSocketServer and drives a weighted
+mix of requests for capacity planning. Reports sustained requests/second,
+p50/p95/p99 latency, error and drop counts, and device heap over time sampled
+through the system_info tool on a separate monitor session.
+
+Requests that never get an answer within --timeout are counted as drops.
+Requests the server refuses with TINYMCP_ERROR_RESOURCE_LIMIT (full message
+queue or low heap) are counted as rejections; a full queue is also logged on
+the device as "Message queue full, rejecting message". With --serial the UART
+log is tailed as well and those lines are counted directly (requires
+pyserial).
+
+Usage:
+    python load_test_mcp.py <ESP8266_IP> [options]
+
+Example:
+    python load_test_mcp.py 192.168.1.100 --sessions 3 --duration 30
+    python load_test_mcp.py 192.168.1.100 --mix ping:5,echo:3,gpio_control:1 --pipeline 4
+    python load_test_mcp.py 127.0.0.1 --batch 8 --json   # against tinymcp_host_server
+    python load_test_mcp.py 192.168.1.100 --encoding cbor  # negotiate CBOR frames
+"""
+
+import argparse
+import json
+import random
+import socket
+import struct
+import sys
+import threading
+import time
+from dataclasses import dataclass, field
+from typing import Any, Dict, List, Optional, Tuple
+
+
+DEFAULT_MIX = "ping:4,echo:4,tools_list:1,gpio_control:1"
+DROP_LOG_LINE = "Message queue full, rejecting message"
+RESOURCE_LIMIT_CODE = -32011  # TINYMCP_ERROR_RESOURCE_LIMIT
+
+
+def build_request(kind: str, payload: str, gpio_pin: int) -> Tuple[str, Optional[Dict[str, Any]]]:
+    """Map a mix entry to a JSON-RPC method and params."""
+    if kind == "ping":
+        return "ping", None
+    if kind == "tools_list":
+        return "tools/list", None
+    if kind == "echo":
+        return "tools/call", {"name": "echo", "arguments": {"message": payload}}
+    if kind == "gpio_control":
+        return "tools/call", {"name": "gpio_control", "arguments": {"operation": "get", "pin": gpio_pin}}
+    if kind == "network_scan":
+        return "tools/call", {"name": "network_scan", "arguments": {"max_results": 5}}
+    if kind == "system_info":
+        return "tools/call", {"name": "system_info", "arguments": {}}
+    raise ValueError(f"unknown request kind: {kind}")
+
+
+def parse_mix(spec: str) -> List[Tuple[str, int]]:
+    """Parse 'ping:4,echo:2' into [(kind, weight)]."""
+    mix = []
+    for entry in spec.split(","):
+        entry = entry.strip()
+        if not entry:
+            continue
+        kind, _, weight = entry.partition(":")
+        build_request(kind, "", 0)  # validates the name
+        mix.append((kind, int(weight) if weight else 1))
+    if not mix or sum(w for _, w in mix) <= 0:
+        raise ValueError("request mix must have a positive total weight")
+    return mix
+
+
+def percentile(sorted_values: List[float], pct: float) -> float:
+    """Nearest-rank percentile of an already sorted list."""
+    if not sorted_values:
+        return 0.0
+    rank = max(0, min(len(sorted_values) - 1, int(round(pct / 100.0 * len(sorted_values) + 0.5)) - 1))
+    return sorted_values[rank]
+
+
+def cbor_encode(value: Any) -> bytes:
+    """Minimal CBOR encoder for the JSON data model."""
+    def header(major: int, argument: int) -> bytes:
+        if argument < 24:
+            return bytes([major << 5 | argument])
+        for info, size in ((24, 1), (25, 2), (26, 4), (27, 8)):
+            if argument < 1 << (8 * size):
+                return bytes([major << 5 | info]) + argument.to_bytes(size, "big")
+        raise ValueError("integer too large for CBOR")
+
+    if value is None:
+        return b"\xf6"
+    if value is True:
+        return b"\xf5"
+    if value is False:
+        return b"\xf4"
+    if isinstance(value, int):
+        return header(0, value) if value >= 0 else header(1, -1 - value)
+    if isinstance(value, float):
+        return b"\xfb" + struct.pack(">d", value)
+    if isinstance(value, str):
+        data = value.encode("utf-8")
+        return header(3, len(data)) + data
+    if isinstance(value, (list, tuple)):
+        return header(4, len(value)) + b"".join(cbor_encode(v) for v in value)
+    if isinstance(value, dict):
+        return header(5, len(value)) + b"".join(cbor_encode(k) + cbor_encode(v) for k, v in value.items())
+    raise TypeError(f"cannot encode {type(value).__name__} as CBOR")
+
+
+def cbor_decode(data: bytes) -> Any:
+    """Minimal CBOR decoder covering what the server emits."""
+    def item(pos: int) -> Tuple[Any, int]:
+        initial = data[pos]
+        major, info = initial >> 5, initial & 0x1F
+        pos += 1
+        if major == 7:
+            if info == 20:
+                return False, pos
+            if info == 21:
+                return True, pos
+            if info in (22, 23):
+                return None, pos
+            if info == 25:
+                return struct.unpack(">e", data[pos:pos + 2])[0], pos + 2
+            if info == 26:
+                return struct.unpack(">f", data[pos:pos + 4])[0], pos + 4
+            if info == 27:
+                return struct.unpack(">d", data[pos:pos + 8])[0], pos + 8
+            raise ValueError(f"unsupported simple value {info}")
+        indefinite = info == 31
+        argument = 0
+        if info < 24:
+            argument = info
+        elif 24 <= info <= 27:
+            size = 1 << (info - 24)
+            argument = int.from_bytes(data[pos:pos + size], "big")
+            pos += size
+        elif not indefinite:
+            raise ValueError("reserved additional information")
+        if major == 0:
+            return argument, pos
+        if major == 1:
+            return -1 - argument, pos
+        if major == 3:
+            if not indefinite:
+                return data[pos:pos + argument].decode("utf-8"), pos + argument
+            chunks = []
+            while data[pos] != 0xFF:
+                chunk, pos = item(pos)
+                chunks.append(chunk)
+            return "".join(chunks), pos + 1
+        if major in (4, 5):
+            result: Any = [] if major == 4 else {}
+            count = 0
+            while (data[pos] != 0xFF) if indefinite else (count < argument):
+                if major == 4:
+                    value, pos = item(pos)
+                    result.append(value)
+                else:
+                    key, pos = item(pos)
+                    result[key], pos = item(pos)
+                count += 1
+            return result, pos + 1 if indefinite else pos
+        if major == 6:
+            return item(pos)
+        raise ValueError(f"unsupported major type {major}")
+
+    value, end = item(0)
+    if end != len(data):
+        raise ValueError("trailing bytes after CBOR item")
+    return value
+
+
+class FramedConnection:
+    """TCP connection speaking the server's framing (4-byte length prefix or newline)."""
+
+    def __init__(self, host: str, port: int, framing: str, timeout: float):
+        self.framing = framing
+        self.encoding = "json"   # switched once the server accepts CBOR during initialize
+        self.sock = socket.create_connection((host, port), timeout=timeout)
+        self.sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        self.buffer = b""
+
+    def close(self):
+        try:
+            self.sock.close()
+        except OSError:
+            pass
+
+    def send(self, message: Any):
+        if self.encoding == "cbor":
+            data = cbor_encode(message)
+        else:
+            data = json.dumps(message, separators=(",", ":")).encode("utf-8")
+        if self.framing == "length":
+            self.sock.sendall(len(data).to_bytes(4, byteorder="big") + data)
+        else:
+            self.sock.sendall(data + b"\n")
+
+    def _extract(self) -> Optional[bytes]:
+        if self.framing == "length":
+            if len(self.buffer) < 4:
+                return None
+            length = int.from_bytes(self.buffer[:4], byteorder="big")
+            if len(self.buffer) < 4 + length:
+                return None
+            frame, self.buffer = self.buffer[4:4 + length], self.buffer[4 + length:]
+            return frame
+        newline = self.buffer.find(b"\n")
+        if newline < 0:
+            return None
+        frame, self.buffer = self.buffer[:newline], self.buffer[newline + 1:]
+        return frame
+
+    def receive(self, timeout: float) -> Optional[Any]:
+        """Return the next decoded frame, or None on timeout. Raises ConnectionError on close."""
+        deadline = time.monotonic() + timeout
+        while True:
+            frame = self._extract()
+            if frame is not None:
+                # CBOR replies start with a map or array header, never with JSON text
+                if frame and 0x80 <= frame[0] <= 0xBF:
+                    return cbor_decode(frame)
+                return json.loads(frame.decode("utf-8"))
+            remaining = deadline - time.monotonic()
+            if remaining <= 0:
+                return None
+            self.sock.settimeout(remaining)
+            try:
+                chunk = self.sock.recv(4096)
+            except socket.timeout:
+                return None
+            if not chunk:
+                raise ConnectionError("connection closed by server")
+            self.buffer += chunk
+
+
+@dataclass
+class SessionStats:
+    sent: int = 0
+    completed: int = 0
+    errors: int = 0
+    rejected: int = 0
+    drops: int = 0
+    disconnects: int = 0
+    latencies_ms: List[float] = field(default_factory=list)
+    error_codes: Dict[str, int] = field(default_factory=dict)
+
+
+class LoadSession(threading.Thread):
+    """One client session keeping up to `pipeline` requests (or batches) in flight."""
+
+    def __init__(self, index: int, args: argparse.Namespace, mix: List[Tuple[str, int]],
+                 stop_event: threading.Event, start_barrier: threading.Barrier):
+        super().__init__(name=f"load-{index}", daemon=True)
+        self.index = index
+        self.args = args
+        self.kinds = [k for k, _ in mix]
+        self.weights = [w for _, w in mix]
+        self.stop_event = stop_event
+        self.start_barrier = start_barrier
+        self.stats = SessionStats()
+        self.payload = "x" * args.payload_bytes
+        self.rng = random.Random(args.seed + index)
+        self.next_id = 0
+        # id -> (send time, kind); a batch shares one send time across its ids
+        self.in_flight: Dict[int, Tuple[float, str]] = {}
+
+    def _new_request(self) -> Dict[str, Any]:
+        kind = self.rng.choices(self.kinds, weights=self.weights)[0]
+        method, params = build_request(kind, self.payload, self.args.gpio_pin)
+        self.next_id += 1
+        request = {"jsonrpc": "2.0", "id": self.next_id, "method": method}
+        if params is not None:
+            request["params"] = params
+        self.in_flight[self.next_id] = (0.0, kind)
+        return request
+
+    def _handshake(self, conn: FramedConnection) -> bool:
+        capabilities: Dict[str, Any] = {}
+        if self.args.encoding != "json":
+            capabilities["experimental"] = {"encoding": {"formats": [self.args.encoding]}}
+        conn.send({
+            "jsonrpc": "2.0", "id": 0, "method": "initialize",
+            "params": {
+                "protocolVersion": "2024-11-05",
+                "capabilities": capabilities,
+                "clientInfo": {"name": "ESP8266-MCP-Load-Generator", "version": "1.0.0"},
+            },
+        })
+        deadline = time.monotonic() + self.args.timeout
+        while time.monotonic() < deadline:
+            reply = conn.receive(deadline - time.monotonic())
+            if isinstance(reply, dict) and reply.get("id") == 0:
+                if "result" not in reply:
+                    return False
+                encoding = reply["result"].get("capabilities", {}).get("experimental", {}).get("encoding", {})
+                if self.args.encoding != "json":
+                    if encoding.get("format") != self.args.encoding:
+                        return False
+                    conn.encoding = self.args.encoding
+                conn.send({"jsonrpc": "2.0", "method": "notifications/initialized"})
+                return True
+        return False
+
+    def _send_next(self, conn: FramedConnection):
+        if self.args.batch > 1:
+            batch = [self._new_request() for _ in range(self.args.batch)]
+            now = time.monotonic()
+            for request in batch:
+                self.in_flight[request["id"]] = (now, self.in_flight[request["id"]][1])
+            conn.send(batch)
+            self.stats.sent += len(batch)
+        else:
+            request = self._new_request()
+            self.in_flight[request["id"]] = (time.monotonic(), self.in_flight[request["id"]][1])
+            conn.send(request)
+            self.stats.sent += 1
+
+    def _record(self, reply: Any):
+        replies = reply if isinstance(reply, list) else [reply]
+        now = time.monotonic()
+        for item in replies:
+            if not isinstance(item, dict) or "id" not in item:
+                continue  # progress and other notifications
+            entry = self.in_flight.pop(item["id"], None)
+            if entry is None:
+                continue  # already expired as a drop
+            self.stats.completed += 1
+            self.stats.latencies_ms.append((now - entry[0]) * 1000.0)
+            error = item.get("error")
+            if error is None and isinstance(item.get("result"), dict) and item["result"].get("isError"):
+                error = {"code": "isError"}
+            if error is not None:
+                self.stats.errors += 1
+                code = str(error.get("code", "unknown")) if isinstance(error, dict) else "unknown"
+                self.stats.error_codes[code] = self.stats.error_codes.get(code, 0) + 1
+                if code == str(RESOURCE_LIMIT_CODE):
+                    self.stats.rejected += 1
+
+    def _expire(self):
+        cutoff = time.monotonic() - self.args.timeout
+        for request_id in [i for i, (sent, _) in self.in_flight.items() if sent < cutoff]:
+            del self.in_flight[request_id]
+            self.stats.drops += 1
+
+    def _window_full(self) -> bool:
+        window = self.args.pipeline * max(1, self.args.batch)
+        return len(self.in_flight) + max(1, self.args.batch) > window
+
+    def run(self):
+        conn = None
+        try:
+            conn = FramedConnection(self.args.host, self.args.port, self.args.framing, self.args.timeout)
+            handshake_ok = self._handshake(conn)
+        except (OSError, ValueError, ConnectionError):
+            handshake_ok = False
+        try:
+            self.start_barrier.wait()
+        except threading.BrokenBarrierError:
+            pass
+        if not handshake_ok:
+            self.stats.disconnects += 1
+            if conn:
+                conn.close()
+            return
+
+        sent_limit = self.args.requests if self.args.requests > 0 else None
+        try:
+            while True:
+                stopping = self.stop_event.is_set() or (sent_limit is not None and self.stats.sent >= sent_limit)
+                if stopping and not self.in_flight:
+                    break
+                if not stopping and not self._window_full():
+                    self._send_next(conn)
+                    continue
+                reply = conn.receive(min(0.2, self.args.timeout))
+                if reply is not None:
+                    self._record(reply)
+                self._expire()
+        except (OSError, ValueError, ConnectionError):
+            self.stats.disconnects += 1
+            self.stats.drops += len(self.in_flight)
+            self.in_flight.clear()
+        finally:
+            conn.close()
+
+
+class HeapMonitor(threading.Thread):
+    """Samples free heap through system_info on its own session."""
+
+    def __init__(self, args: argparse.Namespace, stop_event: threading.Event):
+        super().__init__(name="heap-monitor", daemon=True)
+        self.args = args
+        self.stop_event = stop_event
+        self.samples: List[Tuple[float, int, int]] = []
+        self.failures = 0
+
+    def run(self):
+        start = time.monotonic()
+        try:
+            conn = FramedConnection(self.args.host, self.args.port, self.args.framing, self.args.timeout)
+            session = LoadSession(-1, self.args, [("system_info", 1)], self.stop_event, threading.Barrier(1))
+            if not session._handshake(conn):
+                self.failures += 1
+                conn.close()
+                return
+        except (OSError, ValueError, ConnectionError):
+            self.failures += 1
+            return
+
+        request_id = 1000000
+        try:
+            while not self.stop_event.is_set():
+                request_id += 1
+                method, params = build_request("system_info", "", 0)
+                conn.send({"jsonrpc": "2.0", "id": request_id, "method": method, "params": params})
+                deadline = time.monotonic() + self.args.timeout
+                while time.monotonic() < deadline:
+                    reply = conn.receive(deadline - time.monotonic())
+                    if isinstance(reply, dict) and reply.get("id") == request_id:
+                        self._record(time.monotonic() - start, reply)
+                        break
+                else:
+                    self.failures += 1
+                self.stop_event.wait(self.args.heap_interval)
+        except (OSError, ValueError, ConnectionError):
+            self.failures += 1
+        finally:
+            conn.close()
+
+    def _record(self, elapsed: float, reply: Dict[str, Any]):
+        try:
+            text = reply["result"]["content"][0]["text"]
+            memory = json.loads(text)["memory"]
+            self.samples.append((elapsed, int(memory["free_heap"]), int(memory["minimum_free_heap"])))
+        except (KeyError, IndexError, TypeError, ValueError):
+            self.failures += 1
+
+
+class SerialDropCounter(threading.Thread):
+    """Counts queue-full drop lines on the device UART."""
+
+    def __init__(self, port: str, baud_rate: int, stop_event: threading.Event):
+        super().__init__(name="serial-drops", daemon=True)
+        import serial  # optional dependency, only needed with --serial
+        self.serial_conn = serial.Serial(port, baud_rate, timeout=0.2)
+        self.stop_event = stop_event
+        self.drops = 0
+
+    def run(self):
+        while not self.stop_event.is_set():
+            line = self.serial_conn.readline().decode("utf-8", errors="ignore")
+            if DROP_LOG_LINE in line:
+                self.drops += 1
+        self.serial_conn.close()
+
+
+def summarize(args, sessions: List[LoadSession], monitor: Optional[HeapMonitor],
+              serial_counter: Optional[SerialDropCounter], elapsed: float) -> Dict[str, Any]:
+    latencies = sorted(l for s in sessions for l in s.stats.latencies_ms)
+    error_codes: Dict[str, int] = {}
+    for s in sessions:
+        for code, count in s.stats.error_codes.items():
+            error_codes[code] = error_codes.get(code, 0) + count
+    completed = sum(s.stats.completed for s in sessions)
+
+    report = {
+        "target": f"{args.host}:{args.port}",
+        "framing": args.framing,
+        "sessions": args.sessions,
+        "pipeline": args.pipeline,
+        "batch": args.batch,
+        "mix": args.mix,
+        "elapsed_s": round(elapsed, 3),
+        "sent": sum(s.stats.sent for s in sessions),
+        "completed": completed,
+        "rps": round(completed / elapsed, 1) if elapsed > 0 else 0.0,
+        "errors": sum(s.stats.errors for s in sessions),
+        "error_codes": error_codes,
+        "rejected": sum(s.stats.rejected for s in sessions),
+        "drops": sum(s.stats.drops for s in sessions),
+        "disconnects": sum(s.stats.disconnects for s in sessions),
+        "latency_ms": {
+            "p50": round(percentile(latencies, 50), 2),
+            "p95": round(percentile(latencies, 95), 2),
+            "p99": round(percentile(latencies, 99), 2),
+            "max": round(latencies[-1], 2) if latencies else 0.0,
+        },
+    }
+    if serial_counter is not None:
+        report["device_queue_full_drops"] = serial_counter.drops
+    if monitor is not None:
+        report["heap"] = {
+            "samples": [{"t_s": round(t, 1), "free": free, "min_free": low} for t, free, low in monitor.samples],
+            "failures": monitor.failures,
+        }
+    return report
+
+
+def print_report(report: Dict[str, Any]):
+    print("\n" + "=" * 60)
+    print(f"Load test: {report['target']} ({report['framing']} framing)")
+    print(f"  sessions={report['sessions']} pipeline={report['pipeline']} batch={report['batch']}")
+    print(f"  mix={report['mix']}")
+    print("=" * 60)
+    print(f"Elapsed:      {report['elapsed_s']:.1f} s")
+    print(f"Sent:         {report['sent']}")
+    print(f"Completed:    {report['completed']}")
+    print(f"Sustained:    {report['rps']:.1f} req/s")
+    lat = report["latency_ms"]
+    print(f"Latency ms:   p50={lat['p50']:.2f} p95={lat['p95']:.2f} p99={lat['p99']:.2f} max={lat['max']:.2f}")
+    print(f"Errors:       {report['errors']} {report['error_codes'] or ''}")
+    print(f"Rejected:     {report['rejected']} (queue full or low heap)")
+    print(f"Drops:        {report['drops']} (unanswered within timeout)")
+    if "device_queue_full_drops" in report:
+        print(f"Device log:   {report['device_queue_full_drops']} x '{DROP_LOG_LINE}'")
+    print(f"Disconnects:  {report['disconnects']}")
+    if "heap" in report:
+        samples = report["heap"]["samples"]
+        if samples:
+            frees = [s["free"] for s in samples]
+            print(f"Heap free:    start={frees[0]} end={frees[-1]} min={min(frees)} "
+                  f"low-water={min(s['min_free'] for s in samples)} ({len(samples)} samples)")
+            for s in samples:
+                print(f"  t={s['t_s']:>6.1f}s free={s['free']} min_free={s['min_free']}")
+        else:
+            print(f"Heap free:    no samples ({report['heap']['failures']} failures)")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="ESP8266 MCP load generator")
+    parser.add_argument("host", help="Server IP address or hostname")
+    parser.add_argument("--port", type=int, default=8080, help="Server port (default: 8080)")
+    parser.add_argument("--framing", choices=["length", "newline"], default="length",
+                        help="length: 4-byte big-endian prefix (EspSocketServer); newline: legacy MCPServer")
+    parser.add_argument("--sessions", type=int, default=3, help="Concurrent sessions (default: 3)")
+    parser.add_argument("--duration", type=float, default=20.0, help="Seconds to run (default: 20)")
+    parser.add_argument("--requests", type=int, default=0,
+                        help="Requests per session instead of a fixed duration")
+    parser.add_argument("--mix", default=DEFAULT_MIX,
+                        help=f"Weighted request mix of ping, echo, tools_list, gpio_control, network_scan "
+                             f"(default: {DEFAULT_MIX})")
+    parser.add_argument("--pipeline", type=int, default=1,
+                        help="Requests (or batches) kept in flight per session (default: 1)")
+    parser.add_argument("--batch", type=int, default=1, help="Send JSON-RPC batches of this size (default: 1)")
+    parser.add_argument("--payload-bytes", type=int, default=32, help="Echo message size (default: 32)")
+    parser.add_argument("--gpio-pin", type=int, default=2, help="Pin read by gpio_control (default: 2)")
+    parser.add_argument("--timeout", type=float, default=5.0,
+                        help="Seconds before an unanswered request counts as dropped (default: 5)")
+    parser.add_argument("--heap-interval", type=float, default=2.0,
+                        help="Seconds between system_info heap samples, 0 to disable (default: 2)")
+    parser.add_argument("--serial", help="Serial port to count device-side queue-full drops")
+    parser.add_argument("--baud", type=int, default=74880, help="Serial baud rate (default: 74880)")
+    parser.add_argument("--encoding", choices=["json", "cbor"], default="json",
+                        help="Wire format to negotiate during initialize (default: json)")
+    parser.add_argument("--seed", type=int, default=1, help="Random seed for the request mix")
+    parser.add_argument("--json", action="store_true", help="Print the report as JSON")
+    args = parser.parse_args()
+
+    try:
+        mix = parse_mix(args.mix)
+    except ValueError as e:
+        parser.error(str(e))
+    if args.sessions < 1 or args.pipeline < 1 or args.batch < 1:
+        parser.error("--sessions, --pipeline and --batch must be at least 1")
+    if args.encoding != "json" and args.framing != "length":
+        parser.error("--encoding cbor needs --framing length; binary frames may contain newlines")
+
+    stop_event = threading.Event()
+    serial_counter = None
+    if args.serial:
+        try:
+            serial_counter = SerialDropCounter(args.serial, args.baud, stop_event)
+        except Exception as e:
+            print(f"❌ Could not open serial port {args.serial}: {e}", file=sys.stderr)
+            return 1
+        serial_counter.start()
+
+    barrier = threading.Barrier(args.sessions + 1)
+    sessions = [LoadSession(i, args, mix, stop_event, barrier) for i in range(args.sessions)]
+    for s in sessions:
+        s.start()
+
+    if not args.json:
+        print(f"🔗 Opening {args.sessions} sessions to {args.host}:{args.port}...")
+    barrier.wait()
+
+    monitor = None
+    if args.heap_interval > 0:
+        monitor = HeapMonitor(args, stop_event)
+        monitor.start()
+
+    start = time.monotonic()
+    try:
+        if args.requests > 0:
+            for s in sessions:
+                s.join()
+        else:
+            time.sleep(args.duration)
+    except KeyboardInterrupt:
+        pass
+    stop_event.set()
+    for s in sessions:
+        s.join()
+    elapsed = time.monotonic() - start
+    if monitor:
+        monitor.join(args.timeout + 1)
+    if serial_counter:
+        serial_counter.join(1)
+
+    report = summarize(args, sessions, monitor, serial_counter, elapsed)
+    if args.json:
+        print(json.dumps(report, indent=2))
+    else:
+        print_report(report)
+
+    return 0 if report["completed"] > 0 and report["disconnects"] < args.sessions else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
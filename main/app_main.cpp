@@ -4,10 +4,13 @@
 #include "freertos/task.h"
 #include "freertos/event_groups.h"
 #include "esp_system.h"
+#include "esp_attr.h"
 #include "esp_wifi.h"
 #include "esp_event.h"
 #include "esp_log.h"
 #include "nvs_flash.h"
+#include "nvs.h"
+#include "esp_timer.h"
 #include "lwip/err.h"
 #include "lwip/sys.h"
 #include "lwip/sockets.h"
@@ -25,6 +28,18 @@ static const char *TAG = "ESP8266-MCP";
 #define WIFI_PASS      "jerjushanben2135"
 #define WIFI_MAXIMUM_RETRY  5
 
+// Fast boot: join the last access point directly (BSSID and channel saved
+// in NVS) instead of scanning every channel, and keep its address instead
+// of waiting for DHCP. Falls back to a full scan if that access point
+// does not answer.
+#define WIFI_FAST_CONNECT           1
+// Boots in a row on a saved address before DHCP runs again to renew the lease
+#define WIFI_FAST_IP_REUSE_BOOTS    16
+#define WIFI_FAST_RTC_MAGIC         0x46415354
+
+#define FAST_BOOT_NVS_NAMESPACE     "fastboot"
+#define FAST_BOOT_NVS_KEY           "wifi"
+
 // Server configuration
 #define SERVER_PORT    8080
 
@@ -39,6 +54,28 @@ static EventGroupHandle_t s_wifi_event_group;
 
 static int s_retry_num = 0;
 
+/* Last access point that gave us an address, as saved in NVS */
+typedef struct {
+    uint8_t bssid[6];
+    uint8_t channel;
+    tcpip_adapter_ip_info_t ip_info;
+} wifi_fast_record_t;
+
+/* Boots on the saved address since the last DHCP lease. RTC memory survives
+ * resets and deep sleep, so counting boots never writes flash; after a power
+ * cut the magic is gone and the first boot takes a fresh lease. */
+typedef struct {
+    uint32_t magic;
+    uint32_t ip_reuses;
+} wifi_fast_rtc_t;
+
+static wifi_config_t s_wifi_config;
+static wifi_fast_record_t s_fast_record;
+static bool s_fast_connect = false;     // Connecting with s_fast_record
+static bool s_fast_static_ip = false;   // ... on its saved address
+static RTC_DATA_ATTR wifi_fast_rtc_t s_fast_rtc;
+static int64_t s_wifi_start_us = 0;
+
 void print_memory_info(const char* location) {
     size_t free_heap = esp_get_free_heap_size();
     size_t min_free_heap = esp_get_minimum_free_heap_size();
@@ -47,6 +84,90 @@ void print_memory_info(const char* location) {
 }
 
 
+static bool load_fast_record(wifi_fast_record_t* record)
+{
+    nvs_handle handle;
+    if (nvs_open(FAST_BOOT_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return false;
+    }
+
+    size_t length = sizeof(*record);
+    esp_err_t err = nvs_get_blob(handle, FAST_BOOT_NVS_KEY, record, &length);
+    nvs_close(handle);
+    return err == ESP_OK && length == sizeof(*record) && record->channel != 0;
+}
+
+static void save_fast_record(const wifi_fast_record_t* record)
+{
+    nvs_handle handle;
+    esp_err_t err = nvs_open(FAST_BOOT_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (err == ESP_OK) {
+        err = nvs_set_blob(handle, FAST_BOOT_NVS_KEY, record, sizeof(*record));
+        if (err == ESP_OK) {
+            err = nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to save fast connect record: %d", err);
+    }
+}
+
+static void clear_fast_record(void)
+{
+    nvs_handle handle;
+    if (nvs_open(FAST_BOOT_NVS_NAMESPACE, NVS_READWRITE, &handle) == ESP_OK) {
+        nvs_erase_key(handle, FAST_BOOT_NVS_KEY);
+        nvs_commit(handle);
+        nvs_close(handle);
+    }
+}
+
+/* Remembers the access point and address we just got, writing flash only
+ * when the BSSID, channel or address changed */
+static void remember_access_point(const tcpip_adapter_ip_info_t* ip_info)
+{
+    wifi_ap_record_t ap_info;
+    if (esp_wifi_sta_get_ap_info(&ap_info) != ESP_OK) {
+        return;
+    }
+
+    wifi_fast_record_t record;
+    memset(&record, 0, sizeof(record));
+    memcpy(record.bssid, ap_info.bssid, sizeof(record.bssid));
+    record.channel = ap_info.primary;
+    record.ip_info = *ip_info;
+
+    // An address from DHCP starts a new run of reuses
+    if (!s_fast_static_ip) {
+        s_fast_rtc.magic = WIFI_FAST_RTC_MAGIC;
+        s_fast_rtc.ip_reuses = 0;
+    }
+
+    if (memcmp(&record, &s_fast_record, sizeof(record)) != 0) {
+        save_fast_record(&record);
+        s_fast_record = record;
+    }
+}
+
+/* Drops the cached access point and connects the slow way: full scan, DHCP */
+static void start_full_connect(void)
+{
+    clear_fast_record();
+    memset(&s_fast_record, 0, sizeof(s_fast_record));
+
+    s_wifi_config.sta.bssid_set = false;
+    memset(s_wifi_config.sta.bssid, 0, sizeof(s_wifi_config.sta.bssid));
+    s_wifi_config.sta.channel = 0;
+    esp_wifi_set_config(WIFI_IF_STA, &s_wifi_config);
+
+    if (s_fast_static_ip) {
+        tcpip_adapter_dhcpc_start(TCPIP_ADAPTER_IF_STA);
+        s_fast_static_ip = false;
+    }
+    esp_wifi_connect();
+}
+
 extern "C" {
 static esp_err_t event_handler(void* arg, system_event_t* event)
 {
@@ -55,6 +176,14 @@ static esp_err_t event_handler(void* arg, system_event_t* event)
             esp_wifi_connect();
             break;
         case SYSTEM_EVENT_STA_DISCONNECTED:
+            if (s_fast_connect) {
+                // Gone, or moved to another channel: not worth the retries
+                ESP_LOGW(TAG, "fast connect failed (reason %d), scanning",
+                         event->event_info.disconnected.reason);
+                s_fast_connect = false;
+                start_full_connect();
+                break;
+            }
             if (s_retry_num < WIFI_MAXIMUM_RETRY) {
                 esp_wifi_connect();
                 s_retry_num++;
@@ -67,6 +196,10 @@ static esp_err_t event_handler(void* arg, system_event_t* event)
         case SYSTEM_EVENT_STA_GOT_IP:
             ESP_LOGI(TAG, "got ip:" IPSTR, IP2STR(&event->event_info.got_ip.ip_info.ip));
             s_retry_num = 0;
+            s_fast_connect = false;
+            if (WIFI_FAST_CONNECT) {
+                remember_access_point(&event->event_info.got_ip.ip_info);
+            }
             xEventGroupSetBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
             break;
         default:
@@ -79,6 +212,7 @@ static esp_err_t event_handler(void* arg, system_event_t* event)
 void init_wifi(void)
 {
     s_wifi_event_group = xEventGroupCreate();
+    s_wifi_start_us = esp_timer_get_time();
 
     tcpip_adapter_init();
     ESP_ERROR_CHECK(esp_event_loop_create_default());
@@ -88,13 +222,40 @@ void init_wifi(void)
 
     ESP_ERROR_CHECK(esp_event_loop_init(event_handler, NULL));
 
-    wifi_config_t wifi_config = {};
+    wifi_config_t& wifi_config = s_wifi_config;
+    memset(&wifi_config, 0, sizeof(wifi_config));
     strcpy((char*)wifi_config.sta.ssid, WIFI_SSID);
     strcpy((char*)wifi_config.sta.password, WIFI_PASS);
     wifi_config.sta.threshold.authmode = WIFI_AUTH_WPA2_PSK;
     wifi_config.sta.pmf_cfg.capable = true;
     wifi_config.sta.pmf_cfg.required = false;
 
+    // A saved access point skips the scan; a saved address skips DHCP.
+    // The address is reused only for a bounded number of boots, since the
+    // DHCP server does not know we kept it.
+    if (WIFI_FAST_CONNECT && load_fast_record(&s_fast_record)) {
+        memcpy(wifi_config.sta.bssid, s_fast_record.bssid, sizeof(wifi_config.sta.bssid));
+        wifi_config.sta.bssid_set = true;
+        wifi_config.sta.channel = s_fast_record.channel;
+        s_fast_connect = true;
+
+        if (s_fast_rtc.magic != WIFI_FAST_RTC_MAGIC) {
+            s_fast_rtc.magic = WIFI_FAST_RTC_MAGIC;
+            s_fast_rtc.ip_reuses = WIFI_FAST_IP_REUSE_BOOTS;
+        }
+        if (s_fast_rtc.ip_reuses < WIFI_FAST_IP_REUSE_BOOTS && s_fast_record.ip_info.ip.addr != 0) {
+            tcpip_adapter_dhcpc_stop(TCPIP_ADAPTER_IF_STA);
+            s_fast_static_ip = tcpip_adapter_set_ip_info(TCPIP_ADAPTER_IF_STA, &s_fast_record.ip_info) == ESP_OK;
+            if (s_fast_static_ip) {
+                s_fast_rtc.ip_reuses++;
+            } else {
+                tcpip_adapter_dhcpc_start(TCPIP_ADAPTER_IF_STA);
+            }
+        }
+        ESP_LOGI(TAG, "fast connect to " MACSTR " on channel %d%s", MAC2STR(s_fast_record.bssid),
+                 s_fast_record.channel, s_fast_static_ip ? ", saved address" : "");
+    }
+
     ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
     ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config));
     ESP_ERROR_CHECK(esp_wifi_start());
@@ -112,7 +273,8 @@ void init_wifi(void)
     /* xEventGroupWaitBits() returns the bits before the call returned, hence we can test which event actually
      * happened. */
     if (bits & WIFI_CONNECTED_BIT) {
-        ESP_LOGI(TAG, "connected to ap SSID:%s", WIFI_SSID);
+        ESP_LOGI(TAG, "connected to ap SSID:%s in %u ms", WIFI_SSID,
+                 (unsigned)((esp_timer_get_time() - s_wifi_start_us) / 1000));
     } else if (bits & WIFI_FAIL_BIT) {
         ESP_LOGI(TAG, "Failed to connect to SSID:%s", WIFI_SSID);
         // For this demo, we'll restart if WiFi fails
@@ -3,6 +3,7 @@
 
 #include <string.h>
 #include <memory>
+#include <algorithm>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/event_groups.h"
@@ -21,6 +22,7 @@
 #include "tinymcp_session.h"
 #include "tinymcp_socket_transport.h"
 #include "tinymcp_tools.h"
+#include "tinymcp_reactor.h"
 
 static const char *TAG = "ESP8266-MCP-Session";
 
@@ -33,6 +35,11 @@ static const char *TAG = "ESP8266-MCP-Session";
 #define SERVER_PORT    8080
 #define MAX_CONNECTIONS 3
 
+// Reactor mode serves every client from one select() task instead of
+// four tasks per session, which allows many more concurrent clients
+#define USE_SESSION_REACTOR     1
+#define MAX_REACTOR_SESSIONS    8
+
 /* FreeRTOS event group to signal when we are connected*/
 static EventGroupHandle_t s_wifi_event_group;
 
@@ -48,6 +55,7 @@ static int s_retry_num = 0;
 static std::unique_ptr<tinymcp::EspSocketServer> g_server;
 static std::vector<std::shared_ptr<tinymcp::Session>> g_active_sessions;
 static SemaphoreHandle_t g_sessions_mutex;
+static std::unique_ptr<tinymcp::SessionReactor> g_reactor;
 
 void print_memory_info(const char* location) {
     size_t free_heap = esp_get_free_heap_size();
@@ -131,54 +139,84 @@ void init_wifi(void)
     }
 }
 
-void session_cleanup_task(void *pvParameters)
+void configure_session(tinymcp::Session& session)
 {
-    ESP_LOGI(TAG, "Session cleanup task started");
+    // Configure server information
+    session.setServerInfo("TinyMCP ESP8266 Server", "1.0.0");
     
-    while (true) {
-        vTaskDelay(pdMS_TO_TICKS(30000)); // Clean up every 30 seconds
-        
-        if (xSemaphoreTake(g_sessions_mutex, pdMS_TO_TICKS(1000)) == pdTRUE) {
-            auto it = g_active_sessions.begin();
-            while (it != g_active_sessions.end()) {
-                auto& session = *it;
-                
-                if (session->getState() == tinymcp::SessionState::SHUTDOWN ||
-                    session->getState() == tinymcp::SessionState::ERROR_STATE) {
-                    
-                    ESP_LOGI(TAG, "Cleaning up finished session");
-                    it = g_active_sessions.erase(it);
-                } else {
-                    ++it;
-                }
-            }
-            xSemaphoreGive(g_sessions_mutex);
-        }
-        
-        // Log session statistics
-        size_t activeCount = g_active_sessions.size();
-        if (activeCount > 0) {
-            ESP_LOGI(TAG, "Active sessions: %zu", activeCount);
+    // Set server capabilities
+    tinymcp::ServerCapabilities capabilities;
+    capabilities.setProgressNotifications(true);
+    capabilities.setToolsListChanged(true);
+    session.setServerCapabilities(capabilities);
+    
+    // Add available tools from registry
+    auto& toolRegistry = tinymcp::ToolRegistry::getInstance();
+    auto toolNames = toolRegistry.getToolNames();
+    for (const auto& toolName : toolNames) {
+        const char* description = toolRegistry.getDescription(toolName);
+        if (description) {
+            session.addTool(toolName, description);
         }
-        
-        print_memory_info("Session cleanup");
     }
 }
 
-void session_manager_task(void *pvParameters)
+tinymcp::SocketTransportConfig make_transport_config()
 {
-    ESP_LOGI(TAG, "Session manager task started");
-    print_memory_info("Session manager start");
-    
-    // Configure socket transport
     tinymcp::SocketTransportConfig transport_config;
     transport_config.maxMessageSize = 4096;
     transport_config.receiveTimeoutMs = 5000;
     transport_config.sendTimeoutMs = 5000;
     transport_config.enableKeepAlive = true;
+    return transport_config;
+}
+
+tinymcp::SessionConfig make_session_config()
+{
+    tinymcp::SessionConfig session_config;
+    session_config.maxPendingTasks = 5;
+    session_config.taskStackSize = 3072; // Reduced for ESP8266
+    session_config.messageQueueSize = 8;
+    session_config.taskTimeoutMs = 30000;
+    session_config.sessionTimeoutMs = 300000; // 5 minutes
+    session_config.taskPriority = 3;
+    session_config.enableProgressReporting = true;
+    session_config.enableToolsPagination = true;
+    return session_config;
+}
+
+int start_session_reactor()
+{
+    g_server = std::make_unique<tinymcp::EspSocketServer>(SERVER_PORT, make_transport_config());
+    g_server->setMaxConnections(MAX_REACTOR_SESSIONS);
+    
+    tinymcp::ReactorConfig reactor_config;
+    reactor_config.maxSessions = MAX_REACTOR_SESSIONS;
+    reactor_config.sessionConfig.maxPendingTasks = 5;
+    reactor_config.sessionConfig.taskTimeoutMs = 30000;
+    reactor_config.sessionConfig.sessionTimeoutMs = 300000; // 5 minutes
+    reactor_config.sessionConfig.enableToolsPagination = true;
+    
+    g_reactor = std::make_unique<tinymcp::SessionReactor>(*g_server, reactor_config);
+    g_reactor->setSessionSetup(configure_session);
+    
+    int result = g_reactor->start();
+    if (result != tinymcp::TINYMCP_SUCCESS) {
+        ESP_LOGE(TAG, "Failed to start session reactor: %d", result);
+        return result;
+    }
+    
+    ESP_LOGI(TAG, "TinyMCP session reactor listening on port %d", SERVER_PORT);
+    return result;
+}
+
+void session_manager_task(void *pvParameters)
+{
+    ESP_LOGI(TAG, "Session manager task started");
+    print_memory_info("Session manager start");
     
     // Create socket server
-    g_server = std::make_unique<tinymcp::EspSocketServer>(SERVER_PORT, transport_config);
+    g_server = std::make_unique<tinymcp::EspSocketServer>(SERVER_PORT, make_transport_config());
     
     if (g_server->start() != tinymcp::TINYMCP_SUCCESS) {
         ESP_LOGE(TAG, "Failed to start socket server");
@@ -201,40 +239,12 @@ void session_manager_task(void *pvParameters)
                 continue;
             }
             
-            // Configure session
-            tinymcp::SessionConfig session_config;
-            session_config.maxPendingTasks = 5;
-            session_config.taskStackSize = 3072; // Reduced for ESP8266
-            session_config.messageQueueSize = 8;
-            session_config.taskTimeoutMs = 30000;
-            session_config.sessionTimeoutMs = 300000; // 5 minutes
-            session_config.taskPriority = 3;
-            session_config.enableProgressReporting = true;
-            session_config.enableToolsPagination = false;
-            
-            // Create session
+            // Create session, from the pool when a slot is free
             auto& sessionManager = tinymcp::SessionManager::getInstance();
-            auto session = sessionManager.createSession(std::move(transport), session_config);
+            auto session = sessionManager.createSession(std::move(transport), make_session_config());
             
             if (session) {
-                // Configure server information
-                session->setServerInfo("TinyMCP ESP8266 Server", "1.0.0");
-                
-                // Set server capabilities
-                tinymcp::ServerCapabilities capabilities;
-                capabilities.setProgressNotifications(true);
-                capabilities.setToolsListChanged(true);
-                session->setServerCapabilities(capabilities);
-                
-                // Add available tools from registry
-                auto& toolRegistry = tinymcp::ToolRegistry::getInstance();
-                auto toolNames = toolRegistry.getToolNames();
-                for (const auto& toolName : toolNames) {
-                    const auto* tool = toolRegistry.getTool(toolName);
-                    if (tool) {
-                        session->addTool(toolName, tool->description);
-                    }
-                }
+                configure_session(*session);
                 
                 // Initialize session
                 int result = session->initialize();
@@ -258,6 +268,20 @@ void session_manager_task(void *pvParameters)
                             session->run();
                             ESP_LOGI(TAG, "Session run loop ended");
                             
+                            // Idle timeouts end run() from the shared timer wheel,
+                            // so the finished session is dropped right here
+                            if (xSemaphoreTake(g_sessions_mutex, pdMS_TO_TICKS(1000)) == pdTRUE) {
+                                g_active_sessions.erase(
+                                    std::remove(g_active_sessions.begin(), g_active_sessions.end(), session),
+                                    g_active_sessions.end());
+                                ESP_LOGI(TAG, "Active sessions: %zu", g_active_sessions.size());
+                                xSemaphoreGive(g_sessions_mutex);
+                            }
+                            print_memory_info("Session ended");
+                            
+                            // vTaskDelete() skips destructors; the pool reuses the
+                            // session only once this reference is gone
+                            session.reset();
                             vTaskDelete(NULL);
                         },
                         taskName.c_str(),
@@ -343,29 +367,26 @@ extern "C" void app_main(void)
         return;
     }
 
-    // Register default tools
+    // Register default tools. Their schemas and init hooks run on first
+    // use, so nothing here should enumerate the registry.
     ESP_LOGI(TAG, "Registering tools...");
     tinymcp::registerDefaultTools();
-    
-    // Register custom tools if needed
-    auto& toolRegistry = tinymcp::ToolRegistry::getInstance();
-    ESP_LOGI(TAG, "Available tools: %zu", toolRegistry.getToolNames().size());
-    
-    for (const auto& toolName : toolRegistry.getToolNames()) {
-        ESP_LOGI(TAG, "  - %s", toolName.c_str());
-    }
 
     ESP_LOGI(TAG, "WiFi connected, starting session manager...");
 
-    // Create session cleanup task
-    xTaskCreate(
-        session_cleanup_task,
-        "session_cleanup",
-        2048,           // Stack size
-        NULL,           // Parameters
-        2,              // Priority (lower than session manager)
-        NULL            // Task handle
-    );
+#if USE_SESSION_REACTOR
+    if (start_session_reactor() != tinymcp::TINYMCP_SUCCESS) {
+        esp_restart();
+        return;
+    }
+#else
+    // Allocate every session's queues and locks once, up front, so
+    // reconnecting clients do not churn the heap
+    if (tinymcp::SessionManager::getInstance().initializePool(MAX_CONNECTIONS, make_session_config()) !=
+        tinymcp::TINYMCP_SUCCESS) {
+        ESP_LOGW(TAG, "Session pool incomplete, extra sessions allocated per connection");
+    }
+    print_memory_info("After session pool");
 
     // Create session manager task
     xTaskCreate(
@@ -376,6 +397,7 @@ extern "C" void app_main(void)
         5,              // Priority
         NULL            // Task handle
     );
+#endif
 
     ESP_LOGI(TAG, "ESP8266-MCP Session Management initialization complete");
     